@@ -14,6 +14,9 @@
 #   --check-only    Only validate, don't commit
 #   --force         Skip validation warnings
 #   --backup        Create backup before deploy
+#   --bench-log F   Compare a captured benchmark log against the baseline
+#                   (default: build and run the host benchmark)
+#   --bench-save    Store the benchmark log as the new baseline
 
 set -e  # Exit on any error
 
@@ -28,6 +31,11 @@ NC='\033[0m' # No Color
 PROJECT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 ARDUINO_DIR="$PROJECT_DIR/firmware/multifunctional-clock"
 BACKUP_DIR="$PROJECT_DIR/.backups"
+CHECKS_HEADER="$ARDUINO_DIR/Checks.h"
+BENCH_BASELINE=${BENCH_BASELINE:-"$PROJECT_DIR/firmware/benchmarks/baseline.txt"}  # Host run by default
+BENCH_TOLERANCE=${BENCH_TOLERANCE:-10}  # Allowed slowdown in percent
+BENCH_SLACK_NS=${BENCH_SLACK_NS:-2}     # Plus two 1 us timer steps over 1000 calls
+HOST_BENCH_RUNS=${HOST_BENCH_RUNS:-5}   # Host benchmark runs, fastest kept
 
 # Parse command line arguments
 CHECK_ONLY=false
@@ -35,6 +43,8 @@ FORCE_DEPLOY=false
 CREATE_BACKUP=false
 DEV_MODE=false
 USE_COMMIT_HELPER=false
+BENCH_LOG=""
+BENCH_SAVE=false
 
 while [[ $# -gt 0 ]]; do
   case $1 in
@@ -58,13 +68,23 @@ while [[ $# -gt 0 ]]; do
       USE_COMMIT_HELPER=true
       shift
       ;;
+    --bench-log)
+      BENCH_LOG="$2"
+      shift 2
+      ;;
+    --bench-save)
+      BENCH_SAVE=true
+      shift
+      ;;
     -h|--help)
-      echo "Usage: $0 [--check-only] [--force] [--backup] [--dev] [--interactive]"
+      echo "Usage: $0 [--check-only] [--force] [--backup] [--dev] [--interactive] [--bench-log FILE] [--bench-save]"
       echo "  --check-only    Only validate, don't commit"
       echo "  --force         Skip validation warnings"
       echo "  --backup        Create backup before deploy"
       echo "  --dev           Development mode (ignore some warnings)"
       echo "  --interactive   Use interactive commit helper"
+      echo "  --bench-log F   Compare serial log F (BENCHMARK_MODE build) against the baseline"
+      echo "  --bench-save    Store the benchmark log as the new baseline"
       exit 0
       ;;
     *)
@@ -227,6 +247,14 @@ run_tests() {
     else
       print_warning "Compilation test failed - check your code"
     fi
+    
+    print_status "Attempting benchmark build..."
+    if arduino-cli compile --fqbn arduino:renesas_uno:unor4wifi \
+         --build-property "compiler.cpp.extra_flags=-DBENCHMARK_MODE=1" "$ARDUINO_DIR" &>/dev/null; then
+      print_success "Benchmark build passed"
+    else
+      print_warning "Benchmark build failed - check Benchmark.h"
+    fi
   else
     if [ "$DEV_MODE" = false ]; then
       print_warning "Arduino CLI not found - skipping compilation test"
@@ -235,6 +263,141 @@ run_tests() {
       print_status "Arduino CLI not found - skipping compilation test (development mode)"
     fi
   fi
+  
+  run_host_benchmarks
+}
+
+# Build the BENCHMARK_MODE sketch on the host board (firmware/host) and
+# run it on the host clock a few times; the checks must pass on every run
+# and the fastest timing of each benchmark is compared. The log feeds
+# check_benchmarks unless a board log was given with --bench-log.
+run_host_benchmarks() {
+  if [ -n "$BENCH_LOG" ]; then
+    return
+  fi
+  if ! command -v g++ &> /dev/null; then
+    print_warning "g++ not found - skipping host benchmark run"
+    return
+  fi
+  
+  HOST_BUILD_DIR=$(mktemp -d)
+  trap 'rm -rf "$HOST_BUILD_DIR"' EXIT
+  
+  print_status "Building host benchmark..."
+  if ! (cd "$PROJECT_DIR/firmware" && g++ -O2 -std=gnu++17 -DBENCHMARK_MODE=1 -include Arduino.h \
+          -Ihost -Imultifunctional-clock host/main.cpp host/HostBoard.cpp \
+          -o "$HOST_BUILD_DIR/clock"); then
+    print_error "Host benchmark build failed"
+    exit 1
+  fi
+  
+  print_status "Running host benchmark ($HOST_BENCH_RUNS runs)..."
+  BENCH_LOG="$HOST_BUILD_DIR/bench.txt"
+  : > "$BENCH_LOG"
+  for ((run = 1; run <= HOST_BENCH_RUNS; run++)); do
+    if ! "$HOST_BUILD_DIR/clock" --real-time --loops 10 >> "$BENCH_LOG"; then
+      print_error "Host benchmark run $run failed"
+      exit 1
+    fi
+  done
+  print_success "Host benchmark run complete"
+}
+
+# Check the lines of one BENCHMARK_MODE check in the serial log:
+# PREFIX-BEGIN, one 'PREFIX {json}' line per scenario with its "ok" flag,
+# then 'PREFIX-END failures=N'. A check that never printed its END line
+# (not built in, or the board reset during it) fails like a failed one.
+gate() {
+  local prefix="$1"
+  local label="$2"
+  local failures
+  failures=$(grep -o "^$prefix {.*\"ok\":false}" "$BENCH_LOG" | sed -E 's/.*"name":"([^"]+)".*/\1/')
+  if [ -n "$failures" ]; then
+    print_error "$label failed:"
+    echo "$failures" | sed 's/^/  /'
+    exit 1
+  fi
+  if ! grep -Eq "^$prefix-END failures=0[[:space:]]*$" "$BENCH_LOG"; then
+    print_error "$label did not complete: no $prefix-END failures=0 line in $BENCH_LOG"
+    exit 1
+  fi
+  print_success "$label passed"
+}
+
+# List the "PREFIX label" pairs of the checks, from the CHECK_LIST entries
+# of Checks.h that the BENCHMARK_MODE build runs
+list_checks() {
+  sed -nE 's/^[[:space:]]*CHECK\([A-Za-z]+, *\([^)]*\), *([A-Z]+), *"([^"]+)"\).*/\1 \2/p' "$CHECKS_HEADER"
+}
+
+# Extract "name ns_per_call" pairs from the BENCH lines of a serial log,
+# keeping the fastest result of a benchmark that ran more than once
+extract_bench_results() {
+  grep -o 'BENCH {.*}' "$1" | \
+    sed -E 's/.*"name":"([^"]+)".*"ns_per_call":([0-9]+).*/\1 \2/' | \
+    awk '!($1 in best) { order[n++] = $1; best[$1] = $2 }
+         $2 < best[$1] { best[$1] = $2 }
+         END { for (i = 0; i < n; i++) print order[i], best[order[i]] }'
+}
+
+# Function to compare benchmark results against the baseline
+check_benchmarks() {
+  if [ -z "$BENCH_LOG" ]; then
+    return
+  fi
+  
+  print_status "Checking benchmark results..."
+  
+  if [ ! -f "$BENCH_LOG" ] || ! grep -q 'BENCH {' "$BENCH_LOG"; then
+    print_error "No benchmark results found in $BENCH_LOG"
+    exit 1
+  fi
+  
+  # Functional checks gate the deploy, even with --force
+  local checks=0
+  local prefix label
+  while read -r prefix label; do
+    gate "$prefix" "$label"
+    checks=$((checks + 1))
+  done < <(list_checks)
+  if [ "$checks" -eq 0 ]; then
+    print_error "No checks found in $CHECKS_HEADER"
+    exit 1
+  fi
+  
+  if $BENCH_SAVE; then
+    mkdir -p "$(dirname "$BENCH_BASELINE")"
+    grep 'BENCH {' "$BENCH_LOG" > "$BENCH_BASELINE"
+    print_success "Benchmark baseline saved: $BENCH_BASELINE"
+    return
+  fi
+  
+  if [ ! -f "$BENCH_BASELINE" ]; then
+    print_warning "No benchmark baseline - run with --bench-save to record one"
+    return
+  fi
+  
+  local regressions
+  regressions=$(awk -v tol="$BENCH_TOLERANCE" -v slack="$BENCH_SLACK_NS" '
+    NR == FNR { base[$1] = $2; next }
+    {
+      if (!($1 in base)) { printf "  %-32s %8d ns (new)\n", $1, $2; next }
+      limit = base[$1] * (100 + tol) / 100 + slack
+      status = ($2 > limit) ? "REGRESSION" : "ok"
+      printf "  %-32s %8d ns (baseline %d ns) %s\n", $1, $2, base[$1], status
+    }' <(extract_bench_results "$BENCH_BASELINE") <(extract_bench_results "$BENCH_LOG"))
+  
+  echo "$regressions"
+  
+  if echo "$regressions" | grep -q "REGRESSION"; then
+    print_warning "Benchmark regressions above ${BENCH_TOLERANCE}% detected"
+    if ! $FORCE_DEPLOY; then
+      print_error "Use --force to deploy anyway"
+      exit 1
+    fi
+  else
+    print_success "No benchmark regressions"
+  fi
 }
 
 # Function to show git status
@@ -311,6 +474,7 @@ main() {
   validate_arduino_structure
   check_code_quality
   run_tests
+  check_benchmarks
   commit_and_push
   
   print_success "Deployment process completed!"
@@ -0,0 +1,36 @@
+/**
+ * @file FuzzTarget.h
+ * @brief Common setup of the parser fuzz harnesses
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The parsers are the firmware headers, built against the host stubs
+ * (../host). A board is selected before the first input so that any
+ * Arduino call made by the code under test has somewhere to go.
+ * FUZZ_CHECK aborts on a broken invariant, which the fuzzer reports as
+ * a crash with the input that caused it.
+ */
+
+#ifndef FUZZ_TARGET_H
+#define FUZZ_TARGET_H
+
+#include <Arduino.h>
+
+#define FUZZ_CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      fprintf(stderr, "%s:%d: invariant failed: %s\n", __FILE__, __LINE__, #condition); \
+      abort(); \
+    } \
+  } while (0)
+
+/**
+ * @brief Board used by the harness for the life of the process
+ */
+static struct FuzzBoard {
+  HostBoard board;
+  FuzzBoard() { hostBoard = &board; }
+} fuzzBoard;
+
+#endif // FUZZ_TARGET_H
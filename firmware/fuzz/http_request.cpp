@@ -0,0 +1,54 @@
+/**
+ * @file http_request.cpp
+ * @brief libFuzzer harness for HttpRequestParser::feed
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The first input byte picks a chunk size; the rest is fed to one parser
+ * in chunks of that size and to another byte by byte. Both must reach
+ * the same result and the same request, and a parsed request must stay
+ * within the parser's limits.
+ */
+
+#include "FuzzTarget.h"
+#include "HttpParser.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 1) {
+    return 0;
+  }
+  size_t chunk = data[0] % 64 + 1;
+  data++;
+  size--;
+
+  static HttpRequestParser chunked;
+  static HttpRequestParser bytewise;
+  chunked.reset();
+  bytewise.reset();
+
+  HttpParseResult result = HTTP_PARSE_INCOMPLETE;
+  for (size_t pos = 0; pos < size; pos += chunk) {
+    result = chunked.feed(data + pos, size - pos < chunk ? size - pos : chunk);
+  }
+  for (size_t pos = 0; pos < size && bytewise.getResult() == HTTP_PARSE_INCOMPLETE; pos++) {
+    bytewise.feed((char)data[pos]);
+  }
+
+  FUZZ_CHECK(result == bytewise.getResult());
+  FUZZ_CHECK(strlen(chunked.getPath()) <= HTTP_MAX_PATH);
+  FUZZ_CHECK(strlen(chunked.getQuery()) <= HTTP_MAX_QUERY);
+  FUZZ_CHECK(chunked.getBodyLength() <= HTTP_MAX_BODY);
+  if (result == HTTP_PARSE_ERROR) {
+    FUZZ_CHECK(chunked.getErrorStatus() >= 400 && chunked.getErrorStatus() < 600);
+    FUZZ_CHECK(chunked.getErrorStatus() == bytewise.getErrorStatus());
+  } else if (result == HTTP_PARSE_COMPLETE) {
+    FUZZ_CHECK(chunked.getMethod() == bytewise.getMethod());
+    FUZZ_CHECK(strcmp(chunked.getPath(), bytewise.getPath()) == 0);
+    FUZZ_CHECK(strcmp(chunked.getQuery(), bytewise.getQuery()) == 0);
+    FUZZ_CHECK(chunked.getBodyLength() == bytewise.getBodyLength());
+    FUZZ_CHECK(memcmp(chunked.getBody(), bytewise.getBody(), chunked.getBodyLength()) == 0);
+    chunked.ifNoneMatch("\"00000000\"");
+  }
+  return 0;
+}
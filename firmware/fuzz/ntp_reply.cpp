@@ -0,0 +1,43 @@
+/**
+ * @file ntp_reply.cpp
+ * @brief libFuzzer harness for NtpPacket::parseReply
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The first 8 input bytes are the nonce of the request, the rest is the
+ * datagram received. An accepted reply must match every check
+ * parseReply() documents, and isClientRequest() must never accept it.
+ */
+
+#include "FuzzTarget.h"
+#include "NtpPacket.h"
+
+static uint32_t be32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 8) {
+    return 0;
+  }
+  NtpTimestamp nonce;
+  nonce.seconds = be32(data);
+  nonce.fraction = be32(data + 4);
+  data += 8;
+  size -= 8;
+
+  NtpReply reply;
+  NtpStatus status = NtpPacket::parseReply(data, size, nonce, reply);
+  if (status == NTP_OK) {
+    FUZZ_CHECK(size >= NTP_PACKET_SIZE);
+    FUZZ_CHECK((data[0] & 0x07) == 4);
+    FUZZ_CHECK(reply.stratum >= 1 && reply.stratum <= 15);
+    FUZZ_CHECK(reply.leap != 3);
+    FUZZ_CHECK(reply.transmit.seconds != 0 || reply.transmit.fraction != 0);
+    FUZZ_CHECK(be32(data + 24) == nonce.seconds);
+    FUZZ_CHECK(!NtpPacket::isClientRequest(data, size));
+    reply.unixSeconds();
+  }
+  return 0;
+}
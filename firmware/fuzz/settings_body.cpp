@@ -0,0 +1,32 @@
+/**
+ * @file settings_body.cpp
+ * @brief libFuzzer harness for SettingsParser feed/finish
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * Feeds the input as a POST /api/settings body. Whatever the body,
+ * every setting must stay within its range and, for settings with
+ * presets, on one of them; a body that fails must report an error.
+ */
+
+#include "FuzzTarget.h"
+#include "Settings.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  Settings settings;
+  settings.loadDefaults();
+  SettingsParser parser(settings);
+  parser.feed((const char*)data, size);
+  bool ok = parser.finish();
+
+  FUZZ_CHECK(ok == !parser.hasError());
+  FUZZ_CHECK(parser.getAppliedCount() <= size);
+  for (int i = 0; i < SETTING_COUNT; i++) {
+    FUZZ_CHECK(Settings::isAllowed(SETTINGS_TABLE[i], settings.get((SettingId)i)));
+  }
+
+  char json[JSON_BUFFER_SIZE];
+  FUZZ_CHECK(settings.toJson(json, sizeof(json)) > 0);
+  return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file standalone_main.cpp
+ * @brief Runs a fuzz harness without libFuzzer
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * For compilers without -fsanitize=fuzzer (e.g. g++). Replays every file
+ * of the corpus directories given, then, with -runs or -max_total_time,
+ * keeps mutating corpus inputs at random: bit flips, byte changes,
+ * inserts and deletes, chunk copies and protocol tokens. There is no
+ * coverage feedback, so this is for replaying crashes and smoke runs
+ * under the sanitizers; use libFuzzer for real campaigns. Prints one
+ * FUZZ {json} line with the number of runs and exec/s.
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+typedef std::vector<uint8_t> Input;
+
+static const char* const TOKENS[] = {
+  "\r\n", "\r\n\r\n", "GET ", "POST ", " HTTP/1.1", " HTTP/1.0", "/api/data", "/api/settings",
+  "/api/history", "?", "&", "=", "%", "%2D", "+", "Content-Length: ", "If-None-Match: ",
+  "W/", "\"", ",", "*", "nightStart", "sunriseMinutes", "alarm1Days", "timezone", "-",
+  "0", "255", "4294967295", "99999999999"
+};
+
+static uint32_t rngState = 2463534242UL;
+
+static uint32_t next() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static void loadFile(const std::string& path, std::vector<Input>& corpus) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return;
+  }
+  Input input;
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    input.insert(input.end(), buffer, buffer + n);
+  }
+  fclose(file);
+  corpus.push_back(input);
+}
+
+static void load(const std::string& path, std::vector<Input>& corpus) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    fprintf(stderr, "cannot read %s\n", path.c_str());
+    return;
+  }
+  if (!S_ISDIR(info.st_mode)) {
+    loadFile(path, corpus);
+    return;
+  }
+  DIR* dir = opendir(path.c_str());
+  while (dirent* entry = dir ? readdir(dir) : nullptr) {
+    if (entry->d_name[0] != '.') {
+      load(path + "/" + entry->d_name, corpus);
+    }
+  }
+  if (dir) closedir(dir);
+}
+
+static void mutate(Input& input, const std::vector<Input>& corpus, size_t maxLength) {
+  int count = 1 + next() % 4;
+  for (int i = 0; i < count; i++) {
+    size_t size = input.size();
+    switch (next() % 7) {
+      case 0:
+        if (size) input[next() % size] ^= 1 << (next() % 8);
+        break;
+      case 1:
+        if (size) input[next() % size] = next();
+        break;
+      case 2:
+        input.insert(input.begin() + (size ? next() % (size + 1) : 0), (uint8_t)next());
+        break;
+      case 3:
+        if (size) {
+          size_t at = next() % size;
+          size_t n = 1 + next() % (size - at);
+          input.erase(input.begin() + at, input.begin() + at + n);
+        }
+        break;
+      case 4:
+        if (size) {
+          size_t at = next() % size;
+          size_t n = 1 + next() % (size - at);
+          Input chunk(input.begin() + at, input.begin() + at + n);
+          input.insert(input.begin() + next() % (size + 1), chunk.begin(), chunk.end());
+        }
+        break;
+      case 5: {
+        const char* token = TOKENS[next() % (sizeof(TOKENS) / sizeof(TOKENS[0]))];
+        input.insert(input.begin() + (size ? next() % (size + 1) : 0), token, token + strlen(token));
+        break;
+      }
+      default: {
+        // Splice with another corpus input
+        const Input& other = corpus[next() % corpus.size()];
+        if (!other.empty()) {
+          size_t at = next() % (size + 1);
+          input.resize(at);
+          size_t from = next() % other.size();
+          input.insert(input.end(), other.begin() + from, other.end());
+        }
+        break;
+      }
+    }
+  }
+  if (input.size() > maxLength) {
+    input.resize(maxLength);
+  }
+}
+
+int main(int argc, char** argv) {
+  unsigned long runs = 0;
+  double maxTime = 0;
+  size_t maxLength = 4096;
+  std::vector<Input> corpus;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-runs=", 6)) {
+      runs = strtoul(argv[i] + 6, nullptr, 10);
+    } else if (!strncmp(argv[i], "-max_total_time=", 16)) {
+      maxTime = atof(argv[i] + 16);
+    } else if (!strncmp(argv[i], "-max_len=", 9)) {
+      maxLength = strtoul(argv[i] + 9, nullptr, 10);
+    } else if (!strncmp(argv[i], "-seed=", 6)) {
+      rngState = strtoul(argv[i] + 6, nullptr, 10) | 1;
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "ignored option %s\n", argv[i]);
+    } else {
+      load(argv[i], corpus);
+    }
+  }
+  if (corpus.empty()) {
+    corpus.push_back(Input());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  unsigned long executed = 0;
+  for (const Input& input : corpus) {
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+    executed++;
+  }
+
+  Input input;
+  double elapsed = 0;
+  // Stops at whichever limit is reached first, like libFuzzer
+  while ((runs || maxTime > 0) && !(runs && executed >= runs) && !(maxTime > 0 && elapsed >= maxTime)) {
+    input = corpus[next() % corpus.size()];
+    mutate(input, corpus, maxLength);
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+    executed++;
+    if ((executed & 1023) == 0) {
+      elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+  }
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  const char* name = strrchr(argv[0], '/');
+  printf("FUZZ {\"target\":\"%s\",\"corpus\":%zu,\"runs\":%lu,\"seconds\":%.2f,\"exec_per_s\":%.0f}\n",
+         name ? name + 1 : argv[0], corpus.size(), executed, elapsed,
+         elapsed > 0 ? executed / elapsed : 0.0);
+  return 0;
+}
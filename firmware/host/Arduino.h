@@ -0,0 +1,170 @@
+/**
+ * @file Arduino.h
+ * @brief Arduino core for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * Just enough of the Arduino API for the firmware to compile and run on
+ * a PC: time, pins, random numbers, Print/Stream and IPAddress. Every
+ * call goes to the board selected in hostBoard (HostBoard.h). Force it
+ * into the sketch with -include Arduino.h, as the Arduino IDE does.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "HostBoard.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+#define A4 18
+#define A5 19
+#define PROGMEM
+#define F(x) (x)
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+inline unsigned long micros() { return (unsigned long)(uint32_t)hostBoard->now(); }
+inline unsigned long millis() { return (unsigned long)(uint32_t)(hostBoard->now() / 1000); }
+inline void delay(unsigned long ms) { hostBoard->advance((uint64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { hostBoard->advance(us); }
+
+inline void pinMode(int pin, int mode) {}
+inline int digitalRead(int pin) { return pin >= 0 && pin < HOST_PIN_COUNT ? hostBoard->pins[pin] : LOW; }
+inline void digitalWrite(int pin, int value) {
+  if (pin >= 0 && pin < HOST_PIN_COUNT) hostBoard->pins[pin] = value ? HIGH : LOW;
+}
+inline int analogRead(int pin) { return 512; }
+
+inline long random(long howbig) {
+  if (howbig <= 0) return 0;
+  uint32_t x = hostBoard->rngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  hostBoard->rngState = x;
+  return (long)(x % (uint32_t)howbig);
+}
+inline long random(long low, long high) { return low < high ? low + random(high - low) : low; }
+inline void randomSeed(unsigned long seed) { hostBoard->rngState = seed ? (uint32_t)seed : 1; }
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+template<class T> T min(T a, T b) { return a < b ? a : b; }
+template<class T> T max(T a, T b) { return a > b ? a : b; }
+
+inline uint8_t pgm_read_byte(const void* p) { return *(const uint8_t*)p; }
+inline uint16_t pgm_read_word(const void* p) { uint16_t v; memcpy(&v, p, 2); return v; }
+inline uint32_t pgm_read_dword(const void* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+/**
+ * @class Print
+ * @brief Text and number formatting over write(), as in the Arduino core
+ */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buffer[n])) n++;
+    return n;
+  }
+  virtual void flush() {}
+
+  size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t print(const char* text) { return write(text); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = 10) { return print((long)v, base); }
+  size_t print(unsigned v, int base = 10) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = 10) {
+    return base == 10 ? format("%ld", v) : print((unsigned long)v, base);
+  }
+  size_t print(unsigned long v, int base = 10) { return format(base == 16 ? "%lX" : "%lu", v); }
+  size_t print(long long v) { return format("%lld", v); }
+  size_t print(unsigned long long v) { return format("%llu", v); }
+  size_t print(double v, int digits = 2) { return format("%.*f", digits, v); }
+  size_t println() { return write((const uint8_t*)"\r\n", 2); }
+  template<class T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template<class T> size_t println(T v, int base) { size_t n = print(v, base); return n + println(); }
+
+private:
+  template<class... A> size_t format(const char* spec, A... args) {
+    char text[40];
+    int length = snprintf(text, sizeof(text), spec, args...);
+    return write((const uint8_t*)text, length < (int)sizeof(text) ? length : sizeof(text) - 1);
+  }
+};
+
+#define HEX 16
+#define DEC 10
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+};
+
+/**
+ * @class HardwareSerial
+ * @brief Serial port writing to the board's serial sink
+ */
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  operator bool() { return true; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    hostBoard->serialBytes += size;
+    return hostBoard->serial ? hostBoard->serial->write(buffer, size) : size;
+  }
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+/**
+ * @class IPAddress
+ * @brief IPv4 address, stored in network order
+ */
+class IPAddress {
+private:
+  uint8_t bytes[4];
+
+public:
+  IPAddress() : bytes{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+  IPAddress(uint32_t value) { memcpy(bytes, &value, 4); }
+  uint8_t operator[](int i) const { return bytes[i]; }
+  uint8_t& operator[](int i) { return bytes[i]; }
+  operator uint32_t() const { uint32_t v; memcpy(&v, bytes, 4); return v; }
+  bool operator==(const IPAddress& o) const { return memcmp(bytes, o.bytes, 4) == 0; }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+  bool fromString(const char* text) {
+    unsigned a, b, c, d;
+    char extra;
+    if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 ||
+        a > 255 || b > 255 || c > 255 || d > 255) {
+      return false;
+    }
+    bytes[0] = a; bytes[1] = b; bytes[2] = c; bytes[3] = d;
+    return true;
+  }
+};
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,59 @@
+/**
+ * @file FastLED.h
+ * @brief FastLED for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The LED buffers belong to the firmware; show() only counts frames on
+ * the current board, so the buffers can be checked after each loop().
+ */
+
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+#include <Arduino.h>
+
+struct CRGB {
+  uint8_t r, g, b;
+
+  enum : uint32_t { Black = 0x000000, White = 0xFFFFFF, Red = 0xFF0000 };
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+  CRGB(uint32_t code) : r(code >> 16), g(code >> 8), b(code) {}
+  CRGB& operator=(uint32_t code) { r = code >> 16; g = code >> 8; b = code; return *this; }
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB& o) const { return !(*this == o); }
+  uint8_t& operator[](int i) { return (&r)[i]; }
+  const uint8_t& operator[](int i) const { return (&r)[i]; }
+};
+
+enum { WS2812B };
+enum { GRB };
+
+#define BINARY_DITHER 1
+#define DISABLE_DITHER 0
+
+struct CLEDController {
+  CLEDController& setDither(uint8_t mode) { return *this; }
+  CLEDController& setCorrection(uint32_t correction) { return *this; }
+};
+
+class CFastLED {
+public:
+  template<int CHIPSET, int PIN, int ORDER>
+  CLEDController& addLeds(CRGB* leds, int count) {
+    static CLEDController controller;
+    return controller;
+  }
+  void setBrightness(uint8_t scale) { hostBoard->brightness = scale; }
+  uint8_t getBrightness() { return hostBoard->brightness; }
+  void setDither(uint8_t mode) {}
+  void show() { hostBoard->frames++; }
+  void clear(bool write = false) {}
+};
+
+extern CFastLED FastLED;
+
+#endif // HOST_FASTLED_H
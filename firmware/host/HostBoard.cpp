@@ -0,0 +1,64 @@
+/**
+ * @file HostBoard.cpp
+ * @brief Board state and library globals for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <RTC.h>
+#include <FastLED.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+RTClock RTC;
+CFastLED FastLED;
+
+static HostNetwork quietNetwork;
+
+thread_local HostBoard* hostBoard = nullptr;
+
+static uint64_t hostMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+HostBoard::HostBoard() :
+  micros(0),
+  realTime(false),
+  realStart(hostMicros()),
+  rngState(1),
+  serial(nullptr),
+  serialBytes(0),
+  network(&quietNetwork),
+  rtcRunning(false),
+  rtcSeconds(0),
+  rtcSetAt(0),
+  brightness(255),
+  frames(0) {
+  memset(pins, HIGH, sizeof(pins));
+  useDhcp();
+}
+
+uint64_t HostBoard::now() {
+  return realTime ? hostMicros() - realStart : micros;
+}
+
+void HostBoard::useDhcp() {
+  ip = IPAddress(192, 168, 1, 10);
+  dns = IPAddress(192, 168, 1, 1);
+  gateway = IPAddress(192, 168, 1, 1);
+  subnet = IPAddress(255, 255, 255, 0);
+}
+
+void HostBoard::advance(uint64_t us) {
+  if (realTime) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  } else {
+    micros += us;
+  }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file HostBoard.h
+ * @brief State of one simulated board for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The host stubs of the Arduino, WiFi, RTC and FastLED libraries keep no
+ * state of their own: micros(), the pins, Serial, the RTC and the network
+ * all read and write the HostBoard selected for the calling thread. One
+ * board per thread runs the sketch on its own (host/main.cpp); the fleet
+ * simulator switches a thread between many boards, each with its own
+ * virtual time and HostNetwork.
+ *
+ * Time is virtual: it only advances through delay() and
+ * delayMicroseconds(), so a simulated day takes as long as the loop()
+ * code does, not 24 hours. With realTime set, micros() reads the host
+ * clock instead, which is what BENCHMARK_MODE timings need.
+ */
+
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class Print;
+class IPAddress;
+
+#define HOST_PIN_COUNT          32
+
+/**
+ * @class HostNetwork
+ * @brief What the WiFi module sees around one board
+ *
+ * The defaults are a LAN that associates at once and where nobody
+ * answers; the fleet simulator overrides them with its DNS, NTP and MQTT
+ * servers. Sockets are numbered by the board: a UDP socket by its local
+ * port, a TCP connection by the handle tcpConnect() returned.
+ */
+class HostNetwork {
+public:
+  virtual ~HostNetwork() {}
+
+  virtual void wifiBegin(const char* ssid) {}
+  virtual void wifiDisconnect() {}
+  virtual bool wifiConnected() { return true; }
+
+  virtual bool resolve(const char* host, IPAddress& address) { return false; }
+
+  virtual bool udpSend(uint16_t localPort, const IPAddress& address, uint16_t port,
+                       const uint8_t* data, size_t length) { return true; }
+  /**
+   * @return Length of the next datagram due on localPort, 0 if none
+   */
+  virtual int udpReceive(uint16_t localPort, uint8_t* buffer, size_t size,
+                         IPAddress& address, uint16_t& port) { return 0; }
+
+  /**
+   * @return Connection handle, 0 if refused
+   */
+  virtual int tcpConnect(const IPAddress& address, uint16_t port) { return 0; }
+  virtual int tcpAccept(uint16_t port) { return 0; }
+  virtual bool tcpConnected(int handle) { return false; }
+  virtual int tcpAvailable(int handle) { return 0; }
+  virtual int tcpRead(int handle, uint8_t* buffer, size_t size) { return 0; }
+  virtual size_t tcpWrite(int handle, const uint8_t* data, size_t length) { return 0; }
+  virtual void tcpClose(int handle) {}
+};
+
+/**
+ * @struct HostBoard
+ * @brief Pins, clock, RTC and radio of one board
+ */
+struct HostBoard {
+  uint64_t micros;                 ///< Virtual time since power-up (us)
+  bool realTime;                   ///< micros() reads the host clock
+  uint64_t realStart;              ///< Host clock at power-up (us)
+  uint8_t pins[HOST_PIN_COUNT];    ///< Input levels, HIGH when released
+  uint32_t rngState;               ///< random() generator
+  Print* serial;                   ///< Serial output, nullptr to discard
+  unsigned long serialBytes;       ///< Bytes written to Serial
+  HostNetwork* network;            ///< Never nullptr
+  uint32_t ip, dns, gateway, subnet;  ///< WiFi.config() addresses
+
+  bool rtcRunning;
+  uint32_t rtcSeconds;             ///< RTC time at rtcSetAt (UTC)
+  uint64_t rtcSetAt;               ///< Board time of the last RTC write (us)
+
+  uint8_t brightness;
+  unsigned long frames;            ///< FastLED.show() calls
+
+  HostBoard();
+
+  /**
+   * @brief Board time (us), from virtual or real time
+   */
+  uint64_t now();
+
+  /**
+   * @brief Let time pass (us); sleeps in real time
+   */
+  void advance(uint64_t us);
+
+  /**
+   * @brief Addresses a DHCP server on the host LAN hands out
+   */
+  void useDhcp();
+};
+
+/**
+ * @brief Board used by the calling thread's Arduino calls
+ */
+extern thread_local HostBoard* hostBoard;
+
+#endif // HOST_BOARD_H
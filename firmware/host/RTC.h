@@ -0,0 +1,46 @@
+/**
+ * @file RTC.h
+ * @brief UNO R4 RTC library for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The RTC of the current board: stopped until first set, then counting
+ * seconds on the board's clock.
+ */
+
+#ifndef HOST_RTC_H
+#define HOST_RTC_H
+
+#include <Arduino.h>
+
+class RTCTime {
+private:
+  time_t unixTime;
+
+public:
+  RTCTime() : unixTime(0) {}
+  explicit RTCTime(time_t t) : unixTime(t) {}
+  time_t getUnixTime() { return unixTime; }
+  bool setUnixTime(time_t t) { unixTime = t; return true; }
+};
+
+class RTClock {
+public:
+  bool begin() { return true; }
+  bool isRunning() { return hostBoard->rtcRunning; }
+  bool setTime(RTCTime& time) {
+    hostBoard->rtcSeconds = (uint32_t)time.getUnixTime();
+    hostBoard->rtcSetAt = hostBoard->now();
+    hostBoard->rtcRunning = true;
+    return true;
+  }
+  bool getTime(RTCTime& time) {
+    time.setUnixTime(hostBoard->rtcSeconds + (time_t)((hostBoard->now() - hostBoard->rtcSetAt) / 1000000));
+    return hostBoard->rtcRunning;
+  }
+};
+
+extern RTClock RTC;
+
+#endif // HOST_RTC_H
@@ -0,0 +1,17 @@
+/**
+ * @file TimeLib.h
+ * @brief Time library for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * The firmware keeps its own time and only pushes it to TimeLib, so
+ * setTime() has nothing to do on the host.
+ */
+
+#ifndef HOST_TIME_LIB_H
+#define HOST_TIME_LIB_H
+
+inline void setTime(unsigned long unixSeconds) {}
+
+#endif // HOST_TIME_LIB_H
@@ -0,0 +1,132 @@
+/**
+ * @file WiFi.h
+ * @brief WiFiS3 for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * WiFi, WiFiClient and WiFiServer forward to the HostNetwork of the
+ * current board. A client is a connection handle, so copies share the
+ * connection like they do on the UNO R4. WiFi.begin() waits for the
+ * association for up to setTimeout() like the WiFiS3 one does, and an
+ * all-zero WiFi.config() goes back to the DHCP addresses.
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+
+#define HOST_WIFI_BEGIN_TIMEOUT 10000   // Default wait in WiFiS3's begin() (ms)
+
+enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+  WL_NO_MODULE = 255
+};
+
+class Client : public Stream {
+public:
+  virtual int connect(IPAddress address, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+};
+
+class WiFiClient : public Client {
+private:
+  int handle;
+
+public:
+  WiFiClient() : handle(0) {}
+  explicit WiFiClient(int connection) : handle(connection) {}
+
+  int connect(IPAddress address, uint16_t port) override {
+    stop();
+    handle = hostBoard->network->tcpConnect(address, port);
+    return handle != 0;
+  }
+  int connect(const char* host, uint16_t port) {
+    IPAddress address;
+    return hostBoard->network->resolve(host, address) && connect(address, port);
+  }
+  uint8_t connected() override { return handle && hostBoard->network->tcpConnected(handle); }
+  void stop() override {
+    if (handle) hostBoard->network->tcpClose(handle);
+    handle = 0;
+  }
+  int available() override { return handle ? hostBoard->network->tcpAvailable(handle) : 0; }
+  int read() override {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  int read(uint8_t* buffer, size_t size) {
+    return handle ? hostBoard->network->tcpRead(handle, buffer, size) : 0;
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    return handle ? hostBoard->network->tcpWrite(handle, buffer, size) : 0;
+  }
+  using Print::write;
+  operator bool() { return handle != 0; }
+};
+
+class WiFiServer {
+private:
+  uint16_t port;
+
+public:
+  explicit WiFiServer(uint16_t listenPort) : port(listenPort) {}
+  void begin() {}
+  WiFiClient available() { return WiFiClient(hostBoard->network->tcpAccept(port)); }
+  WiFiClient accept() { return available(); }
+};
+
+class WiFiClass {
+private:
+  unsigned long timeout = HOST_WIFI_BEGIN_TIMEOUT;
+
+public:
+  /**
+   * @brief Join a network, waiting up to the timeout for the association,
+   *        as WiFiS3 does
+   */
+  int begin(const char* ssid, const char* password) {
+    hostBoard->network->wifiBegin(ssid);
+    for (unsigned long waited = 0; status() != WL_CONNECTED && waited < timeout; waited++) {
+      delay(1);
+    }
+    return status() == WL_CONNECTED ? WL_CONNECTED : WL_CONNECT_FAILED;
+  }
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  void disconnect() { hostBoard->network->wifiDisconnect(); }
+  int status() { return hostBoard->network->wifiConnected() ? WL_CONNECTED : WL_DISCONNECTED; }
+  void config(IPAddress local) { hostBoard->ip = local; }
+  void config(IPAddress local, IPAddress server) { config(local); hostBoard->dns = server; }
+  void config(IPAddress local, IPAddress server, IPAddress router, IPAddress mask) {
+    if (local == IPAddress(0, 0, 0, 0)) {
+      hostBoard->useDhcp();
+      return;
+    }
+    config(local, server);
+    hostBoard->gateway = router;
+    hostBoard->subnet = mask;
+  }
+  IPAddress localIP() { return hostBoard->ip; }
+  IPAddress gatewayIP() { return hostBoard->gateway; }
+  IPAddress subnetMask() { return hostBoard->subnet; }
+  IPAddress dnsIP(int n = 0) { return hostBoard->dns; }
+  int32_t RSSI() { return -60; }
+  uint8_t* BSSID(uint8_t* bssid) { memset(bssid, 0, 6); return bssid; }
+  uint8_t channel() { return 6; }
+  int hostByName(const char* host, IPAddress& address) {
+    return hostBoard->network->resolve(host, address) ? 1 : 0;
+  }
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,90 @@
+/**
+ * @file WiFiUdp.h
+ * @brief WiFiS3 UDP sockets for host builds
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * A socket is its local port on the current board's HostNetwork. The
+ * outgoing datagram is collected between beginPacket() and endPacket(),
+ * the incoming one is read by parsePacket(), as with the WiFi module.
+ */
+
+#ifndef HOST_WIFI_UDP_H
+#define HOST_WIFI_UDP_H
+
+#include <WiFi.h>
+
+#define HOST_UDP_PACKET_MAX     576
+
+class UDP : public Stream {};
+
+class WiFiUDP : public UDP {
+private:
+  uint16_t localPort;
+  IPAddress txAddress;
+  uint16_t txPort;
+  uint8_t tx[HOST_UDP_PACKET_MAX];
+  size_t txLength;
+  uint8_t rx[HOST_UDP_PACKET_MAX];
+  size_t rxLength;
+  size_t rxPos;
+  IPAddress rxAddress;
+  uint16_t rxPort;
+
+public:
+  WiFiUDP() : localPort(0), txPort(0), txLength(0), rxLength(0), rxPos(0), rxPort(0) {}
+
+  uint8_t begin(uint16_t port) {
+    localPort = port;
+    return 1;
+  }
+  void stop() {
+    localPort = 0;
+    rxLength = rxPos = 0;
+  }
+
+  int beginPacket(IPAddress address, uint16_t port) {
+    txAddress = address;
+    txPort = port;
+    txLength = 0;
+    return localPort != 0;
+  }
+  int beginPacket(const char* host, uint16_t port) {
+    IPAddress address;
+    return hostBoard->network->resolve(host, address) && beginPacket(address, port);
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    if (txLength + size > sizeof(tx)) {
+      return 0;
+    }
+    memcpy(tx + txLength, buffer, size);
+    txLength += size;
+    return size;
+  }
+  using Print::write;
+  int endPacket() {
+    return hostBoard->network->udpSend(localPort, txAddress, txPort, tx, txLength);
+  }
+
+  int parsePacket() {
+    rxPos = 0;
+    int length = localPort ? hostBoard->network->udpReceive(localPort, rx, sizeof(rx), rxAddress, rxPort) : 0;
+    rxLength = length > 0 ? length : 0;
+    return rxLength;
+  }
+  int available() override { return rxLength - rxPos; }
+  int read() override { return rxPos < rxLength ? rx[rxPos++] : -1; }
+  int read(unsigned char* buffer, size_t size) {
+    size_t n = rxLength - rxPos < size ? rxLength - rxPos : size;
+    memcpy(buffer, rx + rxPos, n);
+    rxPos += n;
+    return n;
+  }
+  int read(char* buffer, size_t size) { return read((unsigned char*)buffer, size); }
+  IPAddress remoteIP() { return rxAddress; }
+  uint16_t remotePort() { return rxPort; }
+};
+
+#endif // HOST_WIFI_UDP_H
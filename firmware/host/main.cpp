@@ -0,0 +1,49 @@
+/**
+ * @file main.cpp
+ * @brief Runs the sketch on one host board
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * Calls setup() then loop() on a board with a quiet network, Serial on
+ * stdout. Virtual time by default; --real-time runs on the host clock,
+ * for BENCHMARK_MODE timings. Build from the firmware directory:
+ *
+ *   g++ -O2 -std=gnu++17 -include Arduino.h -Ihost -Imultifunctional-clock \
+ *       host/main.cpp host/HostBoard.cpp -o clock
+ *   ./clock [--loops N] [--real-time]
+ */
+
+#include <Arduino.h>
+#include "multifunctional-clock.ino"
+
+/**
+ * @brief Serial sink writing to stdout
+ */
+class StdoutPrint : public Print {
+public:
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+};
+
+int main(int argc, char** argv) {
+  long loops = 2000;
+  HostBoard board;
+  StdoutPrint out;
+  board.serial = &out;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--loops") && i + 1 < argc) {
+      loops = atol(argv[++i]);
+    } else if (!strcmp(argv[i], "--real-time")) {
+      board.realTime = true;
+    }
+  }
+  hostBoard = &board;
+
+  setup();
+  for (long i = 0; i < loops; i++) {
+    loop();
+  }
+  fflush(stdout);
+  return 0;
+}
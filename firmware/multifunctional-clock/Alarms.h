@@ -0,0 +1,335 @@
+/**
+ * @file Alarms.h
+ * @brief Alarm and one-shot timer scheduling
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Alarms repeat on a set of weekdays or ring once at the next occurrence
+ * of their time; timers ring once after a number of seconds. Every alarm,
+ * the snooze and every timer is one timer of a TimerWheel ticked once per
+ * second, so the clock never scans the alarm list: each alarm is
+ * rescheduled only when it fires or when the time or its settings change.
+ * 
+ * Each alarm also has a sunrise timer that fires the configured number of
+ * minutes before it, to start the wake light.
+ */
+
+#ifndef ALARMS_H
+#define ALARMS_H
+
+#include "config.h"
+#include "Settings.h"
+#include "TimerWheel.h"
+
+// Timer wheel ids
+#define ALARM_FIRST_SUNRISE_ID ALARM_COUNT
+#define ALARM_SNOOZE_ID       (2 * ALARM_COUNT)
+#define ALARM_FIRST_TIMER_ID  (2 * ALARM_COUNT + 1)
+#define ALARM_COUNTDOWN_ID    (ALARM_FIRST_TIMER_ID + ALARM_TIMER_COUNT) // Not on the wheel
+#define ALARM_NONE            0xFF
+
+static_assert(ALARM_FIRST_TIMER_ID + ALARM_TIMER_COUNT <= TIMER_WHEEL_CAPACITY,
+              "TIMER_WHEEL_CAPACITY too small for the alarms and timers");
+
+/**
+ * @struct AlarmConfig
+ * @brief Time and repeat days of one alarm
+ */
+struct AlarmConfig {
+  uint8_t hour;    ///< Hour (0-23)
+  uint8_t minute;  ///< Minute (0-59)
+  uint8_t days;    ///< Weekday mask, ALARM_DAYS_ONCE or ALARM_DAYS_OFF
+};
+
+/**
+ * @class AlarmScheduler
+ * @brief Schedules alarms, snooze and timers and tracks the ringing one
+ * 
+ * Ids below ALARM_COUNT are alarms, the next ALARM_COUNT ids are their
+ * sunrise timers, ALARM_SNOOZE_ID is the snooze and the ALARM_TIMER_COUNT
+ * ids after it are one-shot timers. tick() must be
+ * called once per second with the local time after the increment.
+ */
+class AlarmScheduler {
+private:
+  TimerWheel wheel;
+  AlarmConfig alarms[ALARM_COUNT];
+  bool spent[ALARM_COUNT];   ///< One-shot alarm that already rang
+  uint8_t ringingId;         ///< Id of the ringing alarm or timer
+  uint8_t snoozedId;         ///< Id that the snooze will ring again
+  uint16_t ringElapsed;      ///< Seconds since ringing started
+  uint16_t sunriseDuration;  ///< Wake light ramp length (s), 0 = off
+  uint8_t sunriseId;         ///< Alarm whose wake light is running
+
+public:
+  /**
+   * @brief Constructor
+   */
+  AlarmScheduler() :
+    ringingId(ALARM_NONE),
+    snoozedId(ALARM_NONE),
+    ringElapsed(0),
+    sunriseDuration(0),
+    sunriseId(ALARM_NONE) {
+    for (uint8_t i = 0; i < ALARM_COUNT; i++) {
+      alarms[i].hour = 0;
+      alarms[i].minute = 0;
+      alarms[i].days = ALARM_DAYS_OFF;
+      spent[i] = false;
+    }
+  }
+  
+  /**
+   * @brief Load the alarm settings and schedule every alarm
+   * 
+   * A one-shot alarm that already rang stays off until its settings
+   * change.
+   * 
+   * @param settings Current settings
+   * @param weekday Current weekday (0 = Sunday)
+   * @param secondOfDay Current local time in seconds since midnight
+   */
+  void configure(const Settings& settings, uint8_t weekday, uint32_t secondOfDay) {
+    sunriseDuration = settings.get(SETTING_SUNRISE_MINUTES) * 60;
+    
+    for (uint8_t i = 0; i < ALARM_COUNT; i++) {
+      AlarmConfig config;
+      config.hour = settings.get(alarmSetting(i, SETTING_ALARM1_HOUR));
+      config.minute = settings.get(alarmSetting(i, SETTING_ALARM1_MINUTE));
+      config.days = settings.get(alarmSetting(i, SETTING_ALARM1_DAYS));
+      
+      if (config.hour != alarms[i].hour || config.minute != alarms[i].minute ||
+          config.days != alarms[i].days) {
+        spent[i] = false;
+      }
+      alarms[i] = config;
+    }
+    reschedule(weekday, secondOfDay);
+  }
+  
+  /**
+   * @brief Reschedule every alarm after a time change
+   * 
+   * Timers and a pending snooze keep their remaining delay.
+   * 
+   * @param weekday Current weekday (0 = Sunday)
+   * @param secondOfDay Current local time in seconds since midnight
+   */
+  void reschedule(uint8_t weekday, uint32_t secondOfDay) {
+    sunriseId = ALARM_NONE;
+    for (uint8_t i = 0; i < ALARM_COUNT; i++) {
+      scheduleAlarm(i, weekday, secondOfDay);
+    }
+  }
+  
+  /**
+   * @brief Advance one second and ring whatever is due
+   * 
+   * @param weekday Current weekday (0 = Sunday)
+   * @param secondOfDay Current local time in seconds since midnight
+   */
+  void tick(uint8_t weekday, uint32_t secondOfDay) {
+    if (ringingId != ALARM_NONE && ++ringElapsed >= ALARM_RING_DURATION) {
+      DEBUG_PRINTLN("Alarm stopped ringing");
+      ringingId = ALARM_NONE;
+    }
+    
+    wheel.tick();
+    
+    int id;
+    while ((id = wheel.popExpired()) >= 0) {
+      if (id < ALARM_COUNT) {
+        if (alarms[id].days == ALARM_DAYS_ONCE) {
+          spent[id] = true;
+        }
+        if (sunriseId == id) {
+          sunriseId = ALARM_NONE;
+        }
+        scheduleAlarm(id, weekday, secondOfDay);
+        ring(id);
+      } else if (id < ALARM_SNOOZE_ID) {
+        sunriseId = id - ALARM_FIRST_SUNRISE_ID;
+        DEBUG_PRINTLN("Wake light started");
+      } else if (id == ALARM_SNOOZE_ID) {
+        ring(snoozedId);
+      } else {
+        ring(id);
+      }
+    }
+  }
+  
+  /**
+   * @brief Silence the ringing alarm and ring it again later
+   */
+  void snooze() {
+    if (ringingId == ALARM_NONE) {
+      return;
+    }
+    snoozedId = ringingId;
+    ringingId = ALARM_NONE;
+    wheel.schedule(ALARM_SNOOZE_ID, ALARM_SNOOZE_DURATION);
+    DEBUG_PRINTLN("Alarm snoozed");
+  }
+  
+  /**
+   * @brief Silence the ringing alarm and cancel any snooze
+   */
+  void dismiss() {
+    ringingId = ALARM_NONE;
+    wheel.cancel(ALARM_SNOOZE_ID);
+  }
+  
+  /**
+   * @brief Start a one-shot timer
+   * 
+   * @param seconds Delay before it rings
+   * @return Timer index (0 to ALARM_TIMER_COUNT - 1), or -1 if all are busy
+   */
+  int startTimer(uint32_t seconds) {
+    for (uint8_t i = 0; i < ALARM_TIMER_COUNT; i++) {
+      if (!wheel.isPending(ALARM_FIRST_TIMER_ID + i)) {
+        wheel.schedule(ALARM_FIRST_TIMER_ID + i, seconds);
+        return i;
+      }
+    }
+    return -1;
+  }
+  
+  /**
+   * @brief Cancel a one-shot timer
+   */
+  void cancelTimer(uint8_t index) {
+    if (index < ALARM_TIMER_COUNT) {
+      wheel.cancel(ALARM_FIRST_TIMER_ID + index);
+    }
+  }
+  
+  /**
+   * @brief Ring for the end of the UI countdown
+   * 
+   * The countdown is timed outside the wheel to the microsecond; it rings,
+   * snoozes and stops like a timer.
+   */
+  void ringCountdown() {
+    ring(ALARM_COUNTDOWN_ID);
+  }
+  
+  /**
+   * @brief Check whether an alarm or timer is ringing
+   */
+  bool isRinging() const {
+    return ringingId != ALARM_NONE;
+  }
+  
+  /**
+   * @brief Seconds since the current ringing started
+   */
+  uint16_t getRingElapsed() const {
+    return ringElapsed;
+  }
+  
+  /**
+   * @brief Get the running wake light ramp
+   * 
+   * @param remaining Seconds until the alarm that ends the ramp
+   * @return false if no wake light is running
+   */
+  bool getSunrise(uint32_t& remaining) const {
+    if (sunriseId == ALARM_NONE) {
+      return false;
+    }
+    remaining = wheel.remaining(sunriseId);
+    return true;
+  }
+  
+  /**
+   * @brief Length of the wake light ramp in seconds, 0 if disabled
+   */
+  uint16_t getSunriseDuration() const {
+    return sunriseDuration;
+  }
+  
+  /**
+   * @brief Seconds until an alarm rings, 0 if it is off
+   */
+  uint32_t getSecondsToAlarm(uint8_t index) const {
+    return index < ALARM_COUNT ? wheel.remaining(index) : 0;
+  }
+  
+  /**
+   * @brief Seconds until a timer rings, 0 if it is idle
+   */
+  uint32_t getSecondsToTimer(uint8_t index) const {
+    return index < ALARM_TIMER_COUNT ? wheel.remaining(ALARM_FIRST_TIMER_ID + index) : 0;
+  }
+  
+  /**
+   * @brief Seconds from a time to the next occurrence of an alarm
+   * 
+   * @param alarm Alarm to look up
+   * @param weekday Weekday of the start time (0 = Sunday)
+   * @param secondOfDay Start time in seconds since midnight
+   * @return Delay in seconds (1 to 7 days), or 0 if the alarm never rings
+   */
+  static uint32_t secondsUntil(const AlarmConfig& alarm, uint8_t weekday, uint32_t secondOfDay) {
+    if (alarm.days == ALARM_DAYS_OFF) {
+      return 0;
+    }
+    
+    long alarmOfDay = alarm.hour * 3600L + alarm.minute * 60L;
+    
+    for (uint8_t d = 0; d <= 7; d++) {
+      long delay = d * 86400L + alarmOfDay - (long)secondOfDay;
+      uint8_t day = (weekday + d) % 7;
+      if (delay > 0 && (alarm.days == ALARM_DAYS_ONCE || (alarm.days & (1 << day)))) {
+        return delay;
+      }
+    }
+    return 0;
+  }
+
+private:
+  /**
+   * @brief Setting id of one field of an alarm
+   * 
+   * @param index Alarm index
+   * @param firstAlarmField Field of the first alarm (SETTING_ALARM1_*)
+   */
+  static SettingId alarmSetting(uint8_t index, SettingId firstAlarmField) {
+    return (SettingId)(firstAlarmField + index * SETTINGS_PER_ALARM);
+  }
+  
+  void scheduleAlarm(uint8_t index, uint8_t weekday, uint32_t secondOfDay) {
+    uint32_t delay = spent[index] ? 0 : secondsUntil(alarms[index], weekday, secondOfDay);
+    if (delay > 0) {
+      wheel.schedule(index, delay);
+    } else {
+      wheel.cancel(index);
+    }
+    
+    // Wake light starts sunriseDuration before the alarm, or at once if
+    // the alarm is already closer than that
+    uint8_t sunrise = ALARM_FIRST_SUNRISE_ID + index;
+    if (delay > sunriseDuration) {
+      wheel.schedule(sunrise, delay - sunriseDuration);
+    } else {
+      wheel.cancel(sunrise);
+      if (delay > 0 && sunriseDuration > 0) {
+        sunriseId = index;
+      }
+    }
+  }
+  
+  void ring(uint8_t id) {
+    if (id == ALARM_NONE) {
+      return;
+    }
+    ringingId = id;
+    ringElapsed = 0;
+    DEBUG_PRINT("Alarm ringing: ");
+    DEBUG_PRINTLN(id);
+  }
+};
+
+#endif // ALARMS_H
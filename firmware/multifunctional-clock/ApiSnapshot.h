@@ -0,0 +1,136 @@
+/**
+ * @file ApiSnapshot.h
+ * @brief Pre-serialized API response, rebuilt only when its data changes
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * The sensor readings change every SENSOR_READ_INTERVAL, but a dashboard
+ * can ask for them much more often. A snapshot keeps the serialized body
+ * with the version of the data it was built from (the sensor sample
+ * sequence number), so a request only has to compare two integers and
+ * send the buffer as it is. Its ETag combines that version with a hash of
+ * the body: it changes with every new sample, and cannot match a body
+ * cached by a browser before a reboot restarted the sequence.
+ */
+
+#ifndef API_SNAPSHOT_H
+#define API_SNAPSHOT_H
+
+#include "config.h"
+
+#define API_ETAG_SIZE        24    // "<version>-<hash>" + suffix, quoted
+
+/**
+ * @class ApiSnapshot
+ * @brief One cached response body and its validator
+ */
+class ApiSnapshot {
+private:
+  char body[JSON_BUFFER_SIZE];
+  size_t length;
+  uint32_t version;
+  uint32_t hash;
+  bool valid;
+  unsigned long builds;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  ApiSnapshot() :
+    length(0),
+    version(0),
+    hash(0),
+    valid(false),
+    builds(0) {}
+  
+  /**
+   * @brief Check whether the body was built from this data version
+   */
+  bool isCurrent(uint32_t dataVersion) const {
+    return valid && version == dataVersion;
+  }
+  
+  /**
+   * @brief Buffer to serialize a new body into, then call store()
+   */
+  char* getBuffer() {
+    return body;
+  }
+  
+  size_t getCapacity() const {
+    return sizeof(body);
+  }
+  
+  /**
+   * @brief Keep the body just serialized into getBuffer()
+   * 
+   * @param bodyLength Length serialized, 0 if it failed
+   * @param dataVersion Version of the data it was built from
+   */
+  void store(size_t bodyLength, uint32_t dataVersion) {
+    length = bodyLength;
+    version = dataVersion;
+    valid = bodyLength > 0;
+    builds++;
+    
+    hash = 2166136261UL;  // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+      hash = (hash ^ (uint8_t)body[i]) * 16777619UL;
+    }
+  }
+  
+  /**
+   * @brief Force a rebuild on the next request
+   */
+  void invalidate() {
+    valid = false;
+  }
+  
+  const char* getBody() const { return body; }
+  size_t getLength() const { return valid ? length : 0; }
+  
+  /**
+   * @brief Number of times the body was serialized
+   */
+  unsigned long getBuildCount() const { return builds; }
+  
+  /**
+   * @brief Write the quoted ETag, e.g. "1c-9f3a61b2"
+   * 
+   * @param out Destination, at least API_ETAG_SIZE bytes
+   * @param suffix Appended inside the quotes for another encoding of the
+   * same body (e.g. "z" when compressed), or an empty string
+   */
+  void formatETag(char* out, const char* suffix) const {
+    size_t n = 0;
+    out[n++] = '"';
+    n += formatHex(out + n, version, false);
+    out[n++] = '-';
+    n += formatHex(out + n, hash, true);
+    while (*suffix && n < API_ETAG_SIZE - 2) {
+      out[n++] = *suffix++;
+    }
+    out[n++] = '"';
+    out[n] = '\0';
+  }
+
+private:
+  /**
+   * @brief Hexadecimal digits, all 8 or without leading zeros
+   */
+  static size_t formatHex(char* out, uint32_t value, bool fixed) {
+    static const char hex[] = "0123456789abcdef";
+    size_t n = 0;
+    bool started = fixed;
+    for (int shift = 28; shift >= 0; shift -= 4) {
+      uint8_t digit = (value >> shift) & 0xF;
+      if (digit != 0 || shift == 0) started = true;
+      if (started) out[n++] = hex[digit];
+    }
+    return n;
+  }
+};
+
+#endif // API_SNAPSHOT_H
@@ -0,0 +1,68 @@
+/**
+ * @file Backoff.h
+ * @brief Jittered exponential backoff between connection attempts
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Shared by the WiFi link (WifiConnection) and the MQTT session
+ * (MqttClient). The delay starts at a minimum and doubles for each
+ * consecutive failure up to a maximum; a random half of it is added on
+ * top of the other half, so clocks that lost the same access point or
+ * broker do not retry in step.
+ */
+
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <stdint.h>
+
+/**
+ * @class JitteredBackoff
+ * @brief Retry delays with exponential growth and random jitter
+ */
+class JitteredBackoff {
+private:
+  uint32_t minDelay;
+  uint32_t maxDelay;
+  uint32_t rngState;    ///< xorshift32 state, never 0
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param minimum Delay after the first failure (ms)
+   * @param maximum Longest delay (ms)
+   * @param seed Initial generator state
+   */
+  JitteredBackoff(uint32_t minimum, uint32_t maximum, uint32_t seed) :
+    minDelay(minimum),
+    maxDelay(maximum),
+    rngState(seed | 1) {}
+  
+  /**
+   * @brief Restart the jitter sequence, e.g. from micros() at boot
+   */
+  void seed(uint32_t value) {
+    rngState = value | 1;
+  }
+  
+  /**
+   * @brief Delay before the next attempt (ms)
+   * 
+   * @param failures Consecutive failed attempts before this one
+   * @return Between half and all of minimum << failures, capped at maximum
+   */
+  uint32_t delay(uint8_t failures) {
+    uint32_t full = maxDelay;
+    if (failures < 16 && (minDelay << failures) < maxDelay) {
+      full = minDelay << failures;
+    }
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return full / 2 + rngState % (full / 2 + 1);
+  }
+};
+
+#endif // BACKOFF_H
@@ -0,0 +1,495 @@
+/**
+ * @file Benchmark.h
+ * @brief On-device micro-benchmarks for the firmware hot paths
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * Measures the per-call cost of the code paths that run every loop or
+ * every second. Enabled by building with BENCHMARK_MODE set; results are
+ * printed over Serial as one "BENCH {json}" line per benchmark so a
+ * captured log can be compared against a baseline with deploy.sh.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "config.h"
+#include "ClockManager.h"
+#include "SensorManager.h"
+#include "DisplayManager.h"
+#include "NetworkManager.h"
+#include "UIManager.h"
+#include "HttpParser.h"
+#include "NtpPacket.h"
+#include "Settings.h"
+#include "Alarms.h"
+
+/**
+ * @class Benchmark
+ * @brief Times the managers' hot paths with micros()
+ *
+ * Benchmarked paths:
+ * - ClockManager::updateTimeFromEpoch
+ * - ClockManager LED frame composition
+ * - DisplayManager air quality strip rendering
+ * - SensorManager reading filters and sampling
+ * - NetworkManager JSON serialization
+ * - Telemetry batch encoding, JSON against CBOR
+ * - UIManager button debouncing
+ * - HTTP request, NTP reply and settings parsers
+ * - API_ENDPOINT requests, serialized each time against the snapshot
+ * - API_HISTORY_ENDPOINT bodies and requests, JSON against binary columns
+ * - Alarm timer wheel tick
+ *
+ * Rendering is measured without FastLED.show() so that only the
+ * firmware's own work is timed, not the strip data transfer.
+ */
+class Benchmark {
+private:
+  ClockManager& clock;
+  SensorManager& sensors;
+  DisplayManager& display;
+  NetworkManager& network;
+  UIManager& ui;
+
+  volatile unsigned long sink;  ///< Keeps results observable to the compiler
+
+  /**
+   * @brief Discards what is written, counting the bytes and the calls
+   */
+  class ByteCounter : public Print {
+  public:
+    unsigned long count;
+    unsigned long writes;       ///< Calls, each a round trip on a WiFiClient
+
+    ByteCounter() : count(0), writes(0) {}
+
+    size_t write(uint8_t c) override {
+      (void)c;
+      count++;
+      writes++;
+      return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+      (void)buffer;
+      count += size;
+      writes++;
+      return size;
+    }
+  };
+
+public:
+  /**
+   * @brief Constructor
+   */
+  Benchmark(ClockManager& clockMgr, SensorManager& sensorMgr,
+            DisplayManager& displayMgr, NetworkManager& networkMgr,
+            UIManager& uiMgr) :
+    clock(clockMgr),
+    sensors(sensorMgr),
+    display(displayMgr),
+    network(networkMgr),
+    ui(uiMgr),
+    sink(0) {}
+
+  /**
+   * @brief Run every benchmark and print the results
+   *
+   * Manager state touched by the benchmarks is saved and restored, so the
+   * firmware can keep running normally afterwards.
+   */
+  void runAll() {
+    Serial.println("BENCH-BEGIN");
+
+    TimeInfo savedTime = clock.currentTime;
+    SensorData savedData = sensors.currentData;
+
+    benchTimeFromEpoch();
+    benchClockFrame();
+    benchAirQualityFrame();
+    benchSensorFilter();
+    benchSensorSample();
+    benchJsonSerialization();
+    benchTelemetryBatch();
+    benchButtonDebounce();
+    benchHttpParse();
+    benchApiData();
+    benchHistoryQuery();
+    benchNtpParse();
+    benchSettingsParse();
+    benchAlarmTick();
+
+    clock.currentTime = savedTime;
+    sensors.currentData = savedData;
+
+    Serial.println("BENCH-END");
+  }
+
+private:
+  void benchTimeFromEpoch() {
+    unsigned long epoch = 1735689600UL;  // 2025-01-01 00:00:00 UTC
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      clock.updateTimeFromEpoch(epoch + i * 3607UL);
+      sink += clock.currentTime.seconds;
+    }
+    report("clock.updateTimeFromEpoch", micros() - start);
+  }
+
+  void benchClockFrame() {
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      clock.currentTime.hours = i % 24;
+      clock.currentTime.minutes = (i / 7) % 60;
+      clock.currentTime.seconds = i % 60;
+      clock.renderClockFrame();
+      sink += clock.minutesLEDs[clock.currentTime.seconds].r;
+    }
+    report("clock.renderClockFrame", micros() - start);
+  }
+
+  void benchAirQualityFrame() {
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      sink += display.renderAirQualityFrame(i % 600);
+    }
+    report("display.renderAirQualityFrame", micros() - start);
+  }
+
+  void benchSensorFilter() {
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      sensors.currentData.tempIndoor = 10.0 + (i % 30);
+      sensors.currentData.airQuality = i % 200;
+      sensors.filterReadings();
+      sink += sensors.currentData.airQuality;
+    }
+    report("sensors.filterReadings", micros() - start);
+  }
+
+  void benchSensorSample() {
+    // Seeded source so every run processes the same readings
+    SimulatedSensorSource replay(SENSOR_SIM_SEED);
+    sensors.setSource(&replay);
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      sink += sensors.sample();
+    }
+    report("sensors.sample", micros() - start);
+    sensors.setSource(nullptr);
+  }
+  
+  void benchJsonSerialization() {
+    char buffer[JSON_BUFFER_SIZE];
+    SensorData data = sensors.currentData;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      data.airQuality = i % 500;
+      sink += network.serializeSensorData(data, buffer, sizeof(buffer));
+    }
+    report("network.serializeSensorData", micros() - start);
+  }
+
+  /**
+   * @brief Same MQTT batch encoded as JSON and as CBOR
+   *
+   * Also prints the payload sizes as a "BENCH-SIZE {json}" line.
+   */
+  void benchTelemetryBatch() {
+    MqttSample samples[MQTT_BATCH_SIZE];
+    for (uint8_t i = 0; i < MQTT_BATCH_SIZE; i++) {
+      samples[i].time = 1748736000UL + i * (SENSOR_READ_INTERVAL / 1000);
+      samples[i].data = sensors.currentData;
+      samples[i].data.airQuality = 40 + i;
+    }
+    uint8_t buffer[MQTT_PACKET_MAX];
+
+    size_t jsonBytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      jsonBytes = NetworkManager::encodeBatch(samples, MQTT_BATCH_SIZE, buffer, sizeof(buffer));
+      sink += jsonBytes;
+    }
+    report("telemetry.encodeBatchJson", micros() - start);
+
+    size_t cborBytes = 0;
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      cborBytes = TelemetryCbor::encodeBatch(samples, MQTT_BATCH_SIZE, buffer, sizeof(buffer));
+      sink += cborBytes;
+    }
+    report("telemetry.encodeBatchCbor", micros() - start);
+
+    Serial.print("BENCH-SIZE {\"name\":\"telemetry.batch\",\"samples\":");
+    Serial.print(MQTT_BATCH_SIZE);
+    Serial.print(",\"json_bytes\":");
+    Serial.print((unsigned long)jsonBytes);
+    Serial.print(",\"cbor_bytes\":");
+    Serial.print((unsigned long)cborBytes);
+    Serial.println("}");
+  }
+
+  void benchButtonDebounce() {
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      ui.handleButtons(Timebase::millis64());
+      sink += ui.currentMode;
+    }
+    report("ui.handleButtons", micros() - start);
+  }
+
+  void benchHttpParse() {
+    static const char requestText[] =
+      "POST /api/settings HTTP/1.1\r\n"
+      "Host: clock.local\r\n"
+      "Content-Type: application/x-www-form-urlencoded\r\n"
+      "Content-Length: 24\r\n"
+      "\r\n"
+      "nightStart=22&nightEnd=7";
+    HttpRequestParser parser;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      parser.reset();
+      sink += parser.feed((const uint8_t*)requestText, sizeof(requestText) - 1);
+    }
+    report("http.parseRequest", micros() - start);
+  }
+
+  /**
+   * @brief GET API_ENDPOINT without the socket I/O: parse, then body
+   *
+   * Serializing on every request, as before the snapshot, against the
+   * snapshot and a conditional GET answered 304; calls_per_sec is the
+   * request rate the firmware itself can sustain.
+   */
+  void benchApiData() {
+    static const char requestText[] =
+      "GET /api/data HTTP/1.1\r\n"
+      "Host: clock.local\r\n"
+      "Accept: application/json\r\n"
+      "\r\n";
+    HttpRequestParser parser;
+    SensorData data = sensors.currentData;
+    char buffer[JSON_BUFFER_SIZE];
+    char etag[API_ETAG_SIZE];
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      parser.reset();
+      parser.feed((const uint8_t*)requestText, sizeof(requestText) - 1);
+      sink += network.serializeSensorData(data, buffer, sizeof(buffer));
+    }
+    report("api.dataUncached", micros() - start);
+
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      parser.reset();
+      parser.feed((const uint8_t*)requestText, sizeof(requestText) - 1);
+      const ApiSnapshot& snapshot = network.getDataSnapshot(data, 1, false);
+      snapshot.formatETag(etag, "");
+      sink += snapshot.getLength();
+    }
+    report("api.dataCached", micros() - start);
+
+    // Same request revalidating the copy it already has
+    char conditional[160];
+    size_t length = snprintf(conditional, sizeof(conditional),
+                             "GET /api/data HTTP/1.1\r\nHost: clock.local\r\nIf-None-Match: %s\r\n\r\n", etag);
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      parser.reset();
+      parser.feed((const uint8_t*)conditional, length);
+      const ApiSnapshot& snapshot = network.getDataSnapshot(data, 1, false);
+      snapshot.formatETag(etag, "");
+      sink += parser.ifNoneMatch(etag);
+    }
+    report("api.dataNotModified", micros() - start);
+
+    network.dataJson.invalidate();
+  }
+
+  /**
+   * @brief A day of history reduced to HISTORY_DEFAULT_POINTS
+   *
+   * A JSON answer holds one series and a binary answer all of them, so
+   * the same data is HISTORY_FIELD_COUNT JSON requests or one binary
+   * request: api.historyJson times one JSON body, api.historyJsonAll one
+   * per series and api.historyBinary the binary body. The
+   * api.historyRequest* lines time the same answers end to end, from the
+   * request text to the last byte handed to the client: parsing, query,
+   * headers and buffered body. Bytes and client writes of each are
+   * printed as a "BENCH-SIZE {json}" line.
+   */
+  void benchHistoryQuery() {
+    static HistoryLog log;  // Too large for the stack
+    SensorData data = sensors.currentData;
+    data.isValid = true;
+    for (uint16_t i = 0; i <= HISTORY_SIZE; i++) {
+      data.tempIndoor = 20.0f + (i % 50) * 0.1f;
+      log.add(data, 1748736000UL + i * HISTORY_INTERVAL);
+    }
+    HistoryRange range = log.select(0, 0xFFFFFFFFUL, 0);
+    ByteCounter json;
+    ByteCounter jsonAll;
+    ByteCounter binary;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      sink += NetworkManager::writeHistoryJson(json, log, range, HISTORY_TEMP_INDOOR,
+                                               HISTORY_DEFAULT_POINTS);
+    }
+    report("api.historyJson", micros() - start);
+
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; f++) {
+        sink += NetworkManager::writeHistoryJson(jsonAll, log, range, (HistoryField)f,
+                                                 HISTORY_DEFAULT_POINTS);
+      }
+    }
+    report("api.historyJsonAll", micros() - start);
+
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      sink += NetworkManager::writeHistoryBinary(binary, log, range, HISTORY_TEMP_INDOOR,
+                                                 HISTORY_DEFAULT_POINTS);
+    }
+    report("api.historyBinary", micros() - start);
+
+    // The same answers as whole requests
+    char requests[HISTORY_FIELD_COUNT + 1][96];
+    size_t lengths[HISTORY_FIELD_COUNT + 1];
+    for (uint8_t f = 0; f <= HISTORY_FIELD_COUNT; f++) {
+      lengths[f] = snprintf(requests[f], sizeof(requests[f]),
+                            "GET %s?%s%s HTTP/1.1\r\nHost: clock.local\r\n\r\n", API_HISTORY_ENDPOINT,
+                            f < HISTORY_FIELD_COUNT ? "field=" : "format=bin",
+                            f < HISTORY_FIELD_COUNT ? HistoryLog::fieldName((HistoryField)f) : "");
+    }
+    HttpRequestParser parser;
+    HistoryQuery params;
+    ByteCounter jsonAllRequest;
+    ByteCounter binaryRequest;
+
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; f++) {
+        parser.reset();
+        parser.feed((const uint8_t*)requests[f], lengths[f]);
+        sink += NetworkManager::parseHistoryQuery(parser.getQuery(), params);
+        NetworkManager::writeHistoryAnswer(jsonAllRequest, log, params);
+      }
+    }
+    report("api.historyRequestJsonAll", micros() - start);
+
+    start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      parser.reset();
+      parser.feed((const uint8_t*)requests[HISTORY_FIELD_COUNT], lengths[HISTORY_FIELD_COUNT]);
+      sink += NetworkManager::parseHistoryQuery(parser.getQuery(), params);
+      NetworkManager::writeHistoryAnswer(binaryRequest, log, params);
+    }
+    report("api.historyRequestBinary", micros() - start);
+
+    Serial.print("BENCH-SIZE {\"name\":\"api.history\",\"points\":");
+    Serial.print(HISTORY_DEFAULT_POINTS);
+    Serial.print(",\"series\":");
+    Serial.print(HISTORY_FIELD_COUNT);
+    Serial.print(",\"json_bytes\":");
+    Serial.print(json.count / BENCHMARK_ITERATIONS);
+    Serial.print(",\"json_all_bytes\":");
+    Serial.print(jsonAll.count / BENCHMARK_ITERATIONS);
+    Serial.print(",\"binary_bytes\":");
+    Serial.print(binary.count / BENCHMARK_ITERATIONS);
+    Serial.print(",\"json_all_request_bytes\":");
+    Serial.print(jsonAllRequest.count / BENCHMARK_ITERATIONS);
+    Serial.print(",\"json_all_request_writes\":");
+    Serial.print(jsonAllRequest.writes / BENCHMARK_ITERATIONS);
+    Serial.print(",\"binary_request_bytes\":");
+    Serial.print(binaryRequest.count / BENCHMARK_ITERATIONS);
+    Serial.print(",\"binary_request_writes\":");
+    Serial.print(binaryRequest.writes / BENCHMARK_ITERATIONS);
+    Serial.println("}");
+  }
+
+  void benchNtpParse() {
+    uint8_t packet[NTP_PACKET_SIZE];
+    NtpTimestamp nonce = { 0x12345678UL, 0x9ABCDEF0UL };
+    NtpPacket::buildRequest(packet, nonce);
+
+    // Turn the request into a plausible stratum 2 server reply
+    packet[0] = (0 << 6) | (4 << 3) | 4;
+    packet[1] = 2;
+    memcpy(packet + 24, packet + 40, 8);
+    packet[40] = 0xEB;
+
+    NtpReply reply;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      sink += NtpPacket::parseReply(packet, sizeof(packet), nonce, reply);
+    }
+    report("ntp.parseReply", micros() - start);
+  }
+
+  void benchSettingsParse() {
+    static const char body[] = "nightStart=22&nightEnd=7&nightBrightness=50&timezone=%2D1&dst=1";
+    Settings settings;
+    settings.loadDefaults();
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      SettingsParser parser(settings);
+      parser.feed(body, sizeof(body) - 1);
+      sink += parser.finish();
+    }
+    report("settings.parse", micros() - start);
+  }
+
+  void benchAlarmTick() {
+    // Every alarm and timer armed, so expiries and cascades are included
+    Settings settings;
+    settings.loadDefaults();
+    for (int i = 0; i < ALARM_COUNT; i++) {
+      settings.set((SettingId)(SETTING_ALARM1_DAYS + i * SETTINGS_PER_ALARM), ALARM_DAYS_EVERY_DAY);
+    }
+    AlarmScheduler scheduler;
+    uint32_t secondOfDay = 6 * 3600UL + 59 * 60UL;
+    scheduler.configure(settings, 1, secondOfDay);
+    for (int i = 0; i < ALARM_TIMER_COUNT; i++) {
+      scheduler.startTimer(100 + i * 300);
+    }
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < BENCHMARK_ITERATIONS; i++) {
+      scheduler.tick(1, ++secondOfDay);
+      sink += scheduler.isRinging();
+    }
+    report("alarms.tick", micros() - start);
+  }
+
+  /**
+   * @brief Print one result as a machine-readable line
+   *
+   * @param name Benchmark identifier
+   * @param elapsedMicros Total time for BENCHMARK_ITERATIONS calls
+   */
+  void report(const char* name, unsigned long elapsedMicros) {
+    unsigned long nsPerCall = (elapsedMicros * 1000UL) / BENCHMARK_ITERATIONS;
+    unsigned long callsPerSecond = elapsedMicros > 0 ?
+      (unsigned long)((BENCHMARK_ITERATIONS * 1000000ULL) / elapsedMicros) : 0;
+
+    Serial.print("BENCH {\"name\":\"");
+    Serial.print(name);
+    Serial.print("\",\"iterations\":");
+    Serial.print((unsigned long)BENCHMARK_ITERATIONS);
+    Serial.print(",\"total_us\":");
+    Serial.print(elapsedMicros);
+    Serial.print(",\"ns_per_call\":");
+    Serial.print(nsPerCall);
+    Serial.print(",\"calls_per_sec\":");
+    Serial.print(callsPerSecond);
+    Serial.println("}");
+  }
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,196 @@
+/**
+ * @file BootSequence.h
+ * @brief Staged, non-blocking start-up
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * setup() only brings up the display, the clock (with the RTC time) and
+ * the buttons, and draws the first frame. The slower subsystems are then
+ * started one stage per loop() iteration, so the clock is shown and the
+ * buttons answer while sensors, WiFi and NTP come up. Progress is shown
+ * on the LCD, and the times to the first frame and to the end of the
+ * boot are printed as "BOOT {json}" lines.
+ */
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include "config.h"
+#include "Timebase.h"
+#include "ClockManager.h"
+#include "SensorManager.h"
+#include "DisplayManager.h"
+#include "NetworkManager.h"
+
+/**
+ * @brief Start-up stages run from loop()
+ */
+enum BootStage {
+  BOOT_STAGE_SENSORS = 0,  ///< Initialize the sensors
+  BOOT_STAGE_NETWORK,      ///< Start the WiFi connection
+  BOOT_STAGE_NETWORK_WAIT, ///< Wait for the link or a failed attempt
+  BOOT_STAGE_NTP,          ///< Send the first NTP request
+  BOOT_STAGE_NTP_WAIT,     ///< Wait for the NTP reply
+  BOOT_STAGE_DONE,
+  BOOT_STAGE_COUNT = BOOT_STAGE_DONE
+};
+
+/**
+ * @class BootSequence
+ * @brief Runs the start-up stages without blocking the main loop
+ */
+class BootSequence {
+private:
+  ClockManager& clock;
+  SensorManager& sensors;
+  DisplayManager& display;
+  NetworkManager& network;
+  
+  BootStage stage;
+  uint64_t firstFrameMicros;  ///< Time from reset to the first LED frame
+  uint64_t readyMicros;       ///< Time from reset to the end of the boot
+
+public:
+  /**
+   * @brief Constructor
+   */
+  BootSequence(ClockManager& clockMgr, SensorManager& sensorMgr,
+               DisplayManager& displayMgr, NetworkManager& networkMgr) :
+    clock(clockMgr),
+    sensors(sensorMgr),
+    display(displayMgr),
+    network(networkMgr),
+    stage(BOOT_STAGE_SENSORS),
+    firstFrameMicros(0),
+    readyMicros(0) {}
+  
+  /**
+   * @brief Draw the first clock frame and report how long it took
+   * 
+   * Called at the end of setup(), once the clock is initialized.
+   */
+  void showFirstFrame() {
+    clock.forceDisplayUpdate();
+    firstFrameMicros = sinceReset();
+    
+    Serial.print("BOOT {\"event\":\"first_frame\",\"us\":");
+    Serial.print((unsigned long)firstFrameMicros);
+    Serial.print(",\"time_valid\":");
+    Serial.print(clock.isTimeValid() ? "true" : "false");
+    Serial.println("}");
+  }
+  
+  /**
+   * @brief Run the current stage for one step
+   * 
+   * Should be called every loop iteration; does nothing once the boot is
+   * done. No stage waits: the WiFi link and the NTP reply are advanced by
+   * the caller through NetworkManager::update() and
+   * ClockManager::updateNtpSync().
+   */
+  void update() {
+    switch (stage) {
+      case BOOT_STAGE_SENSORS:
+        showProgress("Capteurs...");
+        if (!sensors.init()) {
+          Serial.println("ATTENTION: Capteurs non disponibles");
+          display.showBootMessage("Capteurs: ERREUR");
+        }
+        stage = BOOT_STAGE_NETWORK;
+        break;
+      
+      case BOOT_STAGE_NETWORK:
+        showProgress("WiFi...");
+        if (network.init()) {
+          stage = BOOT_STAGE_NETWORK_WAIT;
+        } else {
+          Serial.println("ATTENTION: WiFi non disponible");
+          display.showBootMessage("WiFi: ERREUR");
+          finish();
+        }
+        break;
+      
+      case BOOT_STAGE_NETWORK_WAIT:
+        // Retries continue in the background; NTP follows the reconnect
+        if (network.isConnected()) {
+          stage = BOOT_STAGE_NTP;
+        } else if (network.hasConnectFailed()) {
+          Serial.println("ATTENTION: WiFi non disponible");
+          display.showBootMessage("WiFi: ERREUR");
+          finish();
+        }
+        break;
+      
+      case BOOT_STAGE_NTP:
+        showProgress("Heure NTP...");
+        if (clock.startNtpSync()) {
+          stage = BOOT_STAGE_NTP_WAIT;
+        } else {
+          finish();
+        }
+        break;
+      
+      case BOOT_STAGE_NTP_WAIT:
+        if (!clock.isNtpPending()) {
+          finish();
+        }
+        break;
+      
+      default:
+        break;
+    }
+  }
+  
+  /**
+   * @brief Check whether every stage has run
+   */
+  bool isDone() const {
+    return stage == BOOT_STAGE_DONE;
+  }
+  
+  /**
+   * @brief Time from reset to the first LED frame (us)
+   */
+  uint64_t getFirstFrameMicros() const {
+    return firstFrameMicros;
+  }
+  
+  /**
+   * @brief Time from reset to the end of the boot (us), 0 while booting
+   */
+  uint64_t getReadyMicros() const {
+    return readyMicros;
+  }
+
+private:
+  /**
+   * @brief Time since reset, whatever TIMEBASE_START_US is
+   */
+  static uint64_t sinceReset() {
+    return Timebase::micros64() - TIMEBASE_START_US;
+  }
+  
+  /**
+   * @brief Show "[stage/count] message" on the LCD
+   */
+  void showProgress(const char* message) {
+    char line[LCD_COLS + 1];
+    snprintf(line, sizeof(line), "[%d/%d] %s", (int)stage + 1, (int)BOOT_STAGE_COUNT, message);
+    display.showBootMessage(line);
+  }
+  
+  void finish() {
+    stage = BOOT_STAGE_DONE;
+    readyMicros = sinceReset();
+    display.showBootMessage("Prêt !");
+    
+    Serial.print("BOOT {\"event\":\"ready\",\"us\":");
+    Serial.print((unsigned long)readyMicros);
+    Serial.print(",\"time_source\":");
+    Serial.print((int)clock.getTimeSource());
+    Serial.println("}");
+  }
+};
+
+#endif // BOOT_SEQUENCE_H
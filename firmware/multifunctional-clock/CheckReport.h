@@ -0,0 +1,144 @@
+/**
+ * @file CheckReport.h
+ * @brief Serial result lines shared by the BENCHMARK_MODE checks
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Every check prints the same skeleton, which deploy.sh gates on:
+ * 
+ *   PREFIX-BEGIN
+ *   PREFIX {"name":"scenario",...fields...,"ok":true}
+ *   PREFIX-END failures=0
+ * 
+ * A check owns one CheckReport with its prefix and builds each scenario
+ * line with start(), field() and finish(); the report counts the failed
+ * scenarios for the END line.
+ * 
+ * The checks are listed once, in Checks.h: BENCHMARK_MODE builds run them
+ * at boot after the benchmarks, and deploy.sh reads the same list to gate
+ * the captured log on each check's END line.
+ */
+
+#ifndef CHECK_REPORT_H
+#define CHECK_REPORT_H
+
+#include "config.h"
+
+/**
+ * @class CheckReport
+ * @brief Prints the BEGIN, scenario and END lines of one check
+ */
+class CheckReport {
+private:
+  const char* prefix;   ///< Line prefix, e.g. "TRACE"
+  int failures;         ///< Failed scenarios since begin()
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param linePrefix Prefix of every line of the check
+   */
+  explicit CheckReport(const char* linePrefix) :
+    prefix(linePrefix),
+    failures(0) {}
+  
+  /**
+   * @brief Print the BEGIN line and clear the failure count
+   */
+  void begin() {
+    failures = 0;
+    Serial.print(prefix);
+    Serial.println("-BEGIN");
+  }
+  
+  /**
+   * @brief Print the END line
+   * 
+   * @return Number of failed scenarios
+   */
+  int end() {
+    Serial.print(prefix);
+    Serial.print("-END failures=");
+    Serial.println(failures);
+    return failures;
+  }
+  
+  /**
+   * @brief Start the line of one scenario
+   * 
+   * @param name Scenario name, e.g. "trace.fixtureReplay"
+   */
+  void start(const char* name) {
+    Serial.print(prefix);
+    Serial.print(" {\"name\":\"");
+    Serial.print(name);
+    Serial.print('"');
+  }
+  
+  /**
+   * @brief Add a numeric field
+   * 
+   * @param value Any type Serial.print() takes as a number
+   */
+  template <typename T>
+  void field(const char* key, T value) {
+    printKey(key);
+    Serial.print(value);
+  }
+  
+  /**
+   * @brief Add a decimal field
+   * 
+   * @param digits Digits after the decimal point
+   */
+  void field(const char* key, float value, int digits) {
+    printKey(key);
+    Serial.print(value, digits);
+  }
+  
+  /**
+   * @brief Add a string field
+   */
+  void text(const char* key, const char* value) {
+    printKey(key);
+    Serial.print('"');
+    Serial.print(value);
+    Serial.print('"');
+  }
+  
+  /**
+   * @brief Add a 32-bit value as an 8-digit hex string
+   */
+  void hex(const char* key, uint32_t value) {
+    printKey(key);
+    Serial.print('"');
+    for (int shift = 28; shift >= 0; shift -= 4) {
+      Serial.print("0123456789ABCDEF"[(value >> shift) & 0xF]);
+    }
+    Serial.print('"');
+  }
+  
+  /**
+   * @brief End the line with the scenario result
+   * 
+   * @return ok, so the caller can pass it on
+   */
+  bool finish(bool ok) {
+    if (!ok) failures++;
+    Serial.print(",\"ok\":");
+    Serial.print(ok ? "true" : "false");
+    Serial.println("}");
+    return ok;
+  }
+
+private:
+  void printKey(const char* key) {
+    Serial.print(",\"");
+    Serial.print(key);
+    Serial.print("\":");
+  }
+};
+
+#endif // CHECK_REPORT_H
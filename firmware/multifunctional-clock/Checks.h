@@ -0,0 +1,72 @@
+/**
+ * @file Checks.h
+ * @brief The BENCHMARK_MODE checks, in the order they run
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * CHECK_LIST holds one CHECK(class, constructor arguments, prefix, label)
+ * entry per check. The arguments are the firmware managers a check
+ * borrows; the prefix is the one the check gives its CheckReport. The
+ * list is read twice: runChecks() below builds and runs every check, and
+ * deploy.sh takes the prefix and label of each entry for its gates, so a
+ * check added here is both run and gated. A prefix that does not match
+ * the check's lines fails the gate: its END line is never seen.
+ * 
+ * Keep one entry per line, in this form, for deploy.sh.
+ */
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include "config.h"
+#include "Firmware.h"
+#include "FrameCheck.h"
+#include "UiCheck.h"
+#include "TimebaseCheck.h"
+#include "DnsCheck.h"
+#include "NtpCheck.h"
+#include "SntpCheck.h"
+#include "MqttCheck.h"
+#include "LzssCheck.h"
+#include "SseCheck.h"
+#include "HistoryCheck.h"
+#include "TraceCheck.h"
+#include "SettingsCheck.h"
+#include "RtcCheck.h"
+#include "WifiCheck.h"
+
+#define CHECK_LIST(CHECK) \
+  CHECK(FrameCheck, (firmware.clockMgr, firmware.displayMgr), FRAME, "LED frame checks") \
+  CHECK(UiCheck, (), UI, "Button replay scenarios") \
+  CHECK(TimebaseCheck, (), TIME, "Timebase rollover checks") \
+  CHECK(DnsCheck, (), DNS, "DNS cache checks") \
+  CHECK(NtpCheck, (), NTP, "NTP selection checks") \
+  CHECK(SntpCheck, (), SNTP, "SNTP responder checks") \
+  CHECK(MqttCheck, (), MQTT, "MQTT publisher checks") \
+  CHECK(LzssCheck, (), LZSS, "LZSS compression checks") \
+  CHECK(SseCheck, (), SSE, "SSE fan-out checks") \
+  CHECK(HistoryCheck, (), HISTORY, "History checks") \
+  CHECK(TraceCheck, (), TRACE, "Sensor trace checks") \
+  CHECK(SettingsCheck, (), SETTINGS, "Settings checks") \
+  CHECK(RtcCheck, (firmware.clockMgr), RTC, "RTC checks") \
+  CHECK(WifiCheck, (), WIFI, "WiFi connection checks")
+
+/**
+ * @brief Run every check of CHECK_LIST on the firmware, in order
+ * 
+ * Each check lives only while it runs, so their scripted stand-ins never
+ * share the stack.
+ * 
+ * @param firmware Firmware after begin(), whose managers some checks borrow
+ * @return Number of failed scenarios
+ */
+inline int runChecks(Firmware& firmware) {
+  int failures = 0;
+#define RUN_CHECK(type, args, prefix, label) failures += type args.runAll();
+  CHECK_LIST(RUN_CHECK)
+#undef RUN_CHECK
+  return failures;
+}
+
+#endif // CHECKS_H
@@ -7,16 +7,22 @@
  * 
  * This class handles time keeping, NTP synchronization, and LED clock display.
  * It manages two LED rings (60 LEDs for minutes/seconds, 12 LEDs for hours)
- * and provides animations for hour transitions.
+ * and provides animations for hour transitions, the alarm layer and the
+ * sunrise wake light.
  */
 
 #ifndef CLOCK_MANAGER_H
 #define CLOCK_MANAGER_H
 
 #include "config.h"
+#include "Timebase.h"
+#include "NtpSync.h"
+#include "Settings.h"
+#include "Alarms.h"
+#include "RtcBackend.h"
+#include "DnsCache.h"
 #include <WiFi.h>
 #include <WiFiUdp.h>
-#include <NTPClient.h>
 #include <FastLED.h>
 #include <TimeLib.h>
 
@@ -31,26 +37,53 @@ struct TimeInfo {
   int day;          ///< Day of month (1-31)
   int month;        ///< Month (1-12)
   int year;         ///< Year (full year, e.g., 2025)
-  int weekday;      ///< Day of week (1=Sunday, 7=Saturday)
+  int weekday;      ///< Day of week (0=Sunday, 6=Saturday)
   bool isValid;     ///< Whether time is valid/synchronized
 };
 
+/**
+ * @brief Where the current time came from
+ */
+enum TimeSource {
+  TIME_SOURCE_NONE = 0,  ///< Not set since boot
+  TIME_SOURCE_RTC,       ///< Read from the RTC (boot or NTP holdover)
+  TIME_SOURCE_NTP        ///< Last NTP synchronization succeeded
+};
+
+/**
+ * @brief Progress of an NTP synchronization
+ */
+enum NtpSyncState {
+  NTP_SYNC_IDLE = 0,     ///< No synchronization started yet
+  NTP_SYNC_PENDING,      ///< Requests sent, waiting for the replies
+  NTP_SYNC_OK,           ///< Last synchronization succeeded
+  NTP_SYNC_FAILED        ///< Last synchronization timed out
+};
+
 /**
  * @class ClockManager
  * @brief Manages time keeping and LED clock display
  * 
  * The ClockManager handles:
  * - Time synchronization via NTP
+ * - RTC time at boot and while NTP is unavailable
  * - LED ring management for visual clock display
  * - Hour transition animations
  * - Night mode brightness adjustment
+ * - Alarms, snooze and one-shot timers
+ * - Sunrise wake light before alarms
  * - Time validation and error handling
  */
 class ClockManager {
+  friend class Benchmark;
+  friend class FrameCheck;
+  friend class RtcCheck;
+
 private:
-  // NTP client for time synchronization
-  WiFiUDP ntpUDP;
-  NTPClient* timeClient;
+  // NTP synchronization against several servers
+  NtpSync ntp;
+  NtpSyncState ntpState;
+  NtpReference ntpReference;    ///< Result of the last successful sync
   
   // LED arrays for clock display
   CRGB minutesLEDs[LED_RING_MINUTES_COUNT];  ///< 60 LEDs for minutes/seconds
@@ -58,18 +91,47 @@ private:
   
   // Current time information
   TimeInfo currentTime;
-  unsigned long lastTimeUpdate;
+  uint64_t nextTick;            ///< Timebase time of the next second edge (us)
+  bool phaseAligned;            ///< nextTick falls on a UTC second edge
+  
+  // Lateness of the second frame behind its edge, reported every minute
+  uint32_t tickLate;            ///< Last tick (us)
+  uint32_t tickLateMax;         ///< Worst tick since the last report (us)
+  uint8_t ticksSinceReport;
   bool timeValidated;
+  unsigned long epoch;          ///< UTC seconds, counted with currentTime
+  
+  // Real-time clock, written on every NTP sync
+  BoardRtc boardRtc;
+  RtcBackend* rtc;
+  TimeSource timeSource;
+  uint64_t lastRtcRead;
   
   // Animation state
   bool inHourAnimation;
-  unsigned long animationStart;
+  uint64_t animationStart;
   int animationStep;
   
   // Night mode state
   bool nightModeActive;
   uint8_t currentBrightness;
   
+  // User settings (night mode hours, timezone, alarms)
+  Settings settings;
+  
+  // Alarms and timers, ticked with the internal time
+  AlarmScheduler alarms;
+  
+  // Wake light state
+  bool sunriseActive;
+  uint64_t nextFrame;           ///< Time of the next animation frame
+  uint8_t sunriseFrame;         ///< Frame counter driving the dither pattern
+  
+  // Stopwatch/countdown progress shown on the minutes ring
+  bool progressActive;
+  uint16_t progress;            ///< Arc length (0-65535 = full ring)
+  uint32_t progressColor;
+  
   // Last displayed values (to detect changes)
   int lastHour;
   int lastMinute;
@@ -82,14 +144,28 @@ public:
    * Initializes time client and LED arrays.
    */
   ClockManager() : 
-    timeClient(nullptr),
-    lastTimeUpdate(0),
+    ntpState(NTP_SYNC_IDLE),
+    nextTick(0),
+    phaseAligned(false),
+    tickLate(0),
+    tickLateMax(0),
+    ticksSinceReport(0),
     timeValidated(false),
+    epoch(0),
+    rtc(&boardRtc),
+    timeSource(TIME_SOURCE_NONE),
+    lastRtcRead(0),
     inHourAnimation(false),
     animationStart(0),
     animationStep(0),
     nightModeActive(false),
     currentBrightness(255),
+    sunriseActive(false),
+    nextFrame(0),
+    sunriseFrame(0),
+    progressActive(false),
+    progress(0),
+    progressColor(0),
     lastHour(-1),
     lastMinute(-1),
     lastSecond(-1) {
@@ -101,14 +177,17 @@ public:
     currentTime.day = 1;
     currentTime.month = 1;
     currentTime.year = 2025;
-    currentTime.weekday = 1;
+    currentTime.weekday = 3;  // 2025-01-01 was a Wednesday
     currentTime.isValid = false;
+    
+    memset(&ntpReference, 0, sizeof(ntpReference));
+    settings.loadDefaults();
   }
   
   /**
    * @brief Initialize the clock manager
    * 
-   * Sets up NTP client, LED strips, and initial time.
+   * Sets up LED strips and initial time.
    * 
    * @return true if initialization successful, false otherwise
    */
@@ -126,15 +205,10 @@ public:
     clearAllLEDs();
     FastLED.show();
     
-    // Initialize NTP client
-    timeClient = new NTPClient(ntpUDP, NTP_SERVER, TIMEZONE_OFFSET * 3600, 60000);
-    
-    if (!timeClient) {
-      DEBUG_PRINTLN("Failed to create NTP client");
-      return false;
-    }
+    nextTick = Timebase::micros64() + 1000000;
     
-    lastTimeUpdate = millis();
+    // Valid time right away if the RTC kept running
+    restoreFromRtc();
     
     DEBUG_PRINTLN("ClockManager initialized successfully");
     return true;
@@ -143,15 +217,31 @@ public:
   /**
    * @brief Update clock state
    * 
-   * Should be called every second to update time and LED display.
+   * Should be called every loop iteration. Advances the time at each
+   * second edge, which after an NTP sync falls on the true UTC second, so
+   * that clocks synchronized to the same servers tick together; edges are
+   * scheduled from the previous one, so loop timing does not accumulate.
    */
   void update() {
-    unsigned long currentMillis = millis();
+    // Without NTP, follow the RTC rather than the loop timing
+    if (timeSource == TIME_SOURCE_RTC && Timebase::millis64() - lastRtcRead >= RTC_HOLDOVER_INTERVAL) {
+      loadFromRtc();
+    }
     
-    // Update internal time (every second)
-    if (currentMillis - lastTimeUpdate >= 1000) {
+    uint64_t now = Timebase::micros64();
+    if (now < nextTick) {
+      return;
+    }
+    
+    // One step per edge, catching up after a blocking call
+    while (now >= nextTick) {
       updateInternalTime();
-      lastTimeUpdate = currentMillis;
+      nextTick += 1000000;
+      
+      // Alarms only run once the time is known
+      if (timeValidated) {
+        alarms.tick(currentTime.weekday, getSecondOfDay());
+      }
     }
     
     // Check for night mode
@@ -164,56 +254,286 @@ public:
     
     // Update LED display if time changed
     if (hasTimeChanged()) {
+      recordTickPhase(Timebase::micros64() - (nextTick - 1000000));
       updateLEDDisplay();
       updateLastDisplayedTime();
     }
   }
   
   /**
-   * @brief Synchronize time with NTP server
+   * @brief Pause the loop, ending on the next second edge if it is close
    * 
-   * Attempts to get current time from NTP server and update internal clock.
+   * Replaces the fixed loop delay: when the edge falls within the pause,
+   * waits for it (sleeping, then delayMicroseconds() for the last millisecond) and
+   * shows the new second at once, instead of up to a loop later. An edge
+   * already passed, after a slow loop, is shown without pausing at all.
    * 
-   * @return true if synchronization successful, false otherwise
+   * @param maxWait Pause when no edge is due (ms)
+   */
+  void waitForTick(uint32_t maxWait) {
+    uint64_t now = Timebase::micros64();
+    if (nextTick <= now) {
+      update();
+      return;
+    }
+    if (nextTick - now > (uint64_t)maxWait * 1000) {
+      delay(maxWait);
+      return;
+    }
+    
+    uint32_t wait = nextTick - now;
+    if (wait > 2000) {
+      delay(wait / 1000 - 1);
+    }
+    now = Timebase::micros64();
+    if (now < nextTick) {
+      delayMicroseconds(nextTick - now);
+    }
+    update();
+  }
+  
+  /**
+   * @brief Time between the last second edge and its LED frame (us)
    */
-  bool syncWithNTP() {
-    if (!timeClient || WiFi.status() != WL_CONNECTED) {
+  uint32_t getTickLate() const {
+    return tickLate;
+  }
+  
+  /**
+   * @brief Render animation frames at a fixed rate
+   * 
+   * Should be called every loop iteration. While the wake light or the
+   * progress ring is shown, composes and shows one frame every
+   * LED_FRAME_INTERVAL; frames that are already late are dropped rather
+   * than caught up, so the cost per call stays bounded to one frame.
+   */
+  void updateFrame() {
+    uint32_t remaining;
+    bool sunrise = timeValidated && alarms.getSunrise(remaining);
+    uint64_t now = Timebase::millis64();
+    
+    if (sunrise != sunriseActive) {
+      sunriseActive = sunrise;
+      nextFrame = now;
+      // The ramp uses the full 8-bit range; brightness is restored after
+      FastLED.setBrightness(sunriseActive ? 255 : currentBrightness);
+      DEBUG_PRINTLN(sunriseActive ? "Sunrise ON" : "Sunrise OFF");
+      if (!sunriseActive) {
+        updateLEDDisplay();
+      }
+    }
+    
+    if (!(sunriseActive || progressActive) || now < nextFrame) {
+      return;
+    }
+    
+    nextFrame += LED_FRAME_INTERVAL;
+    if (now >= nextFrame) {
+      nextFrame = now + LED_FRAME_INTERVAL;
+    }
+    updateLEDDisplay();
+  }
+  
+  /**
+   * @brief Show a progress arc on the minutes ring instead of the hands
+   * 
+   * The arc is redrawn by updateFrame(), so it can be set every loop.
+   * 
+   * @param value Arc length, 0 to 65535 for the full ring
+   * @param color Arc colour (0xRRGGBB)
+   */
+  void setProgress(uint16_t value, uint32_t color) {
+    if (!progressActive) {
+      progressActive = true;
+      nextFrame = Timebase::millis64();
+    }
+    progress = value;
+    progressColor = color;
+  }
+  
+  /**
+   * @brief Go back to the clock hands on the minutes ring
+   */
+  void clearProgress() {
+    if (progressActive) {
+      progressActive = false;
+      updateLEDDisplay();
+    }
+  }
+  
+  /**
+   * @brief Ring for the end of the UI countdown
+   */
+  void ringCountdown() {
+    alarms.ringCountdown();
+    updateLEDDisplay();
+  }
+  
+  /**
+   * @brief Send a request to every NTP server
+   * 
+   * Returns at once; the replies are collected by updateNtpSync(). If no
+   * request can be sent, the clock holds over on the RTC.
+   * 
+   * @return true if at least one request was sent
+   */
+  bool startNtpSync() {
+    if (ntp.isWaiting()) {
+      return true;
+    }
+    if (WiFi.status() != WL_CONNECTED) {
       DEBUG_PRINTLN("Cannot sync NTP: WiFi not connected");
+      ntpState = NTP_SYNC_FAILED;
+      holdoverOnRtc();
       return false;
     }
     
-    DEBUG_PRINTLN("Synchronizing with NTP server...");
+    DEBUG_PRINTLN("Synchronizing with NTP servers...");
     
-    timeClient->begin();
+    if (ntp.start() == 0) {
+      DEBUG_PRINTLN("NTP sync failed: cannot send request");
+      ntpState = NTP_SYNC_FAILED;
+      holdoverOnRtc();
+      return false;
+    }
+    
+    ntpState = NTP_SYNC_PENDING;
+    return true;
+  }
+  
+  /**
+   * @brief Collect the NTP replies without blocking
+   * 
+   * Should be called every loop iteration. Once every server has replied
+   * or NTP_TIMEOUT has passed, the samples are combined by NtpSelector;
+   * without an agreeing majority the clock holds over on the RTC.
+   * 
+   * @return Progress of the synchronization started last
+   */
+  NtpSyncState updateNtpSync() {
+    if (ntpState != NTP_SYNC_PENDING || ntp.poll() != NTP_EXCHANGE_DONE) {
+      return ntpState;
+    }
     
-    // Try to update time (with timeout)
-    unsigned long startTime = millis();
-    while (!timeClient->update() && millis() - startTime < 5000) {
-      delay(100);
+    NtpReference reference;
+    uint8_t survivors;
+    if (!ntp.getResult(reference, survivors)) {
+      DEBUG_PRINT("NTP sync failed: no agreeing replies out of ");
+      DEBUG_PRINTLN(ntp.getSampleCount());
+      ntpState = NTP_SYNC_FAILED;
+      holdoverOnRtc();
+      return ntpState;
     }
     
-    if (timeClient->isTimeSet()) {
-      // Get epoch time and convert to local time
-      unsigned long epochTime = timeClient->getEpochTime();
-      setTime(epochTime);
-      
-      // Update our time structure
-      updateTimeFromEpoch(epochTime);
-      
-      timeValidated = true;
-      
-      DEBUG_PRINT("NTP sync successful. Time: ");
-      DEBUG_PRINT(currentTime.hours);
-      DEBUG_PRINT(":");
-      DEBUG_PRINT(currentTime.minutes);
-      DEBUG_PRINT(":");
-      DEBUG_PRINTLN(currentTime.seconds);
-      
-      return true;
-    } else {
-      DEBUG_PRINTLN("NTP sync failed");
+    DEBUG_PRINT("NTP samples used: ");
+    DEBUG_PRINT(survivors);
+    DEBUG_PRINT("/");
+    DEBUG_PRINTLN(ntp.getSampleCount());
+    
+    ntpReference = reference;
+    ntpState = NTP_SYNC_OK;
+    
+    // Next edge on the true second: UTC now, rounded up
+    uint64_t now = Timebase::micros64();
+    int64_t utc = (int64_t)now + reference.offset;
+    nextTick = now + (1000000 - utc % 1000000);
+    phaseAligned = true;
+    applyNtpTime((unsigned long)(utc / 1000000));
+    return ntpState;
+  }
+  
+  /**
+   * @brief Check whether NTP requests await their replies
+   */
+  bool isNtpPending() const {
+    return ntpState == NTP_SYNC_PENDING;
+  }
+  
+  /**
+   * @brief UTC at timebase zero from the last synchronization (us)
+   * 
+   * UTC now is Timebase::micros64() plus this offset, to the accuracy of
+   * the synchronization; 0 before the first one.
+   */
+  int64_t getNtpOffset() const {
+    return ntpReference.offset;
+  }
+  
+  /**
+   * @brief Get the last synchronization, to serve time to the LAN
+   * 
+   * @param reference Offset and upstream details, set only when true is
+   * returned
+   * @return false unless the time comes from an NTP sync newer than
+   * SNTP_MAX_SYNC_AGE
+   */
+  bool getNtpReference(NtpReference& reference) const {
+    if (timeSource != TIME_SOURCE_NTP ||
+        Timebase::millis64() - ntpReference.syncedAt > SNTP_MAX_SYNC_AGE) {
       return false;
     }
+    reference = ntpReference;
+    return true;
+  }
+  
+  /**
+   * @brief Apply user settings
+   * 
+   * Night mode hours, brightness and alarms take effect immediately;
+   * timezone changes apply from the next NTP synchronization.
+   * 
+   * @param newSettings Settings to use
+   */
+  void applySettings(const Settings& newSettings) {
+    settings = newSettings;
+    
+    // Re-evaluate night mode with the new hours and brightness
+    nightModeActive = !isNightTime();
+    updateNightMode();
+    
+    if (timeValidated) {
+      alarms.configure(settings, currentTime.weekday, getSecondOfDay());
+    }
+  }
+  
+  /**
+   * @brief Check whether an alarm or timer is ringing
+   */
+  bool isAlarmRinging() const {
+    return alarms.isRinging();
+  }
+  
+  /**
+   * @brief Silence the ringing alarm for ALARM_SNOOZE_DURATION
+   */
+  void snoozeAlarm() {
+    alarms.snooze();
+    forceDisplayUpdate();
+  }
+  
+  /**
+   * @brief Silence the ringing alarm
+   */
+  void dismissAlarm() {
+    alarms.dismiss();
+    forceDisplayUpdate();
+  }
+  
+  /**
+   * @brief Start a one-shot timer
+   * 
+   * @param seconds Delay before it rings
+   * @return Timer index, or -1 if every timer is in use
+   */
+  int startTimer(uint32_t seconds) {
+    return alarms.startTimer(seconds);
+  }
+  
+  /**
+   * @brief Get the alarm and timer scheduler
+   */
+  const AlarmScheduler& getAlarms() const {
+    return alarms;
   }
   
   /**
@@ -225,15 +545,52 @@ public:
     return currentTime;
   }
   
+  /**
+   * @brief Select the RTC written on sync and read at boot
+   * 
+   * Must be called before init().
+   * 
+   * @param backend RTC to use, or nullptr for the on-chip RTC
+   */
+  void setRtc(RtcBackend* backend) {
+    rtc = backend ? backend : &boardRtc;
+  }
+  
+  /**
+   * @brief Resolve the NTP_SERVERS names through a DNS cache
+   * 
+   * Without a cache, or until it holds an address, a name is resolved by
+   * the WiFi library on every sync.
+   * 
+   * @param cache Cache to use, or nullptr
+   */
+  void setDnsCache(DnsCache* cache) {
+    ntp.setDnsCache(cache);
+  }
+  
+  /**
+   * @brief Get where the current time came from
+   */
+  TimeSource getTimeSource() const {
+    return timeSource;
+  }
+  
   /**
    * @brief Check if time is valid/synchronized
    * 
-   * @return true if time has been synchronized with NTP
+   * @return true if time has been set from NTP or the RTC
    */
   bool isTimeValid() const {
     return timeValidated && currentTime.isValid;
   }
   
+  /**
+   * @brief Get the current UTC time (Unix seconds), 0 if not valid
+   */
+  unsigned long getEpoch() const {
+    return isTimeValid() ? epoch : 0;
+  }
+  
   /**
    * @brief Force LED display update
    * 
@@ -251,19 +608,50 @@ public:
   void triggerHourAnimation() {
     if (!inHourAnimation) {
       inHourAnimation = true;
-      animationStart = millis();
+      animationStart = Timebase::millis64();
       animationStep = 0;
       DEBUG_PRINTLN("Starting hour animation");
     }
   }
 
 private:
+  /**
+   * @brief Record how late a second frame is, and report it every minute
+   * 
+   * Printed as a "TICK {json}" line once the ticks are aligned on UTC,
+   * in STATS_REPORTS builds: late_us is the local flush delay behind the
+   * edge, sync_error_us the error bound of the last NTP sync, so two
+   * clocks tick within the sum of theirs.
+   */
+  void recordTickPhase(uint64_t late) {
+    tickLate = late > 0xFFFFFFFFUL ? 0xFFFFFFFFUL : (uint32_t)late;
+    if (tickLate > tickLateMax) tickLateMax = tickLate;
+    
+    if (++ticksSinceReport < TICK_REPORT_INTERVAL) {
+      return;
+    }
+#if STATS_REPORTS
+    if (phaseAligned) {
+      Serial.print("TICK {\"late_us\":");
+      Serial.print(tickLate);
+      Serial.print(",\"max_late_us\":");
+      Serial.print(tickLateMax);
+      Serial.print(",\"sync_error_us\":");
+      Serial.print((unsigned long)(ntpReference.rootDelay / 2 + ntpReference.rootDispersion));
+      Serial.println("}");
+    }
+#endif
+    ticksSinceReport = 0;
+    tickLateMax = 0;
+  }
+  
   /**
    * @brief Update internal time counter
    * 
    * Increments seconds and handles minute/hour rollovers.
    */
   void updateInternalTime() {
+    epoch++;
     currentTime.seconds++;
     
     if (currentTime.seconds >= 60) {
@@ -279,6 +667,7 @@ private:
         
         if (currentTime.hours >= 24) {
           currentTime.hours = 0;
+          currentTime.weekday = (currentTime.weekday + 1) % 7;
           // Day rollover - could be enhanced to handle dates properly
         }
       }
@@ -292,11 +681,11 @@ private:
    */
   void updateTimeFromEpoch(unsigned long epochTime) {
     // Apply timezone offset
-    epochTime += TIMEZONE_OFFSET * 3600;
+    epochTime += settings.get(SETTING_TIMEZONE) * 3600L;
     
     // Apply DST offset if needed (simplified - could be more sophisticated)
     // TODO: Implement proper DST calculation
-    epochTime += DST_OFFSET * 3600;
+    epochTime += settings.get(SETTING_DST) * 3600L;
     
     currentTime.seconds = epochTime % 60;
     epochTime /= 60;
@@ -332,6 +721,112 @@ private:
     currentTime.isValid = true;
   }
   
+  /**
+   * @brief Set the clock from a validated NTP reply
+   * 
+   * @param epochTime UTC seconds since 1970
+   */
+  void applyNtpTime(unsigned long epochTime) {
+    setTime(epochTime);
+    epoch = epochTime;
+    
+    // Update our time structure
+    updateTimeFromEpoch(epochTime);
+    
+    // Keep it in the RTC for the next boot and for holdover
+    if (!rtc->write(epochTime)) {
+      DEBUG_PRINTLN("RTC write failed");
+    }
+    
+    timeValidated = true;
+    timeSource = TIME_SOURCE_NTP;
+    alarms.configure(settings, currentTime.weekday, getSecondOfDay());
+    
+    DEBUG_PRINT("NTP sync successful. Time: ");
+    DEBUG_PRINT(currentTime.hours);
+    DEBUG_PRINT(":");
+    DEBUG_PRINT(currentTime.minutes);
+    DEBUG_PRINT(":");
+    DEBUG_PRINTLN(currentTime.seconds);
+  }
+  
+  /**
+   * @brief Start the RTC and take the time from it, as at boot
+   * 
+   * @return true if the RTC kept running and its time was taken
+   */
+  bool restoreFromRtc() {
+    if (rtc->begin() && loadFromRtc()) {
+      DEBUG_PRINTLN("Time restored from RTC");
+      return true;
+    }
+    return false;
+  }
+  
+  /**
+   * @brief Set the time from the RTC
+   * 
+   * Alarms are rescheduled only if the time moved, so a regular holdover
+   * read does not disturb them.
+   * 
+   * @return false if the RTC has no valid time
+   */
+  bool loadFromRtc() {
+    uint32_t epochTime;
+    lastRtcRead = Timebase::millis64();
+    if (!rtc->read(epochTime) || epochTime < RTC_MIN_VALID_EPOCH) {
+      return false;
+    }
+    
+    // The RTC only gives whole seconds: keep the NTP phase while they agree
+    if (phaseAligned) {
+      int64_t ours = ((int64_t)Timebase::micros64() + ntpReference.offset) / 1000000;
+      if (ours - (int64_t)epochTime <= 1 && (int64_t)epochTime - ours <= 1) {
+        timeSource = TIME_SOURCE_RTC;
+        return true;
+      }
+      phaseAligned = false;
+    } else if (timeValidated &&
+               (int64_t)epoch - (int64_t)epochTime <= 1 && (int64_t)epochTime - (int64_t)epoch <= 1) {
+      // Same for the second counted since boot: restarting it would shift
+      // the edge by up to a second on every holdover read
+      timeSource = TIME_SOURCE_RTC;
+      return true;
+    }
+    
+    uint32_t before = getSecondOfDay();
+    bool wasValid = timeValidated;
+    setTime(epochTime);
+    epoch = epochTime;
+    updateTimeFromEpoch(epochTime);
+    timeValidated = true;
+    timeSource = TIME_SOURCE_RTC;
+    nextTick = Timebase::micros64() + 1000000;
+    
+    if (!wasValid) {
+      alarms.configure(settings, currentTime.weekday, getSecondOfDay());
+    } else if (getSecondOfDay() != before) {
+      alarms.reschedule(currentTime.weekday, getSecondOfDay());
+    }
+    return true;
+  }
+  
+  /**
+   * @brief Fall back on the RTC after a failed NTP synchronization
+   */
+  void holdoverOnRtc() {
+    if (timeSource != TIME_SOURCE_RTC && loadFromRtc()) {
+      DEBUG_PRINTLN("NTP unavailable, holding over on RTC");
+    }
+  }
+  
+  /**
+   * @brief Current local time in seconds since midnight
+   */
+  uint32_t getSecondOfDay() const {
+    return currentTime.hours * 3600UL + currentTime.minutes * 60UL + currentTime.seconds;
+  }
+  
   /**
    * @brief Check if it's a leap year
    * 
@@ -346,19 +841,34 @@ private:
    * @brief Check and update night mode status
    */
   void updateNightMode() {
-    bool shouldBeNightMode = (currentTime.hours >= NIGHT_MODE_START || 
-                             currentTime.hours < NIGHT_MODE_END);
+    bool shouldBeNightMode = isNightTime();
     
     if (shouldBeNightMode != nightModeActive) {
       nightModeActive = shouldBeNightMode;
-      currentBrightness = nightModeActive ? NIGHT_BRIGHTNESS : 255;
-      FastLED.setBrightness(currentBrightness);
+      currentBrightness = nightModeActive ? settings.get(SETTING_NIGHT_BRIGHTNESS) : 255;
+      FastLED.setBrightness(sunriseActive ? 255 : currentBrightness);
       
       DEBUG_PRINT("Night mode ");
       DEBUG_PRINTLN(nightModeActive ? "ON" : "OFF");
     }
   }
   
+  /**
+   * @brief Check whether the current hour falls in the night mode window
+   * 
+   * @return true if night mode should be active
+   */
+  bool isNightTime() const {
+    int start = settings.get(SETTING_NIGHT_START);
+    int end = settings.get(SETTING_NIGHT_END);
+    
+    // Window spans midnight (e.g. 22h -> 7h)
+    if (start > end) {
+      return currentTime.hours >= start || currentTime.hours < end;
+    }
+    return currentTime.hours >= start && currentTime.hours < end;
+  }
+  
   /**
    * @brief Check if displayed time has changed
    * 
@@ -383,6 +893,32 @@ private:
    * @brief Update LED display based on current time
    */
   void updateLEDDisplay() {
+    renderClockFrame();
+    
+    if (progressActive) {
+      renderProgressLayer(progress, progressColor);
+    }
+    
+    uint32_t remaining;
+    if (sunriseActive && alarms.getSunrise(remaining)) {
+      renderSunriseLayer(getSunriseProgress(remaining), sunriseFrame++);
+    }
+    
+    if (alarms.isRinging()) {
+      renderAlarmLayer(alarms.getRingElapsed());
+    }
+    
+    // Show the updated LEDs
+    FastLED.show();
+  }
+  
+  /**
+   * @brief Compose the clock frame into the LED buffers
+   * 
+   * Pure composition step of updateLEDDisplay(), kept separate so it can
+   * be measured without the cost of pushing data to the strips.
+   */
+  void renderClockFrame() {
     // Clear all LEDs
     clearAllLEDs();
     
@@ -402,32 +938,126 @@ private:
     if (currentTime.minutes == currentTime.seconds) {
       minutesLEDs[currentTime.minutes] = CRGB(COLOR_OVERLAP >> 16, (COLOR_OVERLAP >> 8) & 0xFF, COLOR_OVERLAP & 0xFF);
     }
+  }
+  
+  /**
+   * @brief Replace the minutes ring with a progress arc
+   * 
+   * The arc starts at the top LED and runs clockwise; the LED at its end
+   * is lit in proportion to the part of it covered, so the arc grows
+   * smoothly between two LEDs. The hour LED is left as is.
+   * 
+   * @param value Arc length (0-65535 = full ring)
+   * @param color Arc colour (0xRRGGBB)
+   */
+  void renderProgressLayer(uint16_t value, uint32_t color) {
+    uint32_t length = (uint32_t)value * LED_RING_MINUTES_COUNT;  // LEDs << 16
+    uint8_t full = length >> 16;
+    uint8_t partial = (length >> 8) & 0xFF;
+    CRGB arc(color >> 16, (color >> 8) & 0xFF, color & 0xFF);
     
-    // Show the updated LEDs
-    FastLED.show();
+    for (int i = 0; i < LED_RING_MINUTES_COUNT; i++) {
+      if (i < full) {
+        minutesLEDs[i] = arc;
+      } else if (i == full) {
+        for (int c = 0; c < 3; c++) {
+          minutesLEDs[i][c] = ((uint16_t)arc[c] * partial) >> 8;
+        }
+      } else {
+        minutesLEDs[i] = CRGB::Black;
+      }
+    }
   }
   
   /**
-   * @brief Update hour transition animation
+   * @brief Draw the ringing alarm over the clock frame
+   * 
+   * The five-minute marks blink in COLOR_ALARM, one second on and one
+   * off, while the hands stay visible between them.
+   * 
+   * @param elapsed Seconds since the alarm started ringing
    */
-  void updateHourAnimation() {
-    unsigned long elapsed = millis() - animationStart;
+  void renderAlarmLayer(uint16_t elapsed) {
+    if (elapsed % 2) {
+      return;
+    }
+    CRGB color(COLOR_ALARM >> 16, (COLOR_ALARM >> 8) & 0xFF, COLOR_ALARM & 0xFF);
+    for (int i = 0; i < LED_RING_MINUTES_COUNT; i += 5) {
+      if (i != currentTime.minutes && i != currentTime.seconds) {
+        minutesLEDs[i] = color;
+      }
+    }
+  }
+  
+  /**
+   * @brief Position in the wake light ramp, to the millisecond
+   * 
+   * @param remaining Whole seconds left before the alarm at the last tick
+   * @return 0 at the start of the ramp to 65535 at the alarm
+   */
+  uint16_t getSunriseProgress(uint32_t remaining) const {
+    uint32_t total = alarms.getSunriseDuration() * 1000UL;
+    uint64_t lastTick = nextTick - 1000000;
+    uint64_t now = Timebase::micros64();
+    uint32_t intoSecond = now > lastTick ? (now - lastTick) / 1000 : 0;
+    if (intoSecond > 999) intoSecond = 999;
+    
+    uint32_t left = remaining * 1000UL - intoSecond;
+    if (total == 0 || left >= total) {
+      return 0;
+    }
+    return (uint16_t)(((uint64_t)(total - left) * 65535UL) / total);
+  }
+  
+  /**
+   * @brief Draw the wake light behind the clock hands
+   * 
+   * Colours are computed with 16 bits per channel: intensity follows
+   * progress squared, green and blue rise later than red so the ramp goes
+   * from deep red to COLOR_SUNRISE_END. Each LED is rounded to 8 bits
+   * against an ordered threshold that moves every frame, so levels between
+   * two 8-bit steps are shown by alternating them instead of jumping.
+   * Global brightness is 255 during the ramp, so the hands are scaled to
+   * the normal brightness here.
+   * 
+   * @param progress Ramp position (0-65535)
+   * @param frame Frame counter for the dither pattern
+   */
+  void renderSunriseLayer(uint16_t progress, uint8_t frame) {
+    static const uint8_t DITHER_ORDER[8] = { 0, 4, 2, 6, 1, 5, 3, 7 };
+    
+    uint32_t level = ((uint32_t)progress * progress) >> 16;
+    uint16_t target[3];
+    target[0] = (level * (COLOR_SUNRISE_END >> 16)) / 255;
+    target[1] = (((level * ((COLOR_SUNRISE_END >> 8) & 0xFF)) / 255) * progress) >> 16;
+    target[2] = (((((level * (COLOR_SUNRISE_END & 0xFF)) / 255) * progress) >> 16) * progress) >> 16;
     
-    if (elapsed < 5000) { // 5 second animation
-      // Create a spinning effect or color wave
-      int pos = (elapsed / 100) % LED_RING_HOURS_COUNT;
+    for (int i = 0; i < LED_RING_MINUTES_COUNT + LED_RING_HOURS_COUNT; i++) {
+      CRGB& led = (i < LED_RING_MINUTES_COUNT) ? minutesLEDs[i] : hoursLEDs[i - LED_RING_MINUTES_COUNT];
       
-      // Clear hour ring
-      for (int i = 0; i < LED_RING_HOURS_COUNT; i++) {
-        hoursLEDs[i] = CRGB::Black;
+      if (led.r || led.g || led.b) {
+        for (int c = 0; c < 3; c++) {
+          led[c] = ((uint16_t)led[c] * (currentBrightness + 1)) >> 8;
+        }
+        continue;
       }
       
-      // Set animated LEDs
-      for (int i = 0; i < 3; i++) {
-        int ledPos = (pos + i) % LED_RING_HOURS_COUNT;
-        hoursLEDs[ledPos] = CRGB::White;
+      uint16_t threshold = (DITHER_ORDER[(i + frame) & 7] << 5) | 16;
+      for (int c = 0; c < 3; c++) {
+        uint16_t value = ((uint32_t)target[c] + threshold) >> 8;
+        led[c] = value > 255 ? 255 : value;
       }
-      
+    }
+  }
+  
+  /**
+   * @brief Update hour transition animation
+   */
+  void updateHourAnimation() {
+    unsigned long elapsed = Timebase::millis64() - animationStart;
+    
+    if (elapsed < HOUR_ANIMATION_DURATION) {
+      renderHourAnimationFrame(elapsed);
       FastLED.show();
     } else {
       // Animation finished
@@ -436,6 +1066,27 @@ private:
     }
   }
   
+  /**
+   * @brief Compose one frame of the hour animation into the hour ring
+   * 
+   * @param elapsed Time since the animation started (ms)
+   */
+  void renderHourAnimationFrame(unsigned long elapsed) {
+    // Create a spinning effect or color wave
+    int pos = (elapsed / ANIMATION_SPEED) % LED_RING_HOURS_COUNT;
+    
+    // Clear hour ring
+    for (int i = 0; i < LED_RING_HOURS_COUNT; i++) {
+      hoursLEDs[i] = CRGB::Black;
+    }
+    
+    // Set animated LEDs
+    for (int i = 0; i < 3; i++) {
+      int ledPos = (pos + i) % LED_RING_HOURS_COUNT;
+      hoursLEDs[ledPos] = CRGB::White;
+    }
+  }
+  
   /**
    * @brief Clear all LED arrays
    */
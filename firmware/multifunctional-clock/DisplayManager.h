@@ -10,24 +10,54 @@
 #define DISPLAY_MANAGER_H
 
 #include "config.h"
+#include "Timebase.h"
 #include "ClockManager.h"
 #include "SensorManager.h"
+#include "Settings.h"
+#include "Stopwatch.h"
 #include <FastLED.h>
 
+// Identifies what a screen shows: the UI mode and the page, menu item or
+// timer state within it. A screen is redrawn as soon as this changes.
+#define DISPLAY_SCREEN(mode, item)  (((uint32_t)(mode) << 24) | (uint32_t)(item))
+#define DISPLAY_SCREEN_NONE         0xFFFFFFFFUL
+
 /**
  * @class DisplayManager
  * @brief Simplified display manager for testing
  */
 class DisplayManager {
+  friend class Benchmark;
+  friend class FrameCheck;
+
 private:
   CRGB airQualityLEDs[LED_STRIP_AIR_COUNT];
-  unsigned long lastUpdate;
+  uint64_t lastUpdate;
+  
+  // Debug output throttling (per instance)
+  uint64_t lastClockDisplay;
+  uint64_t lastSensorDisplay;
+  uint64_t lastAirDisplay;
+  uint64_t lastTimerDisplay;
+  int lastAirQuality;
+  int shownAirQuality;           ///< Reading currently on the air strip
+  uint32_t shownScreen;          ///< Screen last drawn (DISPLAY_SCREEN)
+  uint64_t lastRedrawMicros;     ///< Time it was drawn (us)
 
 public:
   /**
    * @brief Constructor
    */
-  DisplayManager() : lastUpdate(0) {}
+  DisplayManager() :
+    lastUpdate(0),
+    lastClockDisplay(0),
+    lastSensorDisplay(0),
+    lastAirDisplay(0),
+    lastTimerDisplay(0),
+    lastAirQuality(-1),
+    shownAirQuality(-1),
+    shownScreen(DISPLAY_SCREEN_NONE),
+    lastRedrawMicros(0) {}
   
   /**
    * @brief Initialize display manager
@@ -44,7 +74,7 @@ public:
     }
     FastLED.show();
     
-    lastUpdate = millis();
+    lastUpdate = Timebase::millis64();
     
     DEBUG_PRINTLN("DisplayManager initialized (test mode)");
     return true;
@@ -65,8 +95,8 @@ public:
   void showClock(TimeInfo timeInfo) {
     // In real implementation, this would show time info on LCD
     // For now, just debug output occasionally
-    static unsigned long lastClockDisplay = 0;
-    if (millis() - lastClockDisplay > 10000) { // Every 10 seconds
+    uint32_t screen = DISPLAY_SCREEN(UI_MODE_CLOCK, 0);
+    if (screen != shownScreen || Timebase::millis64() - lastClockDisplay > 10000) { // Every 10 seconds
       DEBUG_PRINT("Clock Display - ");
       DEBUG_PRINT(timeInfo.hours);
       DEBUG_PRINT(":");
@@ -75,7 +105,8 @@ public:
       DEBUG_PRINT(":");
       if (timeInfo.seconds < 10) DEBUG_PRINT("0");
       DEBUG_PRINTLN(timeInfo.seconds);
-      lastClockDisplay = millis();
+      lastClockDisplay = Timebase::millis64();
+      markDrawn(screen);
     }
   }
   
@@ -91,15 +122,16 @@ public:
    * @brief Show sensor data
    */
   void showSensorData(SensorData data, SensorPage page) {
-    static unsigned long lastSensorDisplay = 0;
-    if (millis() - lastSensorDisplay > 5000) { // Every 5 seconds
+    uint32_t screen = DISPLAY_SCREEN(UI_MODE_SENSORS, page);
+    if (screen != shownScreen || Timebase::millis64() - lastSensorDisplay > 5000) { // Every 5 seconds
       DEBUG_PRINT("Sensor Display - Page ");
       DEBUG_PRINT(page);
       DEBUG_PRINT(": Temp=");
       DEBUG_PRINT(data.tempIndoor);
       DEBUG_PRINT("°C, AQ=");
       DEBUG_PRINTLN(data.airQuality);
-      lastSensorDisplay = millis();
+      lastSensorDisplay = Timebase::millis64();
+      markDrawn(screen);
     }
   }
   
@@ -109,20 +141,165 @@ public:
   void showNetworkInfo(int status) {
     DEBUG_PRINT("Network Display - Status: ");
     DEBUG_PRINTLN(status);
+    markDrawn(DISPLAY_SCREEN(UI_MODE_NETWORK, 0));
   }
   
   /**
    * @brief Show settings menu
+   * 
+   * @param menuItem Selected setting (SettingId)
+   * @param settings Current settings
+   * @param editing Whether the selected value is being edited
    */
-  void showSettings(int menuItem) {
-    DEBUG_PRINT("Settings Display - Item: ");
-    DEBUG_PRINTLN(menuItem);
+  void showSettings(int menuItem, const Settings& settings, bool editing) {
+    DEBUG_PRINT("Settings Display - ");
+    DEBUG_PRINT(SETTINGS_TABLE[menuItem].key);
+    DEBUG_PRINT(editing ? " [" : " ");
+    DEBUG_PRINT(settings.get((SettingId)menuItem));
+    DEBUG_PRINTLN(editing ? "]" : "");
+    markDrawn(DISPLAY_SCREEN(editing ? UI_MODE_SETTINGS_EDIT : UI_MODE_SETTINGS, menuItem));
+  }
+  
+  /**
+   * @brief Show the stopwatch and its last laps
+   * 
+   * Line 1 holds the running time, the next lines the most recent laps.
+   */
+  void showStopwatch(const Stopwatch& stopwatch) {
+    uint32_t screen = timerScreen(stopwatch);
+    if (screen == shownScreen && Timebase::millis64() - lastTimerDisplay < 1000) {
+      return;
+    }
+    char line[32];  // Cut to LCD_COLS by the display
+    char time[16];
+    
+    formatDuration(time, sizeof(time), stopwatch.getElapsedMillis());
+    snprintf(line, sizeof(line), "Chrono %s%s", time, stopwatch.isRunning() ? "" : " ||");
+    DEBUG_PRINTLN(line);
+    
+    uint8_t laps = stopwatch.getLapCount();
+    for (uint8_t i = 0; i < STOPWATCH_MAX_LAPS && i < laps; i++) {
+      formatDuration(time, sizeof(time), stopwatch.getLapMillis(i));
+      snprintf(line, sizeof(line), "Tour %-3u %s", (unsigned)(laps - i), time);
+      DEBUG_PRINTLN(line);
+    }
+    lastTimerDisplay = Timebase::millis64();
+    markDrawn(screen);
+  }
+  
+  /**
+   * @brief Show the countdown and its preset
+   */
+  void showCountdown(const Countdown& countdown) {
+    uint32_t screen = timerScreen(countdown);
+    if (screen == shownScreen && Timebase::millis64() - lastTimerDisplay < 1000) {
+      return;
+    }
+    char line[32];  // Cut to LCD_COLS by the display
+    char time[16];
+    
+    formatDuration(time, sizeof(time), countdown.getRemainingMillis());
+    snprintf(line, sizeof(line), "Rebours %s%s", time, countdown.isRunning() ? "" : " ||");
+    DEBUG_PRINTLN(line);
+    lastTimerDisplay = Timebase::millis64();
+    markDrawn(screen);
+  }
+  
+  /**
+   * @brief Screen of the stopwatch: running state and lap count
+   * 
+   * The running time itself is refreshed once per second.
+   */
+  static uint32_t timerScreen(const Stopwatch& stopwatch) {
+    return DISPLAY_SCREEN(UI_MODE_STOPWATCH, ((uint32_t)stopwatch.getLapCount() << 1) | stopwatch.isRunning());
+  }
+  
+  /**
+   * @brief Screen of the countdown: running state and preset
+   */
+  static uint32_t timerScreen(const Countdown& countdown) {
+    return DISPLAY_SCREEN(UI_MODE_COUNTDOWN, (countdown.getDurationSeconds() << 1) | countdown.isRunning());
+  }
+  
+  /**
+   * @brief Get the screen last drawn
+   * 
+   * @return DISPLAY_SCREEN of the last redraw, DISPLAY_SCREEN_NONE before the first
+   */
+  uint32_t getShownScreen() const {
+    return shownScreen;
+  }
+  
+  /**
+   * @brief Get the time of the last redraw (us)
+   */
+  uint64_t getLastRedrawMicros() const {
+    return lastRedrawMicros;
   }
   
   /**
    * @brief Update air quality LED display
+   * 
+   * The strip is only pushed when the reading changes; the clock rings
+   * share the same show() and would otherwise be resent every loop.
    */
   void updateAirQualityLED(int airQuality) {
+    if (airQuality == shownAirQuality) {
+      return;
+    }
+    renderAirQualityFrame(airQuality);
+    
+    FastLED.show();
+    shownAirQuality = airQuality;
+    
+    // Debug output occasionally
+    if (airQuality != lastAirQuality && Timebase::millis64() - lastAirDisplay > 2000) {
+      DEBUG_PRINT("Air Quality LEDs updated: ");
+      DEBUG_PRINT(airQuality);
+      DEBUG_PRINT(" PPM, ");
+      DEBUG_PRINT(airQualityLedCount(airQuality));
+      DEBUG_PRINTLN(" LEDs lit");
+      lastAirDisplay = Timebase::millis64();
+      lastAirQuality = airQuality;
+    }
+  }
+
+private:
+  /**
+   * @brief Note that a screen was drawn
+   */
+  void markDrawn(uint32_t screen) {
+    shownScreen = screen;
+    lastRedrawMicros = Timebase::micros64();
+  }
+  
+  /**
+   * @brief Format a duration as "m:ss.mmm", or "h:mm:ss.mmm" past an hour
+   * 
+   * @param buffer Output buffer
+   * @param size Buffer size
+   * @param ms Duration in milliseconds
+   */
+  static void formatDuration(char* buffer, size_t size, uint32_t ms) {
+    uint32_t seconds = ms / 1000;
+    if (seconds >= 3600) {
+      snprintf(buffer, size, "%lu:%02lu:%02lu.%03lu",
+               (unsigned long)(seconds / 3600), (unsigned long)(seconds / 60 % 60),
+               (unsigned long)(seconds % 60), (unsigned long)(ms % 1000));
+    } else {
+      snprintf(buffer, size, "%lu:%02lu.%03lu",
+               (unsigned long)(seconds / 60), (unsigned long)(seconds % 60),
+               (unsigned long)(ms % 1000));
+    }
+  }
+  
+  /**
+   * @brief Compose the air quality strip into its LED buffer
+   * 
+   * @param airQuality Air quality reading (PPM)
+   * @return Number of LEDs lit
+   */
+  int renderAirQualityFrame(int airQuality) {
     // Map air quality to color
     CRGB color;
     if (airQuality <= AIR_EXCELLENT_MAX) {
@@ -139,9 +316,7 @@ public:
       color = CRGB(128, 0, 128);  // Purple
     }
     
-    // Calculate how many LEDs to light based on air quality level
-    int ledsToLight = map(airQuality, 0, 500, 1, LED_STRIP_AIR_COUNT);
-    ledsToLight = constrain(ledsToLight, 1, LED_STRIP_AIR_COUNT);
+    int ledsToLight = airQualityLedCount(airQuality);
     
     // Clear all LEDs
     for (int i = 0; i < LED_STRIP_AIR_COUNT; i++) {
@@ -153,20 +328,15 @@ public:
       airQualityLEDs[i] = color;
     }
     
-    FastLED.show();
-    
-    // Debug output occasionally
-    static unsigned long lastAirDisplay = 0;
-    static int lastAirQuality = -1;
-    if (airQuality != lastAirQuality && millis() - lastAirDisplay > 2000) {
-      DEBUG_PRINT("Air Quality LEDs updated: ");
-      DEBUG_PRINT(airQuality);
-      DEBUG_PRINT(" PPM, ");
-      DEBUG_PRINT(ledsToLight);
-      DEBUG_PRINTLN(" LEDs lit");
-      lastAirDisplay = millis();
-      lastAirQuality = airQuality;
-    }
+    return ledsToLight;
+  }
+  
+  /**
+   * @brief Calculate how many LEDs to light based on air quality level
+   */
+  static int airQualityLedCount(int airQuality) {
+    int ledsToLight = map(airQuality, 0, 500, 1, LED_STRIP_AIR_COUNT);
+    return constrain(ledsToLight, 1, LED_STRIP_AIR_COUNT);
   }
 };
 
@@ -0,0 +1,313 @@
+/**
+ * @file DnsCache.h
+ * @brief Host name cache with TTL expiry and stale-while-refresh
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Keeps the last address of a few host names (NTP server, upload hosts)
+ * for as long as their DNS record allows. lookup() never waits: a fresh
+ * entry is returned at once; an expired one is still returned while a
+ * refresh query runs in the background, and keeps being returned for
+ * DNS_STALE_LIMIT if the resolver does not answer, so a brief resolver
+ * outage does not stop NTP syncs or uploads. Queries go through a
+ * DnsTransport, which is the resolver of the current network on the
+ * device and can be pointed at a local DNS stand-in for tests.
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include "config.h"
+#include "DnsMessage.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+/**
+ * @class DnsTransport
+ * @brief Interface for sending queries to a resolver
+ */
+class DnsTransport {
+public:
+  virtual ~DnsTransport() {}
+  
+  /**
+   * @brief Send a query datagram
+   * 
+   * @return true if the datagram was sent
+   */
+  virtual bool send(const uint8_t* query, size_t length) = 0;
+  
+  /**
+   * @brief Read one pending response datagram without waiting
+   * 
+   * @return Number of bytes read, 0 if nothing has arrived
+   */
+  virtual int receive(uint8_t* buffer, size_t size) = 0;
+};
+
+/**
+ * @class UdpDnsTransport
+ * @brief Queries over UDP to the DHCP-provided or a configured resolver
+ */
+class UdpDnsTransport : public DnsTransport {
+private:
+  WiFiUDP udp;
+  IPAddress server;      ///< Configured resolver, 0.0.0.0 for the DHCP one
+  IPAddress queried;     ///< Resolver of the last query
+  bool open;
+
+public:
+  UdpDnsTransport() : open(false) {}
+  
+  /**
+   * @brief Use a fixed resolver instead of the one given by DHCP
+   * 
+   * @param address Resolver address, 0.0.0.0 to go back to DHCP
+   */
+  void setServer(const IPAddress& address) {
+    server = address;
+  }
+  
+  bool send(const uint8_t* query, size_t length) override {
+    if (!open) {
+      open = udp.begin(DNS_LOCAL_PORT);
+    }
+    queried = server != IPAddress(0, 0, 0, 0) ? server : WiFi.dnsIP(0);
+    return open &&
+           udp.beginPacket(queried, DNS_PORT) &&
+           udp.write(query, length) == length &&
+           udp.endPacket();
+  }
+  
+  int receive(uint8_t* buffer, size_t size) override {
+    if (!open || udp.parsePacket() <= 0) {
+      return 0;
+    }
+    int length = udp.read(buffer, size);
+    // Answers from anyone but the resolver we asked are dropped
+    if (udp.remoteIP() != queried) {
+      return 0;
+    }
+    return length > 0 ? length : 0;
+  }
+};
+
+/**
+ * @struct DnsEntry
+ * @brief Cached address of one host name
+ */
+struct DnsEntry {
+  char host[DNS_HOST_MAX];
+  IPAddress address;
+  uint64_t expiresAt;   ///< End of the record TTL (ms)
+  uint64_t retryAt;     ///< Earliest refresh after a failed query (ms)
+  uint64_t lastUsed;    ///< Last lookup, for eviction (ms)
+  bool resolved;        ///< address holds a resolved value
+};
+
+/**
+ * @class DnsCache
+ * @brief Small TTL-respecting resolver cache
+ * 
+ * One query is in flight at a time. Times are passed in by the caller
+ * (Timebase::millis64() on the device), so checks can replay hours of
+ * expiry in a few steps.
+ */
+class DnsCache {
+private:
+  DnsTransport* transport;
+  DnsEntry entries[DNS_CACHE_SIZE];
+  uint8_t entryCount;
+  
+  int8_t pending;        ///< Entry being refreshed, -1 if none
+  uint16_t queryId;
+  uint64_t queryStart;
+  
+  // Lookup statistics
+  unsigned long hits;
+  unsigned long staleHits;
+  unsigned long misses;
+  unsigned long queries;
+  unsigned long failures;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param dnsTransport Where queries are sent
+   */
+  explicit DnsCache(DnsTransport* dnsTransport) :
+    transport(dnsTransport),
+    entryCount(0),
+    pending(-1),
+    queryId(0),
+    queryStart(0),
+    hits(0),
+    staleHits(0),
+    misses(0),
+    queries(0),
+    failures(0) {}
+  
+  /**
+   * @brief Get the address of a host name without waiting
+   * 
+   * Starts a refresh query when the entry is missing or expired.
+   * 
+   * @param host Host name
+   * @param address Cached address, set only when true is returned
+   * @param now Current time (ms)
+   * @return true if a fresh or usable stale address is known
+   */
+  bool lookup(const char* host, IPAddress& address, uint64_t now) {
+    int index = findOrAdd(host);
+    if (index < 0) {
+      misses++;
+      return false;
+    }
+    DnsEntry& entry = entries[index];
+    entry.lastUsed = now;
+    
+    if (entry.resolved && now < entry.expiresAt) {
+      hits++;
+      address = entry.address;
+      return true;
+    }
+    
+    if (pending < 0 && now >= entry.retryAt) {
+      startQuery(index, now);
+    }
+    
+    if (entry.resolved && now - entry.expiresAt < DNS_STALE_LIMIT) {
+      staleHits++;
+      address = entry.address;
+      return true;
+    }
+    misses++;
+    return false;
+  }
+  
+  /**
+   * @brief Collect the answer to the pending query without blocking
+   * 
+   * Should be called every loop iteration. Reads at most one datagram;
+   * answers that fail validation are ignored until DNS_QUERY_TIMEOUT.
+   * 
+   * @param now Current time (ms)
+   */
+  void update(uint64_t now) {
+    if (pending < 0) {
+      return;
+    }
+    DnsEntry& entry = entries[pending];
+    
+    uint8_t packet[DNS_PACKET_MAX];
+    int length = transport->receive(packet, sizeof(packet));
+    if (length > 0) {
+      uint8_t address[4];
+      uint32_t ttl = 0;
+      DnsStatus status = DnsMessage::parseResponse(packet, length, queryId, address, ttl);
+      if (status == DNS_OK) {
+        if (ttl < DNS_MIN_TTL) ttl = DNS_MIN_TTL;
+        if (ttl > DNS_MAX_TTL) ttl = DNS_MAX_TTL;
+        entry.address = IPAddress(address[0], address[1], address[2], address[3]);
+        entry.expiresAt = now + (uint64_t)ttl * 1000;
+        entry.retryAt = 0;
+        entry.resolved = true;
+        pending = -1;
+        
+        DEBUG_PRINT("DNS ");
+        DEBUG_PRINT(entry.host);
+        DEBUG_PRINT(" cached for ");
+        DEBUG_PRINT(ttl);
+        DEBUG_PRINTLN(" s");
+        return;
+      }
+      DEBUG_PRINT("DNS reply rejected, status ");
+      DEBUG_PRINTLN(status);
+    }
+    
+    if (now - queryStart >= DNS_QUERY_TIMEOUT) {
+      DEBUG_PRINT("DNS query failed: ");
+      DEBUG_PRINTLN(entry.host);
+      failures++;
+      entry.retryAt = now + DNS_RETRY_INTERVAL;
+      pending = -1;
+    }
+  }
+  
+  /**
+   * @brief Check whether a query awaits its answer
+   */
+  bool isQueryPending() const {
+    return pending >= 0;
+  }
+  
+  unsigned long getHits() const { return hits; }
+  unsigned long getStaleHits() const { return staleHits; }
+  unsigned long getMisses() const { return misses; }
+  unsigned long getQueries() const { return queries; }
+  unsigned long getFailures() const { return failures; }
+
+private:
+  /**
+   * @brief Find the entry of a host, or make room for it
+   * 
+   * The least recently used entry is evicted when the cache is full,
+   * never the one being refreshed.
+   * 
+   * @return Entry index, or -1 if the name is too long to cache
+   */
+  int findOrAdd(const char* host) {
+    if (strlen(host) >= DNS_HOST_MAX) {
+      return -1;
+    }
+    for (uint8_t i = 0; i < entryCount; i++) {
+      if (strcmp(entries[i].host, host) == 0) {
+        return i;
+      }
+    }
+    
+    int index = entryCount;
+    if (entryCount < DNS_CACHE_SIZE) {
+      entryCount++;
+    } else {
+      index = -1;
+      for (uint8_t i = 0; i < entryCount; i++) {
+        if (i != pending && (index < 0 || entries[i].lastUsed < entries[index].lastUsed)) {
+          index = i;
+        }
+      }
+      if (index < 0) {
+        return -1;
+      }
+    }
+    
+    DnsEntry& entry = entries[index];
+    strcpy(entry.host, host);
+    entry.address = IPAddress(0, 0, 0, 0);
+    entry.expiresAt = 0;
+    entry.retryAt = 0;
+    entry.lastUsed = 0;
+    entry.resolved = false;
+    return index;
+  }
+  
+  void startQuery(int index, uint64_t now) {
+    uint8_t packet[DNS_PACKET_MAX];
+    // Unpredictable IDs make forged answers harder to slip in
+    queryId = (uint16_t)(micros() ^ (now * 2654435761UL) ^ (queries << 8));
+    size_t length = DnsMessage::buildQuery(packet, sizeof(packet), queryId, entries[index].host);
+    
+    queries++;
+    if (length == 0 || !transport->send(packet, length)) {
+      failures++;
+      entries[index].retryAt = now + DNS_RETRY_INTERVAL;
+      return;
+    }
+    pending = index;
+    queryStart = now;
+  }
+};
+
+#endif // DNS_CACHE_H
@@ -0,0 +1,199 @@
+/**
+ * @file DnsCheck.h
+ * @brief DNS cache check against a local resolver stand-in
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Runs DnsCache against LoopbackResolver, a DnsTransport that answers the
+ * queries it receives from a one-host zone, and can go silent or send
+ * forged answers. Times are scripted, so TTL expiry, stale serving and
+ * resolver outages are checked in a few steps.
+ */
+
+#ifndef DNS_CHECK_H
+#define DNS_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "DnsCache.h"
+
+#define DNS_CHECK_HOST   "ntp.example.org"
+#define DNS_CHECK_TTL    300UL  // s
+
+/**
+ * @class LoopbackResolver
+ * @brief Resolver stand-in answering A queries for one host
+ */
+class LoopbackResolver : public DnsTransport {
+private:
+  uint8_t reply[DNS_PACKET_MAX];
+  size_t replyLength;
+
+public:
+  IPAddress address;      ///< Address served for the host
+  uint32_t ttl;           ///< TTL served (s)
+  bool online;            ///< false: queries get no answer
+  bool forgeId;           ///< true: answers carry the wrong query ID
+  unsigned long received; ///< Queries received
+  
+  LoopbackResolver() :
+    replyLength(0),
+    address(192, 0, 2, 1),
+    ttl(DNS_CHECK_TTL),
+    online(true),
+    forgeId(false),
+    received(0) {}
+  
+  bool send(const uint8_t* query, size_t length) override {
+    received++;
+    if (!online || length < DNS_HEADER_SIZE || length + 16 > sizeof(reply)) {
+      return true;
+    }
+    
+    // Header and question echoed, then one A record pointing at the name
+    memcpy(reply, query, length);
+    if (forgeId) {
+      reply[1] ^= 0x5A;
+    }
+    reply[2] = 0x81;  // QR, RD
+    reply[3] = 0x80;  // RA, RCODE 0
+    reply[7] = 1;     // ANCOUNT
+    size_t pos = length;
+    const uint8_t answer[] = {
+      0xC0, DNS_HEADER_SIZE, 0, DNS_TYPE_A, 0, DNS_CLASS_IN,
+      (uint8_t)(ttl >> 24), (uint8_t)(ttl >> 16), (uint8_t)(ttl >> 8), (uint8_t)ttl,
+      0, 4, address[0], address[1], address[2], address[3]
+    };
+    memcpy(reply + pos, answer, sizeof(answer));
+    replyLength = pos + sizeof(answer);
+    return true;
+  }
+  
+  int receive(uint8_t* buffer, size_t size) override {
+    if (replyLength == 0 || replyLength > size) {
+      return 0;
+    }
+    memcpy(buffer, reply, replyLength);
+    int length = replyLength;
+    replyLength = 0;
+    return length;
+  }
+};
+
+/**
+ * @class DnsCheck
+ * @brief Runs the cache scenarios and prints the results
+ */
+class DnsCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  DnsCheck() : results("DNS") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    checkCachedWithinTtl();
+    checkStaleWhileRefresh();
+    checkResolverOutage();
+    checkForgedAnswer();
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief First lookup misses and queries; later ones hit until the TTL
+   */
+  void checkCachedWithinTtl() {
+    LoopbackResolver resolver;
+    DnsCache cache(&resolver);
+    IPAddress ip;
+    bool ok = !cache.lookup(DNS_CHECK_HOST, ip, 0);
+    cache.update(10);
+    for (uint64_t t = 1000; t < DNS_CHECK_TTL * 1000; t += 60000) {
+      ok = ok && cache.lookup(DNS_CHECK_HOST, ip, t) && ip == resolver.address;
+    }
+    report("dns.cachedWithinTtl", resolver.received, ok && resolver.received == 1);
+  }
+  
+  /**
+   * @brief Expired entry is served while the refresh runs, then replaced
+   */
+  void checkStaleWhileRefresh() {
+    LoopbackResolver resolver;
+    DnsCache cache(&resolver);
+    IPAddress ip;
+    IPAddress first = resolver.address;
+    cache.lookup(DNS_CHECK_HOST, ip, 0);
+    cache.update(10);
+    
+    // Answer cached at t = 10 ms
+    uint64_t expired = 10 + DNS_CHECK_TTL * 1000;
+    resolver.address = IPAddress(192, 0, 2, 2);
+    bool ok = cache.lookup(DNS_CHECK_HOST, ip, expired) && ip == first;
+    cache.update(expired + 10);
+    ok = ok && cache.lookup(DNS_CHECK_HOST, ip, expired + 20) && ip == resolver.address;
+    report("dns.staleWhileRefresh", resolver.received, ok && resolver.received == 2);
+  }
+  
+  /**
+   * @brief Silent resolver: stale address kept up to DNS_STALE_LIMIT,
+   * refreshes spaced by DNS_RETRY_INTERVAL
+   */
+  void checkResolverOutage() {
+    LoopbackResolver resolver;
+    DnsCache cache(&resolver);
+    IPAddress ip;
+    cache.lookup(DNS_CHECK_HOST, ip, 0);
+    cache.update(10);
+    resolver.online = false;
+    
+    uint64_t expiry = 10 + DNS_CHECK_TTL * 1000;
+    bool ok = true;
+    // Ten minutes of syncs, one every second
+    for (uint64_t t = expiry; t < expiry + 600000; t += 1000) {
+      ok = ok && cache.lookup(DNS_CHECK_HOST, ip, t);
+      cache.update(t + 500);
+    }
+    // One query per retry interval at most, not one per lookup
+    ok = ok && resolver.received >= 2 && resolver.received <= 600000 / DNS_RETRY_INTERVAL + 1;
+    // Past the stale limit, the address is dropped
+    ok = ok && !cache.lookup(DNS_CHECK_HOST, ip, expiry + DNS_STALE_LIMIT);
+    report("dns.resolverOutage", resolver.received, ok);
+  }
+  
+  /**
+   * @brief Answers with another query ID never enter the cache
+   */
+  void checkForgedAnswer() {
+    LoopbackResolver resolver;
+    DnsCache cache(&resolver);
+    IPAddress ip;
+    resolver.forgeId = true;
+    cache.lookup(DNS_CHECK_HOST, ip, 0);
+    cache.update(10);
+    bool ok = !cache.lookup(DNS_CHECK_HOST, ip, 20) && cache.isQueryPending();
+    cache.update(DNS_QUERY_TIMEOUT);
+    ok = ok && !cache.isQueryPending() && cache.getFailures() == 1;
+    report("dns.forgedAnswer", resolver.received, ok);
+  }
+  
+  void report(const char* name, unsigned long queries, bool ok) {
+    results.start(name);
+    results.field("queries", queries);
+    results.finish(ok);
+  }
+};
+
+#endif // DNS_CHECK_H
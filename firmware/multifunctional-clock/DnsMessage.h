@@ -0,0 +1,174 @@
+/**
+ * @file DnsMessage.h
+ * @brief DNS A query building and response parsing
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Works directly on the UDP datagram, without allocation. The core's
+ * WiFi.hostByName() blocks and hides the record TTL, so DnsCache sends its
+ * own queries and reads the first IPv4 address and its TTL from the answer
+ * section, following CNAME chains and compressed names.
+ */
+
+#ifndef DNS_MESSAGE_H
+#define DNS_MESSAGE_H
+
+#include "config.h"
+
+#define DNS_PORT              53
+#define DNS_HEADER_SIZE       12
+#define DNS_TYPE_A            1
+#define DNS_CLASS_IN          1
+
+/**
+ * @brief Result of parsing a DNS response
+ */
+enum DnsStatus {
+  DNS_OK = 0,
+  DNS_TOO_SHORT,        ///< Shorter than its header or records
+  DNS_BAD_ID,           ///< Does not answer our query
+  DNS_NOT_RESPONSE,     ///< QR bit clear
+  DNS_TRUNCATED,        ///< TC bit set: answer did not fit in UDP
+  DNS_SERVER_ERROR,     ///< Non-zero RCODE (NXDOMAIN, SERVFAIL...)
+  DNS_MALFORMED,        ///< Bad label or name pointer
+  DNS_NO_ADDRESS        ///< No A record in the answer
+};
+
+/**
+ * @class DnsMessage
+ * @brief Stateless helpers to build and parse DNS datagrams
+ */
+class DnsMessage {
+public:
+  /**
+   * @brief Build a recursive A query for a host name
+   * 
+   * @param buffer Destination buffer
+   * @param size Size of the destination buffer
+   * @param id Query identifier, echoed by the server
+   * @param host Dotted host name
+   * @return Length of the query, or 0 if the name is invalid or too long
+   */
+  static size_t buildQuery(uint8_t* buffer, size_t size, uint16_t id, const char* host) {
+    if (size < DNS_HEADER_SIZE + 6) {
+      return 0;
+    }
+    memset(buffer, 0, DNS_HEADER_SIZE);
+    put16(buffer, id);
+    buffer[2] = 0x01;             // RD: recursion desired
+    put16(buffer + 4, 1);         // QDCOUNT
+    
+    // Labels: each dot-separated part preceded by its length
+    size_t len = DNS_HEADER_SIZE;
+    const char* label = host;
+    while (*label) {
+      const char* end = label;
+      while (*end && *end != '.') end++;
+      size_t labelLength = end - label;
+      if (labelLength == 0 || labelLength > 63 || len + labelLength + 1 + 5 > size) {
+        return 0;
+      }
+      buffer[len++] = labelLength;
+      memcpy(buffer + len, label, labelLength);
+      len += labelLength;
+      label = *end ? end + 1 : end;
+    }
+    if (len == DNS_HEADER_SIZE) {
+      return 0;
+    }
+    buffer[len++] = 0;
+    put16(buffer + len, DNS_TYPE_A);
+    put16(buffer + len + 2, DNS_CLASS_IN);
+    return len + 4;
+  }
+  
+  /**
+   * @brief Validate a response and extract its first IPv4 address
+   * 
+   * @param buffer Received datagram
+   * @param length Number of bytes received
+   * @param id Identifier of the matching query
+   * @param address First A record, valid only when DNS_OK is returned
+   * @param ttl Its time to live (s), valid only when DNS_OK is returned
+   * @return DNS_OK or the first validation failure
+   */
+  static DnsStatus parseResponse(const uint8_t* buffer, size_t length, uint16_t id,
+                                 uint8_t address[4], uint32_t& ttl) {
+    if (length < DNS_HEADER_SIZE) return DNS_TOO_SHORT;
+    if (get16(buffer) != id) return DNS_BAD_ID;
+    if (!(buffer[2] & 0x80)) return DNS_NOT_RESPONSE;
+    if (buffer[2] & 0x02) return DNS_TRUNCATED;
+    if (buffer[3] & 0x0F) return DNS_SERVER_ERROR;
+    
+    uint16_t questions = get16(buffer + 4);
+    uint16_t answers = get16(buffer + 6);
+    size_t pos = DNS_HEADER_SIZE;
+    
+    for (uint16_t i = 0; i < questions; i++) {
+      if (!skipName(buffer, length, pos)) return DNS_MALFORMED;
+      pos += 4;  // QTYPE, QCLASS
+    }
+    
+    for (uint16_t i = 0; i < answers; i++) {
+      if (!skipName(buffer, length, pos)) return DNS_MALFORMED;
+      if (pos + 10 > length) return DNS_TOO_SHORT;
+      uint16_t type = get16(buffer + pos);
+      uint16_t recordClass = get16(buffer + pos + 2);
+      uint32_t recordTtl = get32(buffer + pos + 4);
+      uint16_t dataLength = get16(buffer + pos + 8);
+      pos += 10;
+      if (pos + dataLength > length) return DNS_TOO_SHORT;
+      
+      // CNAME and other records before the address are skipped
+      if (type == DNS_TYPE_A && recordClass == DNS_CLASS_IN && dataLength == 4) {
+        memcpy(address, buffer + pos, 4);
+        // TTL is unsigned 31-bit (RFC 2181): treat the top bit as zero
+        ttl = recordTtl & 0x7FFFFFFFUL;
+        return DNS_OK;
+      }
+      pos += dataLength;
+    }
+    return DNS_NO_ADDRESS;
+  }
+
+private:
+  /**
+   * @brief Move past an encoded name, stopping at a compression pointer
+   * 
+   * @return false if a label or pointer runs past the datagram
+   */
+  static bool skipName(const uint8_t* buffer, size_t length, size_t& pos) {
+    while (pos < length) {
+      uint8_t labelLength = buffer[pos];
+      if ((labelLength & 0xC0) == 0xC0) {
+        pos += 2;
+        return pos <= length;
+      }
+      if (labelLength & 0xC0) {
+        return false;  // Reserved label types
+      }
+      pos += labelLength + 1;
+      if (labelLength == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  
+  static uint16_t get16(const uint8_t* p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+  }
+  
+  static uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  }
+  
+  static void put16(uint8_t* p, uint16_t value) {
+    p[0] = value >> 8;
+    p[1] = value;
+  }
+};
+
+#endif // DNS_MESSAGE_H
@@ -0,0 +1,283 @@
+/**
+ * @file Firmware.h
+ * @brief The whole clock: managers, settings and main loop
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * The sketch creates one Firmware and calls begin() and start() from
+ * setup(), then loop() from loop(). Every piece of state lives in the
+ * object rather than in sketch globals, so the host fleet simulator can
+ * run many independent clocks in one process, each with its own
+ * settings, timers and network state.
+ */
+
+#ifndef FIRMWARE_H
+#define FIRMWARE_H
+
+#include "config.h"
+#include "ClockManager.h"
+#include "SensorManager.h"
+#include "DisplayManager.h"
+#include "NetworkManager.h"
+#include "UIManager.h"
+#include "Timebase.h"
+#include "BootSequence.h"
+#include "Settings.h"
+
+/**
+ * @class Firmware
+ * @brief One clock, from setup() to the display update of each loop()
+ */
+class Firmware {
+public:
+  // Gestionnaires principaux
+  ClockManager clockMgr;
+  SensorManager sensorMgr;
+  DisplayManager displayMgr;
+  NetworkManager networkMgr;
+  UIManager uiMgr;
+  BootSequence boot;
+  
+  // Réglages utilisateur (modifiables via l'API et le menu)
+  Settings settings;
+
+private:
+  // Horodatages sur l'horloge 64 bits (ms, sans débordement)
+  uint64_t lastSensorRead;
+  uint64_t lastNetworkSync;
+  
+  // Derniers états poussés aux abonnés /api/events (front montant/descendant)
+  NtpSyncState lastNtpState;
+  bool lastAlarmRinging;
+  bool lastAirAlert;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  Firmware() :
+    boot(clockMgr, sensorMgr, displayMgr, networkMgr),
+    lastSensorRead(0),
+    lastNetworkSync(0),
+    lastNtpState(NTP_SYNC_IDLE),
+    lastAlarmRinging(false),
+    lastAirAlert(false) {}
+  
+  /**
+   * @brief Bring up the display, the clock and the buttons
+   * 
+   * Sensors, WiFi and NTP are started later by loop() (BootSequence).
+   * 
+   * @return false if the display or the clock cannot be used
+   */
+  bool begin() {
+    settings.loadDefaults();
+    
+    if (!displayMgr.init()) {
+      Serial.println("ERREUR: Impossible d'initialiser l'affichage");
+      return false;
+    }
+    
+    displayMgr.showBootMessage("Initialisation...");
+    
+    // Adresse du serveur NTP mise en cache par le gestionnaire réseau
+    clockMgr.setDnsCache(networkMgr.getDnsCache());
+    
+    if (!clockMgr.init()) {
+      Serial.println("ERREUR: Impossible d'initialiser l'horloge");
+      displayMgr.showBootMessage("Horloge: ERREUR");
+      return false;
+    }
+    
+    // Heure conservée par la RTC : affichable avant le WiFi
+    if (clockMgr.isTimeValid()) {
+      displayMgr.showBootMessage("Heure RTC OK");
+    }
+    
+    if (!uiMgr.init()) {
+      Serial.println("ATTENTION: Interface utilisateur limitée");
+    }
+    uiMgr.attachSettings(&settings);
+    
+    // Première image LED le plus tôt possible
+    boot.showFirstFrame();
+    return true;
+  }
+  
+  /**
+   * @brief Start the periodic tasks, at the end of setup()
+   */
+  void start() {
+    // Les intervalles partent de la fin de setup()
+    lastSensorRead = lastNetworkSync = Timebase::millis64();
+  }
+  
+  /**
+   * @brief One main loop iteration
+   */
+  void loop() {
+    uint64_t currentTime = Timebase::millis64();
+    
+    // Étapes de démarrage restantes (une par passage, non bloquant)
+    boot.update();
+    
+    // Gestion de l'interface utilisateur (priorité haute)
+    uiMgr.setAlarmRinging(clockMgr.isAlarmRinging());
+    uiMgr.update();
+    
+    // Alarme : sélection = répétition, mode = arrêt
+    switch (uiMgr.takeAlarmCommand()) {
+      case ALARM_COMMAND_SNOOZE:
+        clockMgr.snoozeAlarm();
+        break;
+      case ALARM_COMMAND_DISMISS:
+        clockMgr.dismissAlarm();
+        break;
+      default:
+        break;
+    }
+    
+    // Fin du compte à rebours : sonnerie comme une minuterie
+    if (uiMgr.takeCountdownFinished()) {
+      clockMgr.ringCountdown();
+    }
+    
+    // Réglage modifié depuis le menu
+    if (uiMgr.takeSettingsChange()) {
+      clockMgr.applySettings(settings);
+    }
+    
+    // Mise à jour de l'horloge (avance au front de chaque seconde)
+    clockMgr.update();
+    
+    // Liaison WiFi : reconnexion en arrière-plan (non bloquant)
+    networkMgr.update();
+    if (networkMgr.takeReconnected()) {
+      clockMgr.startNtpSync();
+    }
+    
+    // Réponse NTP (non bloquant), résultat poussé aux navigateurs
+    NtpSyncState ntpState = clockMgr.updateNtpSync();
+    if (ntpState != lastNtpState &&
+        (ntpState == NTP_SYNC_OK || ntpState == NTP_SYNC_FAILED)) {
+      networkMgr.pushTimeSync(ntpState == NTP_SYNC_OK, clockMgr.getEpoch());
+    }
+    lastNtpState = ntpState;
+    
+    // Alerte sonnerie (début et fin)
+    if (clockMgr.isAlarmRinging() != lastAlarmRinging) {
+      lastAlarmRinging = !lastAlarmRinging;
+      networkMgr.pushAlert("alarm", lastAlarmRinging, 0);
+    }
+    
+    // Images animées : réveil lumineux, chrono (cadence fixe)
+    clockMgr.updateFrame();
+    
+    // Lecture des capteurs (toutes les 30 secondes)
+    if (currentTime - lastSensorRead >= SENSOR_READ_INTERVAL) {
+      sensorMgr.update();
+      lastSensorRead = currentTime;
+      
+      // Télémétrie MQTT : mise en file, envoi par lots dans networkMgr.update()
+      networkMgr.sendSensorData(sensorMgr.getAllData(), clockMgr.getEpoch());
+      
+      // Historique pour /api/history (moyenne par créneau)
+      networkMgr.recordHistory(sensorMgr.getAllData(), clockMgr.getEpoch());
+      
+      // Navigateurs abonnés : nouvel échantillon, alerte qualité d'air
+      networkMgr.pushSensorData(sensorMgr.getAllData(), clockMgr.getEpoch());
+      bool airAlert = sensorMgr.getAirQuality() > AIR_POOR_MAX;
+      if (airAlert != lastAirAlert) {
+        lastAirAlert = airAlert;
+        networkMgr.pushAlert("airQuality", airAlert, sensorMgr.getAirQuality());
+      }
+    }
+    
+    // Synchronisation réseau (une fois par jour)
+    if (currentTime - lastNetworkSync >= NETWORK_SYNC_INTERVAL) {
+      if (networkMgr.isConnected()) {
+        clockMgr.startNtpSync();
+      }
+      lastNetworkSync = currentTime;
+    }
+    
+    // Serveur SNTP local, seulement avec une heure NTP récente
+    NtpReference ntpReference;
+    networkMgr.serveSntp(clockMgr.getNtpReference(ntpReference) ? &ntpReference : nullptr);
+    
+    // Requêtes HTTP de l'API (non bloquant)
+    if (networkMgr.handleWebClients(sensorMgr.getAllData(), sensorMgr.getSequence(), settings)) {
+      clockMgr.applySettings(settings);
+    }
+    
+    // Mise à jour de l'affichage selon le mode UI
+    updateDisplay();
+    
+    // Petite pause pour éviter la saturation du processeur, terminée
+    // pile sur le front de la seconde s'il tombe pendant la pause
+    clockMgr.waitForTick(LOOP_DELAY);
+  }
+
+private:
+  /**
+   * @brief Update display based on current UI mode
+   * 
+   * Routes display updates to appropriate functions based on the current
+   * user interface mode. Also handles air quality LED which is always visible.
+   */
+  void updateDisplay() {
+    UIMode currentMode = uiMgr.getCurrentMode();
+    
+    // Anneau des minutes : progression en modes chrono, aiguilles sinon
+    if (currentMode != UI_MODE_STOPWATCH && currentMode != UI_MODE_COUNTDOWN) {
+      clockMgr.clearProgress();
+    }
+    
+    switch (currentMode) {
+      case UI_MODE_CLOCK:
+        displayMgr.showClock(clockMgr.getCurrentTime());
+        displayMgr.updateLEDClock(clockMgr.getCurrentTime());
+        break;
+      
+      case UI_MODE_SENSORS:
+        displayMgr.showSensorData(
+          sensorMgr.getAllData(),
+          uiMgr.getSensorPage()
+        );
+        break;
+      
+      case UI_MODE_NETWORK:
+        displayMgr.showNetworkInfo(networkMgr.getStatus());
+        break;
+      
+      case UI_MODE_SETTINGS:
+      case UI_MODE_SETTINGS_EDIT:
+        displayMgr.showSettings(uiMgr.getSettingsMenu(), settings,
+                                currentMode == UI_MODE_SETTINGS_EDIT);
+        break;
+      
+      case UI_MODE_STOPWATCH: {
+        // Un tour d'anneau par minute, comme une trotteuse
+        const Stopwatch& stopwatch = uiMgr.getStopwatch();
+        displayMgr.showStopwatch(stopwatch);
+        clockMgr.setProgress((uint16_t)((stopwatch.getElapsedMillis() % 60000UL) * 65535UL / 60000UL),
+                             COLOR_STOPWATCH);
+        break;
+      }
+      
+      case UI_MODE_COUNTDOWN:
+        displayMgr.showCountdown(uiMgr.getCountdown());
+        clockMgr.setProgress(uiMgr.getCountdown().getProgress(), COLOR_COUNTDOWN);
+        break;
+      
+      default:
+        break;
+    }
+    
+    // Air quality LED update (always visible)
+    displayMgr.updateAirQualityLED(sensorMgr.getAirQuality());
+  }
+};
+
+#endif // FIRMWARE_H
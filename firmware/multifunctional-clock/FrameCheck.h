@@ -0,0 +1,230 @@
+/**
+ * @file FrameCheck.h
+ * @brief Golden-frame regression check for the LED rendering
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Drives ClockManager and DisplayManager through scripted inputs (every
+ * second of the day, the hour animation, night mode, the wake light ramp
+ * and every air quality band), hashes each composed frame and compares the result with the
+ * golden hashes below, so a rendering optimization that changes what the
+ * rings show is caught before deploy.
+ * 
+ * If a rendering change is intentional, copy the new hashes printed on
+ * Serial into the golden tables.
+ */
+
+#ifndef FRAME_CHECK_H
+#define FRAME_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "ClockManager.h"
+#include "DisplayManager.h"
+
+// Golden hashes, one per hour of the full 24 h x 3600 s sweep
+static const uint32_t GOLDEN_CLOCK_HOURS[24] PROGMEM = {
+  0xE4DBCF15, 0x9B3636D5, 0x24F79075, 0x7EEB5755, 0xEA48AF95, 0xAE2A21D5,
+  0x530167F5, 0x47CE093D, 0xBC38AF7D, 0xE8839A3D, 0x5F09167D, 0xA8ABE73D,
+  0x28F47F7D, 0x1CEDB83D, 0x463B767D, 0xE458233D, 0x56E6F97D, 0x5752843D,
+  0xEE16EA7D, 0x47CE093D, 0xBC38AF7D, 0xE8839A3D, 0x14129DF5, 0xCDD7A355
+};
+
+// Golden hash of the hour transition animation
+static const uint32_t GOLDEN_HOUR_ANIMATION PROGMEM = 0x72174E5D;
+
+// Golden hash of the wake light ramp, dithering included
+static const uint32_t GOLDEN_SUNRISE PROGMEM = 0xAE10E112;
+
+// Golden hash of the stopwatch/countdown progress arc
+static const uint32_t GOLDEN_PROGRESS PROGMEM = 0xEC0FACA9;
+
+// Golden hashes of the air quality strip, one per band
+static const uint32_t GOLDEN_AIR_BANDS[6] PROGMEM = {
+  0x10CC8468, 0xE4CEF5E2, 0x8A29804F, 0x3E329354, 0xE9B20A67, 0xBA2E4525
+};
+
+/**
+ * @class FrameCheck
+ * @brief Renders scripted frames and compares their hashes with goldens
+ * 
+ * Frames are composed without FastLED.show(), so the full day sweep only
+ * costs the rendering itself.
+ */
+class FrameCheck {
+private:
+  ClockManager& clock;
+  DisplayManager& display;
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  FrameCheck(ClockManager& clockMgr, DisplayManager& displayMgr) :
+    clock(clockMgr),
+    display(displayMgr),
+    results("FRAME") {}
+  
+  /**
+   * @brief Run every frame check and print the results
+   * 
+   * @return Number of checks whose hash differs from the golden value
+   */
+  int runAll() {
+    results.begin();
+    
+    TimeInfo savedTime = clock.currentTime;
+    bool savedNightMode = clock.nightModeActive;
+    uint8_t savedBrightness = clock.currentBrightness;
+    
+    checkClockDay();
+    checkHourAnimation();
+    checkSunrise();
+    checkProgress();
+    checkAirQualityBands();
+    
+    clock.currentTime = savedTime;
+    clock.nightModeActive = savedNightMode;
+    clock.currentBrightness = savedBrightness;
+    FastLED.setBrightness(savedBrightness);
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief Sweep every second of the day, one hash per hour
+   * 
+   * Night mode is re-evaluated for each frame, so the brightness switch
+   * at NIGHT_MODE_START/NIGHT_MODE_END is part of the hashed output.
+   */
+  void checkClockDay() {
+    char name[] = "clock.hour.00";
+    
+    for (int h = 0; h < 24; h++) {
+      uint32_t hash = FNV1A_INIT;
+      for (int m = 0; m < 60; m++) {
+        for (int s = 0; s < 60; s++) {
+          clock.currentTime.hours = h;
+          clock.currentTime.minutes = m;
+          clock.currentTime.seconds = s;
+          clock.updateNightMode();
+          clock.renderClockFrame();
+          hash = hashClockFrame(hash);
+        }
+      }
+      name[11] = '0' + h / 10;
+      name[12] = '0' + h % 10;
+      report(name, 3600, hash, pgm_read_dword(&GOLDEN_CLOCK_HOURS[h]));
+    }
+  }
+  
+  /**
+   * @brief Hash every frame of the hour transition animation
+   */
+  void checkHourAnimation() {
+    uint32_t hash = FNV1A_INIT;
+    unsigned long frames = 0;
+    for (unsigned long elapsed = 0; elapsed < HOUR_ANIMATION_DURATION; elapsed += ANIMATION_SPEED) {
+      clock.renderHourAnimationFrame(elapsed);
+      hash = hashClockFrame(hash);
+      frames++;
+    }
+    report("clock.hourAnimation", frames, hash, pgm_read_dword(&GOLDEN_HOUR_ANIMATION));
+  }
+  
+  /**
+   * @brief Hash the wake light ramp from darkness to full, at night
+   * brightness so the hand scaling is covered too
+   */
+  void checkSunrise() {
+    const unsigned long frames = 512;
+    uint32_t hash = FNV1A_INIT;
+    clock.currentTime.hours = 6;
+    clock.currentTime.minutes = 40;
+    clock.currentTime.seconds = 0;
+    clock.currentBrightness = NIGHT_BRIGHTNESS;
+    for (unsigned long i = 0; i < frames; i++) {
+      clock.renderClockFrame();
+      clock.renderSunriseLayer((i * 65535UL) / (frames - 1), i);
+      hash = hashClockFrame(hash);
+    }
+    report("clock.sunrise", frames, hash, pgm_read_dword(&GOLDEN_SUNRISE));
+  }
+  
+  /**
+   * @brief Hash the progress arc over a full turn of the ring
+   */
+  void checkProgress() {
+    const unsigned long frames = 1024;
+    uint32_t hash = FNV1A_INIT;
+    for (unsigned long i = 0; i < frames; i++) {
+      clock.renderClockFrame();
+      clock.renderProgressLayer((i * 65535UL) / (frames - 1), COLOR_STOPWATCH);
+      hash = hashClockFrame(hash);
+    }
+    report("clock.progress", frames, hash, pgm_read_dword(&GOLDEN_PROGRESS));
+  }
+  
+  /**
+   * @brief Hash every PPM value of each air quality band
+   */
+  void checkAirQualityBands() {
+    static const int bandMax[6] = {
+      AIR_EXCELLENT_MAX, AIR_GOOD_MAX, AIR_MODERATE_MAX,
+      AIR_POOR_MAX, AIR_UNHEALTHY_MAX, AIR_UNHEALTHY_MAX + 100
+    };
+    static const char* const bandNames[6] = {
+      "air.excellent", "air.good", "air.moderate",
+      "air.poor", "air.unhealthy", "air.dangerous"
+    };
+    
+    int ppm = 0;
+    for (int band = 0; band < 6; band++) {
+      uint32_t hash = FNV1A_INIT;
+      unsigned long frames = 0;
+      for (; ppm <= bandMax[band]; ppm++) {
+        display.renderAirQualityFrame(ppm);
+        hash = fnv1a(hash, (const uint8_t*)display.airQualityLEDs, sizeof(display.airQualityLEDs));
+        frames++;
+      }
+      report(bandNames[band], frames, hash, pgm_read_dword(&GOLDEN_AIR_BANDS[band]));
+    }
+  }
+  
+  /**
+   * @brief Extend a hash with both clock rings and the global brightness
+   */
+  uint32_t hashClockFrame(uint32_t hash) const {
+    hash = fnv1a(hash, (const uint8_t*)clock.minutesLEDs, sizeof(clock.minutesLEDs));
+    hash = fnv1a(hash, (const uint8_t*)clock.hoursLEDs, sizeof(clock.hoursLEDs));
+    return fnv1a(hash, &clock.currentBrightness, 1);
+  }
+  
+  /**
+   * @brief 32-bit FNV-1a hash
+   */
+  static const uint32_t FNV1A_INIT = 0x811C9DC5UL;
+  
+  static uint32_t fnv1a(uint32_t hash, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      hash = (hash ^ data[i]) * 0x01000193UL;
+    }
+    return hash;
+  }
+  
+  /**
+   * @brief Print one result as a machine-readable line
+   */
+  void report(const char* name, unsigned long frames, uint32_t hash, uint32_t golden) {
+    results.start(name);
+    results.field("frames", frames);
+    results.hex("hash", hash);
+    results.hex("golden", golden);
+    results.finish(hash == golden);
+  }
+};
+
+#endif // FRAME_CHECK_H
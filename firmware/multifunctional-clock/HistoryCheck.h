@@ -0,0 +1,377 @@
+/**
+ * @file HistoryCheck.h
+ * @brief History log and downsampling check on a synthetic day
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Fills a HistoryLog past its capacity with a smooth temperature curve
+ * and one short spike, then runs the queries /api/history answers: the
+ * whole log reduced with LTTB (the spike, the first and the last record
+ * must survive), only the records after a sequence number, and a time
+ * window. Slot averaging, a clock stepping back, the streamed JSON, the
+ * binary columns (against the points of the same query) and the reading
+ * of numbers in the query string are checked too.
+ */
+
+#ifndef HISTORY_CHECK_H
+#define HISTORY_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "HistoryLog.h"
+#include "NetworkManager.h"
+#include "LzssCheck.h"
+
+#define HISTORY_CHECK_SLOTS     (HISTORY_SIZE + 40)   // Wraps the ring
+#define HISTORY_CHECK_SPIKE     (HISTORY_SIZE / 3)    // Slot of the spike
+#define HISTORY_CHECK_POINTS    50
+#define HISTORY_CHECK_START     1735689600UL          // 2025-01-01 00:00 UTC
+#define HISTORY_CHECK_BUFFER    1024                  // JSON of 50 points is about 950 B
+
+/**
+ * @class CollectSink
+ * @brief Keeps the points of a query to inspect them
+ */
+class CollectSink : public HistorySink {
+public:
+  uint32_t sequences[HISTORY_CHECK_POINTS];
+  uint32_t times[HISTORY_CHECK_POINTS];
+  int16_t values[HISTORY_CHECK_POINTS];
+  uint16_t count;
+  bool overflow;
+  HistoryField field;
+  
+  explicit CollectSink(HistoryField series) : count(0), overflow(false), field(series) {}
+  
+  void point(const HistoryRecord& record, uint32_t sequence) override {
+    if (count >= HISTORY_CHECK_POINTS) {
+      overflow = true;
+      return;
+    }
+    sequences[count] = sequence;
+    times[count] = record.time;
+    values[count] = record.values[field];
+    count++;
+  }
+  
+  /**
+   * @brief Points in increasing time and sequence order
+   */
+  bool isOrdered() const {
+    for (uint16_t i = 1; i < count; i++) {
+      if (times[i] <= times[i - 1] || sequences[i] <= sequences[i - 1]) return false;
+    }
+    return true;
+  }
+};
+
+/**
+ * @class HistoryCheck
+ * @brief Runs the history scenarios and prints the results
+ */
+class HistoryCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  HistoryCheck() : results("HISTORY") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    // Too large for the stack; one log and one answer buffer for every
+    // scenario, only linked into BENCHMARK_MODE builds
+    static HistoryLog log;
+    static uint8_t body[HISTORY_CHECK_BUFFER];
+    checkAverage(log);
+    checkStepBack(log);
+    
+    log.reset();
+    fillDay(log);
+    checkDownsample(log);
+    checkSince(log);
+    checkWindow(log);
+    checkJson(log, body);
+    checkBinary(log, body);
+    checkQueryNumbers();
+    
+    return results.end();
+  }
+
+private:
+  static SensorData reading(float tempIndoor) {
+    SensorData data;
+    data.tempIndoor = tempIndoor;
+    data.tempOutdoor = 8.5f;
+    data.humidityIndoor = 45.0f;
+    data.humidityOutdoor = 70.0f;
+    data.pressure = 1013.25f;
+    data.airQuality = 420;
+    data.isValid = true;
+    return data;
+  }
+  
+  /**
+   * @brief One reading per slot: a slow wave, and a spike in one slot
+   */
+  static void fillDay(HistoryLog& log) {
+    for (uint32_t i = 0; i <= HISTORY_CHECK_SLOTS; i++) {
+      float temp = 20.0f + 3.0f * sin(i * 0.05f);
+      if (i == HISTORY_CHECK_SPIKE) temp = 35.0f;
+      log.add(reading(temp), HISTORY_CHECK_START + i * HISTORY_INTERVAL);
+    }
+  }
+  
+  /**
+   * @brief Time of a record of the synthetic day, from its sequence number
+   */
+  static uint32_t slotTime(uint32_t sequence) {
+    return HISTORY_CHECK_START + (sequence - 1) * HISTORY_INTERVAL;
+  }
+  
+  /**
+   * @brief Readings of a slot are averaged into one record
+   */
+  void checkAverage(HistoryLog& log) {
+    log.reset();
+    uint32_t slotStart = (HISTORY_CHECK_START / HISTORY_INTERVAL + 1) * HISTORY_INTERVAL;
+    for (uint8_t i = 0; i < 6; i++) {
+      log.add(reading(20.0f + i * 0.1f), slotStart + i * (SENSOR_READ_INTERVAL / 1000));
+    }
+    SensorData invalid = reading(99.0f);
+    invalid.isValid = false;
+    log.add(invalid, slotStart + 5);
+    log.add(reading(99.0f), 0);
+    bool pending = log.getCount() == 0;  // Slot still open
+    
+    log.add(reading(25.0f), slotStart + HISTORY_INTERVAL);
+    const HistoryRecord& record = log.records[0];
+    
+    // 20.0 to 20.5: mean 20.25, rounded half away from zero to 20.3
+    bool ok = pending && log.getCount() == 1 && log.getLastSequence() == 1 &&
+              record.time == slotStart && record.values[HISTORY_TEMP_INDOOR] == 203 &&
+              record.values[HISTORY_PRESSURE] == 10133 && record.values[HISTORY_AIR_QUALITY] == 420;
+    report("history.average", 6, 1, 0, ok);
+  }
+  
+  /**
+   * @brief Record times keep increasing when the clock steps back
+   * 
+   * Two slots back (an NTP correction), the open slot is dropped and the
+   * log resumes after its newest record; a day back, the records stamped
+   * ahead are dropped and the sequence numbers go on.
+   */
+  void checkStepBack(HistoryLog& log) {
+    log.reset();
+    for (uint32_t i = 0; i < 10; i++) {
+      log.add(reading(20.0f), HISTORY_CHECK_START + i * HISTORY_INTERVAL);
+    }
+    log.add(reading(30.0f), HISTORY_CHECK_START + 7 * HISTORY_INTERVAL);
+    for (uint32_t i = 8; i <= 12; i++) {
+      log.add(reading(21.0f), HISTORY_CHECK_START + i * HISTORY_INTERVAL + 30);
+    }
+    
+    // Slots 0 to 11 stored, slot 9 only from the readings after the step
+    bool ordered = true;
+    for (uint16_t i = 1; i < log.getCount(); i++) {
+      if (log.getRecord(i).time <= log.getRecord(i - 1).time) ordered = false;
+    }
+    uint16_t matched = log.getCount();
+    bool ok = ordered && matched == 12 && log.getLastSequence() == 12 &&
+              log.getRecord(9).time == HISTORY_CHECK_START + 9 * HISTORY_INTERVAL &&
+              log.getRecord(9).values[HISTORY_TEMP_INDOOR] == 210;
+    
+    uint32_t dayBack = HISTORY_CHECK_START - 86400UL;
+    log.add(reading(22.0f), dayBack);
+    log.add(reading(22.0f), dayBack + HISTORY_INTERVAL);
+    HistoryRange range = log.select(0, 0xFFFFFFFFUL, 0);
+    ok = ok && log.getCount() == 1 && log.getFirstSequence() == 13 && log.getLastSequence() == 13 &&
+         range.first == 0 && range.count == 1 && log.getRecord(0).time == dayBack;
+    report("history.stepBack", matched, log.getCount(), 0, ok);
+  }
+  
+  /**
+   * @brief The whole log reduced to HISTORY_CHECK_POINTS with LTTB
+   */
+  void checkDownsample(const HistoryLog& log) {
+    CollectSink sink(HISTORY_TEMP_INDOOR);
+    unsigned long t = micros();
+    HistoryRange range = log.select(0, 0xFFFFFFFFUL, 0);
+    uint16_t points = log.downsample(range, HISTORY_TEMP_INDOOR, HISTORY_CHECK_POINTS, sink);
+    unsigned long elapsed = micros() - t;
+    
+    bool spike = false;
+    for (uint16_t i = 0; i < sink.count; i++) {
+      if (sink.values[i] == 350) spike = true;
+    }
+    uint32_t oldest = log.getLastSequence() - log.getCount() + 1;
+    bool ok = range.count == HISTORY_SIZE && points == HISTORY_CHECK_POINTS &&
+              sink.count == HISTORY_CHECK_POINTS && !sink.overflow && sink.isOrdered() &&
+              sink.sequences[0] == oldest && sink.sequences[sink.count - 1] == log.getLastSequence() &&
+              sink.times[0] == slotTime(oldest) && spike;
+    report("history.lttb", range.count, points, elapsed, ok);
+  }
+  
+  /**
+   * @brief Only the records after the last sequence number received
+   */
+  void checkSince(const HistoryLog& log) {
+    CollectSink sink(HISTORY_TEMP_INDOOR);
+    uint32_t since = log.getLastSequence() - 10;
+    unsigned long t = micros();
+    HistoryRange range = log.select(0, 0xFFFFFFFFUL, since);
+    uint16_t points = log.downsample(range, HISTORY_TEMP_INDOOR, HISTORY_CHECK_POINTS, sink);
+    unsigned long elapsed = micros() - t;
+    
+    // Nothing new: an empty answer, still with the last sequence number
+    HistoryRange none = log.select(0, 0xFFFFFFFFUL, log.getLastSequence());
+    
+    bool ok = range.count == 10 && points == 10 && sink.isOrdered() &&
+              sink.sequences[0] == since + 1 && sink.sequences[9] == log.getLastSequence() &&
+              none.count == 0 && none.lastSequence == log.getLastSequence();
+    report("history.since", range.count, points, elapsed, ok);
+  }
+  
+  /**
+   * @brief A time window inside the log, bounds included
+   */
+  void checkWindow(const HistoryLog& log) {
+    CollectSink sink(HISTORY_TEMP_INDOOR);
+    uint32_t oldest = log.getLastSequence() - log.getCount() + 1;
+    uint32_t from = slotTime(oldest + 100);
+    uint32_t to = slotTime(oldest + 139);
+    unsigned long t = micros();
+    HistoryRange range = log.select(from, to, 0);
+    uint16_t points = log.downsample(range, HISTORY_TEMP_INDOOR, HISTORY_CHECK_POINTS, sink);
+    unsigned long elapsed = micros() - t;
+    
+    bool ok = range.count == 40 && points == 40 && sink.isOrdered() &&
+              sink.times[0] == from && sink.times[points - 1] == to;
+    report("history.window", range.count, points, elapsed, ok);
+  }
+  
+  /**
+   * @brief The body /api/history streams, plain and through LZSS
+   */
+  void checkJson(const HistoryLog& log, uint8_t (&text)[HISTORY_CHECK_BUFFER]) {
+    HistoryRange range = log.select(0, 0xFFFFFFFFUL, 0);
+    
+    unsigned long t = micros();
+    BoundedPrint out(text, sizeof(text));
+    uint16_t points = NetworkManager::writeHistoryJson(out, log, range, HISTORY_TEMP_INDOOR,
+                                                       HISTORY_CHECK_POINTS);
+    unsigned long elapsed = micros() - t;
+    size_t length = out.length();
+    
+    uint16_t pairs = 0;
+    for (size_t i = 0; i < length; i++) {
+      if (text[i] == '[') pairs++;
+    }
+    static const char head[] = "{\"field\":\"tempIndoor\",\"last\":";
+    bool ok = length > 0 && memcmp(text, head, sizeof(head) - 1) == 0 &&
+              text[length - 2] == ']' && text[length - 1] == '}' && pairs == points + 1;
+    
+    // Compressed answer decodes to the same bytes
+    ChecksumPrint plain;
+    plain.write(text, length);
+    ChecksumPrint decoded;
+    LzssDecoder decoder(decoded);
+    LzssEncoder encoder(decoder);
+    NetworkManager::writeHistoryJson(encoder, log, range, HISTORY_TEMP_INDOOR, HISTORY_CHECK_POINTS);
+    encoder.finish();
+    ok = ok && decoded.hash == plain.hash && decoded.count == plain.count;
+    
+    report("history.json", range.count, points, elapsed, ok);
+  }
+  
+  /**
+   * @brief The columns of ?format=bin hold the points of the same query
+   */
+  void checkBinary(const HistoryLog& log, uint8_t (&bytes)[HISTORY_CHECK_BUFFER]) {
+    HistoryRange range = log.select(0, 0xFFFFFFFFUL, 0);
+    CollectSink sink(HISTORY_TEMP_INDOOR);
+    log.downsample(range, HISTORY_TEMP_INDOOR, HISTORY_CHECK_POINTS, sink);
+    
+    unsigned long t = micros();
+    BoundedPrint out(bytes, sizeof(bytes));
+    uint16_t points = NetworkManager::writeHistoryBinary(out, log, range, HISTORY_TEMP_INDOOR,
+                                                         HISTORY_CHECK_POINTS);
+    unsigned long elapsed = micros() - t;
+    
+    const uint8_t* times = bytes + HISTORY_BINARY_HEADER;
+    const uint8_t* temps = times + points * 4;
+    const uint8_t* pressures = temps + HISTORY_PRESSURE * points * 2;
+    bool ok = out.length() == NetworkManager::historyBinarySize(points) &&
+              points == HISTORY_CHECK_POINTS && bytes[0] == HISTORY_BINARY_MAGIC &&
+              bytes[1] == HISTORY_BINARY_VERSION && bytes[2] == HISTORY_TEMP_INDOOR &&
+              bytes[3] == HISTORY_FIELD_COUNT && readLe(bytes + 4, 4) == log.getLastSequence() &&
+              readLe(bytes + 8, 2) == range.count && readLe(bytes + 10, 2) == points;
+    for (uint16_t i = 0; ok && i < points; i++) {
+      ok = readLe(times + i * 4, 4) == sink.times[i] &&
+           (int16_t)readLe(temps + i * 2, 2) == sink.values[i] &&
+           readLe(pressures + i * 2, 2) == 10133;
+    }
+    
+    // Every record of the day, as a graph zoomed out asks for
+    ChecksumPrint whole;
+    uint16_t all = NetworkManager::writeHistoryBinary(whole, log, range, HISTORY_TEMP_INDOOR,
+                                                      HISTORY_MAX_POINTS);
+    ok = ok && all == HISTORY_SIZE && whole.count == NetworkManager::historyBinarySize(all);
+    
+    report("history.binary", range.count, points, elapsed, ok);
+  }
+  
+  /**
+   * @brief Query numbers up to 4294967295 are read, larger ones refused
+   */
+  void checkQueryNumbers() {
+    static const struct {
+      const char* query;
+      bool accepted;
+      uint32_t value;
+    } CASES[] = {
+      { "since=0", true, 0 },
+      { "points=100&since=4294967295", true, 4294967295UL },
+      { "since=4294967296", false, 0 },
+      { "since=4294967299", false, 0 },  // 429496729 * 10 + 9 wraps
+      { "since=99999999999", false, 0 },
+      { "since=12a", false, 0 },
+      { "points=100", true, 7 }          // Absent: left unchanged
+    };
+    uint16_t passed = 0;
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+      uint32_t value = 7;
+      bool accepted = NetworkManager::queryUnsigned(CASES[i].query, "since", value);
+      if (accepted == CASES[i].accepted && (!accepted || value == CASES[i].value)) passed++;
+    }
+    uint16_t cases = sizeof(CASES) / sizeof(CASES[0]);
+    report("history.queryNumbers", cases, passed, 0, passed == cases);
+  }
+  
+  static uint32_t readLe(const uint8_t* bytes, uint8_t size) {
+    uint32_t value = 0;
+    for (uint8_t i = size; i > 0; i--) {
+      value = (value << 8) | bytes[i - 1];
+    }
+    return value;
+  }
+  
+  void report(const char* name, uint16_t matched, uint16_t points, unsigned long elapsed, bool ok) {
+    results.start(name);
+    results.field("matched", matched);
+    results.field("points", points);
+    results.field("us", elapsed);
+    results.finish(ok);
+  }
+};
+
+#endif // HISTORY_CHECK_H
@@ -0,0 +1,423 @@
+/**
+ * @file HistoryLog.h
+ * @brief On-device sensor history and its downsampled queries
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Readings are averaged over HISTORY_INTERVAL slots and kept in a ring of
+ * HISTORY_SIZE fixed-point records (16 bytes each), about a day at the
+ * default settings. Every record gets a sequence number, so a client can
+ * ask only for what it has not seen yet.
+ * 
+ * A query selects records by time and sequence number (a contiguous run
+ * of the ring: times only increase), then reduces them to at most N
+ * points with largest-triangle-three-buckets (Steinarsson, 2013): the
+ * first and last records are kept, the others are split into N - 2
+ * buckets and each bucket keeps the record forming the largest triangle
+ * with the point kept before it and the average of the next bucket. This
+ * keeps the peaks and the shape of a curve where plain decimation would
+ * skip them. The pass needs no memory beyond a few running values and
+ * hands the points to a HistorySink as they are chosen, so they can be
+ * written straight to the client.
+ * 
+ * The binary form of /api/history copies the times and values as they
+ * are stored here, which is only the little-endian layout the browser
+ * expects on a little-endian MCU (the UNO R4's Cortex-M4 is one).
+ */
+
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include "config.h"
+#include "SensorSource.h"
+
+/**
+ * @brief Series that can be queried
+ */
+enum HistoryField {
+  HISTORY_TEMP_INDOOR = 0,
+  HISTORY_TEMP_OUTDOOR,
+  HISTORY_HUMIDITY_INDOOR,
+  HISTORY_HUMIDITY_OUTDOOR,
+  HISTORY_PRESSURE,
+  HISTORY_AIR_QUALITY,
+  HISTORY_FIELD_COUNT
+};
+
+/**
+ * @struct HistoryRecord
+ * @brief One averaged slot, fixed-point like the CBOR telemetry
+ */
+struct HistoryRecord {
+  uint32_t time;            ///< UTC epoch of the start of the slot
+  int16_t values[HISTORY_FIELD_COUNT];  ///< x10, pressure in hPa x10, air quality in ppm
+};
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "HistoryRecord is sent as stored: the binary history format needs a little-endian MCU"
+#endif
+
+// Binary history (GET API_HISTORY_ENDPOINT?format=bin), little-endian:
+// 'H', version, field, column count, uint32 last sequence, uint16 matched,
+// uint16 points, then a uint32 time column and one int16 column per field
+#define HISTORY_BINARY_MAGIC    'H'
+#define HISTORY_BINARY_VERSION  1
+#define HISTORY_BINARY_HEADER   12    // Keeps the columns aligned for typed arrays
+
+/**
+ * @class HistorySink
+ * @brief Receives the points chosen by a query, oldest first
+ */
+class HistorySink {
+public:
+  virtual ~HistorySink() {}
+  
+  /**
+   * @param record Record kept
+   * @param sequence Its sequence number
+   */
+  virtual void point(const HistoryRecord& record, uint32_t sequence) = 0;
+};
+
+/**
+ * @struct HistoryRange
+ * @brief Records matched by a query, before downsampling
+ */
+struct HistoryRange {
+  uint16_t first;           ///< Index from the oldest record kept
+  uint16_t count;
+  uint32_t lastSequence;    ///< Newest record in the log, 0 if none
+};
+
+/**
+ * @class HistoryLog
+ * @brief Ring of averaged records
+ */
+class HistoryLog {
+  friend class HistoryCheck;
+
+private:
+  HistoryRecord records[HISTORY_SIZE];
+  uint16_t start;           ///< Ring index of the oldest record
+  uint16_t count;
+  uint32_t total;           ///< Records stored since boot (last sequence number)
+  
+  // Slot being averaged
+  uint32_t pendingSlot;
+  int32_t sums[HISTORY_FIELD_COUNT];
+  uint16_t pendingCount;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  HistoryLog() :
+    start(0),
+    count(0),
+    total(0),
+    pendingSlot(0),
+    pendingCount(0) {
+    memset(sums, 0, sizeof(sums));
+  }
+  
+  /**
+   * @brief Drop every record and the slot being averaged
+   * 
+   * Sequence numbers start again from 1.
+   */
+  void reset() {
+    start = 0;
+    count = 0;
+    total = 0;
+    clearPending();
+  }
+  
+  /**
+   * @brief Add a reading to the average of its slot
+   * 
+   * The slot is stored once a reading from a later slot arrives. Record
+   * times only increase, as select() and downsample() expect, even when
+   * the clock steps back (e.g. the first NTP sync after an RTC that ran
+   * fast): a slot the clock stepped back from is dropped, and readings
+   * are ignored until they are past the newest record. If that record is
+   * more than HISTORY_MAX_STEP_BACK ahead, the records were stamped with
+   * a wrong time and are dropped instead; sequence numbers go on.
+   * 
+   * @param data Readings, ignored if not valid
+   * @param time UTC epoch, ignored if 0 (clock not set)
+   */
+  void add(const SensorData& data, uint32_t time) {
+    if (time == 0 || !data.isValid) {
+      return;
+    }
+    uint32_t slot = time / HISTORY_INTERVAL;
+    if (pendingCount > 0 && slot < pendingSlot) {
+      clearPending();
+    }
+    if (count > 0) {
+      uint32_t newest = at(count - 1).time;
+      uint32_t slotTime = slot * HISTORY_INTERVAL;
+      if (slotTime <= newest) {
+        if (newest - slotTime <= HISTORY_MAX_STEP_BACK) {
+          return;
+        }
+        start = 0;
+        count = 0;
+      }
+    }
+    if (pendingCount > 0 && slot != pendingSlot) {
+      flush();
+    }
+    pendingSlot = slot;
+    sums[HISTORY_TEMP_INDOOR] += toFixed(data.tempIndoor, 10);
+    sums[HISTORY_TEMP_OUTDOOR] += toFixed(data.tempOutdoor, 10);
+    sums[HISTORY_HUMIDITY_INDOOR] += toFixed(data.humidityIndoor, 10);
+    sums[HISTORY_HUMIDITY_OUTDOOR] += toFixed(data.humidityOutdoor, 10);
+    sums[HISTORY_PRESSURE] += toFixed(data.pressure, 10);
+    sums[HISTORY_AIR_QUALITY] += data.airQuality;
+    pendingCount++;
+  }
+  
+  /**
+   * @brief Sequence number of the newest record, 0 if none
+   */
+  uint32_t getLastSequence() const {
+    return total;
+  }
+  
+  uint16_t getCount() const {
+    return count;
+  }
+  
+  /**
+   * @brief Record by index from the oldest kept, as in HistoryRange
+   */
+  const HistoryRecord& getRecord(uint16_t index) const {
+    return at(index);
+  }
+  
+  /**
+   * @brief Sequence number of the oldest record kept
+   */
+  uint32_t getFirstSequence() const {
+    return total - count + 1;
+  }
+  
+  /**
+   * @brief Number of points downsample() passes on for this range
+   */
+  static uint16_t keptCount(const HistoryRange& range, uint16_t maxPoints) {
+    if (range.count <= maxPoints) return range.count;
+    return maxPoints < 3 ? 0 : maxPoints;
+  }
+  
+  /**
+   * @brief Records with from <= time <= to and a sequence above since
+   */
+  HistoryRange select(uint32_t from, uint32_t to, uint32_t since) const {
+    HistoryRange range;
+    range.lastSequence = total;
+    
+    uint32_t oldestSequence = getFirstSequence();
+    uint16_t first = lowerBound(from);
+    if (since >= oldestSequence) {
+      uint32_t afterSince = since - oldestSequence + 1;
+      if (afterSince > first) first = afterSince > count ? count : afterSince;
+    }
+    uint16_t end = to == 0xFFFFFFFFUL ? count : lowerBound(to + 1);
+    
+    range.first = first;
+    range.count = end > first ? end - first : 0;
+    return range;
+  }
+  
+  /**
+   * @brief Pass at most maxPoints records of a range to the sink (LTTB)
+   * 
+   * @param range Records from select()
+   * @param field Series the triangles are measured on
+   * @param maxPoints Points to keep, at least 3
+   * @param sink Receives the kept records, oldest first
+   * @return Number of points passed to the sink
+   */
+  uint16_t downsample(const HistoryRange& range, HistoryField field, uint16_t maxPoints,
+                      HistorySink& sink) const {
+    if (range.count <= maxPoints || maxPoints < 3) {
+      uint16_t kept = keptCount(range, maxPoints);
+      for (uint16_t i = 0; i < kept; i++) {
+        emit(range.first + i, sink);
+      }
+      return kept;
+    }
+    
+    // Times relative to the first record keep float precision
+    uint32_t origin = at(range.first).time;
+    uint16_t last = range.first + range.count - 1;
+    uint16_t buckets = maxPoints - 2;
+    
+    uint16_t kept = range.first;
+    emit(kept, sink);
+    
+    for (uint16_t b = 0; b < buckets; b++) {
+      uint16_t bucketStart = bucketBoundary(range, buckets, b);
+      uint16_t bucketEnd = bucketBoundary(range, buckets, b + 1);
+      
+      // Third vertex: average of the next bucket, or the last record
+      uint16_t nextEnd = b + 1 < buckets ? bucketBoundary(range, buckets, b + 2) : last + 1;
+      float avgX = 0;
+      float avgY = 0;
+      for (uint16_t i = bucketEnd; i < nextEnd; i++) {
+        avgX += at(i).time - origin;
+        avgY += at(i).values[field];
+      }
+      uint16_t nextCount = nextEnd - bucketEnd;
+      avgX /= nextCount;
+      avgY /= nextCount;
+      
+      float keptX = at(kept).time - origin;
+      float keptY = at(kept).values[field];
+      float bestArea = -1;
+      uint16_t best = bucketStart;
+      for (uint16_t i = bucketStart; i < bucketEnd; i++) {
+        float x = at(i).time - origin;
+        float y = at(i).values[field];
+        float area = (keptX - avgX) * (y - keptY) - (keptX - x) * (avgY - keptY);
+        if (area < 0) area = -area;
+        if (area > bestArea) {
+          bestArea = area;
+          best = i;
+        }
+      }
+      kept = best;
+      emit(kept, sink);
+    }
+    
+    emit(last, sink);
+    return maxPoints;
+  }
+  
+  /**
+   * @brief Name of a series, as in the /api/data JSON
+   */
+  static const char* fieldName(HistoryField field) {
+    static const char* const names[HISTORY_FIELD_COUNT] = {
+      "tempIndoor", "tempOutdoor", "humidityIndoor", "humidityOutdoor", "pressure", "airQuality"
+    };
+    return field < HISTORY_FIELD_COUNT ? names[field] : "";
+  }
+  
+  /**
+   * @brief Look up a series by its /api/data name
+   * 
+   * @return The field, or HISTORY_FIELD_COUNT if unknown
+   */
+  static HistoryField fieldFromName(const char* name) {
+    for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) {
+      if (strcmp(name, fieldName((HistoryField)i)) == 0) return (HistoryField)i;
+    }
+    return HISTORY_FIELD_COUNT;
+  }
+
+private:
+  const HistoryRecord& at(uint16_t index) const {
+    return records[(start + index) % HISTORY_SIZE];
+  }
+  
+  /**
+   * @brief Start of bucket b; the records between the first and the last
+   * are split as evenly as integers allow
+   */
+  static uint16_t bucketBoundary(const HistoryRange& range, uint16_t buckets, uint16_t b) {
+    return range.first + 1 + (uint16_t)((uint32_t)b * (range.count - 2) / buckets);
+  }
+  
+  void emit(uint16_t index, HistorySink& sink) const {
+    sink.point(at(index), getFirstSequence() + index);
+  }
+  
+  /**
+   * @brief Index of the first record at or after time
+   */
+  uint16_t lowerBound(uint32_t time) const {
+    uint16_t low = 0;
+    uint16_t high = count;
+    while (low < high) {
+      uint16_t mid = (low + high) / 2;
+      if (at(mid).time < time) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+  
+  void clearPending() {
+    pendingSlot = 0;
+    pendingCount = 0;
+    memset(sums, 0, sizeof(sums));
+  }
+  
+  /**
+   * @brief Store the slot average, overwriting the oldest record if full
+   * 
+   * add() makes sure the slot is after the newest record.
+   */
+  void flush() {
+    HistoryRecord& record = records[(start + count) % HISTORY_SIZE];
+    record.time = pendingSlot * HISTORY_INTERVAL;
+    for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) {
+      int32_t half = (sums[i] < 0 ? -pendingCount : pendingCount) / 2;
+      record.values[i] = (int16_t)((sums[i] + half) / pendingCount);
+      sums[i] = 0;
+    }
+    pendingCount = 0;
+    
+    if (count < HISTORY_SIZE) {
+      count++;
+    } else {
+      start = (start + 1) % HISTORY_SIZE;
+    }
+    total++;
+  }
+  
+  static int32_t toFixed(float value, int32_t scale) {
+    return (int32_t)(value * scale + (value < 0 ? -0.5f : 0.5f));
+  }
+};
+
+/**
+ * @class HistorySelection
+ * @brief Remembers which records of a range a query kept, one bit each
+ * 
+ * For writers that need the points more than once, e.g. column by
+ * column, without copying them: downsample() into it, then walk the
+ * range and skip the records not kept.
+ */
+class HistorySelection : public HistorySink {
+private:
+  uint8_t kept[(HISTORY_SIZE + 7) / 8];
+  uint32_t firstSequence;   ///< Sequence number of the first record of the range
+
+public:
+  HistorySelection(const HistoryLog& log, const HistoryRange& range) :
+    firstSequence(log.getFirstSequence() + range.first) {
+    memset(kept, 0, sizeof(kept));
+  }
+  
+  void point(const HistoryRecord& record, uint32_t sequence) override {
+    (void)record;
+    uint16_t index = sequence - firstSequence;
+    kept[index / 8] |= 1 << (index % 8);
+  }
+  
+  /**
+   * @param index Index from the first record of the range
+   */
+  bool isKept(uint16_t index) const {
+    return kept[index / 8] & (1 << (index % 8));
+  }
+};
+
+#endif // HISTORY_LOG_H
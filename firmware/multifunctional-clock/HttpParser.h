@@ -0,0 +1,416 @@
+/**
+ * @file HttpParser.h
+ * @brief Incremental HTTP/1.x request parser
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Bytes are fed as they arrive from the socket, one at a time or in
+ * chunks, so a request can be parsed across several loop() iterations.
+ * Every field is stored in a fixed-size buffer and every input size is
+ * bounded, so the parser never allocates and rejects oversized input
+ * instead of growing.
+ */
+
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include "config.h"
+
+/**
+ * @brief Request methods understood by the web server
+ */
+enum HttpMethod {
+  HTTP_METHOD_UNKNOWN = 0,
+  HTTP_METHOD_GET,
+  HTTP_METHOD_POST
+};
+
+/**
+ * @brief Overall parse result after feeding bytes
+ */
+enum HttpParseResult {
+  HTTP_PARSE_INCOMPLETE = 0,  ///< More bytes needed
+  HTTP_PARSE_COMPLETE,        ///< Request line, headers and body received
+  HTTP_PARSE_ERROR            ///< Malformed or oversized request
+};
+
+/**
+ * @class HttpRequestParser
+ * @brief Bounded, allocation-free state machine for one HTTP request
+ */
+class HttpRequestParser {
+private:
+  enum State {
+    STATE_METHOD,
+    STATE_PATH,
+    STATE_QUERY,
+    STATE_VERSION,
+    STATE_REQUEST_LINE_LF,
+    STATE_HEADER_START,
+    STATE_HEADER_NAME,
+    STATE_HEADER_VALUE_START,
+    STATE_HEADER_VALUE,
+    STATE_HEADER_LF,
+    STATE_HEADERS_END_LF,
+    STATE_BODY,
+    STATE_COMPLETE,
+    STATE_ERROR
+  };
+  
+  enum Header {
+    HEADER_OTHER,
+    HEADER_CONTENT_LENGTH,
+    HEADER_IF_NONE_MATCH
+  };
+  
+  State state;
+  Header currentHeader;
+  HttpMethod method;
+  
+  char token[HTTP_MAX_TOKEN + 1];
+  uint8_t tokenLength;
+  
+  char path[HTTP_MAX_PATH + 1];
+  uint8_t pathLength;
+  char query[HTTP_MAX_QUERY + 1];
+  uint8_t queryLength;
+  char body[HTTP_MAX_BODY + 1];
+  uint16_t bodyLength;
+  char etags[HTTP_MAX_ETAGS + 1];  ///< If-None-Match, without spaces
+  uint8_t etagsLength;
+  bool etagsTruncated;
+  
+  uint32_t contentLength;
+  uint16_t headerBytes;
+  uint16_t errorStatus;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  HttpRequestParser() {
+    reset();
+  }
+  
+  /**
+   * @brief Prepare for a new request
+   */
+  void reset() {
+    state = STATE_METHOD;
+    currentHeader = HEADER_OTHER;
+    method = HTTP_METHOD_UNKNOWN;
+    tokenLength = 0;
+    pathLength = 0;
+    queryLength = 0;
+    bodyLength = 0;
+    etagsLength = 0;
+    etagsTruncated = false;
+    contentLength = 0;
+    headerBytes = 0;
+    errorStatus = 0;
+    token[0] = '\0';
+    path[0] = '\0';
+    query[0] = '\0';
+    body[0] = '\0';
+    etags[0] = '\0';
+  }
+  
+  /**
+   * @brief Feed a chunk of received bytes
+   * 
+   * Bytes after a complete request are ignored.
+   * 
+   * @param data Received bytes
+   * @param length Number of bytes
+   * @return Parse result after consuming the chunk
+   */
+  HttpParseResult feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length && state != STATE_COMPLETE && state != STATE_ERROR; i++) {
+      feed((char)data[i]);
+    }
+    return getResult();
+  }
+  
+  /**
+   * @brief Feed one received byte
+   * 
+   * @param c Received byte
+   * @return Parse result after consuming the byte
+   */
+  HttpParseResult feed(char c) {
+    if (state == STATE_COMPLETE || state == STATE_ERROR) {
+      return getResult();
+    }
+    
+    if (state != STATE_BODY && ++headerBytes > HTTP_MAX_HEADER_BYTES) {
+      return fail(431);
+    }
+    
+    switch (state) {
+      case STATE_METHOD:
+        if (c == ' ') {
+          method = parseMethod();
+          state = STATE_PATH;
+        } else if (!appendToken(c)) {
+          return fail(501);
+        }
+        break;
+      
+      case STATE_PATH:
+        if (c == ' ') {
+          if (pathLength == 0 || path[0] != '/') return fail(400);
+          tokenLength = 0;
+          state = STATE_VERSION;
+        } else if (c == '?') {
+          state = STATE_QUERY;
+        } else if (!isPrintable(c) || !append(path, pathLength, HTTP_MAX_PATH, c)) {
+          return fail(414);
+        }
+        break;
+      
+      case STATE_QUERY:
+        if (c == ' ') {
+          state = STATE_VERSION;
+          tokenLength = 0;
+        } else if (!isPrintable(c) || !append(query, queryLength, HTTP_MAX_QUERY, c)) {
+          return fail(414);
+        }
+        break;
+      
+      case STATE_VERSION:
+        if (c == '\r') {
+          state = STATE_REQUEST_LINE_LF;
+        } else if (c == '\n') {
+          if (!checkVersion()) return fail(505);
+          state = STATE_HEADER_START;
+        } else if (!appendToken(c)) {
+          return fail(400);
+        }
+        break;
+      
+      case STATE_REQUEST_LINE_LF:
+        if (c != '\n' || !checkVersion()) return fail(c != '\n' ? 400 : 505);
+        state = STATE_HEADER_START;
+        break;
+      
+      case STATE_HEADER_START:
+        if (c == '\r') {
+          state = STATE_HEADERS_END_LF;
+        } else if (c == '\n') {
+          endHeaders();
+        } else {
+          tokenLength = 0;
+          currentHeader = HEADER_OTHER;
+          state = STATE_HEADER_NAME;
+          if (!appendHeaderName(c)) return fail(400);
+        }
+        break;
+      
+      case STATE_HEADER_NAME:
+        if (c == ':') {
+          currentHeader = identifyHeader();
+          tokenLength = 0;
+          state = STATE_HEADER_VALUE_START;
+        } else if (!appendHeaderName(c)) {
+          return fail(400);
+        }
+        break;
+      
+      case STATE_HEADER_VALUE_START:
+        if (c == ' ' || c == '\t') break;
+        state = STATE_HEADER_VALUE;
+        // fall through
+      
+      case STATE_HEADER_VALUE:
+        if (c == '\r') {
+          state = STATE_HEADER_LF;
+        } else if (c == '\n') {
+          if (!storeHeaderValue()) return fail(400);
+          state = STATE_HEADER_START;
+        } else if (currentHeader == HEADER_IF_NONE_MATCH) {
+          appendETag(c);
+        } else if (currentHeader != HEADER_OTHER && c != ' ' && c != '\t' && !appendToken(c)) {
+          return fail(400);
+        }
+        break;
+      
+      case STATE_HEADER_LF:
+        if (c != '\n' || !storeHeaderValue()) return fail(400);
+        state = STATE_HEADER_START;
+        break;
+      
+      case STATE_HEADERS_END_LF:
+        if (c != '\n') return fail(400);
+        endHeaders();
+        break;
+      
+      case STATE_BODY:
+        body[bodyLength++] = c;
+        body[bodyLength] = '\0';
+        if (bodyLength >= contentLength) {
+          state = STATE_COMPLETE;
+        }
+        break;
+      
+      default:
+        break;
+    }
+    
+    return getResult();
+  }
+  
+  /**
+   * @brief Get the current parse result
+   */
+  HttpParseResult getResult() const {
+    if (state == STATE_COMPLETE) return HTTP_PARSE_COMPLETE;
+    if (state == STATE_ERROR) return HTTP_PARSE_ERROR;
+    return HTTP_PARSE_INCOMPLETE;
+  }
+  
+  /**
+   * @brief HTTP status to answer a failed parse with (400, 413, 414...)
+   */
+  uint16_t getErrorStatus() const {
+    return errorStatus;
+  }
+  
+  HttpMethod getMethod() const { return method; }
+  const char* getPath() const { return path; }
+  const char* getQuery() const { return query; }
+  const char* getBody() const { return body; }
+  uint16_t getBodyLength() const { return bodyLength; }
+  
+  /**
+   * @brief Check whether the path matches exactly
+   */
+  bool pathEquals(const char* expected) const {
+    return strcmp(path, expected) == 0;
+  }
+  
+  /**
+   * @brief Check a conditional GET against the current ETag
+   * 
+   * Weak comparison, as If-None-Match requires: a W/ prefix is ignored,
+   * and "*" matches anything. A list too long to keep never matches, so
+   * the full response is sent.
+   * 
+   * @param etag Current ETag, with its quotes
+   * @return true if the client's copy is current (answer 304)
+   */
+  bool ifNoneMatch(const char* etag) const {
+    if (etagsTruncated || etagsLength == 0) return false;
+    if (strcmp(etags, "*") == 0) return true;
+    
+    size_t length = strlen(etag);
+    const char* item = etags;
+    while (*item) {
+      const char* end = strchr(item, ',');
+      size_t itemLength = end ? (size_t)(end - item) : strlen(item);
+      if (itemLength > 2 && item[0] == 'W' && item[1] == '/') {
+        item += 2;
+        itemLength -= 2;
+      }
+      if (itemLength == length && strncmp(item, etag, length) == 0) {
+        return true;
+      }
+      if (!end) break;
+      item = end + 1;
+    }
+    return false;
+  }
+
+private:
+  HttpParseResult fail(uint16_t status) {
+    errorStatus = status;
+    state = STATE_ERROR;
+    return HTTP_PARSE_ERROR;
+  }
+  
+  static bool isPrintable(char c) {
+    return c > ' ' && c < 0x7F;
+  }
+  
+  static bool append(char* buffer, uint8_t& length, uint8_t max, char c) {
+    if (length >= max) return false;
+    buffer[length++] = c;
+    buffer[length] = '\0';
+    return true;
+  }
+  
+  bool appendToken(char c) {
+    return isPrintable(c) && append(token, tokenLength, HTTP_MAX_TOKEN, c);
+  }
+  
+  /**
+   * @brief Header names are matched case-insensitively, longer ones are
+   * truncated since only short names are of interest
+   */
+  bool appendHeaderName(char c) {
+    if (!isPrintable(c)) return false;
+    if (tokenLength < HTTP_MAX_TOKEN) {
+      token[tokenLength++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+      token[tokenLength] = '\0';
+    }
+    return true;
+  }
+  
+  HttpMethod parseMethod() const {
+    if (strcmp(token, "GET") == 0) return HTTP_METHOD_GET;
+    if (strcmp(token, "POST") == 0) return HTTP_METHOD_POST;
+    return HTTP_METHOD_UNKNOWN;
+  }
+  
+  bool checkVersion() const {
+    return strcmp(token, "HTTP/1.1") == 0 || strcmp(token, "HTTP/1.0") == 0;
+  }
+  
+  Header identifyHeader() {
+    if (strcmp(token, "content-length") == 0) return HEADER_CONTENT_LENGTH;
+    if (strcmp(token, "if-none-match") == 0) {
+      // Repeated header: same as one comma-separated list
+      if (etagsLength > 0) appendETag(',');
+      return HEADER_IF_NONE_MATCH;
+    }
+    return HEADER_OTHER;
+  }
+  
+  /**
+   * @brief Keep If-None-Match without blanks; too long is not an error
+   */
+  void appendETag(char c) {
+    if (!isPrintable(c)) return;
+    if (!append(etags, etagsLength, HTTP_MAX_ETAGS, c)) {
+      etagsTruncated = true;
+    }
+  }
+  
+  bool storeHeaderValue() {
+    if (currentHeader == HEADER_CONTENT_LENGTH) {
+      if (tokenLength == 0) return false;
+      uint32_t value = 0;
+      for (uint8_t i = 0; i < tokenLength; i++) {
+        if (token[i] < '0' || token[i] > '9') return false;
+        // Saturate: anything above HTTP_MAX_BODY is rejected with 413 later
+        if (value <= HTTP_MAX_BODY) {
+          value = value * 10 + (token[i] - '0');
+        }
+      }
+      contentLength = value;
+    }
+    currentHeader = HEADER_OTHER;
+    tokenLength = 0;
+    return true;
+  }
+  
+  void endHeaders() {
+    if (contentLength > HTTP_MAX_BODY) {
+      fail(413);
+    } else {
+      state = (contentLength > 0) ? STATE_BODY : STATE_COMPLETE;
+    }
+  }
+};
+
+#endif // HTTP_PARSER_H
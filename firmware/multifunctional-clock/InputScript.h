@@ -0,0 +1,214 @@
+/**
+ * @file InputScript.h
+ * @brief Scripted button input and button edge recording
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * A ButtonScript is a list of timestamped press/release edges, bounces
+ * included, that UIManager reads instead of the button pins. Replaying a
+ * script drives the real debounce and mode state machine, so UI flows
+ * can be reproduced exactly. ButtonRecorder captures the edges seen on
+ * the real pins in the same format, so a session on the device can be
+ * turned into a script.
+ */
+
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include "config.h"
+
+/**
+ * @struct ButtonEvent
+ * @brief One raw button edge
+ */
+struct ButtonEvent {
+  unsigned long at;  ///< Time of the edge (ms since script start)
+  uint8_t pin;       ///< BUTTON_MODE_PIN or BUTTON_SELECT_PIN
+  bool pressed;      ///< Level after the edge
+};
+
+/**
+ * @class ButtonScript
+ * @brief Replays a sequence of button edges against a time base
+ * 
+ * Events must be sorted by time. Button levels are advanced up to the
+ * time passed to advance(), so the script can be polled at any rate.
+ */
+class ButtonScript {
+private:
+  const ButtonEvent* events;
+  size_t count;
+  size_t next;
+  bool modePressed;
+  bool selectPressed;
+  unsigned long pendingEdge;  ///< Time of the first edge not yet taken
+  bool hasPendingEdge;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param scriptEvents Edges sorted by time
+   * @param eventCount Number of edges
+   */
+  ButtonScript(const ButtonEvent* scriptEvents, size_t eventCount) :
+    events(scriptEvents),
+    count(eventCount) {
+    rewind();
+  }
+  
+  /**
+   * @brief Restart from the first event with both buttons released
+   */
+  void rewind() {
+    next = 0;
+    modePressed = false;
+    selectPressed = false;
+    pendingEdge = 0;
+    hasPendingEdge = false;
+  }
+  
+  /**
+   * @brief Apply every edge up to the given time
+   * 
+   * @param now Time since script start (ms)
+   */
+  void advance(unsigned long now) {
+    while (next < count && events[next].at <= now) {
+      if (events[next].pin == BUTTON_MODE_PIN) {
+        modePressed = events[next].pressed;
+      } else if (events[next].pin == BUTTON_SELECT_PIN) {
+        selectPressed = events[next].pressed;
+      }
+      if (!hasPendingEdge) {
+        pendingEdge = events[next].at;
+        hasPendingEdge = true;
+      }
+      next++;
+    }
+  }
+  
+  /**
+   * @brief Get the scripted level of a button
+   * 
+   * @param pin Button pin
+   * @return true if the button is held down
+   */
+  bool isPressed(uint8_t pin) const {
+    return pin == BUTTON_MODE_PIN ? modePressed : selectPressed;
+  }
+  
+  /**
+   * @brief Take the time of the first edge applied since the last call
+   * 
+   * Bounces that follow within the same poll are folded into that first
+   * edge, which is when the user actually touched the button.
+   * 
+   * @param at Edge time (ms since script start)
+   * @return false if no edge was applied since the last call
+   */
+  bool takeFirstEdge(unsigned long& at) {
+    if (!hasPendingEdge) {
+      return false;
+    }
+    at = pendingEdge;
+    hasPendingEdge = false;
+    return true;
+  }
+  
+  /**
+   * @brief Check whether every event has been replayed
+   */
+  bool isFinished() const {
+    return next >= count;
+  }
+  
+  /**
+   * @brief Time of the last event in the script
+   */
+  unsigned long getDuration() const {
+    return count > 0 ? events[count - 1].at : 0;
+  }
+};
+
+/**
+ * @class ButtonRecorder
+ * @brief Captures raw button edges into a fixed-size buffer
+ * 
+ * Recording stops silently when the buffer is full. dump() prints the
+ * edges as ButtonEvent initializers ready to paste into a script.
+ */
+class ButtonRecorder {
+private:
+  ButtonEvent events[BUTTON_RECORD_CAPACITY];
+  size_t count;
+  uint64_t start;
+  bool recording;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  ButtonRecorder() : count(0), start(0), recording(false) {}
+  
+  /**
+   * @brief Start a new recording, discarding the previous one
+   * 
+   * @param now Current time (ms), used as the script origin
+   */
+  void begin(uint64_t now) {
+    count = 0;
+    start = now;
+    recording = true;
+  }
+  
+  /**
+   * @brief Stop recording
+   */
+  void end() {
+    recording = false;
+  }
+  
+  /**
+   * @brief Check whether edges are being recorded
+   */
+  bool isRecording() const {
+    return recording;
+  }
+  
+  /**
+   * @brief Record one raw edge
+   */
+  void record(uint64_t now, uint8_t pin, bool pressed) {
+    if (!recording || count >= BUTTON_RECORD_CAPACITY) {
+      return;
+    }
+    events[count].at = now - start;
+    events[count].pin = pin;
+    events[count].pressed = pressed;
+    count++;
+  }
+  
+  /**
+   * @brief Get number of recorded edges
+   */
+  size_t getCount() const {
+    return count;
+  }
+  
+  /**
+   * @brief Print the recording as ButtonEvent initializers
+   */
+  void dump(Print& out) const {
+    for (size_t i = 0; i < count; i++) {
+      out.print("  { ");
+      out.print(events[i].at);
+      out.print(events[i].pin == BUTTON_MODE_PIN ? ", BUTTON_MODE_PIN, " : ", BUTTON_SELECT_PIN, ");
+      out.print(events[i].pressed ? "true" : "false");
+      out.println(" },");
+    }
+  }
+};
+
+#endif // INPUT_SCRIPT_H
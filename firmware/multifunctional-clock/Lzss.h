@@ -0,0 +1,273 @@
+/**
+ * @file Lzss.h
+ * @brief Streaming LZSS compression in a few hundred bytes of RAM
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Heatshrink-style LZSS for uploads and HTTP exports: the encoder is a
+ * Print, so JSON or CBOR text is written straight through it to a
+ * WiFiClient or a buffer, and the compressed bits come out as the input
+ * goes in. It keeps a LZSS_WINDOW_SIZE history in a ring twice that size
+ * (512 bytes); matches are searched in the whole window, which is fast
+ * enough for exports of a few tens of kilobytes.
+ * 
+ * Stream format, read MSB first, padded with 0 bits at the end:
+ *   1 + 8 bits                  literal byte
+ *   0 + 8 bits + 4 bits         match: distance - 1, length - LZSS_MIN_MATCH
+ * Matches may overlap the bytes they produce (distance < length). The
+ * matching decoders are LzssDecoder and web-interface/telemetry.js.
+ */
+
+#ifndef LZSS_H
+#define LZSS_H
+
+#include "config.h"
+
+#define LZSS_WINDOW_BITS     8
+#define LZSS_LENGTH_BITS     4
+#define LZSS_WINDOW_SIZE     (1 << LZSS_WINDOW_BITS)
+#define LZSS_MIN_MATCH       2     // A match token (13 bits) beats 2 literals (18 bits)
+#define LZSS_MAX_MATCH       (LZSS_MIN_MATCH + (1 << LZSS_LENGTH_BITS) - 1)
+#define LZSS_RING_SIZE       (2 * LZSS_WINDOW_SIZE)
+
+/**
+ * @class BoundedPrint
+ * @brief Print into a fixed buffer; refuses bytes once it is full
+ */
+class BoundedPrint : public Print {
+private:
+  uint8_t* buffer;
+  size_t size;
+  size_t len;
+  bool overflow;
+
+public:
+  BoundedPrint(uint8_t* out, size_t outSize) :
+    buffer(out),
+    size(outSize),
+    len(0),
+    overflow(false) {}
+  
+  size_t write(uint8_t c) override {
+    if (len >= size) {
+      overflow = true;
+      return 0;
+    }
+    buffer[len++] = c;
+    return 1;
+  }
+  
+  using Print::write;
+  
+  /**
+   * @brief Bytes written, 0 if the buffer was too small
+   */
+  size_t length() const {
+    return overflow ? 0 : len;
+  }
+};
+
+/**
+ * @class LzssEncoder
+ * @brief Compresses everything written to it into another Print
+ */
+class LzssEncoder : public Print {
+private:
+  Print& out;
+  uint8_t ring[LZSS_RING_SIZE];
+  uint32_t processed;   ///< Bytes encoded so far (start of the lookahead)
+  uint32_t received;    ///< Bytes written so far (end of the lookahead)
+  uint8_t bits;         ///< Pending output bits, MSB first
+  uint8_t bitCount;
+  uint32_t produced;    ///< Compressed bytes written to out
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param output Where the compressed stream goes
+   */
+  explicit LzssEncoder(Print& output) :
+    out(output),
+    processed(0),
+    received(0),
+    bits(0),
+    bitCount(0),
+    produced(0) {}
+  
+  size_t write(uint8_t c) override {
+    ring[received % LZSS_RING_SIZE] = c;
+    received++;
+    if (received - processed >= LZSS_MAX_MATCH) {
+      encodeToken();
+    }
+    return 1;
+  }
+  
+  using Print::write;
+  
+  /**
+   * @brief Encode the remaining input and pad the last byte
+   * 
+   * The encoder can then be used for a new stream.
+   */
+  void finish() {
+    while (processed < received) {
+      encodeToken();
+    }
+    if (bitCount > 0) {
+      emitByte(bits << (8 - bitCount));
+    }
+    processed = received = 0;
+    bits = bitCount = 0;
+  }
+  
+  uint32_t getInputLength() const { return received; }
+  uint32_t getOutputLength() const { return produced; }
+
+private:
+  /**
+   * @brief Emit the longest match at the lookahead, or a literal
+   */
+  void encodeToken() {
+    uint32_t lookahead = received - processed;
+    uint32_t history = processed < LZSS_WINDOW_SIZE ? processed : LZSS_WINDOW_SIZE;
+    uint8_t first = ring[processed % LZSS_RING_SIZE];
+    uint32_t bestLength = 0;
+    uint32_t bestDistance = 0;
+    
+    for (uint32_t distance = 1; distance <= history; distance++) {
+      uint32_t from = processed - distance;
+      if (ring[from % LZSS_RING_SIZE] != first) continue;
+      uint32_t length = 1;
+      while (length < lookahead &&
+             ring[(from + length) % LZSS_RING_SIZE] == ring[(processed + length) % LZSS_RING_SIZE]) {
+        length++;
+      }
+      if (length > bestLength) {
+        bestLength = length;
+        bestDistance = distance;
+        if (length == LZSS_MAX_MATCH) break;
+      }
+    }
+    
+    if (bestLength >= LZSS_MIN_MATCH) {
+      emitBits(0, 1);
+      emitBits(bestDistance - 1, LZSS_WINDOW_BITS);
+      emitBits(bestLength - LZSS_MIN_MATCH, LZSS_LENGTH_BITS);
+      processed += bestLength;
+    } else {
+      emitBits(1, 1);
+      emitBits(first, 8);
+      processed++;
+    }
+  }
+  
+  void emitBits(uint16_t value, uint8_t count) {
+    while (count > 0) {
+      count--;
+      bits = (bits << 1) | ((value >> count) & 1);
+      if (++bitCount == 8) {
+        emitByte(bits);
+        bits = bitCount = 0;
+      }
+    }
+  }
+  
+  void emitByte(uint8_t c) {
+    out.write(c);
+    produced++;
+  }
+};
+
+/**
+ * @class LzssDecoder
+ * @brief Decompresses everything written to it into another Print
+ */
+class LzssDecoder : public Print {
+private:
+  enum Field {
+    FIELD_LITERAL,
+    FIELD_DISTANCE,
+    FIELD_LENGTH
+  };
+  
+  Print& out;
+  uint8_t window[LZSS_WINDOW_SIZE];
+  uint32_t produced;    ///< Bytes decoded so far
+  uint16_t value;       ///< Token field being read
+  uint8_t need;         ///< Bits missing from the field, 0 before a tag
+  Field field;
+  uint16_t distance;
+  bool malformed;
+
+public:
+  explicit LzssDecoder(Print& output) :
+    out(output),
+    produced(0),
+    value(0),
+    need(0),
+    field(FIELD_LITERAL),
+    distance(0),
+    malformed(false) {}
+  
+  size_t write(uint8_t c) override {
+    for (int8_t bit = 7; bit >= 0; bit--) {
+      takeBit((c >> bit) & 1);
+    }
+    return 1;
+  }
+  
+  using Print::write;
+  
+  uint32_t getOutputLength() const { return produced; }
+  
+  /**
+   * @brief A match pointed before the start of the stream
+   */
+  bool isMalformed() const { return malformed; }
+
+private:
+  void takeBit(uint8_t bit) {
+    if (need == 0) {
+      field = bit ? FIELD_LITERAL : FIELD_DISTANCE;
+      need = bit ? 8 : LZSS_WINDOW_BITS;
+      value = 0;
+      return;
+    }
+    value = (value << 1) | bit;
+    if (--need > 0) return;
+    
+    switch (field) {
+      case FIELD_LITERAL:
+        emit(value);
+        break;
+      
+      case FIELD_DISTANCE:
+        distance = value + 1;
+        field = FIELD_LENGTH;
+        need = LZSS_LENGTH_BITS;
+        value = 0;
+        break;
+      
+      case FIELD_LENGTH:
+        if (distance > produced) {
+          malformed = true;
+          break;
+        }
+        for (uint16_t i = 0; i < value + LZSS_MIN_MATCH; i++) {
+          emit(window[(produced - distance) % LZSS_WINDOW_SIZE]);
+        }
+        break;
+    }
+  }
+  
+  void emit(uint8_t c) {
+    window[produced % LZSS_WINDOW_SIZE] = c;
+    produced++;
+    out.write(c);
+  }
+};
+
+#endif // LZSS_H
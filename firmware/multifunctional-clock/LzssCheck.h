@@ -0,0 +1,211 @@
+/**
+ * @file LzssCheck.h
+ * @brief LZSS compression check on the telemetry payloads
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Compresses what the clock actually sends (JSON and CBOR batches, a day
+ * of JSON samples as a history export would stream it, and random bytes)
+ * then decodes it again with LzssDecoder and compares checksums. The
+ * in-place MQTT encoder is checked the same way.
+ */
+
+#ifndef LZSS_CHECK_H
+#define LZSS_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "Lzss.h"
+#include "NetworkManager.h"
+
+#define LZSS_CHECK_DAY_SAMPLES  2880    // One day at the 30 s sensor period
+#define LZSS_CHECK_RANDOM_BYTES (MQTT_PACKET_MAX - 64)   // Fits raw, and its worst case packed
+
+/**
+ * @class ChecksumPrint
+ * @brief Counts and hashes (FNV-1a) the bytes written to it
+ */
+class ChecksumPrint : public Print {
+public:
+  uint32_t hash;
+  uint32_t count;
+  
+  ChecksumPrint() : hash(2166136261UL), count(0) {}
+  
+  size_t write(uint8_t c) override {
+    hash = (hash ^ c) * 16777619UL;
+    count++;
+    return 1;
+  }
+  
+  using Print::write;
+};
+
+/**
+ * @class LzssCheck
+ * @brief Runs the compression scenarios and prints the results
+ */
+class LzssCheck {
+private:
+  CheckReport results;
+  uint8_t raw[MQTT_PACKET_MAX];
+  uint8_t packed[MQTT_PACKET_MAX + MQTT_PACKET_MAX / 8 + 1];
+
+public:
+  /**
+   * @brief Constructor
+   */
+  LzssCheck() : results("LZSS") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    MqttSample samples[MQTT_BATCH_SIZE];
+    makeSamples(samples, MQTT_BATCH_SIZE, 0);
+    
+    size_t length = NetworkManager::encodeBatch(samples, MQTT_BATCH_SIZE, raw, sizeof(raw));
+    checkRoundTrip("lzss.jsonBatch", length, 0);
+    
+    length = TelemetryCbor::encodeBatch(samples, MQTT_BATCH_SIZE, raw, sizeof(raw));
+    checkRoundTrip("lzss.cborBatch", length, 0);
+    
+    checkDayExport();
+    
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < LZSS_CHECK_RANDOM_BYTES; i++) {
+      seed = seed * 1103515245UL + 12345;
+      raw[i] = seed >> 16;
+    }
+    // Worst case: every byte a 9-bit literal
+    checkRoundTrip("lzss.incompressible", LZSS_CHECK_RANDOM_BYTES,
+                   LZSS_CHECK_RANDOM_BYTES + LZSS_CHECK_RANDOM_BYTES / 8 + 1);
+    
+    checkInPlace(samples);
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief Readings drifting slowly, as the sensors report them
+   */
+  static void makeSamples(MqttSample* samples, uint8_t count, uint32_t first) {
+    for (uint8_t i = 0; i < count; i++) {
+      uint32_t n = first + i;
+      SensorData& data = samples[i].data;
+      samples[i].time = 1735689600UL + n * (SENSOR_READ_INTERVAL / 1000);
+      data.tempIndoor = 21.0f + (n % 40) * 0.1f;
+      data.tempOutdoor = 8.5f - (n % 25) * 0.2f;
+      data.humidityIndoor = 45.0f + (n % 10) * 0.5f;
+      data.humidityOutdoor = 70.0f - (n % 16) * 0.5f;
+      data.pressure = 1013.25f + (n % 8) * 0.05f;
+      data.airQuality = 420 + (n % 30);
+      data.isValid = true;
+    }
+  }
+  
+  static uint32_t checksum(const uint8_t* data, size_t length) {
+    ChecksumPrint sum;
+    sum.write(data, length);
+    return sum.hash;
+  }
+  
+  /**
+   * @brief Compress the first length bytes of raw and decode them back
+   * 
+   * @param maxOut Largest acceptable compressed length, 0 for no limit
+   */
+  void checkRoundTrip(const char* name, size_t length, size_t maxOut) {
+    unsigned long t = micros();
+    BoundedPrint out(packed, sizeof(packed));
+    LzssEncoder encoder(out);
+    encoder.write(raw, length);
+    encoder.finish();
+    unsigned long elapsed = micros() - t;
+    
+    ChecksumPrint decoded;
+    LzssDecoder decoder(decoded);
+    decoder.write(packed, out.length());
+    
+    bool ok = length > 0 && out.length() > 0 && !decoder.isMalformed() &&
+              decoded.count == length && decoded.hash == checksum(raw, length) &&
+              (maxOut == 0 || out.length() <= maxOut);
+    report(name, length, out.length(), elapsed, ok);
+  }
+  
+  /**
+   * @brief A day of JSON samples streamed through the encoder
+   * 
+   * Nothing is buffered: each sample is serialized, compressed straight
+   * into the decoder and hashed on both sides, as an export to a
+   * WiFiClient would run.
+   */
+  void checkDayExport() {
+    ChecksumPrint source;
+    ChecksumPrint decoded;
+    LzssDecoder decoder(decoded);
+    LzssEncoder encoder(decoder);
+    char line[192];
+    unsigned long elapsed = 0;
+    bool serialized = true;
+    
+    for (uint32_t n = 0; n < LZSS_CHECK_DAY_SAMPLES; n++) {
+      MqttSample sample;
+      makeSamples(&sample, 1, n);
+      size_t length = NetworkManager::serializeSensorData(sample.data, line, sizeof(line) - 1);
+      if (length == 0) serialized = false;
+      line[length++] = '\n';
+      source.write((const uint8_t*)line, length);
+      
+      unsigned long t = micros();
+      encoder.write((const uint8_t*)line, length);
+      elapsed += micros() - t;
+    }
+    unsigned long t = micros();
+    encoder.finish();
+    elapsed += micros() - t;
+    
+    bool ok = serialized && !decoder.isMalformed() &&
+              decoded.count == source.count && decoded.hash == source.hash &&
+              encoder.getOutputLength() < source.count / 3;
+    report("lzss.dayExport", source.count, encoder.getOutputLength(), elapsed, ok);
+  }
+  
+  /**
+   * @brief The compressed MQTT encoder, which works in its own buffer
+   */
+  void checkInPlace(const MqttSample* samples) {
+    size_t length = NetworkManager::rawBatchEncoder()(samples, MQTT_BATCH_SIZE, raw, sizeof(raw));
+    uint32_t expected = checksum(raw, length);
+    
+    unsigned long t = micros();
+    size_t packedLength = NetworkManager::encodeCompressedBatch(samples, MQTT_BATCH_SIZE,
+                                                                packed, MQTT_PACKET_MAX);
+    unsigned long elapsed = micros() - t;
+    
+    ChecksumPrint decoded;
+    LzssDecoder decoder(decoded);
+    decoder.write(packed, packedLength);
+    
+    bool ok = length > 0 && packedLength > 0 && !decoder.isMalformed() &&
+              decoded.count == length && decoded.hash == expected;
+    report("lzss.inPlace", length, packedLength, elapsed, ok);
+  }
+  
+  void report(const char* name, size_t in, size_t out, unsigned long elapsed, bool ok) {
+    results.start(name);
+    results.field("in", (unsigned long)in);
+    results.field("out", (unsigned long)out);
+    results.field("ratio_pct", in > 0 ? (unsigned long)(out * 100 / in) : 0UL);
+    results.field("us", elapsed);
+    results.finish(ok);
+  }
+};
+
+#endif // LZSS_CHECK_H
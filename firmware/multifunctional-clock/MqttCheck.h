@@ -0,0 +1,409 @@
+/**
+ * @file MqttCheck.h
+ * @brief MQTT publisher check against a local broker stand-in
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * LoopbackBroker is an MqttTransport that parses what the client writes
+ * like a broker would, and answers CONNACK and PUBACK one scripted round
+ * trip later. It can accept only a few bytes per write, drop the
+ * connection or be unreachable. Each sample carries a sequence number as
+ * its time, so the broker checks that every sample arrives, and how often.
+ * Times are scripted: throughput is in messages per simulated second over
+ * a MQTT_CHECK_RTT link, the CPU cost of update() is timed with micros().
+ * The same client is tested against a real broker as described in the
+ * README (MQTT-STATS lines).
+ */
+
+#ifndef MQTT_CHECK_H
+#define MQTT_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "MqttClient.h"
+
+#define MQTT_CHECK_RTT          40      // Broker round trip (ms)
+#define MQTT_CHECK_STEP         5       // Loop period (ms)
+#define MQTT_CHECK_SAMPLES      (MQTT_QUEUE_SIZE * MQTT_BATCH_SIZE)
+#define MQTT_CHECK_MAX_ACKS     16
+#define MQTT_CHECK_BROKER       192, 0, 2, 10   // Address handed to the client
+
+/**
+ * @class LoopbackBroker
+ * @brief Broker stand-in answering one client
+ */
+class LoopbackBroker : public MqttTransport {
+private:
+  uint8_t rx[MQTT_PACKET_MAX];
+  size_t rxLength;
+  uint8_t out[MQTT_CHECK_MAX_ACKS][4];
+  uint64_t outDue[MQTT_CHECK_MAX_ACKS];
+  uint8_t outCount;
+  bool open;
+
+public:
+  uint64_t now;               ///< Scripted time (ms)
+  size_t writeLimit;          ///< Bytes accepted per write, 0 for all
+  bool reachable;             ///< false: connect() fails
+  uint8_t closeAfter;         ///< Close on this PUBLISH of the session, 0 for never
+  uint8_t seen[MQTT_CHECK_SAMPLES + 1];  ///< Deliveries per sample number
+  unsigned long publishes;
+  unsigned long dupFlags;     ///< PUBLISH packets with DUP set
+  unsigned long errors;       ///< Malformed or unexpected packets
+  uint8_t sessionPublishes;
+  uint8_t inFlight;           ///< PUBLISH received, PUBACK not yet read
+  uint8_t maxInFlight;
+  
+  LoopbackBroker() :
+    rxLength(0),
+    outCount(0),
+    open(false),
+    now(0),
+    writeLimit(0),
+    reachable(true),
+    closeAfter(0),
+    publishes(0),
+    dupFlags(0),
+    errors(0),
+    sessionPublishes(0),
+    inFlight(0),
+    maxInFlight(0) {
+    memset(seen, 0, sizeof(seen));
+  }
+  
+  bool connect(const IPAddress& address, uint16_t port) override {
+    if (address != IPAddress(MQTT_CHECK_BROKER) || port != MQTT_BROKER_PORT) {
+      errors++;
+    }
+    if (!reachable) return false;
+    open = true;
+    rxLength = 0;
+    outCount = 0;
+    sessionPublishes = 0;
+    inFlight = 0;
+    return true;
+  }
+  
+  bool connected() override {
+    return open;
+  }
+  
+  int write(const uint8_t* buffer, size_t length) override {
+    if (!open) return -1;
+    if (writeLimit > 0 && length > writeLimit) length = writeLimit;
+    if (rxLength + length > sizeof(rx)) {
+      errors++;
+      return -1;
+    }
+    memcpy(rx + rxLength, buffer, length);
+    rxLength += length;
+    while (open && takePacket()) {
+    }
+    return length;
+  }
+  
+  int read(uint8_t* buffer, size_t size) override {
+    if (!open || outCount == 0 || outDue[0] > now || size < 4) {
+      return 0;
+    }
+    size_t length = out[0][1] + 2;
+    memcpy(buffer, out[0], length);
+    outCount--;
+    memmove(out[0], out[1], outCount * sizeof(out[0]));
+    memmove(outDue, outDue + 1, outCount * sizeof(outDue[0]));
+    if ((buffer[0] >> 4) == MQTT_PUBACK && inFlight > 0) inFlight--;
+    return length;
+  }
+  
+  void stop() override {
+    open = false;
+  }
+  
+  /**
+   * @brief Sample numbers delivered at least once, and duplicates
+   */
+  void countSeen(uint8_t first, uint8_t last, uint8_t& delivered, uint8_t& duplicates) const {
+    delivered = duplicates = 0;
+    for (uint8_t i = first; i <= last; i++) {
+      if (seen[i] > 0) delivered++;
+      if (seen[i] > 1) duplicates++;
+    }
+  }
+
+private:
+  /**
+   * @brief Handle one complete packet at the front of rx
+   * 
+   * @return false if no complete packet is buffered
+   */
+  bool takePacket() {
+    if (rxLength < 2) return false;
+    size_t remaining = 0;
+    size_t pos = 1;
+    uint8_t shift = 0;
+    do {
+      if (pos >= rxLength) return false;
+      remaining |= (size_t)(rx[pos] & 0x7F) << shift;
+      shift += 7;
+    } while (rx[pos++] & 0x80);
+    if (rxLength < pos + remaining) return false;
+    
+    handle(rx[0], rx + pos, remaining);
+    size_t used = pos + remaining;
+    rxLength -= used;
+    memmove(rx, rx + used, rxLength);
+    return true;
+  }
+  
+  void handle(uint8_t first, const uint8_t* body, size_t length) {
+    switch (first >> 4) {
+      case MQTT_CONNECT:
+        // Protocol name "MQTT", level 4, clean session
+        if (length < 10 || memcmp(body + 2, "MQTT", 4) != 0 || body[6] != MQTT_PROTOCOL_LEVEL ||
+            !(body[7] & 0x02)) {
+          errors++;
+        }
+        answer(MQTT_CONNACK, 2, 0, 0);
+        break;
+      
+      case MQTT_PUBLISH: {
+        size_t topicLength = (body[0] << 8) | body[1];
+        if ((first & 0x06) != 0x02 || length < 2 + topicLength + 2) {
+          errors++;
+          return;
+        }
+        publishes++;
+        if (first & 0x08) dupFlags++;
+        const uint8_t* id = body + 2 + topicLength;
+        for (size_t i = 2 + topicLength + 2; i + 4 <= length; i += 4) {
+          uint32_t number;
+          memcpy(&number, body + i, 4);
+          if (number >= 1 && number <= MQTT_CHECK_SAMPLES && seen[number] < 255) seen[number]++;
+        }
+        if (closeAfter > 0 && ++sessionPublishes >= closeAfter) {
+          open = false;
+          closeAfter = 0;
+          return;
+        }
+        if (++inFlight > maxInFlight) maxInFlight = inFlight;
+        answer(MQTT_PUBACK, 2, id[0], id[1]);
+        break;
+      }
+      
+      case MQTT_PINGREQ:
+        answer(MQTT_PINGRESP, 0, 0, 0);
+        break;
+      
+      default:
+        errors++;
+        break;
+    }
+  }
+  
+  /**
+   * @brief Queue a reply, readable one round trip later
+   */
+  void answer(MqttPacketType type, uint8_t length, uint8_t a, uint8_t b) {
+    if (outCount >= MQTT_CHECK_MAX_ACKS) {
+      errors++;
+      return;
+    }
+    out[outCount][0] = type << 4;
+    out[outCount][1] = length;
+    out[outCount][2] = a;
+    out[outCount][3] = b;
+    outDue[outCount] = now + MQTT_CHECK_RTT;
+    outCount++;
+  }
+};
+
+/**
+ * @class MqttCheck
+ * @brief Runs the publisher scenarios and prints the results
+ */
+class MqttCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  MqttCheck() : results("MQTT") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    checkThroughput("mqtt.throughput", 0);
+    checkThroughput("mqtt.partialWrite", 7);
+    checkLostConnection();
+    checkBrokerDown();
+    checkBatchAge();
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief Payload: the sample numbers, 4 bytes each
+   */
+  static size_t encodeNumbers(const MqttSample* samples, uint8_t count, uint8_t* buffer, size_t size) {
+    if (size < count * 4U) return 0;
+    for (uint8_t i = 0; i < count; i++) {
+      memcpy(buffer + i * 4, &samples[i].time, 4);
+    }
+    return count * 4;
+  }
+  
+  static void enqueueRange(MqttClient& client, uint32_t first, uint32_t last, uint64_t now) {
+    for (uint32_t n = first; n <= last; n++) {
+      MqttSample sample;
+      memset(&sample, 0, sizeof(sample));
+      sample.time = n;
+      client.enqueue(sample, now);
+    }
+  }
+  
+  /**
+   * @brief Step the loop until every queued sample is acknowledged
+   * 
+   * @return Simulated time taken (ms)
+   */
+  uint64_t runUntilDelivered(MqttClient& client, LoopbackBroker& broker, uint64_t start,
+                             uint64_t limit, unsigned long& maxUpdateMicros) {
+    IPAddress address(MQTT_CHECK_BROKER);
+    uint64_t now = start;
+    maxUpdateMicros = 0;
+    while (now - start < limit) {
+      broker.now = now;
+      unsigned long t = micros();
+      client.update(now, true, &address);
+      unsigned long elapsed = micros() - t;
+      if (elapsed > maxUpdateMicros) maxUpdateMicros = elapsed;
+      if (client.getPendingSamples() == 0) break;
+      now += MQTT_CHECK_STEP;
+    }
+    return now - start;
+  }
+  
+  /**
+   * @brief A full queue published over one session, all delivered once
+   * 
+   * @param writeLimit Bytes the broker accepts per write, 0 for all
+   */
+  void checkThroughput(const char* name, size_t writeLimit) {
+    LoopbackBroker broker;
+    broker.writeLimit = writeLimit;
+    MqttClient client(&broker, encodeNumbers, MQTT_TOPIC);
+    enqueueRange(client, 1, MQTT_CHECK_SAMPLES, 0);
+    
+    unsigned long maxUpdateMicros;
+    uint64_t elapsed = runUntilDelivered(client, broker, 0, 60000, maxUpdateMicros);
+    uint8_t delivered, duplicates;
+    broker.countSeen(1, MQTT_CHECK_SAMPLES, delivered, duplicates);
+    const MqttMetrics& metrics = client.getMetrics();
+    
+    bool ok = delivered == MQTT_CHECK_SAMPLES && duplicates == 0 && broker.errors == 0 &&
+              metrics.acked == MQTT_QUEUE_SIZE && metrics.retransmits == 0 &&
+              broker.maxInFlight <= MQTT_MAX_INFLIGHT &&
+              (writeLimit > 0 || broker.maxInFlight == MQTT_MAX_INFLIGHT);
+    report(name, client, elapsed, maxUpdateMicros, ok);
+  }
+  
+  /**
+   * @brief Connection lost with messages in flight: resent with DUP
+   */
+  void checkLostConnection() {
+    LoopbackBroker broker;
+    broker.closeAfter = 2;
+    MqttClient client(&broker, encodeNumbers, MQTT_TOPIC);
+    enqueueRange(client, 1, MQTT_CHECK_SAMPLES, 0);
+    
+    unsigned long maxUpdateMicros;
+    uint64_t elapsed = runUntilDelivered(client, broker, 0, 60000 + MQTT_BACKOFF_MAX, maxUpdateMicros);
+    uint8_t delivered, duplicates;
+    broker.countSeen(1, MQTT_CHECK_SAMPLES, delivered, duplicates);
+    const MqttMetrics& metrics = client.getMetrics();
+    
+    // At least once: nothing lost, the unacknowledged messages sent again
+    bool ok = delivered == MQTT_CHECK_SAMPLES && broker.errors == 0 &&
+              metrics.connects == 2 && metrics.retransmits > 0 &&
+              broker.dupFlags == metrics.retransmits;
+    report("mqtt.lostConnection", client, elapsed, maxUpdateMicros, ok);
+  }
+  
+  /**
+   * @brief Broker down: the oldest batches are dropped, the rest kept
+   */
+  void checkBrokerDown() {
+    LoopbackBroker broker;
+    broker.reachable = false;
+    MqttClient client(&broker, encodeNumbers, MQTT_TOPIC);
+    enqueueRange(client, 1, MQTT_CHECK_SAMPLES, 0);
+    
+    // Two more batches: the first two are dropped
+    IPAddress address(MQTT_CHECK_BROKER);
+    for (uint64_t t = 0; t < 10000; t += 1000) {
+      broker.now = t;
+      client.update(t, true, &address);
+    }
+    MqttSample sample;
+    memset(&sample, 0, sizeof(sample));
+    for (uint8_t i = 0; i < 2 * MQTT_BATCH_SIZE; i++) {
+      client.enqueue(sample, 10000);
+    }
+    bool ok = client.getMetrics().dropped == 2 * MQTT_BATCH_SIZE &&
+              client.getPendingSamples() == MQTT_CHECK_SAMPLES &&
+              client.getMetrics().connects == 0;
+    
+    broker.reachable = true;
+    unsigned long maxUpdateMicros;
+    uint64_t elapsed = runUntilDelivered(client, broker, 10000, 60000 + MQTT_BACKOFF_MAX, maxUpdateMicros);
+    uint8_t delivered, duplicates;
+    broker.countSeen(2 * MQTT_BATCH_SIZE + 1, MQTT_CHECK_SAMPLES, delivered, duplicates);
+    ok = ok && delivered == MQTT_CHECK_SAMPLES - 2 * MQTT_BATCH_SIZE && duplicates == 0 &&
+         broker.seen[1] == 0 && broker.errors == 0;
+    report("mqtt.brokerDown", client, elapsed, maxUpdateMicros, ok);
+  }
+  
+  /**
+   * @brief An incomplete batch waits MQTT_BATCH_MAX_AGE, then goes out
+   */
+  void checkBatchAge() {
+    LoopbackBroker broker;
+    MqttClient client(&broker, encodeNumbers, MQTT_TOPIC);
+    enqueueRange(client, 1, 1, 0);
+    
+    IPAddress address(MQTT_CHECK_BROKER);
+    broker.now = MQTT_BATCH_MAX_AGE - 1;
+    client.update(broker.now, true, &address);
+    bool ok = broker.publishes == 0;
+    
+    unsigned long maxUpdateMicros;
+    uint64_t elapsed = runUntilDelivered(client, broker, MQTT_BATCH_MAX_AGE, 60000, maxUpdateMicros);
+    ok = ok && broker.publishes == 1 && broker.seen[1] == 1;
+    report("mqtt.batchAge", client, elapsed, maxUpdateMicros, ok);
+  }
+  
+  void report(const char* name, const MqttClient& client, uint64_t elapsed,
+              unsigned long maxUpdateMicros, bool ok) {
+    const MqttMetrics& metrics = client.getMetrics();
+    
+    results.start(name);
+    results.field("acked", metrics.acked);
+    results.field("retransmits", metrics.retransmits);
+    results.field("dropped", metrics.dropped);
+    results.field("msgs_per_s", elapsed > 0 ? (unsigned long)(metrics.acked * 1000ULL / elapsed) : 0UL);
+    results.field("ack_avg_ms", metrics.acked > 0 ? (unsigned long)(metrics.ackLatencyTotal / metrics.acked) : 0UL);
+    results.field("max_update_us", maxUpdateMicros);
+    results.finish(ok);
+  }
+};
+
+#endif // MQTT_CHECK_H
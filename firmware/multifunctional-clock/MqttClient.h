@@ -0,0 +1,594 @@
+/**
+ * @file MqttClient.h
+ * @brief Non-blocking MQTT 3.1.1 publisher with a batched QoS 1 queue
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Sensor samples are queued in a fixed ring of messages, each holding up
+ * to MQTT_BATCH_SIZE samples, so one PUBLISH carries several readings. A
+ * message is sealed when it is full or its first sample is older than
+ * MQTT_BATCH_MAX_AGE. Up to MQTT_MAX_INFLIGHT sealed messages are
+ * published before their PUBACKs come back, which keeps the link busy
+ * across the broker round trip instead of sending one message per RTT.
+ * 
+ * update(), called every loop iteration, never waits: each call writes at
+ * most MQTT_WRITE_CHUNK bytes of the current packet and reads only the
+ * bytes already received. A message that is not acknowledged within
+ * MQTT_ACK_TIMEOUT, a missing PINGRESP or a closed socket drops the
+ * connection; after a jittered backoff the client reconnects and sends
+ * every unacknowledged message again with the DUP flag, so samples are
+ * delivered at least once. When the ring is full the oldest unsent
+ * message is dropped. The TCP connect itself is the one blocking call of
+ * the WiFiS3 client, made at most once per backoff period.
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include "config.h"
+#include "SensorManager.h"
+#include "MqttPacket.h"
+#include "Backoff.h"
+#include <WiFi.h>
+
+/**
+ * @class MqttTransport
+ * @brief Interface for the broker stream
+ */
+class MqttTransport {
+public:
+  virtual ~MqttTransport() {}
+  
+  /**
+   * @brief Open the connection to the broker
+   */
+  virtual bool connect(const IPAddress& address, uint16_t port) = 0;
+  
+  /**
+   * @brief Check whether the connection is still open
+   */
+  virtual bool connected() = 0;
+  
+  /**
+   * @brief Write some bytes without waiting for the peer
+   * 
+   * @return Number of bytes accepted (possibly fewer than length), -1 on
+   * a closed connection
+   */
+  virtual int write(const uint8_t* buffer, size_t length) = 0;
+  
+  /**
+   * @brief Read the bytes already received
+   * 
+   * @return Number of bytes read, 0 if nothing has arrived
+   */
+  virtual int read(uint8_t* buffer, size_t size) = 0;
+  
+  /**
+   * @brief Close the connection
+   */
+  virtual void stop() = 0;
+};
+
+/**
+ * @class TcpMqttTransport
+ * @brief Broker stream over WiFiClient
+ */
+class TcpMqttTransport : public MqttTransport {
+private:
+  WiFiClient client;
+
+public:
+  bool connect(const IPAddress& address, uint16_t port) override {
+    return client.connect(address, port);
+  }
+  
+  bool connected() override {
+    return client.connected();
+  }
+  
+  int write(const uint8_t* buffer, size_t length) override {
+    if (!client.connected()) {
+      return -1;
+    }
+    return client.write(buffer, length);
+  }
+  
+  int read(uint8_t* buffer, size_t size) override {
+    int available = client.available();
+    if (available <= 0) {
+      return 0;
+    }
+    int length = client.read(buffer, (size_t)available < size ? available : size);
+    return length > 0 ? length : 0;
+  }
+  
+  void stop() override {
+    client.stop();
+  }
+};
+
+/**
+ * @brief Connection states
+ */
+enum MqttState {
+  MQTT_STATE_IDLE = 0,      ///< Not connected, next attempt due
+  MQTT_STATE_WAIT_CONNACK,  ///< CONNECT sent
+  MQTT_STATE_CONNECTED,     ///< Session up, publishing
+  MQTT_STATE_BACKOFF        ///< Waiting before the next attempt
+};
+
+/**
+ * @struct MqttSample
+ * @brief One queued sensor reading
+ */
+struct MqttSample {
+  uint32_t time;     ///< UTC epoch of the reading, 0 if the clock is not set
+  SensorData data;
+};
+
+/**
+ * @brief Batch encoder: writes the payload of one message
+ * 
+ * @return Payload length, or 0 if it does not fit
+ */
+typedef size_t (*MqttBatchEncoder)(const MqttSample* samples, uint8_t count,
+                                   uint8_t* buffer, size_t size);
+
+/**
+ * @struct MqttMetrics
+ * @brief Delivery statistics since boot
+ */
+struct MqttMetrics {
+  unsigned long connects;        ///< Sessions established
+  unsigned long published;       ///< Messages sent for the first time
+  unsigned long retransmits;     ///< Messages sent again with DUP
+  unsigned long acked;           ///< Messages acknowledged
+  unsigned long samplesAcked;    ///< Samples in acknowledged messages
+  unsigned long dropped;         ///< Samples dropped on a full queue
+  unsigned long bytesSent;
+  uint64_t ackLatencyTotal;      ///< Sum of PUBLISH to PUBACK times (ms)
+  uint32_t ackLatencyMax;        ///< Worst PUBLISH to PUBACK time (ms)
+};
+
+/**
+ * @class MqttClient
+ * @brief Publishes queued samples to one topic with QoS 1
+ */
+class MqttClient {
+  friend class MqttCheck;
+
+private:
+  enum MessageState {
+    MESSAGE_FILLING = 0,  ///< Open batch, accepting samples
+    MESSAGE_QUEUED,       ///< Sealed, waiting for a window slot
+    MESSAGE_SENT,         ///< Published, waiting for its PUBACK
+    MESSAGE_ACKED         ///< Acknowledged, freed once it is the oldest
+  };
+  
+  struct Message {
+    MqttSample samples[MQTT_BATCH_SIZE];
+    uint8_t count;
+    uint8_t state;
+    bool sentBefore;     ///< Next send is a retransmission
+    uint16_t packetId;
+    uint64_t openedAt;   ///< First sample queued (ms)
+    uint64_t sentAt;     ///< Last PUBLISH written (ms)
+  };
+  
+  MqttTransport* transport;
+  MqttBatchEncoder encoder;
+  const char* topic;
+  
+  // Ring of messages, oldest first
+  Message messages[MQTT_QUEUE_SIZE];
+  uint8_t head;
+  uint8_t count;
+  uint8_t inFlight;
+  uint16_t nextPacketId;
+  
+  // Packet being written
+  uint8_t tx[MQTT_PACKET_MAX];
+  size_t txStart;
+  size_t txEnd;
+  
+  MqttReader reader;
+  MqttState state;
+  uint64_t stateSince;
+  uint64_t nextAttempt;
+  uint64_t lastSend;
+  uint64_t pingSentAt;
+  bool pingPending;
+  uint8_t failures;
+  JitteredBackoff backoff;
+  MqttMetrics metrics;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param mqttTransport Stream to the broker
+   * @param batchEncoder Writes the payload of each message
+   * @param topicName Topic the samples are published to
+   */
+  MqttClient(MqttTransport* mqttTransport, MqttBatchEncoder batchEncoder, const char* topicName) :
+    transport(mqttTransport),
+    encoder(batchEncoder),
+    topic(topicName),
+    head(0),
+    count(0),
+    inFlight(0),
+    nextPacketId(1),
+    txStart(0),
+    txEnd(0),
+    state(MQTT_STATE_IDLE),
+    stateSince(0),
+    nextAttempt(0),
+    lastSend(0),
+    pingSentAt(0),
+    pingPending(false),
+    failures(0),
+    backoff(MQTT_BACKOFF_MIN, MQTT_BACKOFF_MAX, 0x2545F491UL) {
+    memset(&metrics, 0, sizeof(metrics));
+  }
+  
+  /**
+   * @brief Queue a sample
+   * 
+   * Never sends: the sample goes into the open batch, published by
+   * update().
+   * 
+   * @param sample Reading and its time
+   * @param now Current time (ms)
+   * @return false if the sample was dropped because the queue is full of
+   * messages in flight
+   */
+  bool enqueue(const MqttSample& sample, uint64_t now) {
+    if (count > 0) {
+      Message& last = at(count - 1);
+      if (last.state == MESSAGE_FILLING) {
+        last.samples[last.count++] = sample;
+        if (last.count >= MQTT_BATCH_SIZE) {
+          last.state = MESSAGE_QUEUED;
+        }
+        return true;
+      }
+    }
+    
+    if (count >= MQTT_QUEUE_SIZE) {
+      // Drop the oldest batch unless the broker may already have it
+      Message& oldest = at(0);
+      if (oldest.state == MESSAGE_SENT) {
+        metrics.dropped++;
+        return false;
+      }
+      if (oldest.state == MESSAGE_QUEUED) {
+        metrics.dropped += oldest.count;
+      }
+      head = (head + 1) % MQTT_QUEUE_SIZE;
+      count--;
+    }
+    
+    Message& message = at(count++);
+    message.samples[0] = sample;
+    message.count = 1;
+    message.state = MQTT_BATCH_SIZE > 1 ? MESSAGE_FILLING : MESSAGE_QUEUED;
+    message.sentBefore = false;
+    message.packetId = 0;
+    message.openedAt = now;
+    message.sentAt = 0;
+    return true;
+  }
+  
+  /**
+   * @brief Advance the connection and the queue without blocking
+   * 
+   * Should be called every loop iteration.
+   * 
+   * @param now Current time (ms)
+   * @param networkUp WiFi link is up
+   * @param broker Broker address, or nullptr while it is not resolved
+   */
+  void update(uint64_t now, bool networkUp, const IPAddress* broker) {
+    releaseAcked();
+    sealOldBatch(now);
+    
+    switch (state) {
+      case MQTT_STATE_IDLE:
+      case MQTT_STATE_BACKOFF:
+        if (now >= nextAttempt && networkUp && broker && hasWork()) {
+          startSession(now, *broker);
+        }
+        break;
+      
+      case MQTT_STATE_WAIT_CONNACK:
+        if (!networkUp || !flush(now) || !receive(now)) {
+          fail(now);
+        } else if (state == MQTT_STATE_WAIT_CONNACK && now - stateSince > MQTT_CONNECT_TIMEOUT) {
+          DEBUG_PRINTLN("MQTT CONNACK timeout");
+          fail(now);
+        }
+        break;
+      
+      case MQTT_STATE_CONNECTED:
+        if (!networkUp || !transport->connected() || !flush(now) || !receive(now)) {
+          fail(now);
+          break;
+        }
+        if (ackOverdue(now)) {
+          DEBUG_PRINTLN("MQTT PUBACK timeout");
+          fail(now);
+          break;
+        }
+        if (txStart == txEnd) {
+          sendNext(now);
+        }
+        break;
+    }
+  }
+  
+  MqttState getState() const { return state; }
+  bool isConnected() const { return state == MQTT_STATE_CONNECTED; }
+  
+  /**
+   * @brief Number of queued samples not yet acknowledged
+   */
+  uint16_t getPendingSamples() const {
+    uint16_t samples = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (at(i).state != MESSAGE_ACKED) samples += at(i).count;
+    }
+    return samples;
+  }
+  
+  uint8_t getInFlight() const { return inFlight; }
+  const MqttMetrics& getMetrics() const { return metrics; }
+
+private:
+  Message& at(uint8_t index) {
+    return messages[(head + index) % MQTT_QUEUE_SIZE];
+  }
+  
+  const Message& at(uint8_t index) const {
+    return messages[(head + index) % MQTT_QUEUE_SIZE];
+  }
+  
+  /**
+   * @brief Something to publish, so a session is worth opening
+   */
+  bool hasWork() const {
+    return count > 0 && at(0).state != MESSAGE_FILLING;
+  }
+  
+  /**
+   * @brief Seal the open batch once its first sample is old enough
+   */
+  void sealOldBatch(uint64_t now) {
+    if (count == 0) return;
+    Message& last = at(count - 1);
+    if (last.state == MESSAGE_FILLING && now - last.openedAt >= MQTT_BATCH_MAX_AGE) {
+      last.state = MESSAGE_QUEUED;
+    }
+  }
+  
+  void startSession(uint64_t now, const IPAddress& broker) {
+    reader.reset();
+    txStart = txEnd = 0;
+    pingPending = false;
+    if (!transport->connect(broker, MQTT_BROKER_PORT)) {
+      DEBUG_PRINTLN("MQTT broker unreachable");
+      fail(now);
+      return;
+    }
+    
+    txEnd = MqttPacket::buildConnect(tx, sizeof(tx), MQTT_CLIENT_ID, MQTT_KEEPALIVE,
+                                     MQTT_USER, MQTT_PASSWORD);
+    state = MQTT_STATE_WAIT_CONNACK;
+    stateSince = now;
+    flush(now);
+  }
+  
+  /**
+   * @brief Write the next chunk of the current packet
+   * 
+   * @return false if the connection is closed
+   */
+  bool flush(uint64_t now) {
+    if (txStart == txEnd) return true;
+    size_t length = txEnd - txStart;
+    int written = transport->write(tx + txStart, length < MQTT_WRITE_CHUNK ? length : MQTT_WRITE_CHUNK);
+    if (written < 0) {
+      return false;
+    }
+    txStart += written;
+    metrics.bytesSent += written;
+    if (txStart == txEnd) {
+      txStart = txEnd = 0;
+      lastSend = now;
+    }
+    return true;
+  }
+  
+  /**
+   * @brief Handle the packets received so far
+   * 
+   * @return false on a refused session or a malformed stream
+   */
+  bool receive(uint64_t now) {
+    uint8_t buffer[MQTT_READ_CHUNK];
+    int length;
+    while ((length = transport->read(buffer, sizeof(buffer))) > 0) {
+      size_t offset = 0;
+      while (offset < (size_t)length) {
+        size_t used;
+        bool complete = reader.feed(buffer + offset, length - offset, used);
+        offset += used;
+        if (reader.isMalformed()) {
+          return false;
+        }
+        if (complete && !handlePacket(now)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+  
+  bool handlePacket(uint64_t now) {
+    const uint8_t* body = reader.getBody();
+    switch (reader.getType()) {
+      case MQTT_CONNACK:
+        if (state != MQTT_STATE_WAIT_CONNACK || reader.getBodyLength() != 2 || body[1] != 0) {
+          DEBUG_PRINTLN("MQTT session refused");
+          return false;
+        }
+        onConnected(now);
+        return true;
+      
+      case MQTT_PUBACK:
+        if (reader.getBodyLength() == 2) {
+          onPubAck((body[0] << 8) | body[1], now);
+        }
+        return true;
+      
+      case MQTT_PINGRESP:
+        pingPending = false;
+        return true;
+      
+      default:
+        // Nothing subscribed: ignore anything else
+        return true;
+    }
+  }
+  
+  void onConnected(uint64_t now) {
+    state = MQTT_STATE_CONNECTED;
+    stateSince = now;
+    lastSend = now;
+    failures = 0;
+    metrics.connects++;
+    DEBUG_PRINTLN("MQTT connected");
+  }
+  
+  void onPubAck(uint16_t packetId, uint64_t now) {
+    for (uint8_t i = 0; i < count; i++) {
+      Message& message = at(i);
+      if (message.state == MESSAGE_SENT && message.packetId == packetId) {
+        message.state = MESSAGE_ACKED;
+        inFlight--;
+        
+        uint32_t latency = now - message.sentAt;
+        metrics.acked++;
+        metrics.samplesAcked += message.count;
+        metrics.ackLatencyTotal += latency;
+        if (latency > metrics.ackLatencyMax) metrics.ackLatencyMax = latency;
+        return;
+      }
+    }
+  }
+  
+  /**
+   * @brief Free the acknowledged messages at the front of the ring
+   */
+  void releaseAcked() {
+    while (count > 0 && at(0).state == MESSAGE_ACKED) {
+      head = (head + 1) % MQTT_QUEUE_SIZE;
+      count--;
+    }
+  }
+  
+  bool ackOverdue(uint64_t now) const {
+    if (pingPending && now - pingSentAt > MQTT_ACK_TIMEOUT) {
+      return true;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+      const Message& message = at(i);
+      if (message.state == MESSAGE_SENT && now - message.sentAt > MQTT_ACK_TIMEOUT) {
+        return true;
+      }
+    }
+    return false;
+  }
+  
+  /**
+   * @brief Start the next PUBLISH if the window allows, or a PINGREQ
+   */
+  void sendNext(uint64_t now) {
+    if (inFlight < MQTT_MAX_INFLIGHT) {
+      for (uint8_t i = 0; i < count; i++) {
+        Message& message = at(i);
+        if (message.state == MESSAGE_QUEUED) {
+          publish(message, now);
+          return;
+        }
+      }
+    }
+    
+    if (!pingPending && now - lastSend >= MQTT_KEEPALIVE * 1000UL / 2) {
+      txEnd = MqttPacket::buildEmpty(tx, MQTT_PINGREQ);
+      pingPending = true;
+      pingSentAt = now;
+      flush(now);
+    }
+  }
+  
+  void publish(Message& message, uint64_t now) {
+    size_t offset = MqttPacket::publishPayloadOffset(topic);
+    size_t length = encoder(message.samples, message.count, tx + offset, sizeof(tx) - offset);
+    if (length == 0) {
+      // Cannot be encoded: drop it rather than block the queue
+      DEBUG_PRINTLN("MQTT batch too large, dropped");
+      metrics.dropped += message.count;
+      message.state = MESSAGE_ACKED;
+      return;
+    }
+    
+    if (message.packetId == 0) {
+      message.packetId = nextPacketId;
+      nextPacketId = nextPacketId == 0xFFFF ? 1 : nextPacketId + 1;
+    }
+    txStart = MqttPacket::finishPublish(tx, topic, message.packetId, message.sentBefore, length);
+    txEnd = offset + length;
+    
+    if (message.sentBefore) {
+      metrics.retransmits++;
+    } else {
+      metrics.published++;
+    }
+    message.sentBefore = true;
+    message.state = MESSAGE_SENT;
+    message.sentAt = now;
+    inFlight++;
+    flush(now);
+  }
+  
+  /**
+   * @brief Drop the session and schedule a retry after a jittered backoff
+   */
+  void fail(uint64_t now) {
+    closeSession();
+    uint32_t retryDelay = backoff.delay(failures);
+    
+    if (failures < 255) failures++;
+    nextAttempt = now + retryDelay;
+    state = MQTT_STATE_BACKOFF;
+  }
+  
+  /**
+   * @brief Close the socket; unacknowledged messages go back in the queue
+   */
+  void closeSession() {
+    transport->stop();
+    txStart = txEnd = 0;
+    pingPending = false;
+    for (uint8_t i = 0; i < count; i++) {
+      if (at(i).state == MESSAGE_SENT) {
+        at(i).state = MESSAGE_QUEUED;
+      }
+    }
+    inFlight = 0;
+  }
+};
+
+#endif // MQTT_CLIENT_H
@@ -0,0 +1,290 @@
+/**
+ * @file MqttPacket.h
+ * @brief MQTT 3.1.1 packet building and incremental reading
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Covers what a QoS 1 publisher needs: CONNECT, PUBLISH, PINGREQ and
+ * DISCONNECT are built in place in the caller's buffer, and MqttReader
+ * reassembles CONNACK, PUBACK and PINGRESP from the bytes as they arrive,
+ * however the TCP stream splits them. Nothing is allocated; packets with
+ * a body larger than MQTT_READ_MAX are read through and skipped.
+ */
+
+#ifndef MQTT_PACKET_H
+#define MQTT_PACKET_H
+
+#include "config.h"
+
+#define MQTT_PROTOCOL_LEVEL   4     // MQTT 3.1.1
+#define MQTT_PUBLISH_HEADER_MAX 5   // Fixed header: type byte + up to 4 length bytes
+#define MQTT_READ_MAX         8     // Largest body kept by MqttReader
+
+/**
+ * @brief Control packet types (high nibble of the first byte)
+ */
+enum MqttPacketType {
+  MQTT_CONNECT = 1,
+  MQTT_CONNACK = 2,
+  MQTT_PUBLISH = 3,
+  MQTT_PUBACK = 4,
+  MQTT_PINGREQ = 12,
+  MQTT_PINGRESP = 13,
+  MQTT_DISCONNECT = 14
+};
+
+/**
+ * @class MqttPacket
+ * @brief Stateless helpers to build client packets
+ */
+class MqttPacket {
+public:
+  /**
+   * @brief Build a CONNECT packet with a clean session
+   * 
+   * @param buffer Destination buffer
+   * @param size Size of the destination buffer
+   * @param clientId Client identifier
+   * @param keepAlive Keep alive interval (s)
+   * @param user User name, or an empty string for none
+   * @param password Password, only sent with a user name
+   * @return Length of the packet, or 0 if it does not fit
+   */
+  static size_t buildConnect(uint8_t* buffer, size_t size, const char* clientId,
+                             uint16_t keepAlive, const char* user, const char* password) {
+    bool login = user && *user;
+    bool secret = login && password && *password;
+    size_t remaining = 10 + 2 + strlen(clientId);
+    if (login) remaining += 2 + strlen(user);
+    if (secret) remaining += 2 + strlen(password);
+    
+    size_t len = putFixedHeader(buffer, size, MQTT_CONNECT << 4, remaining);
+    if (len == 0 || len + remaining > size) {
+      return 0;
+    }
+    len = putString(buffer, len, "MQTT");
+    buffer[len++] = MQTT_PROTOCOL_LEVEL;
+    buffer[len++] = 0x02 | (login ? 0x80 : 0) | (secret ? 0x40 : 0);  // Clean session
+    buffer[len++] = keepAlive >> 8;
+    buffer[len++] = keepAlive & 0xFF;
+    len = putString(buffer, len, clientId);
+    if (login) len = putString(buffer, len, user);
+    if (secret) len = putString(buffer, len, password);
+    return len;
+  }
+  
+  /**
+   * @brief Space to leave in front of a PUBLISH payload
+   * 
+   * The payload is written at this offset, then finishPublish() fills in
+   * the headers before it, so it never has to be copied.
+   */
+  static size_t publishPayloadOffset(const char* topic) {
+    return MQTT_PUBLISH_HEADER_MAX + 2 + strlen(topic) + 2;
+  }
+  
+  /**
+   * @brief Write the headers of a QoS 1 PUBLISH in front of its payload
+   * 
+   * @param buffer Buffer holding the payload at publishPayloadOffset(topic)
+   * @param topic Topic name
+   * @param packetId Packet identifier, non-zero
+   * @param dup Set on a retransmission
+   * @param payloadLength Length of the payload
+   * @return Offset where the packet starts in the buffer
+   */
+  static size_t finishPublish(uint8_t* buffer, const char* topic, uint16_t packetId,
+                              bool dup, size_t payloadLength) {
+    size_t topicLength = strlen(topic);
+    size_t remaining = 2 + topicLength + 2 + payloadLength;
+    size_t lengthBytes = remainingLengthSize(remaining);
+    size_t start = MQTT_PUBLISH_HEADER_MAX - 1 - lengthBytes;
+    
+    putFixedHeader(buffer + start, 1 + lengthBytes,
+                   (MQTT_PUBLISH << 4) | (dup ? 0x08 : 0) | 0x02, remaining);  // QoS 1
+    size_t len = putString(buffer, MQTT_PUBLISH_HEADER_MAX, topic);
+    buffer[len++] = packetId >> 8;
+    buffer[len++] = packetId & 0xFF;
+    return start;
+  }
+  
+  /**
+   * @brief Build a header-only packet (PINGREQ, DISCONNECT)
+   * 
+   * @return Length of the packet (2)
+   */
+  static size_t buildEmpty(uint8_t* buffer, MqttPacketType type) {
+    buffer[0] = type << 4;
+    buffer[1] = 0;
+    return 2;
+  }
+  
+  /**
+   * @brief Number of bytes encoding a remaining length
+   */
+  static size_t remainingLengthSize(size_t remaining) {
+    size_t n = 1;
+    while (remaining >= 128) {
+      remaining >>= 7;
+      n++;
+    }
+    return n;
+  }
+
+private:
+  /**
+   * @brief Write the type byte and the variable-length remaining length
+   * 
+   * @return Length of the fixed header, or 0 if it does not fit
+   */
+  static size_t putFixedHeader(uint8_t* buffer, size_t size, uint8_t first, size_t remaining) {
+    if (remaining > 268435455UL || size < 1 + remainingLengthSize(remaining)) {
+      return 0;
+    }
+    size_t len = 0;
+    buffer[len++] = first;
+    do {
+      uint8_t digit = remaining % 128;
+      remaining /= 128;
+      buffer[len++] = digit | (remaining > 0 ? 0x80 : 0);
+    } while (remaining > 0);
+    return len;
+  }
+  
+  /**
+   * @brief Write a length-prefixed UTF-8 string (space already checked)
+   */
+  static size_t putString(uint8_t* buffer, size_t len, const char* text) {
+    size_t n = strlen(text);
+    buffer[len++] = n >> 8;
+    buffer[len++] = n & 0xFF;
+    memcpy(buffer + len, text, n);
+    return len + n;
+  }
+};
+
+/**
+ * @class MqttReader
+ * @brief Reassembles incoming packets from a byte stream
+ */
+class MqttReader {
+private:
+  enum State {
+    STATE_TYPE,
+    STATE_LENGTH,
+    STATE_BODY
+  };
+  
+  State state;
+  uint8_t type;
+  uint32_t remaining;
+  uint32_t received;
+  uint8_t lengthShift;
+  uint8_t body[MQTT_READ_MAX];
+  bool malformed;
+
+public:
+  MqttReader() {
+    reset();
+  }
+  
+  /**
+   * @brief Drop any partial packet, e.g. after a reconnect
+   */
+  void reset() {
+    state = STATE_TYPE;
+    type = 0;
+    remaining = 0;
+    received = 0;
+    lengthShift = 0;
+    malformed = false;
+  }
+  
+  /**
+   * @brief Consume bytes until one packet is complete
+   * 
+   * @param data Bytes received
+   * @param length Number of bytes
+   * @param used Number of bytes consumed
+   * @return true if a packet is complete: read it with getType() and
+   * getBody(), then feed the rest of the bytes
+   */
+  bool feed(const uint8_t* data, size_t length, size_t& used) {
+    used = 0;
+    while (used < length) {
+      uint8_t c = data[used++];
+      switch (state) {
+        case STATE_TYPE:
+          type = c;
+          remaining = 0;
+          received = 0;
+          lengthShift = 0;
+          state = STATE_LENGTH;
+          break;
+        
+        case STATE_LENGTH:
+          remaining |= (uint32_t)(c & 0x7F) << lengthShift;
+          lengthShift += 7;
+          if (c & 0x80) {
+            if (lengthShift >= 28) malformed = true;
+            break;
+          }
+          if (remaining == 0) {
+            state = STATE_TYPE;
+            return true;
+          }
+          state = STATE_BODY;
+          break;
+        
+        case STATE_BODY:
+          if (received < MQTT_READ_MAX) {
+            body[received] = c;
+          }
+          if (++received == remaining) {
+            state = STATE_TYPE;
+            return true;
+          }
+          break;
+      }
+    }
+    return false;
+  }
+  
+  /**
+   * @brief Type of the last complete packet
+   */
+  MqttPacketType getType() const {
+    return (MqttPacketType)(type >> 4);
+  }
+  
+  /**
+   * @brief Flags of the last complete packet (low nibble)
+   */
+  uint8_t getFlags() const {
+    return type & 0x0F;
+  }
+  
+  /**
+   * @brief Body of the last complete packet, first MQTT_READ_MAX bytes
+   */
+  const uint8_t* getBody() const {
+    return body;
+  }
+  
+  /**
+   * @brief Full body length of the last complete packet
+   */
+  uint32_t getBodyLength() const {
+    return remaining;
+  }
+  
+  /**
+   * @brief Remaining length encoded on more than 4 bytes
+   */
+  bool isMalformed() const {
+    return malformed;
+  }
+};
+
+#endif // MQTT_PACKET_H
@@ -1,6 +1,6 @@
 /**
  * @file NetworkManager.h
- * @brief Simplified Network Manager for initial testing
+ * @brief Network Manager: WiFi link, uploads and HTTP API
  * @author Your Name
  * @version 1.0
  * @date 2025
@@ -10,34 +10,138 @@
 #define NETWORK_MANAGER_H
 
 #include "config.h"
+#include "Timebase.h"
 #include "SensorManager.h"
+#include "HttpParser.h"
+#include "Settings.h"
+#include "WifiConnection.h"
+#include "DnsCache.h"
+#include "SntpResponder.h"
+#include "MqttClient.h"
+#include "TelemetryCbor.h"
+#include "Lzss.h"
+#include "SseBroadcaster.h"
+#include "ApiSnapshot.h"
+#include "HistoryLog.h"
+#include <WiFi.h>
+
+/**
+ * @class BufferedPrint
+ * @brief Groups small writes into HTTP_WRITE_BUFFER-byte socket writes
+ * 
+ * Each WiFiClient write is a round trip to the WiFi module, so a
+ * response streamed a few bytes at a time is written in chunks instead.
+ */
+class BufferedPrint : public Print {
+private:
+  Print& out;
+  uint8_t buffer[HTTP_WRITE_BUFFER];
+  size_t len;
+
+public:
+  explicit BufferedPrint(Print& output) : out(output), len(0) {}
+  
+  size_t write(uint8_t c) override {
+    buffer[len++] = c;
+    if (len == sizeof(buffer)) {
+      flush();
+    }
+    return 1;
+  }
+  
+  using Print::write;
+  
+  void flush() {
+    if (len > 0) {
+      out.write(buffer, len);
+      len = 0;
+    }
+  }
+};
+
+/**
+ * @struct HistoryQuery
+ * @brief Parameters of a GET API_HISTORY_ENDPOINT request
+ */
+struct HistoryQuery {
+  uint32_t from;
+  uint32_t to;
+  uint32_t since;
+  uint32_t points;
+  HistoryField field;
+  bool binary;              ///< ?format=bin
+  bool compress;            ///< ?compress=lzss
+};
 
 /**
  * @class NetworkManager
- * @brief Simplified network manager for testing
+ * @brief Keeps WiFi up, uploads sensor data and serves the HTTP API
  */
 class NetworkManager {
+  friend class Benchmark;
+  friend class HistoryCheck;
+
 private:
-  bool connected;
-  unsigned long lastConnectionCheck;
+  WifiS3Radio wifiRadio;
+  WifiConnection wifi;
+  UdpDnsTransport dnsTransport;
+  DnsCache dns;
+  UdpSntpPort sntpPort;
+  SntpResponder sntp;
+  TcpMqttTransport mqttTransport;
+  MqttClient mqtt;
+  uint64_t lastMqttReport;
+  
+  // Web server (one client at a time, parsed incrementally)
+  WiFiServer server;
+  WiFiClient client;
+  HttpRequestParser request;
+  uint64_t clientStart;
+  bool serverStarted;
+  
+  // API_ENDPOINT bodies, rebuilt once per sensor reading
+  ApiSnapshot dataJson;
+  ApiSnapshot dataCbor;
+  unsigned long dataRequests;
+  unsigned long notModified;
+  
+  // Averaged readings served by API_HISTORY_ENDPOINT
+  HistoryLog history;
+  
+  // Subscribers of API_EVENTS_ENDPOINT, fed from one shared buffer
+  TcpSseStream eventStreams[SSE_MAX_CLIENTS];
+  SseBroadcaster events;
 
 public:
   /**
    * @brief Constructor
    */
-  NetworkManager() : connected(false), lastConnectionCheck(0) {}
+  NetworkManager() :
+    wifi(&wifiRadio, WIFI_SSID, WIFI_PASSWORD),
+    dns(&dnsTransport),
+    sntp(&sntpPort),
+    mqtt(&mqttTransport, TELEMETRY_LZSS ? encodeCompressedBatch : rawBatchEncoder(), MQTT_TOPIC),
+    lastMqttReport(0),
+    server(WEB_SERVER_PORT),
+    clientStart(0),
+    serverStarted(false),
+    dataRequests(0),
+    notModified(0) {}
   
   /**
    * @brief Initialize network manager
+   * 
+   * Starts the first WiFi attempt and returns at once; the connection is
+   * completed by update().
    */
   bool init() {
     DEBUG_PRINTLN("Initializing NetworkManager...");
     
-    // Simulate network connection attempt
-    connected = true; // For testing, assume we're connected
-    lastConnectionCheck = millis();
-    
-    DEBUG_PRINTLN("NetworkManager initialized (test mode - simulated connection)");
+    if (WiFi.status() == WL_NO_MODULE) {
+      DEBUG_PRINTLN("WiFi module not found");
+      return false;
+    }
+    wifi.begin();
     return true;
   }
   
@@ -45,52 +149,981 @@ public:
    * @brief Check if connected to network
    */
   bool isConnected() const {
-    return connected;
+    return wifi.isConnected();
   }
   
   /**
-   * @brief Get network status
+   * @brief Get network status (WifiState)
    */
   int getStatus() const {
-    return connected ? 1 : 0;
+    return (int)wifi.getState();
   }
   
   /**
-   * @brief Send sensor data to remote server
+   * @brief Check whether the connection attempts since the last
+   * connection have failed at least once
    */
-  bool sendSensorData(SensorData data) {
-    if (!connected) {
-      DEBUG_PRINTLN("Cannot send data - not connected");
+  bool hasConnectFailed() const {
+    return wifi.hasFailed();
+  }
+  
+  /**
+   * @brief Check and clear the "link came back after an outage" flag
+   */
+  bool takeReconnected() {
+    return wifi.takeReconnected();
+  }
+  
+  /**
+   * @brief Get the address of a host from the DNS cache
+   * 
+   * Never waits: a missing or expired entry is refreshed in the
+   * background, and an expired address is still returned meanwhile.
+   * 
+   * @param host Host name
+   * @param address Cached address, set only when true is returned
+   * @return false if no address is known yet
+   */
+  bool resolveHost(const char* host, IPAddress& address) {
+    return dns.lookup(host, address, Timebase::millis64());
+  }
+  
+  /**
+   * @brief Get the DNS cache shared with the NTP client
+   */
+  DnsCache* getDnsCache() {
+    return &dns;
+  }
+  
+  /**
+   * @brief Answer SNTP requests from the LAN without blocking
+   * 
+   * Should be called every loop iteration; answers at most
+   * SNTP_MAX_PER_POLL requests per call.
+   * 
+   * @param reference Last NTP synchronization, or nullptr if the clock is
+   * not synchronized (requests are then dropped)
+   * @return Number of requests answered
+   */
+  uint8_t serveSntp(const NtpReference* reference) {
+    if (!wifi.isConnected() || !sntpPort.begin()) {
+      return 0;
+    }
+    return sntp.poll(reference);
+  }
+  
+  /**
+   * @brief Get the number of SNTP requests answered
+   */
+  unsigned long getSntpServedCount() const {
+    return sntp.getServedCount();
+  }
+  
+  /**
+   * @brief Get connect and outage statistics
+   */
+  const WifiMetrics& getWifiMetrics() const {
+    return wifi.getMetrics();
+  }
+  
+  /**
+   * @brief Get number of sensor messages acknowledged by the broker
+   */
+  unsigned long getUploadCount() const {
+    return mqtt.getMetrics().acked;
+  }
+  
+  /**
+   * @brief Get total bytes written to the broker
+   */
+  unsigned long getBytesSent() const {
+    return mqtt.getMetrics().bytesSent;
+  }
+  
+  /**
+   * @brief Get MQTT delivery statistics
+   */
+  const MqttMetrics& getMqttMetrics() const {
+    return mqtt.getMetrics();
+  }
+  
+  /**
+   * @brief Queue sensor data for the MQTT broker
+   * 
+   * Never waits: samples are batched and published by update(), and stay
+   * queued while WiFi or the broker is down.
+   * 
+   * @param data Sensor readings
+   * @param time UTC epoch of the readings, 0 if the clock is not set
+   * @return false if the sample was dropped (queue full)
+   */
+  bool sendSensorData(const SensorData& data, uint32_t time) {
+    MqttSample sample;
+    sample.time = time;
+    sample.data = data;
+    return mqtt.enqueue(sample, Timebase::millis64());
+  }
+  
+  /**
+   * @brief Add sensor readings to the history served by the API
+   * 
+   * @param data Sensor readings
+   * @param time UTC epoch of the readings, 0 if the clock is not set (the
+   * readings are then not kept)
+   */
+  void recordHistory(const SensorData& data, uint32_t time) {
+    history.add(data, time);
+  }
+  
+  /**
+   * @brief Push new sensor readings to the event subscribers
+   * 
+   * Event "sample": {"time":...,"data":{...}}, data as served by
+   * API_ENDPOINT.
+   */
+  void pushSensorData(const SensorData& data, uint32_t time) {
+    char json[JSON_BUFFER_SIZE];
+    size_t len = 0;
+    if (!appendText(json, sizeof(json), len, "{\"time\":") ||
+        !appendUnsigned(json, sizeof(json), len, time) ||
+        !appendText(json, sizeof(json), len, ",\"data\":")) {
+      return;
+    }
+    size_t n = serializeSensorData(data, json + len, sizeof(json) - len);
+    if (n == 0) return;
+    len += n;
+    if (!appendText(json, sizeof(json), len, "}")) return;
+    events.publish("sample", json, len, Timebase::millis64());
+  }
+  
+  /**
+   * @brief Push the outcome of an NTP synchronization
+   * 
+   * Event "sync": {"ok":true,"time":...}, time 0 if the clock is not set.
+   */
+  void pushTimeSync(bool ok, uint32_t time) {
+    char json[48];
+    size_t len = 0;
+    if (appendText(json, sizeof(json), len, ok ? "{\"ok\":true,\"time\":" : "{\"ok\":false,\"time\":") &&
+        appendUnsigned(json, sizeof(json), len, time) &&
+        appendText(json, sizeof(json), len, "}")) {
+      events.publish("sync", json, len, Timebase::millis64());
+    }
+  }
+  
+  /**
+   * @brief Push an alert raised or cleared
+   * 
+   * Event "alert": {"type":"alarm","active":true,"value":0}.
+   * 
+   * @param type Alert name, e.g. "alarm" or "airQuality"
+   * @param active true when raised, false when cleared
+   * @param value Reading behind the alert, 0 if none
+   */
+  void pushAlert(const char* type, bool active, unsigned long value) {
+    char json[64];
+    size_t len = 0;
+    if (appendText(json, sizeof(json), len, "{\"type\":\"") &&
+        appendText(json, sizeof(json), len, type) &&
+        appendText(json, sizeof(json), len, active ? "\",\"active\":true,\"value\":" :
+                                                     "\",\"active\":false,\"value\":") &&
+        appendUnsigned(json, sizeof(json), len, value) &&
+        appendText(json, sizeof(json), len, "}")) {
+      events.publish("alert", json, len, Timebase::millis64());
+    }
+  }
+  
+  /**
+   * @brief Get the number of API_ENDPOINT requests answered
+   */
+  unsigned long getDataRequestCount() const {
+    return dataRequests;
+  }
+  
+  /**
+   * @brief Get how many of them were answered 304 Not Modified
+   */
+  unsigned long getNotModifiedCount() const {
+    return notModified;
+  }
+  
+  /**
+   * @brief Get how many times the API_ENDPOINT body was serialized
+   */
+  unsigned long getDataBuildCount() const {
+    return dataJson.getBuildCount() + dataCbor.getBuildCount();
+  }
+  
+  /**
+   * @brief Get event fan-out statistics
+   */
+  const SseMetrics& getEventMetrics() const {
+    return events.getMetrics();
+  }
+  
+  /**
+   * @brief Encode a batch of samples as the MQTT payload
+   * 
+   * {"samples":[{"time":...,"data":{...}},...]}, each data object as
+   * served by API_ENDPOINT.
+   * 
+   * @return Payload length, or 0 if the buffer is too small
+   */
+  static size_t encodeBatch(const MqttSample* samples, uint8_t count, uint8_t* buffer, size_t size) {
+    char* text = (char*)buffer;
+    size_t len = 0;
+    if (!appendText(text, size, len, "{\"samples\":[")) return 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (!appendText(text, size, len, i > 0 ? ",{\"time\":" : "{\"time\":") ||
+          !appendUnsigned(text, size, len, samples[i].time) ||
+          !appendText(text, size, len, ",\"data\":")) {
+        return 0;
+      }
+      size_t n = serializeSensorData(samples[i].data, text + len, size - len);
+      if (n == 0) return 0;
+      len += n;
+      if (!appendText(text, size, len, "}")) return 0;
+    }
+    if (!appendText(text, size, len, "]}")) return 0;
+    return len;
+  }
+  
+  /**
+   * @brief Batch encoder for TELEMETRY_FORMAT, before compression
+   */
+  static MqttBatchEncoder rawBatchEncoder() {
+    return TELEMETRY_FORMAT == TELEMETRY_CBOR ? TelemetryCbor::encodeBatch : encodeBatch;
+  }
+  
+  /**
+   * @brief Encode a batch in TELEMETRY_FORMAT, then LZSS-compress it
+   * 
+   * Works in the one buffer: the raw payload is written after its first
+   * quarter and compressed to the front. The encoder reads each byte
+   * before it writes at most 9/8 of a byte per input byte, so the output
+   * never catches up with the input still to be read.
+   * 
+   * @return Compressed length, or 0 if the buffer is too small
+   */
+  static size_t encodeCompressedBatch(const MqttSample* samples, uint8_t count, uint8_t* buffer, size_t size) {
+    size_t offset = size / 4;
+    size_t length = rawBatchEncoder()(samples, count, buffer + offset, size - offset);
+    if (length == 0) {
+      return 0;
+    }
+    BoundedPrint out(buffer, size);
+    LzssEncoder encoder(out);
+    encoder.write(buffer + offset, length);
+    encoder.finish();
+    return out.length();
+  }
+  
+  /**
+   * @brief Serialize sensor data as the JSON payload of API_ENDPOINT
+   * 
+   * Writes a null-terminated JSON object into the caller's buffer without
+   * any heap allocation.
+   * 
+   * @param data Sensor readings to serialize
+   * @param buffer Destination buffer
+   * @param size Size of the destination buffer
+   * @return Length of the JSON text, or 0 if the buffer is too small
+   */
+  static size_t serializeSensorData(const SensorData& data, char* buffer, size_t size) {
+    size_t len = 0;
+    bool ok = appendText(buffer, size, len, "{\"tempIndoor\":") &&
+              appendFixed(buffer, size, len, data.tempIndoor, 1) &&
+              appendText(buffer, size, len, ",\"tempOutdoor\":") &&
+              appendFixed(buffer, size, len, data.tempOutdoor, 1) &&
+              appendText(buffer, size, len, ",\"humidityIndoor\":") &&
+              appendFixed(buffer, size, len, data.humidityIndoor, 1) &&
+              appendText(buffer, size, len, ",\"humidityOutdoor\":") &&
+              appendFixed(buffer, size, len, data.humidityOutdoor, 1) &&
+              appendText(buffer, size, len, ",\"pressure\":") &&
+              appendFixed(buffer, size, len, data.pressure, 2) &&
+              appendText(buffer, size, len, ",\"airQuality\":") &&
+              appendFixed(buffer, size, len, data.airQuality, 0) &&
+              appendText(buffer, size, len, ",\"valid\":") &&
+              appendText(buffer, size, len, data.isValid ? "true}" : "false}");
+    
+    if (!ok) {
+      if (size > 0) buffer[0] = '\0';
+      return 0;
+    }
+    return len;
+  }
+  
+  /**
+   * @brief Serve pending HTTP API requests
+   * 
+   * Non-blocking: reads whatever bytes have arrived, feeds them to the
+   * request parser and answers once the request is complete. Handles
+   * GET API_ENDPOINT, GET API_EVENTS_ENDPOINT (kept open as an event
+   * stream) and GET/POST API_SETTINGS_ENDPOINT.
+   * 
+   * @param data Latest sensor readings
+   * @param sequence Their sequence number (SensorManager::getSequence())
+   * @param settings Current settings, updated by a valid settings write
+   * @return true if the settings were changed
+   */
+  bool handleWebClients(const SensorData& data, uint32_t sequence, Settings& settings) {
+    if (!wifi.isConnected()) {
+      if (client) {
+        client.stop();
+      }
+      events.closeAll();
       return false;
     }
     
-    // Simulate data sending
-    static unsigned long lastDataSend = 0;
-    if (millis() - lastDataSend > 30000) { // Every 30 seconds
-      DEBUG_PRINTLN("Sending sensor data to server (simulated)");
-      DEBUG_PRINT("  Temperature: ");
-      DEBUG_PRINT(data.tempIndoor);
-      DEBUG_PRINT("°C, Air Quality: ");
-      DEBUG_PRINT(data.airQuality);
-      DEBUG_PRINTLN(" PPM");
-      lastDataSend = millis();
+    if (!serverStarted) {
+      server.begin();
+      serverStarted = true;
     }
     
-    return true;
+    if (!client) {
+      client = server.available();
+      if (!client) {
+        return false;
+      }
+      request.reset();
+      clientStart = Timebase::millis64();
+    }
+    
+    // Consume the bytes that have arrived, without waiting for more
+    uint8_t buffer[HTTP_READ_CHUNK];
+    int available = client.available();
+    while (available > 0 && request.getResult() == HTTP_PARSE_INCOMPLETE) {
+      int n = client.read(buffer, available < HTTP_READ_CHUNK ? available : HTTP_READ_CHUNK);
+      if (n <= 0) {
+        break;
+      }
+      request.feed(buffer, n);
+      available -= n;
+    }
+    
+    bool settingsChanged = false;
+    switch (request.getResult()) {
+      case HTTP_PARSE_COMPLETE:
+        settingsChanged = routeRequest(data, sequence, settings);
+        if (client) {
+          client.stop();  // Unless handed over to the event subscribers
+        }
+        break;
+        
+      case HTTP_PARSE_ERROR:
+        sendResponse(request.getErrorStatus(), nullptr, 0);
+        client.stop();
+        break;
+        
+      case HTTP_PARSE_INCOMPLETE:
+        if (!client.connected() || Timebase::millis64() - clientStart > HTTP_CLIENT_TIMEOUT) {
+          client.stop();
+        }
+        break;
+    }
+    
+    return settingsChanged;
   }
   
   /**
    * @brief Update network status
+   * 
+   * Advances the WiFi state machine, collects DNS answers and publishes
+   * queued samples; never waits for the link, the resolver or the broker.
    */
   void update() {
-    unsigned long currentTime = millis();
+    uint64_t now = Timebase::millis64();
+    wifi.update();
+    dns.update(now);
     
-    // Check connection status periodically
-    if (currentTime - lastConnectionCheck > 60000) { // Every minute
-      // In real implementation, check actual WiFi status
-      DEBUG_PRINTLN("Network status check (simulated - OK)");
-      lastConnectionCheck = currentTime;
+    // Broker address only needed to open a session
+    IPAddress broker;
+    bool brokerKnown = false;
+    if (!mqtt.isConnected() && mqtt.getState() != MQTT_STATE_WAIT_CONNACK) {
+      brokerKnown = broker.fromString(MQTT_BROKER) || dns.lookup(MQTT_BROKER, broker, now);
     }
+    mqtt.update(now, wifi.isConnected(), brokerKnown ? &broker : nullptr);
+    events.update(now);
+    
+#if STATS_REPORTS
+    if (now - lastMqttReport >= MQTT_REPORT_INTERVAL) {
+      reportMqtt();
+      lastMqttReport = now;
+    }
+#endif
+  }
+
+private:
+  /**
+   * @brief Writes the points of a history query as [time,value] pairs
+   */
+  class HistoryJsonSink : public HistorySink {
+  private:
+    Print& out;
+    HistoryField field;
+    bool first;
+  
+  public:
+    HistoryJsonSink(Print& output, HistoryField series) :
+      out(output),
+      field(series),
+      first(true) {}
+    
+    void point(const HistoryRecord& record, uint32_t sequence) override {
+      (void)sequence;
+      char text[32];
+      size_t len = 0;
+      int16_t value = record.values[field];
+      appendText(text, sizeof(text), len, first ? "[" : ",[");
+      appendUnsigned(text, sizeof(text), len, record.time);
+      appendText(text, sizeof(text), len, ",");
+      if (field == HISTORY_AIR_QUALITY) {
+        appendFixed(text, sizeof(text), len, value, 0);
+      } else {
+        appendFixed(text, sizeof(text), len, value / 10.0f, 1);
+      }
+      appendText(text, sizeof(text), len, "]");
+      out.write((const uint8_t*)text, len);
+      first = false;
+    }
+  };
+  
+  /**
+   * @brief Print the MQTT delivery statistics as an "MQTT-STATS {json}" line
+   * 
+   * Called every MQTT_REPORT_INTERVAL in STATS_REPORTS builds only.
+   */
+  void reportMqtt() {
+    const MqttMetrics& m = mqtt.getMetrics();
+    if (m.published == 0) return;
+    Serial.print("MQTT-STATS {\"published\":");
+    Serial.print(m.published);
+    Serial.print(",\"acked\":");
+    Serial.print(m.acked);
+    Serial.print(",\"samples\":");
+    Serial.print(m.samplesAcked);
+    Serial.print(",\"retransmits\":");
+    Serial.print(m.retransmits);
+    Serial.print(",\"dropped\":");
+    Serial.print(m.dropped);
+    Serial.print(",\"pending\":");
+    Serial.print(mqtt.getPendingSamples());
+    Serial.print(",\"ack_avg_ms\":");
+    Serial.print(m.acked > 0 ? (unsigned long)(m.ackLatencyTotal / m.acked) : 0UL);
+    Serial.print(",\"ack_max_ms\":");
+    Serial.print((unsigned long)m.ackLatencyMax);
+    Serial.println("}");
+  }
+  
+  /**
+   * @brief Answer a completely parsed request
+   * 
+   * @return true if the settings were changed
+   */
+  bool routeRequest(const SensorData& data, uint32_t sequence, Settings& settings) {
+    char body[JSON_BUFFER_SIZE];
+    
+    if (request.pathEquals(API_ENDPOINT)) {
+      if (request.getMethod() != HTTP_METHOD_GET) {
+        sendResponse(405, nullptr, 0);
+        return false;
+      }
+      dataRequests++;
+      // ?format=cbor: compact binary, see TelemetryCbor.h
+      bool cbor = hasQueryPair(request.getQuery(), "format=cbor");
+      const ApiSnapshot& snapshot = getDataSnapshot(data, sequence, cbor);
+      if (snapshot.getLength() == 0) {
+        sendResponse(500, nullptr, 0);
+        return false;
+      }
+      
+      char etag[API_ETAG_SIZE];
+      snapshot.formatETag(etag, wantsLzss() ? "z" : "");
+      if (request.ifNoneMatch(etag)) {
+        notModified++;
+        sendResponse(304, nullptr, 0, nullptr, etag);
+        return false;
+      }
+      sendResponse(200, snapshot.getBody(), snapshot.getLength(),
+                   cbor ? "application/cbor" : "application/json", etag);
+      return false;
+    }
+    
+    if (request.pathEquals(API_HISTORY_ENDPOINT)) {
+      if (request.getMethod() != HTTP_METHOD_GET) {
+        sendResponse(405, nullptr, 0);
+        return false;
+      }
+      sendHistory();
+      return false;
+    }
+    
+    if (request.pathEquals(API_EVENTS_ENDPOINT)) {
+      if (request.getMethod() != HTTP_METHOD_GET) {
+        sendResponse(405, nullptr, 0);
+        return false;
+      }
+      subscribeEvents();
+      return false;
+    }
+    
+    if (request.pathEquals(API_SETTINGS_ENDPOINT)) {
+      bool changed = false;
+      if (request.getMethod() == HTTP_METHOD_POST) {
+        // Parse into a copy so an invalid write changes nothing
+        Settings updated = settings;
+        SettingsParser parser(updated);
+        parser.feed(request.getBody(), request.getBodyLength());
+        if (!parser.finish()) {
+          sendResponse(400, nullptr, 0);
+          return false;
+        }
+        settings = updated;
+        changed = true;
+        DEBUG_PRINT("Settings updated via API: ");
+        DEBUG_PRINTLN(parser.getAppliedCount());
+      } else if (request.getMethod() != HTTP_METHOD_GET) {
+        sendResponse(405, nullptr, 0);
+        return false;
+      }
+      size_t length = settings.toJson(body, sizeof(body));
+      sendResponse(length > 0 ? 200 : 500, body, length);
+      return changed;
+    }
+    
+    sendResponse(404, nullptr, 0);
+    return false;
+  }
+  
+  /**
+   * @brief Answer GET API_HISTORY_ENDPOINT
+   * 
+   * ?from=&to= (UTC epoch, inclusive), ?since= (last sequence number
+   * already received), ?points= (at most, HISTORY_DEFAULT_POINTS by
+   * default) and ?field= (series the downsampling follows, tempIndoor by
+   * default). The JSON points are written as they are chosen, so the body
+   * ends with the connection; ?format=bin sends every series as columns
+   * (see writeHistoryBinary), whose length is known up front.
+   */
+  void sendHistory() {
+    HistoryQuery params;
+    if (!parseHistoryQuery(request.getQuery(), params)) {
+      sendResponse(400, nullptr, 0);
+      return;
+    }
+    writeHistoryAnswer(client, history, params);
+  }
+  
+  /**
+   * @brief Read the parameters of a history request, with their defaults
+   * 
+   * @return false if one is malformed, to be answered 400
+   */
+  static bool parseHistoryQuery(const char* query, HistoryQuery& params) {
+    params.from = 0;
+    params.to = 0xFFFFFFFFUL;
+    params.since = 0;
+    params.points = HISTORY_DEFAULT_POINTS;
+    char fieldName[20] = "tempIndoor";
+    
+    bool ok = queryUnsigned(query, "from", params.from) && queryUnsigned(query, "to", params.to) &&
+              queryUnsigned(query, "since", params.since) && queryUnsigned(query, "points", params.points) &&
+              queryText(query, "field", fieldName, sizeof(fieldName));
+    params.field = HistoryLog::fieldFromName(fieldName);
+    if (!ok || params.field == HISTORY_FIELD_COUNT || params.points < 3) {
+      return false;
+    }
+    if (params.points > HISTORY_MAX_POINTS) params.points = HISTORY_MAX_POINTS;
+    params.binary = hasQueryPair(query, "format=bin");
+    params.compress = hasQueryPair(query, "compress=lzss");
+    return true;
+  }
+  
+  /**
+   * @brief Write the status line, headers and body of a history answer
+   * 
+   * @param out The client, or any Print standing in for it
+   */
+  static void writeHistoryAnswer(Print& out, const HistoryLog& log, const HistoryQuery& params) {
+    const char* contentType = params.binary ? "application/octet-stream" : "application/json";
+    HistoryRange range = log.select(params.from, params.to, params.since);
+    
+    // Headers and body in HTTP_WRITE_BUFFER-byte writes
+    BufferedPrint buffered(out);
+    buffered.println("HTTP/1.1 200 OK");
+    if (params.compress) {
+      buffered.println("Content-Type: application/x-lzss");
+      buffered.print("X-Content-Type: ");
+      buffered.println(contentType);
+    } else {
+      buffered.print("Content-Type: ");
+      buffered.println(contentType);
+      if (params.binary) {
+        buffered.print("Content-Length: ");
+        buffered.println((unsigned long)historyBinarySize(HistoryLog::keptCount(range, params.points)));
+      }
+    }
+    buffered.println("Cache-Control: no-cache");
+    buffered.println("Connection: close");
+    buffered.println();
+    
+    LzssEncoder encoder(buffered);
+    Print& body = params.compress ? (Print&)encoder : (Print&)buffered;
+    if (params.binary) {
+      writeHistoryBinary(body, log, range, params.field, params.points);
+    } else {
+      writeHistoryJson(body, log, range, params.field, params.points);
+    }
+    if (params.compress) {
+      encoder.finish();
+    }
+    buffered.flush();
+  }
+  
+  /**
+   * @brief Stream a history query as JSON
+   * 
+   * {"field":"tempIndoor","last":<sequence>,"matched":<records>,
+   * "points":[[time,value],...]}; pass "last" as ?since= to get only the
+   * records stored after this answer.
+   * 
+   * @return Number of points written
+   */
+  static uint16_t writeHistoryJson(Print& out, const HistoryLog& log, const HistoryRange& range,
+                                   HistoryField field, uint16_t maxPoints) {
+    char text[48];
+    size_t len = 0;
+    appendText(text, sizeof(text), len, "{\"field\":\"");
+    appendText(text, sizeof(text), len, HistoryLog::fieldName(field));
+    appendText(text, sizeof(text), len, "\",\"last\":");
+    appendUnsigned(text, sizeof(text), len, range.lastSequence);
+    out.write((const uint8_t*)text, len);
+    len = 0;
+    appendText(text, sizeof(text), len, ",\"matched\":");
+    appendUnsigned(text, sizeof(text), len, range.count);
+    appendText(text, sizeof(text), len, ",\"points\":[");
+    out.write((const uint8_t*)text, len);
+    
+    HistoryJsonSink sink(out, field);
+    uint16_t written = log.downsample(range, field, maxPoints, sink);
+    out.write((const uint8_t*)"]}", 2);
+    return written;
+  }
+  
+  /**
+   * @brief Stream a history query as packed columns
+   * 
+   * HISTORY_BINARY_HEADER bytes (see HistoryLog.h), then the times of the
+   * points as uint32 and each series as int16, little-endian, copied from
+   * the records as stored. The points are chosen on one series like the
+   * JSON, but every series is sent, so one request draws every graph.
+   * A browser maps the columns into typed arrays without parsing.
+   * 
+   * @return Number of points written
+   */
+  static uint16_t writeHistoryBinary(Print& out, const HistoryLog& log, const HistoryRange& range,
+                                     HistoryField field, uint16_t maxPoints) {
+    HistorySelection selection(log, range);
+    uint16_t points = log.downsample(range, field, maxPoints, selection);
+    
+    uint8_t header[HISTORY_BINARY_HEADER] = {
+      HISTORY_BINARY_MAGIC, HISTORY_BINARY_VERSION, (uint8_t)field, HISTORY_FIELD_COUNT,
+      (uint8_t)range.lastSequence, (uint8_t)(range.lastSequence >> 8),
+      (uint8_t)(range.lastSequence >> 16), (uint8_t)(range.lastSequence >> 24),
+      (uint8_t)range.count, (uint8_t)(range.count >> 8),
+      (uint8_t)points, (uint8_t)(points >> 8)
+    };
+    out.write(header, sizeof(header));
+    
+    for (uint16_t i = 0; i < range.count; i++) {
+      if (selection.isKept(i)) {
+        out.write((const uint8_t*)&log.getRecord(range.first + i).time, sizeof(uint32_t));
+      }
+    }
+    for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; f++) {
+      for (uint16_t i = 0; i < range.count; i++) {
+        if (selection.isKept(i)) {
+          out.write((const uint8_t*)&log.getRecord(range.first + i).values[f], sizeof(int16_t));
+        }
+      }
+    }
+    return points;
+  }
+  
+  /**
+   * @brief Length of a binary history answer with this many points
+   */
+  static size_t historyBinarySize(uint16_t points) {
+    return HISTORY_BINARY_HEADER + (size_t)points * (sizeof(uint32_t) + HISTORY_FIELD_COUNT * sizeof(int16_t));
+  }
+  
+  /**
+   * @brief API_ENDPOINT body for these readings, serialized only if they
+   * changed since the last request
+   */
+  const ApiSnapshot& getDataSnapshot(const SensorData& data, uint32_t sequence, bool cbor) {
+    ApiSnapshot& snapshot = cbor ? dataCbor : dataJson;
+    if (!snapshot.isCurrent(sequence)) {
+      size_t length = cbor ?
+        TelemetryCbor::encodeSample(data, (uint8_t*)snapshot.getBuffer(), snapshot.getCapacity()) :
+        serializeSensorData(data, snapshot.getBuffer(), snapshot.getCapacity());
+      snapshot.store(length, sequence);
+    }
+    return snapshot;
+  }
+  
+  /**
+   * @brief Answer an event stream request and hand the client over
+   * 
+   * The connection stays open: it moves to a free subscriber slot, so
+   * the server can accept the next request.
+   */
+  void subscribeEvents() {
+    TcpSseStream* stream = nullptr;
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS && !stream; i++) {
+      if (!eventStreams[i].isOpen()) {
+        stream = &eventStreams[i];
+      }
+    }
+    if (!stream) {
+      sendResponse(503, nullptr, 0);
+      return;
+    }
+    
+    client.println("HTTP/1.1 200 OK");
+    client.println("Content-Type: text/event-stream");
+    client.println("Cache-Control: no-cache");
+    client.println("Connection: keep-alive");
+    client.println();
+    client.print("retry: ");
+    client.println(SSE_RETRY_DELAY);
+    client.println();
+    
+    stream->attach(client);
+    events.subscribe(stream);
+    client = WiFiClient();
+  }
+  
+  /**
+   * @brief Send a complete response and its body (JSON by default)
+   * 
+   * With ?compress=lzss in the request, the body is streamed through
+   * LzssEncoder as application/x-lzss, its own type in X-Content-Type;
+   * the compressed length is not known up front, so it ends with the
+   * connection instead of a Content-Length.
+   * 
+   * @param etag Validator of the body, nullptr for none; the browser is
+   * then asked to revalidate its copy on every use (no-cache)
+   */
+  void sendResponse(uint16_t status, const char* body, size_t length,
+                    const char* contentType = "application/json",
+                    const char* etag = nullptr) {
+    bool compress = length > 0 && wantsLzss();
+    
+    client.print("HTTP/1.1 ");
+    client.print(status);
+    client.print(" ");
+    client.println(statusText(status));
+    if (etag) {
+      client.print("ETag: ");
+      client.println(etag);
+      client.println("Cache-Control: no-cache");
+    }
+    if (compress) {
+      client.println("Content-Type: application/x-lzss");
+      client.print("X-Content-Type: ");
+      client.println(contentType);
+    } else if (status != 304) {  // No body to describe
+      if (length > 0) {
+        client.print("Content-Type: ");
+        client.println(contentType);
+      }
+      client.print("Content-Length: ");
+      client.println((unsigned long)length);
+    }
+    client.println("Connection: close");
+    client.println();
+    
+    if (compress) {
+      // The encoder writes a token at a time: group them like sendHistory()
+      BufferedPrint out(client);
+      LzssEncoder encoder(out);
+      encoder.write((const uint8_t*)body, length);
+      encoder.finish();
+      out.flush();
+    } else if (length > 0) {
+      client.write((const uint8_t*)body, length);
+    }
+  }
+  
+  /**
+   * @brief Check whether the request asks for an LZSS-compressed body
+   */
+  bool wantsLzss() const {
+    return hasQueryPair(request.getQuery(), "compress=lzss");
+  }
+  
+  /**
+   * @brief Read an unsigned query parameter
+   * 
+   * @param value Left unchanged if the parameter is absent
+   * @return false if present but not a number
+   */
+  static bool queryUnsigned(const char* query, const char* name, uint32_t& value) {
+    char text[12] = "";
+    if (!queryText(query, name, text, sizeof(text))) return false;
+    if (text[0] == '\0') return true;
+    
+    uint32_t result = 0;
+    for (const char* c = text; *c; c++) {
+      if (*c < '0' || *c > '9') return false;
+      uint32_t digit = *c - '0';
+      if (result > (0xFFFFFFFFUL - digit) / 10) return false;  // Would not fit
+      result = result * 10 + digit;
+    }
+    value = result;
+    return true;
+  }
+  
+  /**
+   * @brief Copy a query parameter's value
+   * 
+   * @param out Left unchanged if the parameter is absent
+   * @return false if the value does not fit
+   */
+  static bool queryText(const char* query, const char* name, char* out, size_t size) {
+    size_t nameLength = strlen(name);
+    while (*query) {
+      const char* end = strchr(query, '&');
+      size_t tokenLength = end ? (size_t)(end - query) : strlen(query);
+      if (tokenLength > nameLength && query[nameLength] == '=' &&
+          strncmp(query, name, nameLength) == 0) {
+        size_t valueLength = tokenLength - nameLength - 1;
+        if (valueLength >= size) return false;
+        memcpy(out, query + nameLength + 1, valueLength);
+        out[valueLength] = '\0';
+        return true;
+      }
+      if (!end) break;
+      query = end + 1;
+    }
+    return true;
+  }
+  
+  /**
+   * @brief Check whether a query string contains a name=value pair
+   * 
+   * @param query Query string, without the '?'
+   * @param pair Pair to look for, e.g. "format=cbor"
+   */
+  static bool hasQueryPair(const char* query, const char* pair) {
+    size_t length = strlen(pair);
+    while (*query) {
+      const char* end = strchr(query, '&');
+      size_t tokenLength = end ? (size_t)(end - query) : strlen(query);
+      if (tokenLength == length && strncmp(query, pair, length) == 0) {
+        return true;
+      }
+      if (!end) break;
+      query = end + 1;
+    }
+    return false;
+  }
+  
+  /**
+   * @brief Reason phrase for the status codes we send
+   */
+  static const char* statusText(uint16_t status) {
+    switch (status) {
+      case 200: return "OK";
+      case 304: return "Not Modified";
+      case 400: return "Bad Request";
+      case 404: return "Not Found";
+      case 405: return "Method Not Allowed";
+      case 413: return "Payload Too Large";
+      case 414: return "URI Too Long";
+      case 431: return "Request Header Fields Too Large";
+      case 501: return "Not Implemented";
+      case 503: return "Service Unavailable";
+      case 505: return "HTTP Version Not Supported";
+      default: return "Internal Server Error";
+    }
+  }
+  
+  /**
+   * @brief Append a string to a bounded buffer
+   * 
+   * @return false if the buffer is too small
+   */
+  static bool appendText(char* buffer, size_t size, size_t& len, const char* text) {
+    while (*text) {
+      if (len + 1 >= size) return false;
+      buffer[len++] = *text++;
+    }
+    buffer[len] = '\0';
+    return true;
+  }
+  
+  /**
+   * @brief Append an unsigned integer to a bounded buffer
+   * 
+   * Exact for epoch times, which a float would round.
+   * 
+   * @return false if the buffer is too small
+   */
+  static bool appendUnsigned(char* buffer, size_t size, size_t& len, unsigned long value) {
+    char digits[12];
+    int n = 0;
+    do {
+      digits[n++] = '0' + (value % 10);
+      value /= 10;
+    } while (value > 0);
+    
+    if (len + n >= size) return false;
+    while (n > 0) {
+      buffer[len++] = digits[--n];
+    }
+    buffer[len] = '\0';
+    return true;
+  }
+  
+  /**
+   * @brief Append a fixed-point decimal number to a bounded buffer
+   * 
+   * Avoids printf float support, which is not linked in by default.
+   * A failed sensor read (NaN) or a value whose scaled form does not fit
+   * in 32 bits is written as null, so the conversion below stays defined.
+   * 
+   * @return false if the buffer is too small
+   */
+  static bool appendFixed(char* buffer, size_t size, size_t& len, float value, uint8_t decimals) {
+    static const int32_t scales[] = {1, 10, 100, 1000};
+    int32_t scale = scales[decimals > 3 ? 3 : decimals];
+    float rounded = value * scale + (value < 0 ? -0.5f : 0.5f);
+    if (!isfinite(rounded) || rounded <= -2147483648.0f || rounded >= 2147483648.0f) {
+      return appendText(buffer, size, len, "null");
+    }
+    int32_t scaled = (int32_t)rounded;
+    
+    char digits[16];
+    int n = 0;
+    bool negative = scaled < 0;
+    uint32_t magnitude = negative ? 0UL - (uint32_t)scaled : (uint32_t)scaled;
+    
+    // Emit digits in reverse, inserting the decimal point
+    do {
+      if (decimals > 0 && n == decimals) digits[n++] = '.';
+      digits[n++] = '0' + (magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude > 0 || (decimals > 0 && n <= decimals));
+    if (negative) digits[n++] = '-';
+    
+    if (len + n >= size) return false;
+    while (n > 0) {
+      buffer[len++] = digits[--n];
+    }
+    buffer[len] = '\0';
+    return true;
   }
 };
 
@@ -0,0 +1,104 @@
+/**
+ * @file NtpCheck.h
+ * @brief Sample selection check for the multi-server NTP sync
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Feeds scripted sample sets to NtpSelector: servers that agree, a
+ * falseticker, a slow asymmetric path and sets without a majority. Each
+ * sample is given as its error against a known true offset and its
+ * delay; the combined result must use the expected samples and land within
+ * the scenario's bound.
+ */
+
+#ifndef NTP_CHECK_H
+#define NTP_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "NtpSync.h"
+
+// 2025-06-01 00:00:00 UTC at timebase zero
+#define NTP_CHECK_TRUE_OFFSET   1748736000000000LL
+
+/**
+ * @struct NtpScenario
+ * @brief Sample errors and delays, and the expected selection
+ */
+struct NtpScenario {
+  const char* name;
+  uint8_t count;
+  int32_t errorUs[NTP_SERVER_COUNT];   ///< Sample offset minus true offset
+  int32_t delayUs[NTP_SERVER_COUNT];
+  bool selected;                       ///< A result is expected
+  uint8_t survivors;                   ///< Samples it should use
+  int32_t maxErrorUs;                  ///< Bound on the result error
+};
+
+static const NtpScenario NTP_SCENARIOS[] = {
+  // Four servers, errors within half their delays
+  { "ntp.agree", 4, { 3000, -4000, 5000, -2000 }, { 20000, 25000, 30000, 40000 }, true, 4, 10000 },
+  // One server 300 ms off with a short delay: outvoted
+  { "ntp.falseticker", 4, { 2000, 300000, -3000, 1000 }, { 20000, 20000, 24000, 22000 }, true, 3, 10000 },
+  // One reply 180 ms off through a slow, asymmetric path: filtered on delay
+  { "ntp.slowAsymmetric", 4, { 1000, -2000, 180000, 2000 }, { 18000, 21000, 400000, 25000 }, true, 3, 9000 },
+  // Two servers a second apart: no majority, keep the RTC
+  { "ntp.noMajority", 2, { 0, 1000000 }, { 20000, 20000 }, false, 0, 0 },
+  // Single reply: used as is
+  { "ntp.single", 1, { 4000 }, { 30000 }, true, 1, 4000 }
+};
+
+/**
+ * @class NtpCheck
+ * @brief Runs every scenario and prints the results
+ */
+class NtpCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  NtpCheck() : results("NTP") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of scenarios with an unexpected selection
+   */
+  int runAll() {
+    results.begin();
+    
+    for (size_t i = 0; i < sizeof(NTP_SCENARIOS) / sizeof(NTP_SCENARIOS[0]); i++) {
+      runScenario(NTP_SCENARIOS[i]);
+    }
+    
+    return results.end();
+  }
+
+private:
+  void runScenario(const NtpScenario& scenario) {
+    NtpSample samples[NTP_SERVER_COUNT];
+    for (uint8_t i = 0; i < scenario.count; i++) {
+      samples[i].offset = NTP_CHECK_TRUE_OFFSET + scenario.errorUs[i];
+      samples[i].delay = scenario.delayUs[i];
+    }
+    
+    int64_t offset = 0;
+    uint8_t survivors = 0;
+    bool selected = NtpSelector::select(samples, scenario.count, offset, survivors);
+    int64_t error = selected ? offset - NTP_CHECK_TRUE_OFFSET : 0;
+    
+    bool ok = selected == scenario.selected && survivors == scenario.survivors &&
+              error <= scenario.maxErrorUs && -error <= scenario.maxErrorUs;
+    
+    results.start(scenario.name);
+    results.field("survivors", survivors);
+    results.field("error_us", (long)error);
+    results.finish(ok);
+  }
+};
+
+#endif // NTP_CHECK_H
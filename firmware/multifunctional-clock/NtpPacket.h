@@ -0,0 +1,239 @@
+/**
+ * @file NtpPacket.h
+ * @brief NTP request building and reply parsing
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Works directly on the 48-byte datagram, without allocation. Replies are
+ * validated before use: mode, version, stratum, leap indicator, a non-zero
+ * transmit timestamp and an originate timestamp that must echo the nonce
+ * we sent, so stale or spoofed packets are rejected.
+ */
+
+#ifndef NTP_PACKET_H
+#define NTP_PACKET_H
+
+#include "config.h"
+
+#define NTP_PACKET_SIZE       48
+#define NTP_PORT              123
+#define NTP_UNIX_OFFSET       2208988800UL  // Seconds from 1900 to 1970
+#define NTP_SERVER_PRECISION  -10           // log2 s: ~1 ms, loop-polled stamps
+
+/**
+ * @struct NtpTimestamp
+ * @brief 64-bit NTP timestamp (seconds since 1900 + 2^-32 fraction)
+ */
+struct NtpTimestamp {
+  uint32_t seconds;   ///< Seconds since 1900-01-01
+  uint32_t fraction;  ///< Fractional second (1/2^32 s)
+};
+
+/**
+ * @struct NtpReply
+ * @brief Fields of a validated NTP server reply
+ */
+struct NtpReply {
+  uint8_t leap;               ///< Leap indicator (0-2)
+  uint8_t stratum;            ///< Server stratum (1-15)
+  uint32_t referenceId;       ///< Reference clock identifier
+  uint32_t rootDelay;         ///< Delay to the reference clock (16.16 s)
+  uint32_t rootDispersion;    ///< Error bound of the server clock (16.16 s)
+  NtpTimestamp receive;       ///< Server receive time (T2)
+  NtpTimestamp transmit;      ///< Server transmit time (T3)
+  
+  /**
+   * @brief Server transmit time as a Unix timestamp
+   */
+  unsigned long unixSeconds() const {
+    return transmit.seconds - NTP_UNIX_OFFSET;
+  }
+};
+
+/**
+ * @brief Result of parsing an NTP reply
+ */
+enum NtpStatus {
+  NTP_OK = 0,
+  NTP_TOO_SHORT,        ///< Fewer than NTP_PACKET_SIZE bytes
+  NTP_BAD_MODE,         ///< Not a server (mode 4) packet
+  NTP_BAD_VERSION,      ///< Version other than 3 or 4
+  NTP_KISS_OF_DEATH,    ///< Stratum 0: server asks us to back off
+  NTP_BAD_STRATUM,      ///< Stratum above 15
+  NTP_UNSYNCHRONIZED,   ///< Leap indicator 3: server clock not set
+  NTP_BAD_ORIGIN,       ///< Reply does not match our request
+  NTP_ZERO_TRANSMIT     ///< Server transmit timestamp missing
+};
+
+/**
+ * @class NtpPacket
+ * @brief Stateless helpers to build and parse NTP datagrams
+ */
+class NtpPacket {
+public:
+  /**
+   * @brief Build a client (mode 3, version 4) request
+   * 
+   * The transmit timestamp carries a nonce which the server copies into
+   * the originate field of its reply.
+   * 
+   * @param buffer Destination, at least NTP_PACKET_SIZE bytes
+   * @param nonce Value to send as our transmit timestamp
+   */
+  static void buildRequest(uint8_t* buffer, const NtpTimestamp& nonce) {
+    memset(buffer, 0, NTP_PACKET_SIZE);
+    buffer[0] = (0 << 6) | (4 << 3) | 3;  // LI = 0, VN = 4, Mode = client
+    put32(buffer + 40, nonce.seconds);
+    put32(buffer + 44, nonce.fraction);
+  }
+  
+  /**
+   * @brief Validate and decode a server reply
+   * 
+   * @param buffer Received datagram
+   * @param length Number of bytes received
+   * @param nonce Transmit timestamp of the matching request
+   * @param reply Decoded fields, valid only when NTP_OK is returned
+   * @return NTP_OK or the first validation failure
+   */
+  static NtpStatus parseReply(const uint8_t* buffer, size_t length,
+                              const NtpTimestamp& nonce, NtpReply& reply) {
+    if (length < NTP_PACKET_SIZE) {
+      return NTP_TOO_SHORT;
+    }
+    
+    uint8_t leap = buffer[0] >> 6;
+    uint8_t version = (buffer[0] >> 3) & 0x07;
+    uint8_t mode = buffer[0] & 0x07;
+    uint8_t stratum = buffer[1];
+    
+    if (mode != 4) return NTP_BAD_MODE;
+    if (version < 3 || version > 4) return NTP_BAD_VERSION;
+    if (stratum == 0) return NTP_KISS_OF_DEATH;
+    if (stratum > 15) return NTP_BAD_STRATUM;
+    if (leap == 3) return NTP_UNSYNCHRONIZED;
+    
+    if (get32(buffer + 24) != nonce.seconds || get32(buffer + 28) != nonce.fraction) {
+      return NTP_BAD_ORIGIN;
+    }
+    
+    reply.transmit.seconds = get32(buffer + 40);
+    reply.transmit.fraction = get32(buffer + 44);
+    if (reply.transmit.seconds == 0 && reply.transmit.fraction == 0) {
+      return NTP_ZERO_TRANSMIT;
+    }
+    
+    reply.leap = leap;
+    reply.stratum = stratum;
+    reply.referenceId = get32(buffer + 12);
+    reply.rootDelay = get32(buffer + 4);
+    reply.rootDispersion = get32(buffer + 8);
+    reply.receive.seconds = get32(buffer + 32);
+    reply.receive.fraction = get32(buffer + 36);
+    return NTP_OK;
+  }
+  
+  /**
+   * @brief Check that a datagram is a client (mode 3) request we can answer
+   */
+  static bool isClientRequest(const uint8_t* buffer, size_t length) {
+    if (length < NTP_PACKET_SIZE) {
+      return false;
+    }
+    uint8_t version = (buffer[0] >> 3) & 0x07;
+    return (buffer[0] & 0x07) == 3 && version >= 1 && version <= 4;
+  }
+  
+  /**
+   * @brief Build a server (mode 4) reply to a client request
+   * 
+   * The version and poll interval are copied from the request and its
+   * transmit timestamp becomes our originate timestamp. The transmit
+   * timestamp is left to setTransmit(), to be stamped just before sending.
+   * 
+   * @param buffer Destination, at least NTP_PACKET_SIZE bytes
+   * @param request Request, validated with isClientRequest()
+   * @param stratum Our stratum (upstream + 1)
+   * @param rootDelay Delay to the reference clock (16.16 s)
+   * @param rootDispersion Error bound of our clock (16.16 s)
+   * @param referenceId Upstream server address
+   * @param reference Time of our last synchronization
+   * @param receive Time the request was read (T2)
+   */
+  static void buildReply(uint8_t* buffer, const uint8_t* request, uint8_t stratum,
+                         uint32_t rootDelay, uint32_t rootDispersion, uint32_t referenceId,
+                         const NtpTimestamp& reference, const NtpTimestamp& receive) {
+    memset(buffer, 0, NTP_PACKET_SIZE);
+    buffer[0] = (0 << 6) | (request[0] & 0x38) | 4;  // LI = 0, client's VN, Mode = server
+    buffer[1] = stratum;
+    buffer[2] = request[2];
+    buffer[3] = (uint8_t)NTP_SERVER_PRECISION;
+    put32(buffer + 4, rootDelay);
+    put32(buffer + 8, rootDispersion);
+    put32(buffer + 12, referenceId);
+    put32(buffer + 16, reference.seconds);
+    put32(buffer + 20, reference.fraction);
+    memcpy(buffer + 24, request + 40, 8);
+    put32(buffer + 32, receive.seconds);
+    put32(buffer + 36, receive.fraction);
+  }
+  
+  /**
+   * @brief Stamp the transmit timestamp of a reply (T3)
+   */
+  static void setTransmit(uint8_t* buffer, const NtpTimestamp& transmit) {
+    put32(buffer + 40, transmit.seconds);
+    put32(buffer + 44, transmit.fraction);
+  }
+  
+  /**
+   * @brief Convert microseconds since 1970 to an NTP timestamp
+   */
+  static NtpTimestamp fromUnixMicros(int64_t micros) {
+    NtpTimestamp timestamp;
+    int64_t seconds = micros / 1000000;
+    int64_t remainder = micros % 1000000;
+    timestamp.seconds = (uint32_t)(seconds + NTP_UNIX_OFFSET);
+    timestamp.fraction = (uint32_t)(((uint64_t)remainder << 32) / 1000000);
+    return timestamp;
+  }
+  
+  /**
+   * @brief Convert microseconds to NTP short format (16.16 s)
+   */
+  static uint32_t toShort(int64_t micros) {
+    if (micros <= 0) return 0;
+    return (uint32_t)(((uint64_t)micros << 16) / 1000000);
+  }
+  
+  /**
+   * @brief Convert NTP short format (16.16 s) to microseconds
+   */
+  static int64_t fromShort(uint32_t value) {
+    return (int64_t)(((uint64_t)value * 1000000) >> 16);
+  }
+  
+  /**
+   * @brief Convert an NTP timestamp to microseconds since 1970
+   */
+  static int64_t toUnixMicros(const NtpTimestamp& timestamp) {
+    return ((int64_t)timestamp.seconds - (int64_t)NTP_UNIX_OFFSET) * 1000000LL +
+           (int64_t)(((uint64_t)timestamp.fraction * 1000000ULL) >> 32);
+  }
+
+private:
+  static uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  }
+  
+  static void put32(uint8_t* p, uint32_t value) {
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+  }
+};
+
+#endif // NTP_PACKET_H
@@ -0,0 +1,369 @@
+/**
+ * @file NtpSync.h
+ * @brief Multi-server NTP exchange and sample selection
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * One synchronization sends a request to each of NTP_SERVER_COUNT servers
+ * at once and collects the replies without blocking. Each reply gives a
+ * clock offset and a round-trip delay from the four NTP timestamps; the
+ * offsets are taken against Timebase::micros64(), so an offset is the UTC
+ * time (us since 1970) at timebase zero.
+ * 
+ * NtpSelector then keeps the samples whose delay is close to the minimum
+ * (a slow reply is also the one most likely to be asymmetric), intersects
+ * their correctness intervals (offset +/- delay/2) to find the range a
+ * majority agrees on, and averages the survivors weighted by 1/delay. A
+ * server that is off by more than its delay can explain is dropped rather
+ * than pulling the result.
+ */
+
+#ifndef NTP_SYNC_H
+#define NTP_SYNC_H
+
+#include "config.h"
+#include "Timebase.h"
+#include "NtpPacket.h"
+#include "DnsCache.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+static const char* const NTP_SERVER_NAMES[NTP_SERVER_COUNT] = NTP_SERVERS;
+
+/**
+ * @struct NtpSample
+ * @brief Offset and delay measured from one reply
+ */
+struct NtpSample {
+  int64_t offset;           ///< UTC at timebase zero (us)
+  int64_t delay;            ///< Round-trip delay, server time excluded (us)
+  uint8_t stratum;          ///< Server stratum
+  uint32_t referenceId;     ///< Server IPv4 address
+  int64_t rootDelay;        ///< Server delay to its reference (us)
+  int64_t rootDispersion;   ///< Server error bound (us)
+};
+
+/**
+ * @struct NtpReference
+ * @brief Result of a synchronization, as served to the LAN over SNTP
+ */
+struct NtpReference {
+  int64_t offset;           ///< UTC at timebase zero (us)
+  uint8_t stratum;          ///< Stratum of the best sample's server
+  uint32_t referenceId;     ///< Its IPv4 address
+  int64_t rootDelay;        ///< Its root delay plus our delay to it (us)
+  int64_t rootDispersion;   ///< Its root dispersion plus our precision (us)
+  uint64_t syncedAt;        ///< Timebase::millis64() of the synchronization
+};
+
+/**
+ * @class NtpSelector
+ * @brief Combines the samples of one synchronization
+ */
+class NtpSelector {
+public:
+  /**
+   * @brief Select and combine the best samples
+   * 
+   * @param samples Samples of one synchronization
+   * @param count Number of samples (at most NTP_SERVER_COUNT)
+   * @param offset Combined offset, set only when true is returned
+   * @param survivors Number of samples used in the result
+   * @param best Index of the survivor with the smallest delay, if not null
+   * @return false if there is no sample or no majority agrees
+   */
+  static bool select(const NtpSample* samples, uint8_t count, int64_t& offset, uint8_t& survivors,
+                     uint8_t* best = nullptr) {
+    survivors = 0;
+    if (count == 0) {
+      return false;
+    }
+    
+    // Minimum-delay filter
+    int64_t minDelay = samples[0].delay;
+    for (uint8_t i = 1; i < count; i++) {
+      if (samples[i].delay < minDelay) minDelay = samples[i].delay;
+    }
+    int64_t maxDelay = minDelay * NTP_DELAY_FACTOR + NTP_DELAY_SLACK_US;
+    
+    int64_t low[NTP_SERVER_COUNT];
+    int64_t high[NTP_SERVER_COUNT];
+    bool kept[NTP_SERVER_COUNT];
+    uint8_t keptCount = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      kept[i] = samples[i].delay <= maxDelay;
+      if (kept[i]) {
+        int64_t halfWidth = samples[i].delay / 2 + NTP_PRECISION_US;
+        low[i] = samples[i].offset - halfWidth;
+        high[i] = samples[i].offset + halfWidth;
+        keptCount++;
+      }
+    }
+    
+    // Intersection: the range covered by the most intervals, which must
+    // be a majority of the kept samples
+    int64_t bestLow = 0;
+    int64_t bestHigh = 0;
+    uint8_t bestCount = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (!kept[i]) continue;
+      // Every interval's lower edge is a candidate start of the range
+      int64_t rangeLow = low[i];
+      int64_t rangeHigh = high[i];
+      uint8_t covering = 0;
+      for (uint8_t j = 0; j < count; j++) {
+        if (kept[j] && low[j] <= rangeLow && high[j] >= rangeLow) {
+          covering++;
+          if (high[j] < rangeHigh) rangeHigh = high[j];
+        }
+      }
+      if (covering > bestCount) {
+        bestCount = covering;
+        bestLow = rangeLow;
+        bestHigh = rangeHigh;
+      }
+    }
+    if (bestCount * 2 <= keptCount) {
+      return false;
+    }
+    
+    // Truechimers: kept samples whose interval overlaps the range
+    int64_t base = 0;
+    int64_t weightedSum = 0;
+    int64_t weightTotal = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (!kept[i] || high[i] < bestLow || low[i] > bestHigh) continue;
+      if (survivors == 0) {
+        base = samples[i].offset;
+        if (best) *best = i;
+      } else if (best && samples[i].delay < samples[*best].delay) {
+        *best = i;
+      }
+      // Residuals keep the products in range; weight 1/delay in ppm
+      int64_t weight = 1000000000LL / (samples[i].delay + NTP_PRECISION_US);
+      weightedSum += (samples[i].offset - base) * weight;
+      weightTotal += weight;
+      survivors++;
+    }
+    offset = base + weightedSum / weightTotal;
+    return true;
+  }
+};
+
+/**
+ * @brief Progress of the current exchange
+ */
+enum NtpExchangeState {
+  NTP_EXCHANGE_IDLE = 0,   ///< Nothing sent
+  NTP_EXCHANGE_WAITING,    ///< Requests sent, replies missing
+  NTP_EXCHANGE_DONE        ///< Every reply in, or NTP_TIMEOUT reached
+};
+
+/**
+ * @class NtpSync
+ * @brief Sends to every server at once and gathers the samples
+ */
+class NtpSync {
+private:
+  WiFiUDP udp;
+  DnsCache* dnsCache;
+  
+  NtpExchangeState state;
+  uint64_t startedAt;                      ///< Time the requests were sent (ms)
+  NtpTimestamp nonces[NTP_SERVER_COUNT];   ///< Transmit timestamps to echo
+  int64_t sentAt[NTP_SERVER_COUNT];        ///< T1, on the timebase (us)
+  bool waiting[NTP_SERVER_COUNT];          ///< Request sent, no reply yet
+  uint8_t waitingCount;
+  
+  NtpSample samples[NTP_SERVER_COUNT];
+  uint8_t sampleCount;
+
+public:
+  NtpSync() :
+    dnsCache(nullptr),
+    state(NTP_EXCHANGE_IDLE),
+    startedAt(0),
+    waitingCount(0),
+    sampleCount(0) {}
+  
+  /**
+   * @brief Resolve server names through a DNS cache
+   * 
+   * Names without a cached address are resolved by the WiFi library.
+   */
+  void setDnsCache(DnsCache* cache) {
+    dnsCache = cache;
+  }
+  
+  /**
+   * @brief Send one request to every server
+   * 
+   * Pool names that resolve to an address already used are skipped.
+   * 
+   * @return Number of requests sent
+   */
+  uint8_t start() {
+    udp.stop();
+    udp.begin(NTP_LOCAL_PORT);
+    waitingCount = 0;
+    sampleCount = 0;
+    
+    IPAddress used[NTP_SERVER_COUNT];
+    uint8_t usedCount = 0;
+    uint32_t seed = (uint32_t)Timebase::micros64();
+    
+    for (uint8_t i = 0; i < NTP_SERVER_COUNT; i++) {
+      waiting[i] = false;
+      IPAddress address;
+      bool cached = dnsCache && dnsCache->lookup(NTP_SERVER_NAMES[i], address, Timebase::millis64());
+      if (cached) {
+        bool duplicate = false;
+        for (uint8_t j = 0; j < usedCount; j++) {
+          if (used[j] == address) duplicate = true;
+        }
+        if (duplicate) continue;
+        used[usedCount++] = address;
+      }
+      
+      // Our transmit timestamp is a nonce the server must echo back
+      uint8_t packet[NTP_PACKET_SIZE];
+      nonces[i].seconds = seed ^ (0x9E3779B9UL * (i + 1));
+      nonces[i].fraction = (uint32_t)micros() + i;
+      NtpPacket::buildRequest(packet, nonces[i]);
+      
+      if (!(cached ? udp.beginPacket(address, NTP_PORT) : udp.beginPacket(NTP_SERVER_NAMES[i], NTP_PORT)) ||
+          udp.write(packet, NTP_PACKET_SIZE) != NTP_PACKET_SIZE) {
+        DEBUG_PRINT("NTP request not sent: ");
+        DEBUG_PRINTLN(NTP_SERVER_NAMES[i]);
+        continue;
+      }
+      sentAt[i] = (int64_t)Timebase::micros64();
+      if (!udp.endPacket()) {
+        continue;
+      }
+      waiting[i] = true;
+      waitingCount++;
+    }
+    
+    startedAt = Timebase::millis64();
+    state = waitingCount > 0 ? NTP_EXCHANGE_WAITING : NTP_EXCHANGE_DONE;
+    if (waitingCount == 0) {
+      udp.stop();
+    }
+    return waitingCount;
+  }
+  
+  /**
+   * @brief Read the replies that have arrived, without waiting
+   * 
+   * Should be called every loop iteration; the receive time of a reply is
+   * taken when it is read, so a late poll counts as network delay.
+   * 
+   * @return State of the exchange
+   */
+  NtpExchangeState poll() {
+    if (state != NTP_EXCHANGE_WAITING) {
+      return state;
+    }
+    
+    // Replies come close together: read all of them in one call
+    for (uint8_t n = 0; n < NTP_SERVER_COUNT && udp.parsePacket() > 0; n++) {
+      int64_t receivedAt = (int64_t)Timebase::micros64();
+      uint8_t packet[NTP_PACKET_SIZE];
+      int length = udp.read(packet, NTP_PACKET_SIZE);
+      acceptReply(packet, length > 0 ? length : 0, receivedAt, udp.remoteIP());
+    }
+    
+    if (waitingCount == 0 || Timebase::millis64() - startedAt >= NTP_TIMEOUT) {
+      state = NTP_EXCHANGE_DONE;
+      udp.stop();
+    }
+    return state;
+  }
+  
+  /**
+   * @brief Check whether requests await their replies
+   */
+  bool isWaiting() const {
+    return state == NTP_EXCHANGE_WAITING;
+  }
+  
+  /**
+   * @brief Combine the samples of the finished exchange
+   * 
+   * @param reference Combined offset and the best server's details, set
+   * only when true is returned
+   * @param survivors Number of samples used
+   * @return false if no reply came or no majority agrees
+   */
+  bool getResult(NtpReference& reference, uint8_t& survivors) const {
+    uint8_t best = 0;
+    if (!NtpSelector::select(samples, sampleCount, reference.offset, survivors, &best)) {
+      return false;
+    }
+    const NtpSample& sample = samples[best];
+    reference.stratum = sample.stratum;
+    reference.referenceId = sample.referenceId;
+    reference.rootDelay = sample.rootDelay + sample.delay;
+    reference.rootDispersion = sample.rootDispersion + NTP_PRECISION_US + sample.delay / 2;
+    reference.syncedAt = Timebase::millis64();
+    return true;
+  }
+  
+  uint8_t getSampleCount() const { return sampleCount; }
+  
+  /**
+   * @brief Smallest round-trip delay of the exchange (us)
+   */
+  int64_t getMinDelay() const {
+    int64_t minDelay = 0;
+    for (uint8_t i = 0; i < sampleCount; i++) {
+      if (i == 0 || samples[i].delay < minDelay) minDelay = samples[i].delay;
+    }
+    return minDelay;
+  }
+
+private:
+  /**
+   * @brief Match a reply to its request and turn it into a sample
+   */
+  void acceptReply(const uint8_t* packet, size_t length, int64_t receivedAt, const IPAddress& from) {
+    for (uint8_t i = 0; i < NTP_SERVER_COUNT; i++) {
+      if (!waiting[i]) continue;
+      
+      NtpReply reply;
+      NtpStatus status = NtpPacket::parseReply(packet, length, nonces[i], reply);
+      if (status == NTP_BAD_ORIGIN) continue;
+      if (status != NTP_OK) {
+        DEBUG_PRINT("NTP reply rejected, status ");
+        DEBUG_PRINTLN(status);
+        return;
+      }
+      
+      waiting[i] = false;
+      waitingCount--;
+      
+      int64_t t2 = NtpPacket::toUnixMicros(reply.receive);
+      int64_t t3 = NtpPacket::toUnixMicros(reply.transmit);
+      NtpSample& sample = samples[sampleCount++];
+      sample.offset = ((t2 - sentAt[i]) + (t3 - receivedAt)) / 2;
+      sample.delay = (receivedAt - sentAt[i]) - (t3 - t2);
+      if (sample.delay < 0) sample.delay = 0;
+      sample.stratum = reply.stratum;
+      sample.referenceId = ((uint32_t)from[0] << 24) | ((uint32_t)from[1] << 16) |
+                           ((uint32_t)from[2] << 8) | (uint32_t)from[3];
+      sample.rootDelay = NtpPacket::fromShort(reply.rootDelay);
+      sample.rootDispersion = NtpPacket::fromShort(reply.rootDispersion);
+      
+      DEBUG_PRINT("NTP ");
+      DEBUG_PRINT(NTP_SERVER_NAMES[i]);
+      DEBUG_PRINT(" delay ");
+      DEBUG_PRINT((long)sample.delay);
+      DEBUG_PRINTLN(" us");
+      return;
+    }
+  }
+};
+
+#endif // NTP_SYNC_H
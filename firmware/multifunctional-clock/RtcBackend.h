@@ -0,0 +1,131 @@
+/**
+ * @file RtcBackend.h
+ * @brief Real-time clock backends
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * ClockManager keeps UTC in an RtcBackend: it is written after every NTP
+ * synchronization and read at boot, so the clock shows a valid time
+ * before WiFi is up, and while NTP is unreachable. BoardRtc uses the
+ * RA4M1 on-chip RTC of the UNO R4, which keeps counting across resets
+ * (and power loss with a backup supply on VRTC). MemoryRtc keeps the time
+ * in RAM and stands in for it in host builds and checks.
+ */
+
+#ifndef RTC_BACKEND_H
+#define RTC_BACKEND_H
+
+#include "config.h"
+#include "Timebase.h"
+#include <RTC.h>
+
+/**
+ * @class RtcBackend
+ * @brief Interface for a clock that holds UTC between synchronizations
+ */
+class RtcBackend {
+public:
+  virtual ~RtcBackend() {}
+  
+  /**
+   * @brief Start the clock hardware
+   * 
+   * @return true if the clock can be used
+   */
+  virtual bool begin() = 0;
+  
+  /**
+   * @brief Read the current time
+   * 
+   * @param unixSeconds UTC seconds since 1970
+   * @return false if the clock was never set or has stopped
+   */
+  virtual bool read(uint32_t& unixSeconds) = 0;
+  
+  /**
+   * @brief Set the current time
+   * 
+   * @param unixSeconds UTC seconds since 1970
+   * @return true if the time was stored
+   */
+  virtual bool write(uint32_t unixSeconds) = 0;
+};
+
+/**
+ * @class BoardRtc
+ * @brief RA4M1 on-chip RTC through the core's RTC library
+ */
+class BoardRtc : public RtcBackend {
+public:
+  bool begin() override {
+    return RTC.begin();
+  }
+  
+  bool read(uint32_t& unixSeconds) override {
+    if (!RTC.isRunning()) {
+      return false;
+    }
+    RTCTime time;
+    if (!RTC.getTime(time)) {
+      return false;
+    }
+    unixSeconds = time.getUnixTime();
+    return true;
+  }
+  
+  bool write(uint32_t unixSeconds) override {
+    RTCTime time((time_t)unixSeconds);
+    return RTC.setTime(time);
+  }
+};
+
+/**
+ * @class MemoryRtc
+ * @brief RTC kept in RAM and advanced with the timebase
+ * 
+ * Host stub for BoardRtc: it can be preset to any time and fails reads
+ * until it is set, like an RTC that lost power.
+ */
+class MemoryRtc : public RtcBackend {
+private:
+  uint32_t setTime;   ///< Time written (UTC seconds)
+  uint64_t setAt;     ///< Timebase::millis64() at the write
+  bool running;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param unixSeconds Initial time, or 0 for a clock that was never set
+   */
+  explicit MemoryRtc(uint32_t unixSeconds = 0) :
+    setTime(0),
+    setAt(0),
+    running(false) {
+    if (unixSeconds) {
+      write(unixSeconds);
+    }
+  }
+  
+  bool begin() override {
+    return true;
+  }
+  
+  bool read(uint32_t& unixSeconds) override {
+    if (!running) {
+      return false;
+    }
+    unixSeconds = setTime + (uint32_t)((Timebase::millis64() - setAt) / 1000);
+    return true;
+  }
+  
+  bool write(uint32_t unixSeconds) override {
+    setTime = unixSeconds;
+    setAt = Timebase::millis64();
+    running = true;
+    return true;
+  }
+};
+
+#endif // RTC_BACKEND_H
@@ -0,0 +1,219 @@
+/**
+ * @file RtcCheck.h
+ * @brief Check of the time kept in the RTC across boots and NTP outages
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Installs a MemoryRtc in the firmware's ClockManager with setRtc() and
+ * runs the RTC paths against it: the boot restore (never set, set before
+ * RTC_MIN_VALID_EPOCH, running), the write after an NTP synchronization,
+ * and the holdover after a failed one, including the periodic re-read
+ * and the second edge it must leave in place. The clock's time state and
+ * RTC are put back afterwards.
+ */
+
+#ifndef RTC_CHECK_H
+#define RTC_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "ClockManager.h"
+#include "RtcBackend.h"
+
+#define RTC_CHECK_EPOCH       1767225600UL  // 2026-01-01 00:00:00 UTC
+#define RTC_CHECK_NTP_EPOCH   (RTC_CHECK_EPOCH + 40 * 86400UL + 3723)
+#define RTC_CHECK_TOLERANCE   1             // A second may tick during a scenario
+
+/**
+ * @class RtcCheck
+ * @brief Runs every RTC scenario on the firmware's ClockManager
+ */
+class RtcCheck {
+private:
+  ClockManager& clock;
+  CheckReport results;
+  MemoryRtc rtc;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param clockMgr Clock manager to borrow, after init()
+   */
+  explicit RtcCheck(ClockManager& clockMgr) :
+    clock(clockMgr),
+    results("RTC") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    RtcBackend* savedRtc = clock.rtc;
+    TimeInfo savedTime = clock.currentTime;
+    unsigned long savedEpoch = clock.epoch;
+    bool savedValid = clock.timeValidated;
+    TimeSource savedSource = clock.timeSource;
+    uint64_t savedTick = clock.nextTick;
+    uint64_t savedRtcRead = clock.lastRtcRead;
+    bool savedAligned = clock.phaseAligned;
+    AlarmScheduler savedAlarms = clock.alarms;
+    
+    clock.setRtc(&rtc);
+    checkBootNeverSet();
+    checkBootNotSet();
+    checkBootRestored();
+    checkNtpWrite();
+    checkHoldover();
+    checkHoldoverPhase();
+    
+    clock.rtc = savedRtc;
+    clock.currentTime = savedTime;
+    clock.epoch = savedEpoch;
+    clock.timeValidated = savedValid;
+    clock.timeSource = savedSource;
+    clock.nextTick = savedTick;
+    clock.lastRtcRead = savedRtcRead;
+    clock.phaseAligned = savedAligned;
+    clock.alarms = savedAlarms;
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief Put the clock back in its state before any time was set
+   */
+  void forget() {
+    clock.timeValidated = false;
+    clock.currentTime.isValid = false;
+    clock.timeSource = TIME_SOURCE_NONE;
+    clock.phaseAligned = false;
+    clock.epoch = 0;
+  }
+  
+  /**
+   * @brief Clock time minus the expected time (s)
+   */
+  long errorFrom(unsigned long expected) const {
+    return (long)(clock.getEpoch() - expected);
+  }
+  
+  static bool within(long error) {
+    return error >= -RTC_CHECK_TOLERANCE && error <= RTC_CHECK_TOLERANCE;
+  }
+  
+  /**
+   * @brief An RTC that was never set gives no time at boot
+   */
+  void checkBootNeverSet() {
+    rtc = MemoryRtc();
+    forget();
+    bool restored = clock.restoreFromRtc();
+    report("rtc.bootNeverSet", 0,
+           !restored && !clock.isTimeValid() && clock.getTimeSource() == TIME_SOURCE_NONE);
+  }
+  
+  /**
+   * @brief An RTC holding a time before RTC_MIN_VALID_EPOCH is not trusted
+   */
+  void checkBootNotSet() {
+    rtc = MemoryRtc(RTC_MIN_VALID_EPOCH - 1);
+    forget();
+    bool restored = clock.restoreFromRtc();
+    report("rtc.bootNotSet", 0,
+           !restored && !clock.isTimeValid() && clock.getTimeSource() == TIME_SOURCE_NONE);
+  }
+  
+  /**
+   * @brief A running RTC gives a valid time right at boot
+   */
+  void checkBootRestored() {
+    rtc = MemoryRtc(RTC_CHECK_EPOCH);
+    forget();
+    bool restored = clock.restoreFromRtc();
+    long error = errorFrom(RTC_CHECK_EPOCH);
+    report("rtc.bootRestored", error,
+           restored && clock.isTimeValid() && clock.getTimeSource() == TIME_SOURCE_RTC &&
+           within(error));
+  }
+  
+  /**
+   * @brief An NTP synchronization sets the RTC for the next boot
+   */
+  void checkNtpWrite() {
+    rtc = MemoryRtc();
+    forget();
+    clock.applyNtpTime(RTC_CHECK_NTP_EPOCH);
+    uint32_t stored = 0;
+    bool running = rtc.read(stored);
+    long error = (long)(stored - RTC_CHECK_NTP_EPOCH);
+    report("rtc.ntpWrite", error,
+           running && within(error) && clock.getTimeSource() == TIME_SOURCE_NTP &&
+           within(errorFrom(RTC_CHECK_NTP_EPOCH)));
+  }
+  
+  /**
+   * @brief A failed synchronization falls back on the RTC, which is then
+   *        re-read every RTC_HOLDOVER_INTERVAL
+   */
+  void checkHoldover() {
+    rtc = MemoryRtc();
+    forget();
+    clock.applyNtpTime(RTC_CHECK_NTP_EPOCH);
+    
+    // The RTC kept counting while the loop time drifted
+    rtc.write(RTC_CHECK_NTP_EPOCH + 120);
+    clock.holdoverOnRtc();
+    long error = errorFrom(RTC_CHECK_NTP_EPOCH + 120);
+    bool ok = clock.getTimeSource() == TIME_SOURCE_RTC && within(error);
+    
+    // A second failure does not read it again...
+    rtc.write(RTC_CHECK_NTP_EPOCH + 500);
+    clock.holdoverOnRtc();
+    ok = ok && within(errorFrom(RTC_CHECK_NTP_EPOCH + 120));
+    
+    // ...but the next holdover read in update() does
+    clock.lastRtcRead = Timebase::millis64() - RTC_HOLDOVER_INTERVAL;
+    clock.update();
+    long reread = errorFrom(RTC_CHECK_NTP_EPOCH + 500);
+    ok = ok && within(reread) && clock.getTimeSource() == TIME_SOURCE_RTC;
+    
+    report("rtc.holdover", within(error) ? reread : error, ok);
+  }
+  
+  /**
+   * @brief A holdover re-read that agrees with the clock keeps its edge
+   * 
+   * Without an NTP phase, the edge is where the boot restore put it; a
+   * re-read within a second must not move it, one further off must.
+   */
+  void checkHoldoverPhase() {
+    rtc = MemoryRtc(RTC_CHECK_EPOCH);
+    forget();
+    clock.restoreFromRtc();
+    uint64_t edge = clock.nextTick;
+    
+    clock.loadFromRtc();
+    bool kept = clock.nextTick == edge;
+    
+    rtc.write(RTC_CHECK_EPOCH + 5);
+    clock.loadFromRtc();
+    long error = errorFrom(RTC_CHECK_EPOCH + 5);
+    report("rtc.holdoverPhase", error,
+           kept && within(error) && clock.getTimeSource() == TIME_SOURCE_RTC);
+  }
+  
+  void report(const char* name, long error, bool ok) {
+    results.start(name);
+    results.field("source", (int)clock.getTimeSource());
+    results.field("error_s", error);
+    results.finish(ok);
+  }
+};
+
+#endif // RTC_CHECK_H
@@ -10,35 +10,30 @@
 #define SENSOR_MANAGER_H
 
 #include "config.h"
-
-/**
- * @struct SensorData
- * @brief Structure to hold all sensor readings
- */
-struct SensorData {
-  float tempIndoor;      ///< Indoor temperature (°C)
-  float tempOutdoor;     ///< Outdoor temperature (°C)
-  float humidityIndoor;  ///< Indoor humidity (%)
-  float humidityOutdoor; ///< Outdoor humidity (%)
-  float pressure;        ///< Atmospheric pressure (hPa)
-  int airQuality;        ///< Air quality (PPM)
-  bool isValid;          ///< Whether readings are valid
-};
+#include "Timebase.h"
+#include "SensorSource.h"
 
 /**
  * @class SensorManager
  * @brief Simplified sensor manager for testing
  */
 class SensorManager {
+  friend class Benchmark;
+
 private:
   SensorData currentData;
-  unsigned long lastReading;
+  uint64_t lastReading;
+  uint32_t sequence;    ///< Readings taken since boot
+  
+  // Reading source (simulation by default)
+  SimulatedSensorSource simulatedSource;
+  SensorSource* source;
 
 public:
   /**
    * @brief Constructor
    */
-  SensorManager() : lastReading(0) {
+  SensorManager() : lastReading(0), sequence(0), source(&simulatedSource) {
     // Initialize with test data
     currentData.tempIndoor = 22.5;
     currentData.tempOutdoor = 15.3;
@@ -54,7 +49,7 @@ public:
    */
   bool init() {
     DEBUG_PRINTLN("Initializing SensorManager...");
-    lastReading = millis();
+    lastReading = Timebase::millis64();
     DEBUG_PRINTLN("SensorManager initialized (test mode)");
     return true;
   }
@@ -63,24 +58,10 @@ public:
    * @brief Update sensor readings
    */
   void update() {
-    unsigned long currentTime = millis();
+    uint64_t currentTime = Timebase::millis64();
     
     if (currentTime - lastReading >= SENSOR_READ_INTERVAL) {
-      // Simulate sensor readings with small variations
-      currentData.tempIndoor += (random(-10, 11) / 10.0);
-      currentData.tempOutdoor += (random(-10, 11) / 10.0);
-      currentData.humidityIndoor += (random(-5, 6) / 10.0);
-      currentData.humidityOutdoor += (random(-5, 6) / 10.0);
-      currentData.pressure += (random(-10, 11) / 10.0);
-      currentData.airQuality += random(-5, 6);
-      
-      // Keep values in reasonable ranges
-      currentData.tempIndoor = constrain(currentData.tempIndoor, 18.0, 28.0);
-      currentData.tempOutdoor = constrain(currentData.tempOutdoor, 10.0, 25.0);
-      currentData.humidityIndoor = constrain(currentData.humidityIndoor, 30.0, 70.0);
-      currentData.humidityOutdoor = constrain(currentData.humidityOutdoor, 40.0, 90.0);
-      currentData.pressure = constrain(currentData.pressure, 980.0, 1040.0);
-      currentData.airQuality = constrain(currentData.airQuality, 30, 150);
+      sample();
       
       lastReading = currentTime;
       
@@ -91,6 +72,35 @@ public:
     }
   }
   
+  /**
+   * @brief Take one reading from the current source immediately
+   * 
+   * Bypasses SENSOR_READ_INTERVAL, so a trace can be replayed at
+   * virtual speed.
+   * 
+   * @return true if the source produced a reading
+   */
+  bool sample() {
+    SensorData reading;
+    if (!source->read(reading)) {
+      return false;
+    }
+    
+    currentData = reading;
+    filterReadings();
+    sequence++;
+    return true;
+  }
+  
+  /**
+   * @brief Select where readings come from
+   * 
+   * @param newSource Source to read from, or nullptr for the simulation
+   */
+  void setSource(SensorSource* newSource) {
+    source = newSource ? newSource : &simulatedSource;
+  }
+  
   /**
    * @brief Get all sensor data
    */
@@ -98,12 +108,35 @@ public:
     return currentData;
   }
   
+  /**
+   * @brief Get the sequence number of the current readings
+   * 
+   * Changes with every new reading, so a copy derived from them (e.g. a
+   * serialized response) can tell whether it is still current.
+   */
+  uint32_t getSequence() const {
+    return sequence;
+  }
+  
   /**
    * @brief Get air quality reading
    */
   int getAirQuality() const {
     return currentData.airQuality;
   }
+
+private:
+  /**
+   * @brief Keep readings within the sensors' physical limits
+   */
+  void filterReadings() {
+    currentData.tempIndoor = constrain(currentData.tempIndoor, TEMP_MIN, TEMP_MAX);
+    currentData.tempOutdoor = constrain(currentData.tempOutdoor, TEMP_MIN, TEMP_MAX);
+    currentData.humidityIndoor = constrain(currentData.humidityIndoor, HUMIDITY_MIN, HUMIDITY_MAX);
+    currentData.humidityOutdoor = constrain(currentData.humidityOutdoor, HUMIDITY_MIN, HUMIDITY_MAX);
+    currentData.pressure = constrain(currentData.pressure, PRESSURE_MIN, PRESSURE_MAX);
+    currentData.airQuality = constrain(currentData.airQuality, AIR_QUALITY_MIN, AIR_QUALITY_MAX);
+  }
 };
 
 #endif // SENSOR_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,332 @@
+/**
+ * @file SensorSource.h
+ * @brief Sensor reading sources, trace recording and replay
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * SensorManager pulls its readings from a SensorSource. The default source
+ * is a seeded simulation, so runs are reproducible. Readings can be
+ * captured to a compact binary trace with TraceRecorder and fed back with
+ * TraceReplaySource, letting filters and LED output be exercised with
+ * identical, realistic data.
+ * 
+ * Trace format (little-endian):
+ * - Header (8 bytes): magic "SNTR", version (1 byte), reserved (1 byte),
+ *   sample interval in seconds (uint16)
+ * - Records (12 bytes each):
+ *   int16  tempIndoor       0.01 °C
+ *   int16  tempOutdoor      0.01 °C
+ *   uint16 humidityIndoor   0.01 %
+ *   uint16 humidityOutdoor  0.01 %
+ *   uint16 pressure         0.02 hPa above TRACE_PRESSURE_BASE
+ *   uint16 airQuality       PPM, TRACE_INVALID_READING if not valid
+ * 
+ * The pressure field spans 300 to 1610 hPa, so every reading within the
+ * sensor limits (PRESSURE_MIN to PRESSURE_MAX) fits; others are clamped.
+ * Version 1 traces stored 0.01 hPa above 900 hPa and are still replayed.
+ */
+
+#ifndef SENSOR_SOURCE_H
+#define SENSOR_SOURCE_H
+
+#include "config.h"
+
+/**
+ * @struct SensorData
+ * @brief Structure to hold all sensor readings
+ */
+struct SensorData {
+  float tempIndoor;      ///< Indoor temperature (°C)
+  float tempOutdoor;     ///< Outdoor temperature (°C)
+  float humidityIndoor;  ///< Indoor humidity (%)
+  float humidityOutdoor; ///< Outdoor humidity (%)
+  float pressure;        ///< Atmospheric pressure (hPa)
+  int airQuality;        ///< Air quality (PPM)
+  bool isValid;          ///< Whether readings are valid
+};
+
+#define TRACE_HEADER_SIZE     8
+#define TRACE_RECORD_SIZE     12
+#define TRACE_VERSION         2
+#define TRACE_PRESSURE_BASE   PRESSURE_MIN  // hPa
+#define TRACE_PRESSURE_SCALE  50.0        // Steps per hPa (0.02 hPa)
+#define TRACE_V1_PRESSURE_BASE  900.0     // Version 1: 0.01 hPa above 900 hPa
+#define TRACE_V1_PRESSURE_SCALE 100.0
+#define TRACE_INVALID_READING 0xFFFF
+
+/**
+ * @class SensorSource
+ * @brief Interface for anything that produces sensor readings
+ */
+class SensorSource {
+public:
+  virtual ~SensorSource() {}
+  
+  /**
+   * @brief Produce the next reading
+   * 
+   * @param data Filled with the reading on success
+   * @return true if a reading was produced
+   */
+  virtual bool read(SensorData& data) = 0;
+};
+
+/**
+ * @class SimulatedSensorSource
+ * @brief Random-walk readings from a seeded generator
+ * 
+ * Uses its own xorshift generator rather than random(), so two sources
+ * built with the same seed produce the same sequence.
+ */
+class SimulatedSensorSource : public SensorSource {
+private:
+  SensorData state;
+  uint32_t rngState;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param seed Generator seed (must be non-zero)
+   */
+  explicit SimulatedSensorSource(uint32_t seed = SENSOR_SIM_SEED) : rngState(seed ? seed : 1) {
+    state.tempIndoor = 22.5;
+    state.tempOutdoor = 15.3;
+    state.humidityIndoor = 45.0;
+    state.humidityOutdoor = 65.0;
+    state.pressure = 1013.25;
+    state.airQuality = 75;
+    state.isValid = true;
+  }
+  
+  bool read(SensorData& data) override {
+    // Simulate sensor readings with small variations
+    state.tempIndoor += (nextInRange(-10, 11) / 10.0);
+    state.tempOutdoor += (nextInRange(-10, 11) / 10.0);
+    state.humidityIndoor += (nextInRange(-5, 6) / 10.0);
+    state.humidityOutdoor += (nextInRange(-5, 6) / 10.0);
+    state.pressure += (nextInRange(-10, 11) / 10.0);
+    state.airQuality += nextInRange(-5, 6);
+    
+    // Keep values in a plausible indoor/outdoor range
+    state.tempIndoor = constrain(state.tempIndoor, 18.0, 28.0);
+    state.tempOutdoor = constrain(state.tempOutdoor, 10.0, 25.0);
+    state.humidityIndoor = constrain(state.humidityIndoor, 30.0, 70.0);
+    state.humidityOutdoor = constrain(state.humidityOutdoor, 40.0, 90.0);
+    state.pressure = constrain(state.pressure, 980.0, 1040.0);
+    state.airQuality = constrain(state.airQuality, 30, 150);
+    
+    data = state;
+    return true;
+  }
+
+private:
+  /**
+   * @brief Uniform value in [low, high), like random(low, high)
+   */
+  long nextInRange(long low, long high) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return low + (long)(rngState % (uint32_t)(high - low));
+  }
+};
+
+/**
+ * @class TraceRecorder
+ * @brief Passes readings through from another source and records them
+ * 
+ * Wrap the source whose readings should be captured and install the
+ * recorder as SensorManager's source. The trace is written to any Print,
+ * typically Serial.
+ */
+class TraceRecorder : public SensorSource {
+private:
+  SensorSource& inner;
+  Print& out;
+  bool headerWritten;
+  unsigned long recordCount;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param source Source to record
+   * @param output Destination of the binary trace
+   */
+  TraceRecorder(SensorSource& source, Print& output) :
+    inner(source),
+    out(output),
+    headerWritten(false),
+    recordCount(0) {}
+  
+  bool read(SensorData& data) override {
+    if (!inner.read(data)) {
+      return false;
+    }
+    
+    uint8_t buffer[TRACE_RECORD_SIZE];
+    if (!headerWritten) {
+      writeHeader(buffer);
+      out.write(buffer, TRACE_HEADER_SIZE);
+      headerWritten = true;
+    }
+    
+    encodeRecord(data, buffer);
+    out.write(buffer, TRACE_RECORD_SIZE);
+    recordCount++;
+    return true;
+  }
+  
+  /**
+   * @brief Get number of records written
+   */
+  unsigned long getRecordCount() const {
+    return recordCount;
+  }
+  
+  /**
+   * @brief Write the trace header
+   * 
+   * @param buffer Destination, at least TRACE_HEADER_SIZE bytes
+   */
+  static void writeHeader(uint8_t* buffer) {
+    const uint16_t intervalSeconds = SENSOR_READ_INTERVAL / 1000;
+    buffer[0] = 'S';
+    buffer[1] = 'N';
+    buffer[2] = 'T';
+    buffer[3] = 'R';
+    buffer[4] = TRACE_VERSION;
+    buffer[5] = 0;
+    buffer[6] = intervalSeconds & 0xFF;
+    buffer[7] = intervalSeconds >> 8;
+  }
+  
+  /**
+   * @brief Encode one reading as a fixed-point record
+   * 
+   * @param data Reading to encode
+   * @param buffer Destination, at least TRACE_RECORD_SIZE bytes
+   */
+  static void encodeRecord(const SensorData& data, uint8_t* buffer) {
+    put16(buffer + 0, (uint16_t)(int16_t)toFixed(data.tempIndoor, 0.0));
+    put16(buffer + 2, (uint16_t)(int16_t)toFixed(data.tempOutdoor, 0.0));
+    put16(buffer + 4, (uint16_t)toFixed(data.humidityIndoor, 0.0));
+    put16(buffer + 6, (uint16_t)toFixed(data.humidityOutdoor, 0.0));
+    float pressure = constrain(data.pressure, PRESSURE_MIN, PRESSURE_MAX);
+    put16(buffer + 8, (uint16_t)toFixed(pressure, TRACE_PRESSURE_BASE, TRACE_PRESSURE_SCALE));
+    put16(buffer + 10, data.isValid ? (uint16_t)constrain(data.airQuality, 0, 0xFFFE)
+                                    : (uint16_t)TRACE_INVALID_READING);
+  }
+
+private:
+  static long toFixed(float value, float base, float scale = 100.0f) {
+    float scaled = (value - base) * scale;
+    return (long)(scaled + (scaled < 0 ? -0.5f : 0.5f));
+  }
+  
+  static void put16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+  }
+};
+
+/**
+ * @class TraceReplaySource
+ * @brief Feeds readings back from a recorded binary trace
+ * 
+ * The trace is read in place (it may live in flash), so replay needs no
+ * buffer of its own. Drive SensorManager::sample() directly to replay at
+ * virtual speed instead of waiting SENSOR_READ_INTERVAL between samples.
+ */
+class TraceReplaySource : public SensorSource {
+private:
+  const uint8_t* trace;
+  size_t length;
+  size_t position;
+  bool loop;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param data Trace bytes, header included
+   * @param size Trace length in bytes
+   * @param loopTrace Restart from the first record at the end of the trace
+   */
+  TraceReplaySource(const uint8_t* data, size_t size, bool loopTrace = false) :
+    trace(data),
+    length(size),
+    position(TRACE_HEADER_SIZE),
+    loop(loopTrace) {}
+  
+  /**
+   * @brief Check the trace header
+   * 
+   * @return true if the trace has a supported header
+   */
+  bool isValid() const {
+    return length >= TRACE_HEADER_SIZE &&
+           trace[0] == 'S' && trace[1] == 'N' && trace[2] == 'T' && trace[3] == 'R' &&
+           (trace[4] == TRACE_VERSION || trace[4] == 1);
+  }
+  
+  /**
+   * @brief Get number of records in the trace
+   */
+  size_t getRecordCount() const {
+    return isValid() ? (length - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE : 0;
+  }
+  
+  /**
+   * @brief Restart replay from the first record
+   */
+  void rewind() {
+    position = TRACE_HEADER_SIZE;
+  }
+  
+  bool read(SensorData& data) override {
+    if (!isValid()) {
+      return false;
+    }
+    
+    if (position + TRACE_RECORD_SIZE > length) {
+      if (!loop || getRecordCount() == 0) {
+        return false;
+      }
+      rewind();
+    }
+    
+    decodeRecord(trace + position, data, trace[4]);
+    position += TRACE_RECORD_SIZE;
+    return true;
+  }
+  
+  /**
+   * @brief Decode one fixed-point record
+   * 
+   * @param buffer Record bytes, TRACE_RECORD_SIZE long
+   * @param data Decoded reading
+   * @param version Trace format version
+   */
+  static void decodeRecord(const uint8_t* buffer, SensorData& data, uint8_t version = TRACE_VERSION) {
+    data.tempIndoor = (int16_t)get16(buffer + 0) / 100.0f;
+    data.tempOutdoor = (int16_t)get16(buffer + 2) / 100.0f;
+    data.humidityIndoor = get16(buffer + 4) / 100.0f;
+    data.humidityOutdoor = get16(buffer + 6) / 100.0f;
+    data.pressure = version == 1 ? TRACE_V1_PRESSURE_BASE + get16(buffer + 8) / TRACE_V1_PRESSURE_SCALE
+                                 : TRACE_PRESSURE_BASE + get16(buffer + 8) / TRACE_PRESSURE_SCALE;
+    
+    uint16_t airQuality = get16(buffer + 10);
+    data.isValid = (airQuality != TRACE_INVALID_READING);
+    data.airQuality = data.isValid ? airQuality : 0;
+  }
+
+private:
+  static uint16_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+  }
+};
+
+#endif // SENSOR_SOURCE_H
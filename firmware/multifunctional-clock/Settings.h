@@ -0,0 +1,419 @@
+/**
+ * @file Settings.h
+ * @brief User settings and the parser for settings writes
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Settings are written over HTTP as an application/x-www-form-urlencoded
+ * body ("nightStart=22&nightEnd=7"). The parser is an incremental state
+ * machine with fixed-size key/value buffers, so a body can be fed in any
+ * chunking without allocation. Values are checked against the range and
+ * choices in the settings table before they are applied.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include "config.h"
+
+/**
+ * @brief Identifiers of the configurable settings, in menu order
+ */
+enum SettingId {
+  SETTING_NIGHT_START = 0,
+  SETTING_NIGHT_END,
+  SETTING_NIGHT_BRIGHTNESS,
+  SETTING_TIMEZONE,
+  SETTING_DST,
+  SETTING_SUNRISE_MINUTES,
+  SETTING_ALARM1_HOUR,
+  SETTING_ALARM1_MINUTE,
+  SETTING_ALARM1_DAYS,
+  SETTING_ALARM2_HOUR,
+  SETTING_ALARM2_MINUTE,
+  SETTING_ALARM2_DAYS,
+  SETTING_COUNT
+};
+
+#define SETTINGS_PER_ALARM    3
+
+static_assert(SETTING_COUNT == SETTING_ALARM1_HOUR + ALARM_COUNT * SETTINGS_PER_ALARM,
+              "Settings table must have one hour/minute/days group per alarm");
+
+// Alarm days: bit 0 = Sunday ... bit 6 = Saturday
+#define ALARM_DAYS_OFF        0
+#define ALARM_DAYS_WEEKDAYS   0x3E
+#define ALARM_DAYS_WEEKEND    0x41
+#define ALARM_DAYS_EVERY_DAY  0x7F
+#define ALARM_DAYS_ONCE       0x80  // Next occurrence only
+
+// Alarm day presets offered by the settings menu
+static const int16_t ALARM_DAY_CHOICES[] = {
+  ALARM_DAYS_OFF, ALARM_DAYS_ONCE, ALARM_DAYS_WEEKDAYS, ALARM_DAYS_WEEKEND, ALARM_DAYS_EVERY_DAY
+};
+
+// Wake light lengths offered by the settings menu (0 = off)
+static const int16_t SUNRISE_CHOICES[] = { 0, 10, 15, 20, 25, 30 };
+
+/**
+ * @struct SettingInfo
+ * @brief Name and valid range of one setting
+ */
+struct SettingInfo {
+  const char* key;          ///< Key used by the HTTP API
+  int16_t min;              ///< Minimum accepted value
+  int16_t max;              ///< Maximum accepted value
+  int16_t step;             ///< Increment used by the settings menu
+  const int16_t* choices;   ///< Values offered by the menu instead of steps
+  uint8_t choiceCount;      ///< Number of choices
+};
+
+static const SettingInfo SETTINGS_TABLE[SETTING_COUNT] = {
+  { "nightStart",      0,   23,  1,  nullptr, 0 },
+  { "nightEnd",        0,   23,  1,  nullptr, 0 },
+  { "nightBrightness", 1,   255, 10, nullptr, 0 },
+  { "timezone",        -12, 14,  1,  nullptr, 0 },
+  { "dst",             0,   1,   1,  nullptr, 0 },
+  { "sunriseMinutes",  0,   30,  5,  SUNRISE_CHOICES, 6 },
+  { "alarm1Hour",      0,   23,  1,  nullptr, 0 },
+  { "alarm1Minute",    0,   59,  5,  nullptr, 0 },
+  { "alarm1Days",      0,   ALARM_DAYS_ONCE, 1, ALARM_DAY_CHOICES, 5 },
+  { "alarm2Hour",      0,   23,  1,  nullptr, 0 },
+  { "alarm2Minute",    0,   59,  5,  nullptr, 0 },
+  { "alarm2Days",      0,   ALARM_DAYS_ONCE, 1, ALARM_DAY_CHOICES, 5 }
+};
+
+/**
+ * @struct Settings
+ * @brief Current values of the user settings
+ */
+struct Settings {
+  int16_t values[SETTING_COUNT];  ///< Indexed by SettingId
+  
+  /**
+   * @brief Reset every setting to its config.h default
+   */
+  void loadDefaults() {
+    values[SETTING_NIGHT_START] = NIGHT_MODE_START;
+    values[SETTING_NIGHT_END] = NIGHT_MODE_END;
+    values[SETTING_NIGHT_BRIGHTNESS] = NIGHT_BRIGHTNESS;
+    values[SETTING_TIMEZONE] = TIMEZONE_OFFSET;
+    values[SETTING_DST] = DST_OFFSET;
+    values[SETTING_SUNRISE_MINUTES] = SUNRISE_DEFAULT_MINUTES;
+    for (int i = 0; i < ALARM_COUNT; i++) {
+      values[SETTING_ALARM1_HOUR + i * SETTINGS_PER_ALARM] = ALARM_DEFAULT_HOUR;
+      values[SETTING_ALARM1_MINUTE + i * SETTINGS_PER_ALARM] = ALARM_DEFAULT_MINUTE;
+      values[SETTING_ALARM1_DAYS + i * SETTINGS_PER_ALARM] = ALARM_DAYS_OFF;
+    }
+  }
+  
+  /**
+   * @brief Get a setting value
+   */
+  int16_t get(SettingId id) const {
+    return values[id];
+  }
+  
+  /**
+   * @brief Set a setting value if it is within range
+   * 
+   * Settings with choices only take one of them, as offered by the menu.
+   * 
+   * @return true if the value was accepted
+   */
+  bool set(SettingId id, long value) {
+    if (id >= SETTING_COUNT || !isAllowed(SETTINGS_TABLE[id], value)) {
+      return false;
+    }
+    values[id] = (int16_t)value;
+    return true;
+  }
+  
+  /**
+   * @brief Check a value against the range and choices of a setting
+   */
+  static bool isAllowed(const SettingInfo& info, long value) {
+    if (value < info.min || value > info.max) {
+      return false;
+    }
+    if (!info.choices) {
+      return true;
+    }
+    for (uint8_t i = 0; i < info.choiceCount; i++) {
+      if (info.choices[i] == value) {
+        return true;
+      }
+    }
+    return false;
+  }
+  
+  /**
+   * @brief Move a setting to the next value offered by the settings menu
+   * 
+   * Steps by the table increment, or to the next preset for settings
+   * with choices, and wraps around to the start of the range.
+   */
+  void increment(SettingId id) {
+    const SettingInfo& info = SETTINGS_TABLE[id];
+    if (info.choices) {
+      // Value after the current one, or the first if it is not a preset
+      uint8_t i = 0;
+      while (i < info.choiceCount && info.choices[i] != values[id]) {
+        i++;
+      }
+      values[id] = info.choices[i + 1 < info.choiceCount ? i + 1 : 0];
+    } else if (values[id] + info.step > info.max) {
+      values[id] = info.min;
+    } else {
+      values[id] += info.step;
+    }
+  }
+  
+  /**
+   * @brief Serialize all settings as a JSON object
+   * 
+   * @return Length written, or 0 if the buffer is too small
+   */
+  size_t toJson(char* buffer, size_t size) const {
+    size_t len = 0;
+    for (int i = 0; i < SETTING_COUNT; i++) {
+      int n = snprintf(buffer + len, size - len, "%s\"%s\":%d",
+                       i == 0 ? "{" : ",", SETTINGS_TABLE[i].key, values[i]);
+      if (n < 0 || len + n >= size) {
+        if (size > 0) buffer[0] = '\0';
+        return 0;
+      }
+      len += n;
+    }
+    if (len + 2 > size) {
+      buffer[0] = '\0';
+      return 0;
+    }
+    buffer[len++] = '}';
+    buffer[len] = '\0';
+    return len;
+  }
+};
+
+/**
+ * @class SettingsParser
+ * @brief Incremental parser for urlencoded settings writes
+ * 
+ * Applies each key=value pair to the target as soon as it is complete.
+ * Callers should parse into a copy and keep it only if hasError() is
+ * false, so a partly invalid write changes nothing.
+ */
+class SettingsParser {
+private:
+  enum State {
+    STATE_KEY,
+    STATE_VALUE,
+    STATE_ERROR
+  };
+  
+  Settings& target;
+  State state;
+  
+  char key[SETTINGS_MAX_KEY + 1];
+  uint8_t keyLength;
+  char value[SETTINGS_MAX_VALUE + 1];
+  uint8_t valueLength;
+  
+  // Percent-escape decoding ("%2D" -> '-')
+  uint8_t escapeDigits;
+  uint8_t escapeValue;
+  
+  uint8_t appliedCount;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param settings Settings to apply parsed values to
+   */
+  explicit SettingsParser(Settings& settings) : target(settings) {
+    reset();
+  }
+  
+  /**
+   * @brief Prepare for a new body
+   */
+  void reset() {
+    state = STATE_KEY;
+    keyLength = 0;
+    valueLength = 0;
+    escapeDigits = 0;
+    escapeValue = 0;
+    appliedCount = 0;
+    key[0] = '\0';
+    value[0] = '\0';
+  }
+  
+  /**
+   * @brief Feed a chunk of the body
+   */
+  void feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length && state != STATE_ERROR; i++) {
+      feed(data[i]);
+    }
+  }
+  
+  /**
+   * @brief Feed one byte of the body
+   */
+  void feed(char c) {
+    if (state == STATE_ERROR) {
+      return;
+    }
+    
+    if (escapeDigits > 0) {
+      int digit = hexDigit(c);
+      if (digit < 0) {
+        state = STATE_ERROR;
+        return;
+      }
+      escapeValue = (escapeValue << 4) | digit;
+      if (--escapeDigits == 0) {
+        appendDecoded((char)escapeValue);
+      }
+      return;
+    }
+    
+    switch (c) {
+      case '%':
+        escapeDigits = 2;
+        escapeValue = 0;
+        break;
+      case '+':
+        appendDecoded(' ');
+        break;
+      case '=':
+        if (state != STATE_KEY || keyLength == 0) {
+          state = STATE_ERROR;
+        } else {
+          state = STATE_VALUE;
+        }
+        break;
+      case '&':
+        completePair();
+        break;
+      default:
+        appendDecoded(c);
+        break;
+    }
+  }
+  
+  /**
+   * @brief Signal the end of the body
+   * 
+   * @return true if the whole body was valid
+   */
+  bool finish() {
+    if (escapeDigits > 0) {
+      state = STATE_ERROR;
+    }
+    completePair();
+    return !hasError();
+  }
+  
+  /**
+   * @brief Check whether a malformed pair or invalid value was seen
+   */
+  bool hasError() const {
+    return state == STATE_ERROR;
+  }
+  
+  /**
+   * @brief Get number of settings applied so far
+   */
+  uint8_t getAppliedCount() const {
+    return appliedCount;
+  }
+
+private:
+  static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+  
+  void appendDecoded(char c) {
+    if (state == STATE_KEY) {
+      if (keyLength >= SETTINGS_MAX_KEY) {
+        state = STATE_ERROR;
+        return;
+      }
+      key[keyLength++] = c;
+      key[keyLength] = '\0';
+    } else if (state == STATE_VALUE) {
+      if (valueLength >= SETTINGS_MAX_VALUE) {
+        state = STATE_ERROR;
+        return;
+      }
+      value[valueLength++] = c;
+      value[valueLength] = '\0';
+    }
+  }
+  
+  /**
+   * @brief Apply the pair collected so far and start a new one
+   */
+  void completePair() {
+    if (state == STATE_ERROR) {
+      return;
+    }
+    
+    // Empty segments ("a=1&&b=2", trailing '&') are ignored
+    if (state == STATE_KEY && keyLength == 0) {
+      return;
+    }
+    
+    long parsed;
+    if (state != STATE_VALUE || !parseInteger(parsed) || !applyPair(parsed)) {
+      state = STATE_ERROR;
+      return;
+    }
+    
+    appliedCount++;
+    state = STATE_KEY;
+    keyLength = 0;
+    valueLength = 0;
+    key[0] = '\0';
+    value[0] = '\0';
+  }
+  
+  bool parseInteger(long& result) const {
+    uint8_t i = 0;
+    bool negative = false;
+    if (valueLength > 0 && value[0] == '-') {
+      negative = true;
+      i = 1;
+    }
+    if (i >= valueLength) {
+      return false;
+    }
+    
+    long magnitude = 0;
+    for (; i < valueLength; i++) {
+      if (value[i] < '0' || value[i] > '9' || magnitude > 32767) {
+        return false;
+      }
+      magnitude = magnitude * 10 + (value[i] - '0');
+    }
+    result = negative ? -magnitude : magnitude;
+    return true;
+  }
+  
+  bool applyPair(long parsed) {
+    for (int i = 0; i < SETTING_COUNT; i++) {
+      if (strcmp(key, SETTINGS_TABLE[i].key) == 0) {
+        return target.set((SettingId)i, parsed);
+      }
+    }
+    return false;  // Unknown key
+  }
+};
+
+#endif // SETTINGS_H
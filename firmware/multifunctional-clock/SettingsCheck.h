@@ -0,0 +1,184 @@
+/**
+ * @file SettingsCheck.h
+ * @brief Check of the values accepted for each setting
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Settings with choices (wake light length, alarm days) must only take one
+ * of the values the menu offers, whether written with set() or over HTTP
+ * through SettingsParser; other settings take any value in their range.
+ * The menu's increment() must only step to accepted values.
+ */
+
+#ifndef SETTINGS_CHECK_H
+#define SETTINGS_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "Settings.h"
+
+/**
+ * @class SettingsCheck
+ * @brief Runs every settings scenario
+ */
+class SettingsCheck {
+private:
+  CheckReport results;
+  uint32_t errors;
+  uint32_t tried;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  SettingsCheck() :
+    results("SETTINGS"),
+    errors(0),
+    tried(0) {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    checkRanges();
+    checkChoices();
+    checkParser();
+    checkMenu();
+    
+    return results.end();
+  }
+
+private:
+  void start() {
+    errors = 0;
+    tried = 0;
+  }
+  
+  /**
+   * @brief Try one value and compare with the expected outcome
+   * 
+   * A rejected value must leave the setting unchanged.
+   */
+  void expectSet(Settings& settings, SettingId id, long value, bool accepted) {
+    int16_t before = settings.get(id);
+    bool result = settings.set(id, value);
+    tried++;
+    if (result != accepted || settings.get(id) != (accepted ? value : before)) {
+      errors++;
+    }
+  }
+  
+  /**
+   * @brief Settings without choices take their whole range and no more
+   */
+  void checkRanges() {
+    start();
+    Settings settings;
+    settings.loadDefaults();
+    for (int i = 0; i < SETTING_COUNT; i++) {
+      const SettingInfo& info = SETTINGS_TABLE[i];
+      if (info.choices) {
+        continue;
+      }
+      for (long value = info.min; value <= info.max; value++) {
+        expectSet(settings, (SettingId)i, value, true);
+      }
+      expectSet(settings, (SettingId)i, info.min - 1L, false);
+      expectSet(settings, (SettingId)i, info.max + 1L, false);
+    }
+    report("settings.ranges");
+  }
+  
+  /**
+   * @brief Settings with choices take exactly their choices
+   */
+  void checkChoices() {
+    start();
+    Settings settings;
+    settings.loadDefaults();
+    for (int i = 0; i < SETTING_COUNT; i++) {
+      const SettingInfo& info = SETTINGS_TABLE[i];
+      if (!info.choices) {
+        continue;
+      }
+      for (long value = info.min - 1L; value <= info.max + 1L; value++) {
+        bool choice = false;
+        for (uint8_t c = 0; c < info.choiceCount; c++) {
+          choice = choice || info.choices[c] == value;
+        }
+        expectSet(settings, (SettingId)i, value, choice);
+      }
+    }
+    report("settings.choices");
+  }
+  
+  /**
+   * @brief A write over HTTP with a value off the choices changes nothing
+   */
+  void checkParser() {
+    start();
+    static const struct {
+      const char* body;
+      bool accepted;
+    } WRITES[] = {
+      { "sunriseMinutes=20&alarm1Days=62", true },
+      { "sunriseMinutes=30&alarm2Days=128", true },
+      { "sunriseMinutes=12", false },
+      { "nightStart=22&sunriseMinutes=5", false },
+      { "alarm1Days=1", false },
+      { "alarm2Days=%2D1", false },
+      { "nightStart=21&nightEnd=6", true }
+    };
+    
+    for (size_t i = 0; i < sizeof(WRITES) / sizeof(WRITES[0]); i++) {
+      Settings settings;
+      settings.loadDefaults();
+      Settings updated = settings;
+      SettingsParser parser(updated);
+      parser.feed(WRITES[i].body, strlen(WRITES[i].body));
+      bool ok = parser.finish();
+      tried++;
+      if (ok != WRITES[i].accepted) {
+        errors++;
+      }
+      // Whatever was kept must be valid
+      for (int id = 0; ok && id < SETTING_COUNT; id++) {
+        if (!Settings::isAllowed(SETTINGS_TABLE[id], updated.get((SettingId)id))) errors++;
+      }
+    }
+    report("settings.parser");
+  }
+  
+  /**
+   * @brief Every step of the menu lands on an accepted value
+   */
+  void checkMenu() {
+    start();
+    Settings settings;
+    settings.loadDefaults();
+    for (int i = 0; i < SETTING_COUNT; i++) {
+      const SettingInfo& info = SETTINGS_TABLE[i];
+      int steps = info.choices ? info.choiceCount : (info.max - info.min) / info.step + 1;
+      for (int n = 0; n < steps; n++) {
+        settings.increment((SettingId)i);
+        tried++;
+        if (!Settings::isAllowed(info, settings.get((SettingId)i))) errors++;
+      }
+    }
+    report("settings.menu");
+  }
+  
+  void report(const char* name) {
+    results.start(name);
+    results.field("values", tried);
+    results.field("errors", errors);
+    results.finish(errors == 0);
+  }
+};
+
+#endif // SETTINGS_CHECK_H
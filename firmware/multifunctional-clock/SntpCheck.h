@@ -0,0 +1,173 @@
+/**
+ * @file SntpCheck.h
+ * @brief Load check for the SNTP responder with a local client
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * LoopbackSntpClient stands in for the UDP socket: it queues a burst of
+ * client requests stamped from the same timebase, and checks every reply
+ * the responder sends with NtpPacket::parseReply(), as a client would.
+ * The receive and transmit times must fall between the request and the
+ * reply, the stratum must be one below the upstream server, and no loop
+ * iteration may answer more than SNTP_MAX_PER_POLL requests.
+ */
+
+#ifndef SNTP_CHECK_H
+#define SNTP_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "Timebase.h"
+#include "SntpResponder.h"
+
+#define SNTP_CHECK_BURST        16
+#define SNTP_CHECK_OFFSET       1748736000000000LL  // 2025-06-01 UTC at timebase zero
+#define SNTP_CHECK_STRATUM      2                   // Upstream stratum
+
+/**
+ * @class LoopbackSntpClient
+ * @brief SntpPort fed by a local client, checking each reply
+ */
+class LoopbackSntpClient : public SntpPort {
+private:
+  uint8_t requests[SNTP_CHECK_BURST][NTP_PACKET_SIZE];
+  NtpTimestamp nonces[SNTP_CHECK_BURST];
+  uint8_t queued;
+  uint8_t next;        ///< Next request to hand to the responder
+  uint8_t current;     ///< Request being answered
+
+public:
+  uint8_t replies;     ///< Replies received
+  uint8_t invalid;     ///< Replies that failed a client check
+  
+  LoopbackSntpClient() : queued(0), next(0), current(0), replies(0), invalid(0) {}
+  
+  /**
+   * @brief Queue a client request stamped with the current time (T1)
+   * 
+   * @param mode NTP mode to send, 3 for a valid client request
+   */
+  void send(uint8_t mode) {
+    if (queued >= SNTP_CHECK_BURST) return;
+    nonces[queued] = NtpPacket::fromUnixMicros(now());
+    NtpPacket::buildRequest(requests[queued], nonces[queued]);
+    requests[queued][0] = (requests[queued][0] & 0xF8) | mode;
+    queued++;
+  }
+  
+  int receive(uint8_t* buffer, size_t size) override {
+    if (next >= queued || size < NTP_PACKET_SIZE) {
+      return 0;
+    }
+    current = next++;
+    memcpy(buffer, requests[current], NTP_PACKET_SIZE);
+    return NTP_PACKET_SIZE;
+  }
+  
+  bool reply(const uint8_t* buffer, size_t length) override {
+    int64_t receivedAt = now();  // T4
+    replies++;
+    
+    NtpReply reply;
+    if (NtpPacket::parseReply(buffer, length, nonces[current], reply) != NTP_OK) {
+      invalid++;
+      return true;
+    }
+    // T1 <= T2 <= T3 <= T4 on a shared clock (1 us of rounding)
+    int64_t sentAt = NtpPacket::toUnixMicros(nonces[current]);
+    int64_t t2 = NtpPacket::toUnixMicros(reply.receive);
+    int64_t t3 = NtpPacket::toUnixMicros(reply.transmit);
+    if (t2 + 1 < sentAt || t3 < t2 || receivedAt + 1 < t3 ||
+        reply.stratum != SNTP_CHECK_STRATUM + 1) {
+      invalid++;
+    }
+    return true;
+  }
+  
+  bool drained() const {
+    return next >= queued;
+  }
+
+private:
+  static int64_t now() {
+    return (int64_t)Timebase::micros64() + SNTP_CHECK_OFFSET;
+  }
+};
+
+/**
+ * @class SntpCheck
+ * @brief Runs the responder scenarios and prints the results
+ */
+class SntpCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  SntpCheck() : results("SNTP") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    NtpReference reference;
+    reference.offset = SNTP_CHECK_OFFSET;
+    reference.stratum = SNTP_CHECK_STRATUM;
+    reference.referenceId = 0xC0000201UL;  // 192.0.2.1
+    reference.rootDelay = 20000;
+    reference.rootDispersion = 5000;
+    reference.syncedAt = Timebase::millis64();
+    
+    runBurst("sntp.burst", &reference, 3, SNTP_CHECK_BURST);
+    runBurst("sntp.unsynchronized", nullptr, 3, 0);
+    runBurst("sntp.notClient", &reference, 4, 0);
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief Queue a burst, poll until drained and check the replies
+   * 
+   * @param mode Mode of the queued requests
+   * @param expected Number of valid replies expected
+   */
+  void runBurst(const char* name, const NtpReference* reference, uint8_t mode, uint8_t expected) {
+    LoopbackSntpClient client;
+    SntpResponder responder(&client);
+    for (uint8_t i = 0; i < SNTP_CHECK_BURST; i++) {
+      client.send(mode);
+    }
+    
+    uint8_t polls = 0;
+    uint8_t maxPerPoll = 0;
+    unsigned long maxPollMicros = 0;
+    while (!client.drained() && polls < 255) {
+      unsigned long start = micros();
+      uint8_t answered = responder.poll(reference);
+      unsigned long elapsed = micros() - start;
+      if (answered > maxPerPoll) maxPerPoll = answered;
+      if (elapsed > maxPollMicros) maxPollMicros = elapsed;
+      polls++;
+    }
+    
+    bool ok = client.drained() && client.replies == expected && client.invalid == 0 &&
+              maxPerPoll <= SNTP_MAX_PER_POLL;
+    
+    results.start(name);
+    results.field("requests", SNTP_CHECK_BURST);
+    results.field("replies", client.replies);
+    results.field("polls", polls);
+    results.field("max_poll_us", maxPollMicros);
+    results.finish(ok);
+  }
+};
+
+#endif // SNTP_CHECK_H
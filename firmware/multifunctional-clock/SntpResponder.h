@@ -0,0 +1,174 @@
+/**
+ * @file SntpResponder.h
+ * @brief SNTP server answering LAN clients from the synchronized clock
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Once the clock is synchronized, it answers SNTP requests on the local
+ * network, so other devices and clocks do not all query the public pool.
+ * Times come from the 64-bit timebase plus the NTP offset, with the
+ * receive time taken when a request is read and the transmit time just
+ * before the reply is sent. Nothing is allocated: requests and replies
+ * use one stack buffer each. At most SNTP_MAX_PER_POLL requests are
+ * answered per loop iteration, so a burst is spread over a few iterations
+ * instead of delaying LED frames; requests are dropped unanswered while
+ * the clock is not synchronized, and clients move on to another server.
+ */
+
+#ifndef SNTP_RESPONDER_H
+#define SNTP_RESPONDER_H
+
+#include "config.h"
+#include "Timebase.h"
+#include "NtpPacket.h"
+#include "NtpSync.h"
+#include <WiFiUdp.h>
+
+/**
+ * @class SntpPort
+ * @brief Interface for receiving requests and answering their sender
+ */
+class SntpPort {
+public:
+  virtual ~SntpPort() {}
+  
+  /**
+   * @brief Read one pending request without waiting
+   * 
+   * @return Number of bytes read, 0 if nothing has arrived
+   */
+  virtual int receive(uint8_t* buffer, size_t size) = 0;
+  
+  /**
+   * @brief Send a datagram to the sender of the last request
+   * 
+   * @return true if the datagram was sent
+   */
+  virtual bool reply(const uint8_t* buffer, size_t length) = 0;
+};
+
+/**
+ * @class UdpSntpPort
+ * @brief SNTP port over WiFiUDP
+ */
+class UdpSntpPort : public SntpPort {
+private:
+  WiFiUDP udp;
+  bool open;
+
+public:
+  UdpSntpPort() : open(false) {}
+  
+  /**
+   * @brief Open the port, once the network is up
+   */
+  bool begin() {
+    if (!open) {
+      open = udp.begin(NTP_PORT);
+    }
+    return open;
+  }
+  
+  int receive(uint8_t* buffer, size_t size) override {
+    if (!open || udp.parsePacket() <= 0) {
+      return 0;
+    }
+    int length = udp.read(buffer, size);
+    return length > 0 ? length : 0;
+  }
+  
+  bool reply(const uint8_t* buffer, size_t length) override {
+    return udp.beginPacket(udp.remoteIP(), udp.remotePort()) &&
+           udp.write(buffer, length) == length &&
+           udp.endPacket();
+  }
+};
+
+/**
+ * @class SntpResponder
+ * @brief Answers client requests with server (mode 4) replies
+ */
+class SntpResponder {
+private:
+  SntpPort* port;
+  
+  // Traffic counters
+  unsigned long served;
+  unsigned long unsynchronized;  ///< Dropped: clock not synchronized
+  unsigned long malformed;       ///< Dropped: not a client request
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param sntpPort Where requests are read and answered
+   */
+  explicit SntpResponder(SntpPort* sntpPort) :
+    port(sntpPort),
+    served(0),
+    unsynchronized(0),
+    malformed(0) {}
+  
+  /**
+   * @brief Answer the pending requests, up to SNTP_MAX_PER_POLL
+   * 
+   * Should be called every loop iteration.
+   * 
+   * @param reference Last synchronization, or nullptr if the clock is not
+   * synchronized
+   * @return Number of requests answered
+   */
+  uint8_t poll(const NtpReference* reference) {
+    uint8_t answered = 0;
+    for (uint8_t n = 0; n < SNTP_MAX_PER_POLL; n++) {
+      uint8_t request[NTP_PACKET_SIZE];
+      int length = port->receive(request, sizeof(request));
+      if (length <= 0) {
+        break;
+      }
+      int64_t receivedAt = (int64_t)Timebase::micros64();
+      
+      if (!NtpPacket::isClientRequest(request, length)) {
+        malformed++;
+        continue;
+      }
+      if (!reference) {
+        unsynchronized++;
+        continue;
+      }
+      
+      if (answer(request, *reference, receivedAt)) {
+        served++;
+        answered++;
+      }
+    }
+    return answered;
+  }
+  
+  unsigned long getServedCount() const { return served; }
+  unsigned long getUnsynchronizedCount() const { return unsynchronized; }
+  unsigned long getMalformedCount() const { return malformed; }
+
+private:
+  bool answer(const uint8_t* request, const NtpReference& reference, int64_t receivedAt) {
+    // Our error bound grows with the time since the last sync
+    int64_t age = (int64_t)(Timebase::millis64() - reference.syncedAt);
+    int64_t dispersion = reference.rootDispersion + age * SNTP_DRIFT_PPM / 1000;
+    int64_t syncedAtUs = (int64_t)reference.syncedAt * 1000 + reference.offset;
+    
+    uint8_t reply[NTP_PACKET_SIZE];
+    uint8_t stratum = reference.stratum < 15 ? reference.stratum + 1 : 15;
+    NtpPacket::buildReply(reply, request, stratum,
+                          NtpPacket::toShort(reference.rootDelay),
+                          NtpPacket::toShort(dispersion),
+                          reference.referenceId,
+                          NtpPacket::fromUnixMicros(syncedAtUs),
+                          NtpPacket::fromUnixMicros(receivedAt + reference.offset));
+    
+    NtpPacket::setTransmit(reply, NtpPacket::fromUnixMicros((int64_t)Timebase::micros64() + reference.offset));
+    return port->reply(reply, NTP_PACKET_SIZE);
+  }
+};
+
+#endif // SNTP_RESPONDER_H
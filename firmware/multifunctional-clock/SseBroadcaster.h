@@ -0,0 +1,306 @@
+/**
+ * @file SseBroadcaster.h
+ * @brief Server-Sent Events fan-out from one shared buffer
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Pushes events to the browsers subscribed to API_EVENTS_ENDPOINT instead
+ * of having each of them poll the API. An event is framed once, as
+ * "id: N\nevent: type\ndata: json\n\n", into a ring of SSE_BUFFER_SIZE
+ * bytes; each subscriber only keeps its read position in that ring, so a
+ * subscriber costs a pointer and a counter, not a copy of every event.
+ * update() sends each subscriber what it has not seen yet, at most
+ * SSE_WRITE_CHUNK bytes per call, and never waits: a subscriber that falls
+ * a whole ring behind is closed (EventSource reconnects by itself) rather
+ * than holding the others back. When nothing is published for
+ * SSE_KEEPALIVE_INTERVAL a comment line is sent, which finds dead
+ * connections and keeps proxies from timing out.
+ */
+
+#ifndef SSE_BROADCASTER_H
+#define SSE_BROADCASTER_H
+
+#include "config.h"
+#include <WiFi.h>
+
+/**
+ * @class SseStream
+ * @brief Connection to one subscriber
+ */
+class SseStream {
+public:
+  virtual ~SseStream() {}
+  
+  /**
+   * @brief Check whether the subscriber is still connected
+   */
+  virtual bool connected() = 0;
+  
+  /**
+   * @brief Write without waiting
+   * 
+   * @return Bytes accepted (possibly fewer than length), -1 if closed
+   */
+  virtual int write(const uint8_t* buffer, size_t length) = 0;
+  
+  /**
+   * @brief Close the connection
+   */
+  virtual void stop() = 0;
+};
+
+/**
+ * @class TcpSseStream
+ * @brief Subscriber connection over a WiFiClient taken from the server
+ */
+class TcpSseStream : public SseStream {
+private:
+  WiFiClient client;
+
+public:
+  /**
+   * @brief Take over a client whose request has been answered
+   */
+  void attach(const WiFiClient& accepted) {
+    client = accepted;
+  }
+  
+  /**
+   * @brief Check whether a client is attached (slot in use)
+   */
+  bool isOpen() {
+    return (bool)client;
+  }
+  
+  bool connected() override {
+    return client.connected();
+  }
+  
+  int write(const uint8_t* buffer, size_t length) override {
+    if (!client.connected()) {
+      return -1;
+    }
+    return client.write(buffer, length);
+  }
+  
+  void stop() override {
+    client.stop();
+    client = WiFiClient();
+  }
+};
+
+/**
+ * @struct SseMetrics
+ * @brief Fan-out counters since boot
+ */
+struct SseMetrics {
+  unsigned long subscribed;    ///< Subscriptions accepted
+  unsigned long events;        ///< Events published
+  unsigned long eventBytes;    ///< Bytes framed (once per event)
+  unsigned long bytesSent;     ///< Bytes written, all subscribers
+  unsigned long writes;        ///< Write calls, all subscribers
+  unsigned long keepalives;    ///< Comment lines sent while idle
+  unsigned long overruns;      ///< Subscribers closed for falling behind
+  unsigned long disconnects;   ///< Subscribers gone on their side
+  unsigned long rejected;      ///< Events larger than half the ring
+};
+
+/**
+ * @class SseBroadcaster
+ * @brief Frames events once and streams them to every subscriber
+ */
+class SseBroadcaster {
+  friend class SseCheck;
+
+private:
+  uint8_t ring[SSE_BUFFER_SIZE];
+  uint32_t head;                            ///< Bytes framed since boot
+  SseStream* subscribers[SSE_MAX_CLIENTS];  ///< nullptr for a free slot
+  uint32_t positions[SSE_MAX_CLIENTS];      ///< Next byte to send, as head
+  uint32_t nextId;
+  uint64_t lastFramed;
+  SseMetrics metrics;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  SseBroadcaster() :
+    head(0),
+    nextId(1),
+    lastFramed(0) {
+    memset(subscribers, 0, sizeof(subscribers));
+    memset(positions, 0, sizeof(positions));
+    memset(&metrics, 0, sizeof(metrics));
+  }
+  
+  /**
+   * @brief Add a subscriber; it receives the events published from now on
+   * 
+   * @param stream Connection, whose response headers have been sent
+   * @return false if SSE_MAX_CLIENTS are already subscribed
+   */
+  bool subscribe(SseStream* stream) {
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+      if (subscribers[i] == nullptr) {
+        subscribers[i] = stream;
+        positions[i] = head;
+        metrics.subscribed++;
+        return true;
+      }
+    }
+    return false;
+  }
+  
+  /**
+   * @brief Frame an event for every subscriber
+   * 
+   * Framed even without subscribers, so the ids count every event.
+   * 
+   * @param type Event name (EventSource listener)
+   * @param data Event data on one line, e.g. a JSON object
+   * @param length Length of data
+   * @param now Current time (ms)
+   * @return false if the event is larger than half the ring
+   */
+  bool publish(const char* type, const char* data, size_t length, uint64_t now) {
+    char id[12];
+    size_t idLength = formatUnsigned(id, nextId);
+    size_t frameLength = 4 + idLength + 8 + strlen(type) + 7 + length + 2;
+    if (frameLength > SSE_BUFFER_SIZE / 2) {
+      metrics.rejected++;
+      return false;
+    }
+    
+    put("id: ", 4);
+    put(id, idLength);
+    put("\nevent: ", 8);
+    put(type, strlen(type));
+    put("\ndata: ", 7);
+    put(data, length);
+    put("\n\n", 2);
+    
+    nextId++;
+    metrics.events++;
+    metrics.eventBytes += frameLength;
+    lastFramed = now;
+    return true;
+  }
+  
+  /**
+   * @brief Stream pending bytes to the subscribers, without waiting
+   * 
+   * Should be called every loop iteration.
+   * 
+   * @param now Current time (ms)
+   */
+  void update(uint64_t now) {
+    uint8_t count = getSubscriberCount();
+    if (count == 0) {
+      lastFramed = now;
+      return;
+    }
+    
+    if (now - lastFramed >= SSE_KEEPALIVE_INTERVAL) {
+      put(":\n\n", 3);
+      metrics.keepalives++;
+      lastFramed = now;
+    }
+    
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+      if (subscribers[i] != nullptr) {
+        send(i);
+      }
+    }
+  }
+  
+  /**
+   * @brief Close every subscriber, e.g. when WiFi is lost
+   */
+  void closeAll() {
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+      if (subscribers[i] != nullptr) {
+        drop(i);
+      }
+    }
+  }
+  
+  uint8_t getSubscriberCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+      if (subscribers[i] != nullptr) count++;
+    }
+    return count;
+  }
+  
+  const SseMetrics& getMetrics() const {
+    return metrics;
+  }
+
+private:
+  /**
+   * @brief Send one subscriber its next contiguous chunk
+   */
+  void send(uint8_t slot) {
+    SseStream* stream = subscribers[slot];
+    uint32_t pending = head - positions[slot];
+    
+    // Its oldest unsent bytes were overwritten: it cannot catch up
+    if (pending > SSE_BUFFER_SIZE) {
+      metrics.overruns++;
+      drop(slot);
+      return;
+    }
+    if (!stream->connected()) {
+      metrics.disconnects++;
+      drop(slot);
+      return;
+    }
+    if (pending == 0) {
+      return;
+    }
+    
+    uint32_t offset = positions[slot] % SSE_BUFFER_SIZE;
+    size_t length = pending;
+    if (length > SSE_BUFFER_SIZE - offset) length = SSE_BUFFER_SIZE - offset;
+    if (length > SSE_WRITE_CHUNK) length = SSE_WRITE_CHUNK;
+    
+    int written = stream->write(ring + offset, length);
+    metrics.writes++;
+    if (written < 0) {
+      metrics.disconnects++;
+      drop(slot);
+      return;
+    }
+    positions[slot] += written;
+    metrics.bytesSent += written;
+  }
+  
+  void drop(uint8_t slot) {
+    subscribers[slot]->stop();
+    subscribers[slot] = nullptr;
+  }
+  
+  void put(const char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      ring[head % SSE_BUFFER_SIZE] = bytes[i];
+      head++;
+    }
+  }
+  
+  static size_t formatUnsigned(char* out, uint32_t value) {
+    char digits[10];
+    size_t n = 0;
+    do {
+      digits[n++] = '0' + (value % 10);
+      value /= 10;
+    } while (value > 0);
+    for (size_t i = 0; i < n; i++) {
+      out[i] = digits[n - 1 - i];
+    }
+    return n;
+  }
+};
+
+#endif // SSE_BROADCASTER_H
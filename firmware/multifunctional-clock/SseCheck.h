@@ -0,0 +1,298 @@
+/**
+ * @file SseCheck.h
+ * @brief Event fan-out load test against local subscriber stand-ins
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * LoopbackSubscriber is an SseStream that hashes what it receives and can
+ * accept only a few bytes per write or hang up. Sample events are
+ * published at a scripted pace to 1 and SSE_MAX_CLIENTS subscribers, and
+ * each stream must match the frames byte for byte. The cost of framing an
+ * event once and of sending it to one more subscriber is timed with
+ * micros(), next to the cost of answering the same reading as a polled
+ * GET API_ENDPOINT. A slow subscriber must be dropped without holding the
+ * others back, and a closed one must free its slot.
+ */
+
+#ifndef SSE_CHECK_H
+#define SSE_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "SseBroadcaster.h"
+#include "NetworkManager.h"
+
+#define SSE_CHECK_EVENTS     60      // Sample events per scenario
+#define SSE_CHECK_STEP       5       // Loop period (ms)
+#define SSE_CHECK_SLOW_WRITE 7       // Bytes accepted per write by a slow subscriber
+
+/**
+ * @class LoopbackSubscriber
+ * @brief Subscriber stand-in hashing its stream
+ */
+class LoopbackSubscriber : public SseStream {
+public:
+  bool open;
+  bool stopped;
+  size_t writeLimit;     ///< Bytes accepted per write, 0 for all
+  uint32_t hash;         ///< FNV-1a of the bytes received
+  uint32_t received;
+  unsigned long frames;  ///< Blank lines, i.e. complete events and comments
+  uint8_t last;
+  
+  LoopbackSubscriber() :
+    open(true),
+    stopped(false),
+    writeLimit(0),
+    hash(2166136261UL),
+    received(0),
+    frames(0),
+    last(0) {}
+  
+  bool connected() override {
+    return open;
+  }
+  
+  int write(const uint8_t* buffer, size_t length) override {
+    if (!open) return -1;
+    if (writeLimit > 0 && length > writeLimit) length = writeLimit;
+    for (size_t i = 0; i < length; i++) {
+      hash = (hash ^ buffer[i]) * 16777619UL;
+      if (buffer[i] == '\n' && last == '\n') frames++;
+      last = buffer[i];
+    }
+    received += length;
+    return length;
+  }
+  
+  void stop() override {
+    open = false;
+    stopped = true;
+  }
+};
+
+/**
+ * @class SseCheck
+ * @brief Runs the fan-out scenarios and prints the results
+ */
+class SseCheck {
+private:
+  CheckReport results;
+  uint32_t expectedHash;
+  uint32_t expectedBytes;
+  unsigned long publishMicros;
+  unsigned long updateMicros;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  SseCheck() :
+    results("SSE"),
+    expectedHash(0),
+    expectedBytes(0),
+    publishMicros(0),
+    updateMicros(0) {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    checkFanout("sse.fanout1", 1);
+    checkFanout("sse.fanoutMax", SSE_MAX_CLIENTS);
+    checkSlowSubscriber();
+    checkDisconnect();
+    
+    return results.end();
+  }
+
+private:
+  static SensorData makeReading(uint32_t n) {
+    SensorData data;
+    data.tempIndoor = 21.0f + (n % 40) * 0.1f;
+    data.tempOutdoor = 8.5f - (n % 25) * 0.2f;
+    data.humidityIndoor = 45.0f + (n % 10) * 0.5f;
+    data.humidityOutdoor = 70.0f - (n % 16) * 0.5f;
+    data.pressure = 1013.25f + (n % 8) * 0.05f;
+    data.airQuality = 420 + (n % 30);
+    data.isValid = true;
+    return data;
+  }
+  
+  /**
+   * @brief Publish the sample events, stepping the loop between them
+   * 
+   * Also hashes the frames as they should reach every subscriber.
+   */
+  uint64_t publishSamples(SseBroadcaster& events, uint64_t now, uint16_t count, uint16_t stepsBetween) {
+    expectedHash = 2166136261UL;
+    expectedBytes = 0;
+    char json[JSON_BUFFER_SIZE];
+    
+    for (uint16_t n = 0; n < count; n++) {
+      size_t length = NetworkManager::serializeSensorData(makeReading(n), json, sizeof(json));
+      uint32_t headBefore = events.head;
+      
+      unsigned long t = micros();
+      events.publish("sample", json, length, now);
+      publishMicros += micros() - t;
+      
+      for (uint32_t i = headBefore; i != events.head; i++) {
+        expectedHash = (expectedHash ^ events.ring[i % SSE_BUFFER_SIZE]) * 16777619UL;
+        expectedBytes++;
+      }
+      for (uint16_t s = 0; s < stepsBetween; s++) {
+        now = step(events, now);
+      }
+    }
+    return now;
+  }
+  
+  /**
+   * @brief One loop pass, timed
+   */
+  uint64_t step(SseBroadcaster& events, uint64_t now) {
+    unsigned long t = micros();
+    events.update(now);
+    updateMicros += micros() - t;
+    return now + SSE_CHECK_STEP;
+  }
+  
+  /**
+   * @brief Step the loop until no subscriber has anything left to send
+   */
+  uint64_t drain(SseBroadcaster& events, uint64_t now) {
+    for (int pass = 0; pass < 1000; pass++) {
+      bool pending = false;
+      for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+        if (events.subscribers[i] && events.positions[i] != events.head) pending = true;
+      }
+      if (!pending) break;
+      now = step(events, now);
+    }
+    return now;
+  }
+  
+  /**
+   * @brief Cost of answering the same reading to a polling browser
+   */
+  static unsigned long pollMicros() {
+    static const char requestText[] =
+      "GET /api/data HTTP/1.1\r\n"
+      "Host: clock.local\r\n"
+      "Accept: application/json\r\n"
+      "\r\n";
+    HttpRequestParser parser;
+    char json[JSON_BUFFER_SIZE];
+    unsigned long t = micros();
+    for (uint16_t n = 0; n < SSE_CHECK_EVENTS; n++) {
+      parser.reset();
+      parser.feed((const uint8_t*)requestText, sizeof(requestText) - 1);
+      NetworkManager::serializeSensorData(makeReading(n), json, sizeof(json));
+    }
+    return (micros() - t) / SSE_CHECK_EVENTS;
+  }
+  
+  /**
+   * @brief Every subscriber gets every event, each framed once
+   */
+  void checkFanout(const char* name, uint8_t clients) {
+    SseBroadcaster events;
+    publishMicros = updateMicros = 0;
+    LoopbackSubscriber subscribers[SSE_MAX_CLIENTS];
+    bool ok = true;
+    for (uint8_t i = 0; i < clients; i++) {
+      ok = events.subscribe(&subscribers[i]) && ok;
+    }
+    
+    // Two loop passes between events, then the loop catches up
+    uint64_t now = publishSamples(events, 0, SSE_CHECK_EVENTS, 2);
+    drain(events, now);
+    
+    for (uint8_t i = 0; i < clients; i++) {
+      ok = ok && subscribers[i].hash == expectedHash && subscribers[i].received == expectedBytes &&
+           subscribers[i].frames == SSE_CHECK_EVENTS && !subscribers[i].stopped;
+    }
+    const SseMetrics& m = events.getMetrics();
+    ok = ok && m.events == SSE_CHECK_EVENTS && m.eventBytes == expectedBytes &&
+         m.overruns == 0 && m.bytesSent == expectedBytes * clients;
+    
+    report(name, clients, events, ok);
+  }
+  
+  /**
+   * @brief A subscriber reading 7 bytes per write falls a ring behind
+   * 
+   * It is dropped, and the fast one still gets everything.
+   */
+  void checkSlowSubscriber() {
+    SseBroadcaster events;
+    publishMicros = updateMicros = 0;
+    LoopbackSubscriber fast;
+    LoopbackSubscriber slow;
+    slow.writeLimit = SSE_CHECK_SLOW_WRITE;
+    events.subscribe(&fast);
+    events.subscribe(&slow);
+    
+    uint64_t now = publishSamples(events, 0, SSE_CHECK_EVENTS, 1);
+    drain(events, now);
+    
+    const SseMetrics& m = events.getMetrics();
+    bool ok = fast.hash == expectedHash && fast.frames == SSE_CHECK_EVENTS && !fast.stopped &&
+              slow.stopped && slow.received < expectedBytes && m.overruns == 1 &&
+              events.getSubscriberCount() == 1;
+    report("sse.slowSubscriber", 2, events, ok);
+  }
+  
+  /**
+   * @brief A subscriber hanging up frees its slot; idle keepalives
+   */
+  void checkDisconnect() {
+    SseBroadcaster events;
+    publishMicros = updateMicros = 0;
+    LoopbackSubscriber subscribers[SSE_MAX_CLIENTS];
+    bool ok = true;
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+      ok = events.subscribe(&subscribers[i]) && ok;
+    }
+    LoopbackSubscriber late;
+    ok = ok && !events.subscribe(&late);
+    
+    uint64_t now = publishSamples(events, 0, 4, 2);
+    subscribers[0].open = false;
+    now = publishSamples(events, now, 4, 2);
+    ok = ok && subscribers[0].stopped && events.getSubscriberCount() == SSE_MAX_CLIENTS - 1 &&
+         events.subscribe(&late);
+    
+    // Nothing published: one comment line reaches everyone
+    unsigned long before = subscribers[1].frames;
+    now = step(events, now + SSE_KEEPALIVE_INTERVAL);
+    drain(events, now);
+    
+    const SseMetrics& m = events.getMetrics();
+    ok = ok && m.disconnects == 1 && m.keepalives == 1 &&
+         subscribers[1].frames == before + 1 && late.frames == 1;
+    report("sse.disconnect", SSE_MAX_CLIENTS, events, ok);
+  }
+  
+  void report(const char* name, uint8_t clients, const SseBroadcaster& events, bool ok) {
+    const SseMetrics& m = events.getMetrics();
+    results.start(name);
+    results.field("clients", clients);
+    results.field("events", m.events);
+    results.field("event_bytes", m.events > 0 ? m.eventBytes / m.events : 0UL);
+    results.field("bytes_sent", m.bytesSent);
+    results.field("writes", m.writes);
+    results.field("publish_us", m.events > 0 ? publishMicros / m.events : 0UL);
+    results.field("client_us", m.events > 0 ? updateMicros / m.events / clients : 0UL);
+    results.field("poll_us", pollMicros());
+    results.finish(ok);
+  }
+};
+
+#endif // SSE_CHECK_H
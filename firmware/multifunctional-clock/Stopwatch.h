@@ -0,0 +1,237 @@
+/**
+ * @file Stopwatch.h
+ * @brief Stopwatch with laps and countdown timer
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Both are timed with Timebase::micros64(), which never wraps. A button
+ * action is stamped with the press time, which may be slightly before the
+ * last sample, so intervals are taken as signed differences.
+ */
+
+#ifndef STOPWATCH_H
+#define STOPWATCH_H
+
+#include "config.h"
+
+// Countdown lengths offered by a long press (s)
+static const uint32_t COUNTDOWN_PRESETS[] = { 60, 180, 300, 600, 900, 1800 };
+#define COUNTDOWN_PRESET_COUNT (sizeof(COUNTDOWN_PRESETS) / sizeof(COUNTDOWN_PRESETS[0]))
+
+/**
+ * @class Stopwatch
+ * @brief Start/stop stopwatch recording the last STOPWATCH_MAX_LAPS laps
+ */
+class Stopwatch {
+private:
+  uint64_t elapsed;           ///< Accumulated time (us)
+  uint64_t lastSample;        ///< Time of the last fold (us)
+  bool running;
+  
+  uint64_t laps[STOPWATCH_MAX_LAPS];  ///< Most recent lap first (us)
+  uint8_t lapCount;
+  uint64_t lapStart;          ///< Elapsed time at the start of the lap
+
+public:
+  /**
+   * @brief Constructor
+   */
+  Stopwatch() {
+    reset();
+  }
+  
+  /**
+   * @brief Fold the running interval into the total
+   * 
+   * @param now Current Timebase::micros64()
+   */
+  void sample(uint64_t now) {
+    if (running) {
+      elapsed += (int64_t)(now - lastSample);
+      lastSample = now;
+    }
+  }
+  
+  /**
+   * @brief Start if stopped, stop if running
+   * 
+   * @param now Timebase::micros64() when the button was pressed
+   */
+  void toggle(uint64_t now) {
+    sample(now);
+    running = !running;
+    lastSample = now;
+  }
+  
+  /**
+   * @brief Record a lap while running, reset while stopped
+   * 
+   * @param now Timebase::micros64() when the button was pressed
+   */
+  void lapOrReset(uint64_t now) {
+    if (!running) {
+      reset();
+      return;
+    }
+    sample(now);
+    for (uint8_t i = STOPWATCH_MAX_LAPS - 1; i > 0; i--) {
+      laps[i] = laps[i - 1];
+    }
+    laps[0] = elapsed - lapStart;
+    lapStart = elapsed;
+    if (lapCount < 255) lapCount++;
+  }
+  
+  /**
+   * @brief Stop and clear the time and laps
+   */
+  void reset() {
+    elapsed = 0;
+    lastSample = 0;
+    running = false;
+    lapCount = 0;
+    lapStart = 0;
+    for (uint8_t i = 0; i < STOPWATCH_MAX_LAPS; i++) {
+      laps[i] = 0;
+    }
+  }
+  
+  bool isRunning() const { return running; }
+  
+  /**
+   * @brief Elapsed time at the last sample, in milliseconds
+   */
+  uint32_t getElapsedMillis() const {
+    return elapsed / 1000;
+  }
+  
+  /**
+   * @brief Number of laps recorded since the last reset
+   */
+  uint8_t getLapCount() const {
+    return lapCount;
+  }
+  
+  /**
+   * @brief Duration of a recent lap in milliseconds
+   * 
+   * @param index 0 for the most recent lap
+   */
+  uint32_t getLapMillis(uint8_t index) const {
+    return index < STOPWATCH_MAX_LAPS ? laps[index] / 1000 : 0;
+  }
+};
+
+/**
+ * @class Countdown
+ * @brief Countdown from one of COUNTDOWN_PRESETS
+ */
+class Countdown {
+private:
+  uint64_t remaining;         ///< Time left (us)
+  uint64_t lastSample;        ///< Time of the last fold (us)
+  uint8_t preset;             ///< Index in COUNTDOWN_PRESETS
+  bool running;
+  bool finished;              ///< Reached zero, not yet taken
+
+public:
+  /**
+   * @brief Constructor
+   */
+  Countdown() : preset(0) {
+    reset();
+  }
+  
+  /**
+   * @brief Fold the running interval and detect the end
+   * 
+   * @param now Current Timebase::micros64()
+   */
+  void sample(uint64_t now) {
+    if (!running) {
+      return;
+    }
+    int64_t delta = (int64_t)(now - lastSample);
+    lastSample = now;
+    if (delta >= 0 && (uint64_t)delta >= remaining) {
+      remaining = 0;
+      running = false;
+      finished = true;
+    } else {
+      remaining -= delta;
+    }
+  }
+  
+  /**
+   * @brief Start or pause; restart from the preset once finished
+   * 
+   * @param now Timebase::micros64() when the button was pressed
+   */
+  void toggle(uint64_t now) {
+    sample(now);
+    if (remaining == 0) {
+      reset();
+    }
+    running = !running;
+    lastSample = now;
+  }
+  
+  /**
+   * @brief Reset if started, otherwise move to the next preset
+   */
+  void resetOrNextPreset() {
+    if (remaining == getDurationMicros()) {
+      preset = (preset + 1) % COUNTDOWN_PRESET_COUNT;
+    }
+    reset();
+  }
+  
+  /**
+   * @brief Stop and reload the current preset
+   */
+  void reset() {
+    remaining = getDurationMicros();
+    running = false;
+    finished = false;
+  }
+  
+  /**
+   * @brief Check and clear the "reached zero" flag
+   */
+  bool takeFinished() {
+    bool wasFinished = finished;
+    finished = false;
+    return wasFinished;
+  }
+  
+  bool isRunning() const { return running; }
+  
+  /**
+   * @brief Time left at the last sample, in milliseconds
+   */
+  uint32_t getRemainingMillis() const {
+    return (remaining + 999) / 1000;
+  }
+  
+  /**
+   * @brief Length of the current preset in seconds
+   */
+  uint32_t getDurationSeconds() const {
+    return COUNTDOWN_PRESETS[preset];
+  }
+  
+  /**
+   * @brief Fraction of the countdown left (65535 = full, 0 = done)
+   */
+  uint16_t getProgress() const {
+    return (uint16_t)((remaining * 65535ULL) / getDurationMicros());
+  }
+
+private:
+  uint64_t getDurationMicros() const {
+    return COUNTDOWN_PRESETS[preset] * 1000000ULL;
+  }
+};
+
+#endif // STOPWATCH_H
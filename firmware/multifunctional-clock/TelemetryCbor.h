@@ -0,0 +1,187 @@
+/**
+ * @file TelemetryCbor.h
+ * @brief Compact CBOR encoding of sensor samples and batches
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Binary alternative to the JSON payloads (RFC 8949 CBOR, integers only):
+ * readings are sent as fixed-point integers, so no float formatting runs
+ * on the MCU and most values take 2 or 3 bytes instead of 5 to 8 digits
+ * and a key. A sample is an array:
+ * 
+ *   [tempIndoor x10, tempOutdoor x10, humidityIndoor x10,
+ *    humidityOutdoor x10, pressure x100 (hPa), airQuality (ppm), valid]
+ * 
+ * A batch is a map with integer keys, each sample prefixed by the seconds
+ * since the previous one (0 for the first), which fits one byte at the
+ * usual 30 s period:
+ * 
+ *   {0: version, 1: first sample time (UTC epoch),
+ *    2: [[dt, <sample fields>], ...]}
+ * 
+ * web-interface/telemetry.js decodes both back to the JSON field names.
+ */
+
+#ifndef TELEMETRY_CBOR_H
+#define TELEMETRY_CBOR_H
+
+#include "config.h"
+#include "SensorManager.h"
+#include "MqttClient.h"
+
+#define TELEMETRY_CBOR_VERSION  1
+
+// CBOR major types (high 3 bits of the initial byte)
+#define CBOR_UNSIGNED        0x00
+#define CBOR_NEGATIVE        0x20
+#define CBOR_ARRAY           0x80
+#define CBOR_MAP             0xA0
+#define CBOR_FALSE           0xF4
+#define CBOR_TRUE            0xF5
+
+/**
+ * @class CborWriter
+ * @brief Writes CBOR items into a bounded buffer
+ * 
+ * Once an item does not fit, the writer stops and length() returns 0.
+ */
+class CborWriter {
+private:
+  uint8_t* buffer;
+  size_t size;
+  size_t len;
+  bool overflow;
+
+public:
+  CborWriter(uint8_t* out, size_t outSize) :
+    buffer(out),
+    size(outSize),
+    len(0),
+    overflow(false) {}
+  
+  void writeUnsigned(uint32_t value) {
+    writeHead(CBOR_UNSIGNED, value);
+  }
+  
+  void writeInt(int32_t value) {
+    if (value < 0) {
+      writeHead(CBOR_NEGATIVE, (uint32_t)(-1 - value));
+    } else {
+      writeHead(CBOR_UNSIGNED, (uint32_t)value);
+    }
+  }
+  
+  void writeArray(uint32_t count) {
+    writeHead(CBOR_ARRAY, count);
+  }
+  
+  void writeMap(uint32_t count) {
+    writeHead(CBOR_MAP, count);
+  }
+  
+  void writeBool(bool value) {
+    put(value ? CBOR_TRUE : CBOR_FALSE);
+  }
+  
+  /**
+   * @brief Bytes written, 0 if the buffer was too small
+   */
+  size_t length() const {
+    return overflow ? 0 : len;
+  }
+
+private:
+  /**
+   * @brief Initial byte and argument, in the shortest form
+   */
+  void writeHead(uint8_t major, uint32_t value) {
+    if (value < 24) {
+      put(major | value);
+    } else if (value <= 0xFF) {
+      put(major | 24);
+      put(value);
+    } else if (value <= 0xFFFF) {
+      put(major | 25);
+      put(value >> 8);
+      put(value);
+    } else {
+      put(major | 26);
+      put(value >> 24);
+      put(value >> 16);
+      put(value >> 8);
+      put(value);
+    }
+  }
+  
+  void put(uint8_t byte) {
+    if (len >= size) {
+      overflow = true;
+      return;
+    }
+    buffer[len++] = byte;
+  }
+};
+
+/**
+ * @class TelemetryCbor
+ * @brief Stateless sample and batch encoders
+ */
+class TelemetryCbor {
+public:
+  /**
+   * @brief Encode one sample
+   * 
+   * @return Length written, or 0 if the buffer is too small
+   */
+  static size_t encodeSample(const SensorData& data, uint8_t* buffer, size_t size) {
+    CborWriter writer(buffer, size);
+    writer.writeArray(7);
+    writeFields(writer, data);
+    return writer.length();
+  }
+  
+  /**
+   * @brief Encode a batch of samples with delta-encoded times
+   * 
+   * Same signature as MqttBatchEncoder, so the MQTT client can use it.
+   * 
+   * @return Length written, or 0 if the buffer is too small
+   */
+  static size_t encodeBatch(const MqttSample* samples, uint8_t count, uint8_t* buffer, size_t size) {
+    CborWriter writer(buffer, size);
+    writer.writeMap(3);
+    writer.writeInt(0);
+    writer.writeInt(TELEMETRY_CBOR_VERSION);
+    writer.writeInt(1);
+    writer.writeUnsigned(count > 0 ? samples[0].time : 0);
+    writer.writeInt(2);
+    writer.writeArray(count);
+    for (uint8_t i = 0; i < count; i++) {
+      writer.writeArray(8);
+      writer.writeInt(i > 0 ? (int32_t)(samples[i].time - samples[i - 1].time) : 0);
+      writeFields(writer, samples[i].data);
+    }
+    return writer.length();
+  }
+
+private:
+  static void writeFields(CborWriter& writer, const SensorData& data) {
+    writer.writeInt(toFixed(data.tempIndoor, 10));
+    writer.writeInt(toFixed(data.tempOutdoor, 10));
+    writer.writeInt(toFixed(data.humidityIndoor, 10));
+    writer.writeInt(toFixed(data.humidityOutdoor, 10));
+    writer.writeInt(toFixed(data.pressure, 100));
+    writer.writeInt(toFixed(data.airQuality, 1));
+    writer.writeBool(data.isValid);
+  }
+  
+  /**
+   * @brief Scale and round, as appendFixed() does for the JSON payload
+   */
+  static int32_t toFixed(float value, int32_t scale) {
+    return (int32_t)(value * scale + (value < 0 ? -0.5f : 0.5f));
+  }
+};
+
+#endif // TELEMETRY_CBOR_H
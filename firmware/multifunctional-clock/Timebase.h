@@ -0,0 +1,104 @@
+/**
+ * @file Timebase.h
+ * @brief 64-bit monotonic clock shared by all managers
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * micros() wraps every 71.6 minutes and millis() every 49.7 days. The
+ * timebase extends micros() to 64 bits by counting its wraps, so stamps
+ * taken with it never wrap during the life of the device and can be
+ * compared with plain < and -. Every manager takes its stamps from here
+ * instead of millis().
+ * 
+ * A wrap is detected when a reading is lower than the previous one, so
+ * the clock must be read at least once per 71 minutes; loop() reads it
+ * many times per second. It is not meant to be read from interrupts.
+ * 
+ * TIMEBASE_START_US moves the origin, e.g. to just before the 32-bit
+ * millis() rollover, so a test build crosses it shortly after boot.
+ * 
+ * The host fleet simulator runs many clocks in one process, each with
+ * its own micros(); it select()s a clock's timebase before running that
+ * clock's loop(). Built with TIMEBASE_LOCAL=thread_local, each thread
+ * keeps its own selection.
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "config.h"
+
+/**
+ * @class Timebase
+ * @brief Extends a 32-bit microsecond counter to 64 bits
+ */
+class Timebase {
+private:
+  uint64_t origin;   ///< Value returned for a raw reading of 0
+  uint32_t lastRaw;  ///< Previous raw reading
+  uint32_t wraps;    ///< Number of raw wraps seen
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param start Time returned for the first raw reading of 0 (us)
+   */
+  explicit Timebase(uint64_t start = TIMEBASE_START_US) :
+    origin(start),
+    lastRaw(0),
+    wraps(0) {}
+  
+  /**
+   * @brief Extend one raw 32-bit reading
+   * 
+   * @param raw Raw counter value, read no earlier than the previous one
+   * @return Monotonic time (us)
+   */
+  uint64_t extend(uint32_t raw) {
+    if (raw < lastRaw) {
+      wraps++;
+    }
+    lastRaw = raw;
+    return origin + (((uint64_t)wraps << 32) | raw);
+  }
+  
+  /**
+   * @brief Current time of the shared clock (us)
+   */
+  static uint64_t micros64() {
+    return shared().extend(micros());
+  }
+  
+  /**
+   * @brief Current time of the shared clock (ms)
+   */
+  static uint64_t millis64() {
+    return micros64() / 1000;
+  }
+
+  /**
+   * @brief Make a timebase the shared clock of the calling thread
+   * 
+   * @param timebase Clock to extend micros() with, or nullptr for the
+   *                 built-in one
+   */
+  static void select(Timebase* timebase) {
+    selected() = timebase;
+  }
+
+private:
+  static Timebase*& selected() {
+    static TIMEBASE_LOCAL Timebase* current = nullptr;
+    return current;
+  }
+  
+  static Timebase& shared() {
+    static Timebase instance;
+    Timebase* current = selected();
+    return current ? *current : instance;
+  }
+};
+
+#endif // TIMEBASE_H
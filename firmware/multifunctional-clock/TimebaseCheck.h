@@ -0,0 +1,106 @@
+/**
+ * @file TimebaseCheck.h
+ * @brief Rollover check for the 64-bit timebase
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Feeds scripted raw micros() readings to a separate Timebase and checks
+ * that the extended time is exact across the 71-minute micros() wrap and
+ * the 49.7-day millis() rollover.
+ */
+
+#ifndef TIMEBASE_CHECK_H
+#define TIMEBASE_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "Timebase.h"
+
+#define TIMEBASE_CHECK_STEP   7919UL     // Raw step (us), prime so wraps land mid-step
+#define MILLIS_ROLLOVER_US    (4294967296ULL * 1000)
+
+/**
+ * @struct TimebaseScenario
+ * @brief A timebase origin, a raw start and the number of steps to run
+ */
+struct TimebaseScenario {
+  const char* name;
+  uint64_t origin;     ///< Timebase origin (us)
+  uint32_t rawStart;   ///< First raw reading
+  uint32_t steps;      ///< Readings, TIMEBASE_CHECK_STEP apart
+};
+
+static const TimebaseScenario TIMEBASE_SCENARIOS[] = {
+  // Raw counter wraps 10 ms in
+  { "time.microsWrap", 0, 0xFFFFFFFFUL - 10000, 50 },
+  // Two raw wraps in a row, 71.6 minutes of readings in large steps
+  { "time.twoWraps", 0, 0xFFFF0000UL, 1100000 },
+  // millis() would roll over 10 ms in
+  { "time.millisRollover", MILLIS_ROLLOVER_US - 10000, 0, 50 },
+  // Both at once, as with TIMEBASE_START_US set to the test value
+  { "time.bothRollovers", MILLIS_ROLLOVER_US - 0x100000000ULL, 0xFFFFFFFFUL - 10000, 50 }
+};
+
+/**
+ * @class TimebaseCheck
+ * @brief Runs every scenario and compares against 64-bit arithmetic
+ */
+class TimebaseCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  TimebaseCheck() : results("TIME") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of scenarios with a wrong or non-monotonic reading
+   */
+  int runAll() {
+    results.begin();
+    
+    for (size_t i = 0; i < sizeof(TIMEBASE_SCENARIOS) / sizeof(TIMEBASE_SCENARIOS[0]); i++) {
+      runScenario(TIMEBASE_SCENARIOS[i]);
+    }
+    
+    return results.end();
+  }
+
+private:
+  void runScenario(const TimebaseScenario& scenario) {
+    Timebase timebase(scenario.origin);
+    uint64_t expected = scenario.origin + scenario.rawStart;
+    uint64_t previous = 0;
+    uint32_t errors = 0;
+    
+    // The first reading after the origin must not count as a wrap
+    timebase.extend(0);
+    
+    for (uint32_t i = 0; i < scenario.steps; i++) {
+      uint32_t raw = (uint32_t)expected - (uint32_t)scenario.origin;
+      uint64_t now = timebase.extend(raw);
+      if (now != expected || now < previous) {
+        errors++;
+      }
+      // Stamps and intervals in ms must not see the millis() rollover
+      if (i > 0 && now / 1000 - previous / 1000 > TIMEBASE_CHECK_STEP / 1000 + 1) {
+        errors++;
+      }
+      previous = now;
+      expected += TIMEBASE_CHECK_STEP;
+    }
+    
+    results.start(scenario.name);
+    results.field("steps", scenario.steps);
+    results.field("end_s", (unsigned long)(previous / 1000000));
+    results.field("errors", errors);
+    results.finish(errors == 0);
+  }
+};
+
+#endif // TIMEBASE_CHECK_H
@@ -0,0 +1,212 @@
+/**
+ * @file TimerWheel.h
+ * @brief Hierarchical timer wheel for second-resolution timers
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Timers are stored in TIMER_WHEEL_LEVELS wheels of 64 slots. Level 0
+ * holds timers due in the next 64 ticks, level 1 in the next 64^2 ticks
+ * and so on; when a lower wheel wraps, the matching slot of the wheel
+ * above is cascaded down. Scheduling, cancelling and expiring a timer are
+ * O(1) whatever the number of timers, and a tick only looks at the slots
+ * that are due. Timers live in a fixed pool and are linked by index, so
+ * nothing is allocated.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "config.h"
+
+#define TIMER_WHEEL_BITS      6
+#define TIMER_WHEEL_SLOTS     (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK      (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS    4
+#define TIMER_WHEEL_MAX_DELAY ((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+#define TIMER_WHEEL_NONE      0xFF
+
+/**
+ * @class TimerWheel
+ * @brief Fixed-capacity timers identified by their index
+ * 
+ * Each id in [0, TIMER_WHEEL_CAPACITY) is one timer that is either idle,
+ * pending in a wheel slot, or expired and waiting to be collected with
+ * popExpired(). The maximum delay is TIMER_WHEEL_MAX_DELAY ticks, about
+ * 194 days at one tick per second.
+ */
+class TimerWheel {
+private:
+  struct Node {
+    uint32_t expires;  ///< Tick at which the timer fires
+    uint8_t next;      ///< Next node in the same list
+    uint8_t prev;      ///< Previous node in the same list
+    uint16_t list;     ///< List holding the node, or LIST_NONE
+  };
+  
+  // Slot lists of every level, followed by the expired list
+  static const uint16_t LIST_COUNT = TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1;
+  static const uint16_t EXPIRED_LIST = LIST_COUNT - 1;
+  static const uint16_t LIST_NONE = 0xFFFF;
+  
+  Node nodes[TIMER_WHEEL_CAPACITY];
+  uint8_t heads[LIST_COUNT];
+  uint32_t now;  ///< Last tick processed
+
+public:
+  /**
+   * @brief Constructor
+   */
+  TimerWheel() {
+    reset();
+  }
+  
+  /**
+   * @brief Cancel every timer and restart the tick count at zero
+   */
+  void reset() {
+    now = 0;
+    for (uint16_t i = 0; i < LIST_COUNT; i++) {
+      heads[i] = TIMER_WHEEL_NONE;
+    }
+    for (uint8_t id = 0; id < TIMER_WHEEL_CAPACITY; id++) {
+      nodes[id].list = LIST_NONE;
+    }
+  }
+  
+  /**
+   * @brief Start or restart a timer
+   * 
+   * @param id Timer id
+   * @param delay Ticks until it fires, at least 1 (clamped to the maximum)
+   */
+  void schedule(uint8_t id, uint32_t delay) {
+    if (id >= TIMER_WHEEL_CAPACITY) {
+      return;
+    }
+    if (delay == 0) delay = 1;
+    if (delay > TIMER_WHEEL_MAX_DELAY) delay = TIMER_WHEEL_MAX_DELAY;
+    
+    unlink(id);
+    nodes[id].expires = now + delay;
+    place(id);
+  }
+  
+  /**
+   * @brief Stop a timer, whether pending or expired
+   */
+  void cancel(uint8_t id) {
+    if (id < TIMER_WHEEL_CAPACITY) {
+      unlink(id);
+    }
+  }
+  
+  /**
+   * @brief Check whether a timer is waiting to fire
+   */
+  bool isPending(uint8_t id) const {
+    return id < TIMER_WHEEL_CAPACITY &&
+           nodes[id].list != LIST_NONE && nodes[id].list != EXPIRED_LIST;
+  }
+  
+  /**
+   * @brief Ticks left before a pending timer fires, 0 if not pending
+   */
+  uint32_t remaining(uint8_t id) const {
+    return isPending(id) ? nodes[id].expires - now : 0;
+  }
+  
+  /**
+   * @brief Advance by one tick
+   * 
+   * Timers due on this tick are moved to the expired list.
+   */
+  void tick() {
+    now++;
+    
+    // Cascade the higher wheels that wrap on this tick
+    for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+      if ((now & ((1UL << (TIMER_WHEEL_BITS * level)) - 1)) != 0) {
+        break;
+      }
+      cascade(level * TIMER_WHEEL_SLOTS + ((now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK));
+    }
+    
+    uint8_t slot = now & TIMER_WHEEL_MASK;
+    while (heads[slot] != TIMER_WHEEL_NONE) {
+      uint8_t id = heads[slot];
+      unlink(id);
+      link(id, EXPIRED_LIST);
+    }
+  }
+  
+  /**
+   * @brief Collect one expired timer
+   * 
+   * @return Id of the timer, or -1 if none expired
+   */
+  int popExpired() {
+    uint8_t id = heads[EXPIRED_LIST];
+    if (id == TIMER_WHEEL_NONE) {
+      return -1;
+    }
+    unlink(id);
+    return id;
+  }
+
+private:
+  /**
+   * @brief Put a timer in the slot matching its expiry
+   */
+  void place(uint8_t id) {
+    uint32_t delta = nodes[id].expires - now;
+    uint8_t level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1)))) {
+      level++;
+    }
+    uint8_t slot = (nodes[id].expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    link(id, level * TIMER_WHEEL_SLOTS + slot);
+  }
+  
+  /**
+   * @brief Move every timer of a higher-level slot down the wheels
+   */
+  void cascade(uint16_t list) {
+    uint8_t id = heads[list];
+    heads[list] = TIMER_WHEEL_NONE;
+    while (id != TIMER_WHEEL_NONE) {
+      uint8_t next = nodes[id].next;
+      nodes[id].list = LIST_NONE;
+      place(id);
+      id = next;
+    }
+  }
+  
+  void link(uint8_t id, uint16_t list) {
+    nodes[id].list = list;
+    nodes[id].prev = TIMER_WHEEL_NONE;
+    nodes[id].next = heads[list];
+    if (heads[list] != TIMER_WHEEL_NONE) {
+      nodes[heads[list]].prev = id;
+    }
+    heads[list] = id;
+  }
+  
+  void unlink(uint8_t id) {
+    Node& node = nodes[id];
+    if (node.list == LIST_NONE) {
+      return;
+    }
+    if (node.prev != TIMER_WHEEL_NONE) {
+      nodes[node.prev].next = node.next;
+    } else {
+      heads[node.list] = node.next;
+    }
+    if (node.next != TIMER_WHEEL_NONE) {
+      nodes[node.next].prev = node.prev;
+    }
+    node.list = LIST_NONE;
+  }
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,258 @@
+/**
+ * @file TraceCheck.h
+ * @brief Round-trip check for sensor trace recording and replay
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * Records readings with TraceRecorder, replays them with
+ * TraceReplaySource and compares what comes back with what went in:
+ * the recorded fixture (TraceFixture.h) both ways, simulated readings,
+ * a sweep over the whole pressure range of the sensor and a version 1
+ * trace.
+ */
+
+#ifndef TRACE_CHECK_H
+#define TRACE_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "SensorSource.h"
+#include "TraceFixture.h"
+#include "Lzss.h"
+
+#define TRACE_CHECK_SAMPLES     64
+#define TRACE_CHECK_SWEEP_STEP  0.37      // hPa, not a multiple of the 0.02 hPa step
+#define TRACE_CHECK_TOLERANCE   0.0051    // Half a step of the 0.01 fields, plus float error
+#define TRACE_CHECK_PRESSURE_TOLERANCE 0.0101  // Half a 0.02 hPa step, plus float error
+
+/**
+ * @class ScriptedReadings
+ * @brief Source handing out a fixed list of readings
+ */
+class ScriptedReadings : public SensorSource {
+private:
+  const SensorData* readings;
+  size_t count;
+  size_t next;
+
+public:
+  ScriptedReadings(const SensorData* list, size_t size) :
+    readings(list),
+    count(size),
+    next(0) {}
+
+  bool read(SensorData& data) override {
+    if (next >= count) {
+      return false;
+    }
+    data = readings[next++];
+    return true;
+  }
+};
+
+/**
+ * @class TraceCheck
+ * @brief Runs every trace scenario
+ */
+class TraceCheck {
+private:
+  CheckReport results;
+  uint32_t errors;
+  float maxError;
+  float maxPressureError;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  TraceCheck() :
+    results("TRACE"),
+    errors(0),
+    maxError(0),
+    maxPressureError(0) {}
+
+  /**
+   * @brief Run every scenario and print the results
+   *
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+
+    checkFixtureReplay();
+    checkFixtureRecord();
+    checkSimulatedRoundTrip();
+    checkPressureRange();
+    checkVersion1();
+
+    return results.end();
+  }
+
+private:
+  void start() {
+    errors = 0;
+    maxError = 0;
+    maxPressureError = 0;
+  }
+
+  /**
+   * @brief Compare a replayed reading with the one recorded
+   */
+  void compare(const SensorData& expected, const SensorData& actual) {
+    const float pairs[][2] = {
+      { expected.tempIndoor, actual.tempIndoor },
+      { expected.tempOutdoor, actual.tempOutdoor },
+      { expected.humidityIndoor, actual.humidityIndoor },
+      { expected.humidityOutdoor, actual.humidityOutdoor }
+    };
+    for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+      float error = fabs(pairs[i][0] - pairs[i][1]);
+      if (error > maxError) maxError = error;
+      if (error > TRACE_CHECK_TOLERANCE) errors++;
+    }
+    comparePressure(expected.pressure, actual.pressure);
+    if (expected.isValid != actual.isValid ||
+        (expected.isValid && expected.airQuality != actual.airQuality)) {
+      errors++;
+    }
+  }
+
+  void comparePressure(float expected, float actual) {
+    float error = fabs(expected - actual);
+    if (error > maxPressureError) maxPressureError = error;
+    if (error > TRACE_CHECK_PRESSURE_TOLERANCE) errors++;
+  }
+
+  /**
+   * @brief The fixture replays as the readings it was recorded from
+   */
+  void checkFixtureReplay() {
+    start();
+    TraceReplaySource replay(TRACE_FIXTURE, sizeof(TRACE_FIXTURE));
+    if (!replay.isValid() || replay.getRecordCount() != TRACE_FIXTURE_COUNT) {
+      errors++;
+    }
+    SensorData data;
+    size_t records = 0;
+    while (replay.read(data)) {
+      if (records < TRACE_FIXTURE_COUNT) {
+        compare(TRACE_FIXTURE_READINGS[records], data);
+      }
+      records++;
+    }
+    if (records != TRACE_FIXTURE_COUNT) errors++;
+    report("trace.fixtureReplay", records);
+  }
+
+  /**
+   * @brief Recording the fixture readings gives the fixture bytes
+   */
+  void checkFixtureRecord() {
+    start();
+    uint8_t buffer[sizeof(TRACE_FIXTURE)];
+    BoundedPrint out(buffer, sizeof(buffer));
+    ScriptedReadings readings(TRACE_FIXTURE_READINGS, TRACE_FIXTURE_COUNT);
+    TraceRecorder recorder(readings, out);
+    SensorData data;
+    while (recorder.read(data)) {
+    }
+    if (recorder.getRecordCount() != TRACE_FIXTURE_COUNT || out.length() != sizeof(buffer)) {
+      errors++;
+    }
+    for (size_t i = 0; i < out.length(); i++) {
+      if (buffer[i] != pgm_read_byte(TRACE_FIXTURE + i)) errors++;
+    }
+    report("trace.fixtureRecord", recorder.getRecordCount());
+  }
+
+  /**
+   * @brief Simulated readings survive recording and replay
+   */
+  void checkSimulatedRoundTrip() {
+    start();
+    uint8_t buffer[TRACE_HEADER_SIZE + TRACE_CHECK_SAMPLES * TRACE_RECORD_SIZE];
+    BoundedPrint out(buffer, sizeof(buffer));
+    SimulatedSensorSource simulated(SENSOR_SIM_SEED);
+    TraceRecorder recorder(simulated, out);
+    SensorData data;
+    for (int i = 0; i < TRACE_CHECK_SAMPLES; i++) {
+      recorder.read(data);
+    }
+
+    SimulatedSensorSource expected(SENSOR_SIM_SEED);
+    TraceReplaySource replay(buffer, out.length());
+    size_t records = 0;
+    SensorData reference;
+    while (replay.read(data) && expected.read(reference)) {
+      compare(reference, data);
+      records++;
+    }
+    if (records != TRACE_CHECK_SAMPLES) errors++;
+    report("trace.simulatedRoundTrip", records);
+  }
+
+  /**
+   * @brief Every pressure the sensor reports fits, others are clamped
+   */
+  void checkPressureRange() {
+    start();
+    SensorData reading = TRACE_FIXTURE_READINGS[0];
+    SensorData decoded;
+    uint8_t record[TRACE_RECORD_SIZE];
+    size_t records = 0;
+    for (float pressure = PRESSURE_MIN; pressure <= PRESSURE_MAX; pressure += TRACE_CHECK_SWEEP_STEP) {
+      reading.pressure = pressure;
+      TraceRecorder::encodeRecord(reading, record);
+      TraceReplaySource::decodeRecord(record, decoded);
+      comparePressure(pressure, decoded.pressure);
+      records++;
+    }
+
+    const float limits[][2] = {
+      { PRESSURE_MIN, PRESSURE_MIN }, { PRESSURE_MAX, PRESSURE_MAX },
+      { 250.0, PRESSURE_MIN }, { 1200.0, PRESSURE_MAX }, { 0.0, PRESSURE_MIN }
+    };
+    for (size_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+      reading.pressure = limits[i][0];
+      TraceRecorder::encodeRecord(reading, record);
+      TraceReplaySource::decodeRecord(record, decoded);
+      comparePressure(limits[i][1], decoded.pressure);
+      records++;
+    }
+    report("trace.pressureRange", records);
+  }
+
+  /**
+   * @brief Version 1 traces still replay
+   */
+  void checkVersion1() {
+    start();
+    const float pressures[] = { 1013.25, 950.5, 900.0 };
+    TraceReplaySource replay(TRACE_FIXTURE_V1, sizeof(TRACE_FIXTURE_V1));
+    SensorData data;
+    size_t records = 0;
+    while (replay.read(data)) {
+      if (records < sizeof(pressures) / sizeof(pressures[0])) {
+        comparePressure(pressures[records], data.pressure);
+      }
+      if (fabs(data.tempIndoor - 21.0) > TRACE_CHECK_TOLERANCE || data.airQuality != 60) {
+        errors++;
+      }
+      records++;
+    }
+    if (records != sizeof(pressures) / sizeof(pressures[0])) errors++;
+    report("trace.version1", records);
+  }
+
+  void report(const char* name, size_t records) {
+    results.start(name);
+    results.field("records", (unsigned long)records);
+    results.field("max_error", maxError, 4);
+    results.field("max_error_hpa", maxPressureError, 4);
+    results.field("errors", errors);
+    results.finish(errors == 0);
+  }
+};
+
+#endif // TRACE_CHECK_H
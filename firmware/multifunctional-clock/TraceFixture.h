@@ -0,0 +1,83 @@
+/**
+ * @file TraceFixture.h
+ * @brief Recorded sensor trace used by TraceCheck
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * TRACE_FIXTURE_READINGS were recorded by TraceRecorder into
+ * TRACE_FIXTURE (format version 2). They cover a drive from a lake up to
+ * a mountain pass and back, with pressures down to 741 hPa and an
+ * outdoor temperature below zero, a reading with the air quality sensor
+ * out, then both pressure limits of the BMP180. TRACE_FIXTURE_V1 is a
+ * version 1 trace, still accepted by TraceReplaySource.
+ * 
+ * Regenerate TRACE_FIXTURE only on purpose: a change in it means that
+ * traces recorded before the change replay differently.
+ */
+
+#ifndef TRACE_FIXTURE_H
+#define TRACE_FIXTURE_H
+
+#include "SensorSource.h"
+
+static const SensorData TRACE_FIXTURE_READINGS[] = {
+  // Lakeside, then up to a mountain pass and back (pressure falls ~12 hPa per 100 m)
+  { 21.50f,  12.30f, 41.20f, 71.40f,  963.40f,  68, true },
+  { 21.60f,  11.80f, 41.10f, 72.00f,  951.16f,  70, true },
+  { 21.70f,  10.90f, 41.30f, 73.80f,  928.02f,  73, true },
+  { 21.70f,   9.40f, 41.60f, 76.10f,  899.98f,  75, true },  // v1 wrapped below 900
+  { 21.80f,   7.60f, 41.80f, 79.30f,  871.54f,  77, true },
+  { 21.90f,   5.20f, 42.00f, 82.60f,  842.86f,  80, true },
+  { 22.00f,   2.90f, 42.10f, 85.20f,  811.30f,  79, true },
+  { 22.00f,   0.40f, 42.30f, 88.90f,  782.48f,  81, true },
+  { 22.10f,  -1.70f, 42.40f, 91.70f,  757.74f,  84, true },
+  { 22.10f,  -3.20f, 42.60f, 93.40f,  741.06f,  86, true },  // Pass
+  { 22.20f,  -3.10f, 42.50f, 93.00f,  741.62f,  88, false }, // Air quality sensor dropout
+  { 22.20f,  -1.90f, 42.40f, 91.10f,  760.08f,  85, true },
+  { 22.30f,   1.10f, 42.20f, 86.50f,  803.44f,  82, true },
+  { 22.30f,   4.80f, 42.00f, 80.20f,  857.92f,  78, true },
+  { 22.40f,   8.70f, 41.70f, 75.40f,  912.36f,  74, true },
+  { 22.40f,  11.90f, 41.50f, 72.20f,  959.88f,  71, true },
+  // Limits of the BMP180 and a deep storm at sea level
+  { 25.00f,  30.00f, 35.00f, 60.00f,  300.00f,  40, true },
+  { 18.00f, -25.50f, 70.00f, 99.90f, 1100.00f, 150, true },
+  { 20.00f,  14.00f, 50.00f, 95.00f,  952.90f,  99, true },
+  { 20.00f,  15.00f, 50.00f, 90.00f, 1013.26f,  66, true },
+};
+
+#define TRACE_FIXTURE_COUNT   (sizeof(TRACE_FIXTURE_READINGS) / sizeof(TRACE_FIXTURE_READINGS[0]))
+
+static const uint8_t TRACE_FIXTURE[] PROGMEM = {
+  0x53, 0x4E, 0x54, 0x52, 0x02, 0x00, 0x1E, 0x00,
+  0x66, 0x08, 0xCE, 0x04, 0x18, 0x10, 0xE4, 0x1B, 0x92, 0x81, 0x44, 0x00,
+  0x70, 0x08, 0x9C, 0x04, 0x0E, 0x10, 0x20, 0x1C, 0x2E, 0x7F, 0x46, 0x00,
+  0x7A, 0x08, 0x42, 0x04, 0x22, 0x10, 0xD4, 0x1C, 0xA9, 0x7A, 0x49, 0x00,
+  0x7A, 0x08, 0xAC, 0x03, 0x40, 0x10, 0xBA, 0x1D, 0x2F, 0x75, 0x4B, 0x00,
+  0x84, 0x08, 0xF8, 0x02, 0x54, 0x10, 0xFA, 0x1E, 0xA1, 0x6F, 0x4D, 0x00,
+  0x8E, 0x08, 0x08, 0x02, 0x68, 0x10, 0x44, 0x20, 0x07, 0x6A, 0x50, 0x00,
+  0x98, 0x08, 0x22, 0x01, 0x72, 0x10, 0x48, 0x21, 0xDD, 0x63, 0x4F, 0x00,
+  0x98, 0x08, 0x28, 0x00, 0x86, 0x10, 0xBA, 0x22, 0x3C, 0x5E, 0x51, 0x00,
+  0xA2, 0x08, 0x56, 0xFF, 0x90, 0x10, 0xD2, 0x23, 0x67, 0x59, 0x54, 0x00,
+  0xA2, 0x08, 0xC0, 0xFE, 0xA4, 0x10, 0x7C, 0x24, 0x25, 0x56, 0x56, 0x00,
+  0xAC, 0x08, 0xCA, 0xFE, 0x9A, 0x10, 0x54, 0x24, 0x41, 0x56, 0xFF, 0xFF,
+  0xAC, 0x08, 0x42, 0xFF, 0x90, 0x10, 0x96, 0x23, 0xDC, 0x59, 0x55, 0x00,
+  0xB6, 0x08, 0x6E, 0x00, 0x7C, 0x10, 0xCA, 0x21, 0x54, 0x62, 0x52, 0x00,
+  0xB6, 0x08, 0xE0, 0x01, 0x68, 0x10, 0x54, 0x1F, 0xF8, 0x6C, 0x4E, 0x00,
+  0xC0, 0x08, 0x66, 0x03, 0x4A, 0x10, 0x74, 0x1D, 0x9A, 0x77, 0x4A, 0x00,
+  0xC0, 0x08, 0xA6, 0x04, 0x36, 0x10, 0x34, 0x1C, 0xE2, 0x80, 0x47, 0x00,
+  0xC4, 0x09, 0xB8, 0x0B, 0xAC, 0x0D, 0x70, 0x17, 0x00, 0x00, 0x28, 0x00,
+  0x08, 0x07, 0x0A, 0xF6, 0x58, 0x1B, 0x06, 0x27, 0x40, 0x9C, 0x96, 0x00,
+  0xD0, 0x07, 0x78, 0x05, 0x88, 0x13, 0x1C, 0x25, 0x85, 0x7F, 0x63, 0x00,
+  0xD0, 0x07, 0xDC, 0x05, 0x88, 0x13, 0x28, 0x23, 0x4F, 0x8B, 0x42, 0x00
+};
+
+// Version 1: 21.00 / 10.00 °C, 40.00 / 70.00 %, 60 PPM at 1013.25, 950.50 and 900.00 hPa
+static const uint8_t TRACE_FIXTURE_V1[] PROGMEM = {
+  0x53, 0x4E, 0x54, 0x52, 0x01, 0x00, 0x1E, 0x00,
+  0x34, 0x08, 0xE8, 0x03, 0xA0, 0x0F, 0x58, 0x1B, 0x3D, 0x2C, 0x3C, 0x00,
+  0x34, 0x08, 0xE8, 0x03, 0xA0, 0x0F, 0x58, 0x1B, 0xBA, 0x13, 0x3C, 0x00,
+  0x34, 0x08, 0xE8, 0x03, 0xA0, 0x0F, 0x58, 0x1B, 0x00, 0x00, 0x3C, 0x00
+};
+
+#endif // TRACE_FIXTURE_H
@@ -6,14 +6,28 @@
  * @date 2025
  * 
  * This class handles all user interface interactions including button processing,
- * mode switching, menu navigation, and timeout management. It provides a clean
- * state machine for UI modes and sensor page navigation.
+ * mode switching, menu navigation, and timeout management. Mode changes are
+ * driven by the transition table in UiStateTable.h.
  */
 
 #ifndef UI_MANAGER_H
 #define UI_MANAGER_H
 
 #include "config.h"
+#include "Timebase.h"
+#include "InputScript.h"
+#include "UiStateTable.h"
+#include "Settings.h"
+#include "Stopwatch.h"
+
+/**
+ * @brief Alarm request made with the buttons while an alarm rings
+ */
+enum AlarmCommand {
+  ALARM_COMMAND_NONE = 0,
+  ALARM_COMMAND_SNOOZE,   ///< Select pressed
+  ALARM_COMMAND_DISMISS   ///< Mode pressed
+};
 
 /**
  * @class UIManager
@@ -24,9 +38,14 @@
  * - UI mode transitions (Clock, Sensors, Network, Settings)
  * - Sensor page navigation within sensor mode
  * - Automatic timeout return to clock mode
- * - Settings menu navigation
+ * - Settings menu navigation and editing (long press on select)
+ * - Stopwatch and countdown controls
+ * - Snooze and dismiss while an alarm rings
+ * - Scripted input replay and edge recording
  */
 class UIManager {
+  friend class Benchmark;
+
 private:
   // Interface state
   UIMode currentMode;           ///< Current UI display mode
@@ -35,13 +54,33 @@ private:
   // Button state management
   bool lastModeButtonState;     ///< Previous state of mode button
   bool lastSelectButtonState;   ///< Previous state of select button
-  unsigned long lastModePress;  ///< Timestamp of last mode button press
-  unsigned long lastSelectPress; ///< Timestamp of last select button press
-  unsigned long lastActivity;   ///< Timestamp of last user activity
+  uint64_t lastModePress;       ///< Timestamp of last mode button press
+  uint64_t lastSelectPress;     ///< Timestamp of last select button press
+  uint64_t lastActivity;        ///< Timestamp of last user activity
+  uint64_t selectHeldSince;     ///< Time the select button went down
+  bool selectConsumed;          ///< Current select press already acted on
+  uint64_t selectDownMicros;    ///< Same, to the microsecond
+  uint64_t updateMicros;        ///< Time of the current update (us)
   
   // Settings menu state
   int settingsMenuItem;         ///< Current settings menu item
-  bool inSettingsEdit;          ///< Whether user is editing a setting
+  Settings* settings;           ///< Settings edited by the menu, or nullptr
+  bool settingsChanged;         ///< A setting was edited since last taken
+  
+  // Timer modes, timed from the select press that drives them
+  Stopwatch stopwatch;
+  Countdown countdown;
+  
+  // Alarm state
+  bool alarmRinging;            ///< Buttons control the alarm while set
+  AlarmCommand alarmCommand;    ///< Pending snooze or dismiss request
+  
+  // Input injection and measurement
+  ButtonScript* inputScript;    ///< Replayed input, or nullptr for the pins
+  uint64_t scriptStart;         ///< Time the script was started
+  ButtonRecorder* recorder;     ///< Raw edge recorder, or nullptr
+  unsigned long stateVersion;   ///< Incremented on every mode/page change
+  unsigned long lastInputLatency; ///< Edge to state change delay (ms)
 
 public:
   /**
@@ -52,13 +91,25 @@ public:
   UIManager() : 
     currentMode(UI_MODE_CLOCK),
     currentSensorPage(SENSOR_PAGE_TEMP_IN),
-    lastModeButtonState(HIGH),
-    lastSelectButtonState(HIGH),
+    lastModeButtonState(false),
+    lastSelectButtonState(false),
     lastModePress(0),
     lastSelectPress(0),
     lastActivity(0),
+    selectHeldSince(0),
+    selectConsumed(false),
+    selectDownMicros(0),
+    updateMicros(0),
     settingsMenuItem(0),
-    inSettingsEdit(false) {}
+    settings(nullptr),
+    settingsChanged(false),
+    alarmRinging(false),
+    alarmCommand(ALARM_COMMAND_NONE),
+    inputScript(nullptr),
+    scriptStart(0),
+    recorder(nullptr),
+    stateVersion(0),
+    lastInputLatency(0) {}
   
   /**
    * @brief Initialize the UI manager
@@ -70,7 +121,7 @@ public:
   bool init() {
     pinMode(BUTTON_MODE_PIN, INPUT_PULLUP);
     pinMode(BUTTON_SELECT_PIN, INPUT_PULLUP);
-    lastActivity = millis();
+    lastActivity = Timebase::millis64();
     return true;
   }
   
@@ -81,8 +132,126 @@ public:
    * and timeout management.
    */
   void update() {
-    handleButtons();
-    checkTimeout();
+    uint64_t nowMicros = Timebase::micros64();
+    step(nowMicros / 1000, nowMicros);
+  }
+  
+  /**
+   * @brief Update UI manager state at a given time
+   * 
+   * Lets scripted input be replayed in simulated time. The stopwatch and
+   * countdown run on the same time, so a replayed press starts and stops
+   * them at its simulated instant.
+   * 
+   * @param now Current time (ms)
+   */
+  void update(uint64_t now) {
+    step(now, now * 1000);
+  }
+  
+  /**
+   * @brief Set the settings edited from the settings menu
+   * 
+   * @param editedSettings Settings to edit, or nullptr for a read-only menu
+   */
+  void attachSettings(Settings* editedSettings) {
+    settings = editedSettings;
+  }
+  
+  /**
+   * @brief Check and clear the "settings edited" flag
+   * 
+   * @return true if a setting was changed from the menu since the last call
+   */
+  bool takeSettingsChange() {
+    bool changed = settingsChanged;
+    settingsChanged = false;
+    return changed;
+  }
+  
+  /**
+   * @brief Tell the UI whether an alarm is ringing
+   * 
+   * While it rings, select snoozes and mode dismisses instead of
+   * navigating.
+   */
+  void setAlarmRinging(bool ringing) {
+    alarmRinging = ringing;
+  }
+  
+  /**
+   * @brief Take the pending snooze or dismiss request
+   */
+  AlarmCommand takeAlarmCommand() {
+    AlarmCommand command = alarmCommand;
+    alarmCommand = ALARM_COMMAND_NONE;
+    return command;
+  }
+  
+  /**
+   * @brief Get the stopwatch shown in stopwatch mode
+   */
+  const Stopwatch& getStopwatch() const {
+    return stopwatch;
+  }
+  
+  /**
+   * @brief Get the countdown shown in countdown mode
+   */
+  const Countdown& getCountdown() const {
+    return countdown;
+  }
+  
+  /**
+   * @brief Check and clear the "countdown reached zero" flag
+   */
+  bool takeCountdownFinished() {
+    return countdown.takeFinished();
+  }
+  
+  /**
+   * @brief Read buttons from a script instead of the pins
+   * 
+   * @param script Script to replay, or nullptr to go back to the pins
+   * @param now Current time (ms), used as the script origin
+   */
+  void setInputScript(ButtonScript* script, uint64_t now) {
+    inputScript = script;
+    scriptStart = now;
+    if (inputScript) {
+      inputScript->rewind();
+    }
+  }
+  
+  /**
+   * @brief Record raw button edges
+   * 
+   * @param edgeRecorder Recorder to fill, or nullptr to stop recording
+   */
+  void setRecorder(ButtonRecorder* edgeRecorder) {
+    recorder = edgeRecorder;
+  }
+  
+  /**
+   * @brief Get the UI state version
+   * 
+   * Incremented whenever the mode, page or menu item changes, so the
+   * display knows when a redraw is due.
+   */
+  unsigned long getStateVersion() const {
+    return stateVersion;
+  }
+  
+  /**
+   * @brief Get the delay between the last input edge and its state change
+   * 
+   * Only measurable while replaying a script, since the script knows when
+   * the edge really happened; 0 for the physical buttons.
+   * 
+   * @return Latency in milliseconds
+   */
+  unsigned long getLastInputLatency() const {
+    return lastInputLatency;
   }
   
   /**
@@ -111,123 +280,202 @@ public:
   int getSettingsMenu() const {
     return settingsMenuItem;
   }
-  
+
+private:
   /**
-   * @brief Check if user is currently editing settings
+   * @brief Run one update on a single time reading
    * 
-   * @return true if in settings edit mode, false otherwise
+   * @param now Current time (ms)
+   * @param nowMicros Same time (us), for the timer modes
    */
-  bool isInSettingsEdit() const {
-    return inSettingsEdit;
+  void step(uint64_t now, uint64_t nowMicros) {
+    updateMicros = nowMicros;
+    stopwatch.sample(nowMicros);
+    countdown.sample(nowMicros);
+    
+    handleButtons(now);
+    checkTimeout(now);
   }
-
-private:
+  
   /**
    * @brief Handle button press detection with debouncing
    * 
    * Reads both buttons, applies debouncing, and calls appropriate
    * handlers when valid presses are detected.
    */
-  void handleButtons() {
-    unsigned long currentTime = millis();
+  void handleButtons(uint64_t currentTime) {
+    uint64_t edgeTime = currentTime;
+    if (inputScript) {
+      inputScript->advance(currentTime - scriptStart);
+      unsigned long scriptEdge;
+      if (inputScript->takeFirstEdge(scriptEdge)) {
+        edgeTime = scriptStart + scriptEdge;
+      }
+    }
     
     // Mode button handling with debouncing
-    bool modePressed = digitalRead(BUTTON_MODE_PIN) == LOW;
+    bool modePressed = readButton(BUTTON_MODE_PIN);
     if (modePressed != lastModeButtonState) {
+      recordEdge(currentTime, BUTTON_MODE_PIN, modePressed);
       if (currentTime - lastModePress > BUTTON_DEBOUNCE_DELAY) {
         if (modePressed) {
-          onModeButtonPressed();
           lastActivity = currentTime;
+          if (alarmRinging) {
+            alarmCommand = ALARM_COMMAND_DISMISS;
+          } else {
+            applyEvent(UI_EVENT_MODE, currentTime - edgeTime);
+          }
         }
         lastModePress = currentTime;
       }
       lastModeButtonState = modePressed;
     }
     
-    // Select button handling with debouncing
-    bool selectPressed = digitalRead(BUTTON_SELECT_PIN) == LOW;
+    // Select button handling with debouncing. Where a long press does
+    // something, a short press acts on release instead of on press.
+    bool selectPressed = readButton(BUTTON_SELECT_PIN);
     if (selectPressed != lastSelectButtonState) {
+      recordEdge(currentTime, BUTTON_SELECT_PIN, selectPressed);
       if (currentTime - lastSelectPress > BUTTON_DEBOUNCE_DELAY) {
+        lastActivity = currentTime;
         if (selectPressed) {
-          onSelectButtonPressed();
-          lastActivity = currentTime;
+          selectHeldSince = currentTime;
+          selectDownMicros = updateMicros;
+          selectConsumed = alarmRinging || !UI_DISPATCH.hasLongPress(currentMode);
+          if (alarmRinging) {
+            alarmCommand = ALARM_COMMAND_SNOOZE;
+          } else if (selectConsumed) {
+            applyEvent(UI_EVENT_SELECT, currentTime - edgeTime);
+          }
+        } else if (!selectConsumed) {
+          selectConsumed = true;
+          applyEvent(UI_EVENT_SELECT, currentTime - edgeTime);
         }
         lastSelectPress = currentTime;
       }
       lastSelectButtonState = selectPressed;
     }
+    
+    // Long press fires once while the button is still held
+    if (lastSelectButtonState && !selectConsumed &&
+        currentTime - selectHeldSince >= BUTTON_LONG_PRESS) {
+      selectConsumed = true;
+      lastActivity = currentTime;
+      applyEvent(UI_EVENT_SELECT_LONG, currentTime - selectHeldSince - BUTTON_LONG_PRESS);
+    }
   }
   
   /**
-   * @brief Handle mode button press events
+   * @brief Dispatch an event and note the state change it causes
    * 
-   * Cycles through UI modes or exits settings edit mode.
+   * @param event Event to apply
+   * @param latency Time since the input that caused it (ms)
    */
-  void onModeButtonPressed() {
-    DEBUG_PRINTLN("Mode button pressed");
-    
-    if (inSettingsEdit) {
-      // Exit settings edit mode
-      inSettingsEdit = false;
-      return;
+  void applyEvent(UiEvent event, unsigned long latency) {
+    if (dispatch(event)) {
+      markStateChanged(latency);
     }
-    
-    // Cycle to next UI mode
-    currentMode = (UIMode)((currentMode + 1) % UI_MODE_COUNT);
-    
-    // Reset sub-menus when entering new modes
-    if (currentMode == UI_MODE_SENSORS) {
-      currentSensorPage = SENSOR_PAGE_TEMP_IN;
-    } else if (currentMode == UI_MODE_SETTINGS) {
-      settingsMenuItem = 0;
+  }
+  
+  /**
+   * @brief Read a button level from the script or the pin
+   * 
+   * @param pin Button pin
+   * @return true if the button is held down
+   */
+  bool readButton(uint8_t pin) const {
+    if (inputScript) {
+      return inputScript->isPressed(pin);
     }
-    
-    DEBUG_PRINT("New mode: ");
-    DEBUG_PRINTLN(getModeString(currentMode));
+    return digitalRead(pin) == LOW;
   }
   
   /**
-   * @brief Handle select button press events
+   * @brief Pass a raw edge to the recorder, if any
+   */
+  void recordEdge(uint64_t now, uint8_t pin, bool pressed) {
+    if (recorder) {
+      recorder->record(now, pin, pressed);
+    }
+  }
+  
+  /**
+   * @brief Note a UI state change and the latency that led to it
+   * 
+   * @param latency Time since the input edge, or the timeout, that caused it (ms)
+   */
+  void markStateChanged(unsigned long latency) {
+    stateVersion++;
+    lastInputLatency = latency;
+  }
+  
+  /**
+   * @brief Apply one event through the transition table
    * 
-   * Behavior depends on current UI mode:
-   * - Clock: No action
-   * - Sensors: Navigate between sensor pages
-   * - Network: Trigger network actions
-   * - Settings: Navigate menu or edit values
+   * @param event Event to apply
+   * @return true if the mode or a sub-menu changed
    */
-  void onSelectButtonPressed() {
-    DEBUG_PRINTLN("Select button pressed");
+  bool dispatch(UiEvent event) {
+    const UiTableEntry& entry = UI_DISPATCH.lookup(currentMode, event);
+    UIMode next = (UIMode)entry.next;
+    bool changed = (next != currentMode) || (entry.action != UI_ACTION_NONE);
     
-    switch (currentMode) {
-      case UI_MODE_CLOCK:
-        // No specific action in clock mode
+    currentMode = next;
+    runAction((UiAction)entry.action);
+    
+    if (changed) {
+      DEBUG_PRINT("Mode: ");
+      DEBUG_PRINTLN(getModeString(currentMode));
+    }
+    return changed;
+  }
+  
+  /**
+   * @brief Run the side effect of a transition
+   */
+  void runAction(UiAction action) {
+    switch (action) {
+      case UI_ACTION_RESET_SENSOR_PAGE:
+        currentSensorPage = SENSOR_PAGE_TEMP_IN;
         break;
         
-      case UI_MODE_SENSORS:
-        // Cycle through sensor pages
+      case UI_ACTION_NEXT_SENSOR_PAGE:
         currentSensorPage = (SensorPage)((currentSensorPage + 1) % SENSOR_PAGE_COUNT);
-        DEBUG_PRINT("Sensor page: ");
-        DEBUG_PRINTLN(currentSensorPage);
         break;
         
-      case UI_MODE_NETWORK:
-        // Force WiFi reconnection or data send
-        // This action will be handled by NetworkManager
+      case UI_ACTION_RESET_SETTINGS:
+        settingsMenuItem = 0;
         break;
         
-      case UI_MODE_SETTINGS:
-        if (inSettingsEdit) {
-          // Modify current setting value
-          modifyCurrentSetting();
-        } else {
-          // Navigate to next settings item or enter edit mode
-          if (settingsMenuItem < getSettingsCount() - 1) {
-            settingsMenuItem++;
-          } else {
-            settingsMenuItem = 0;
-          }
+      case UI_ACTION_NEXT_SETTING:
+        settingsMenuItem = (settingsMenuItem + 1) % getSettingsCount();
+        break;
+        
+      case UI_ACTION_INCREMENT_SETTING:
+        if (settings) {
+          settings->increment((SettingId)settingsMenuItem);
+          settingsChanged = true;
         }
         break;
+        
+      case UI_ACTION_STOPWATCH_TOGGLE:
+        stopwatch.toggle(selectDownMicros);
+        break;
+        
+      case UI_ACTION_STOPWATCH_LAP:
+        stopwatch.lapOrReset(selectDownMicros);
+        break;
+        
+      case UI_ACTION_COUNTDOWN_TOGGLE:
+        countdown.toggle(selectDownMicros);
+        break;
+        
+      case UI_ACTION_COUNTDOWN_RESET:
+        countdown.resetOrNextPreset();
+        break;
+        
+      default:
+        break;
     }
   }
   
@@ -237,35 +485,24 @@ private:
    * Automatically returns to clock mode after UI_TIMEOUT period
    * of inactivity to prevent staying in menus indefinitely.
    */
-  void checkTimeout() {
+  void checkTimeout(uint64_t now) {
     // Auto return to clock mode after inactivity
     if (currentMode != UI_MODE_CLOCK && 
-        millis() - lastActivity > UI_TIMEOUT) {
-      currentMode = UI_MODE_CLOCK;
-      inSettingsEdit = false;
+        now - lastActivity > UI_TIMEOUT &&
+        dispatch(UI_EVENT_TIMEOUT)) {
+      // Due from the first millisecond past UI_TIMEOUT
+      markStateChanged(now - lastActivity - UI_TIMEOUT - 1);
       DEBUG_PRINTLN("Timeout - returning to clock mode");
     }
   }
   
-  /**
-   * @brief Modify the currently selected setting
-   * 
-   * Placeholder for settings modification logic.
-   * Implementation depends on available settings.
-   */
-  void modifyCurrentSetting() {
-    // TODO: Implement setting modification based on settingsMenuItem
-    DEBUG_PRINT("Modifying setting: ");
-    DEBUG_PRINTLN(settingsMenuItem);
-  }
-  
   /**
    * @brief Get total number of configurable settings
    * 
    * @return Number of settings menu items
    */
   int getSettingsCount() const {
-    return 5; // Number of configurable parameters
+    return SETTING_COUNT;
   }
   
   /**
@@ -280,6 +517,9 @@ private:
       case UI_MODE_SENSORS: return "Sensors"; 
       case UI_MODE_NETWORK: return "Network";
       case UI_MODE_SETTINGS: return "Settings";
+      case UI_MODE_SETTINGS_EDIT: return "Settings edit";
+      case UI_MODE_STOPWATCH: return "Stopwatch";
+      case UI_MODE_COUNTDOWN: return "Countdown";
       default: return "Unknown";
     }
   }
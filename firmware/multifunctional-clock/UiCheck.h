@@ -0,0 +1,309 @@
+/**
+ * @file UiCheck.h
+ * @brief Scripted button replay check for the UI state machine
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Replays recorded-style button scripts, contact bounce included, through
+ * a separate UIManager in simulated time and checks the mode and page it
+ * ends on, the number of state changes and the input-to-redraw latency.
+ * Bounce edges are spaced wider than the loop period, so every one of
+ * them is seen by a poll, but closer than BUTTON_DEBOUNCE_DELAY, so none
+ * of them may count as a press.
+ * Simulated time starts just before the 49.7-day millis() rollover, so
+ * every scenario also checks that debounce, long press and timeout
+ * survive it.
+ * 
+ * New scenarios can be captured on the device with ButtonRecorder and
+ * pasted in as event tables.
+ */
+
+#ifndef UI_CHECK_H
+#define UI_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "UIManager.h"
+#include "DisplayManager.h"
+#include "InputScript.h"
+
+#define UI_CHECK_POLL_MS      LOOP_DELAY // Same as the delay at the end of loop()
+#define UI_CHECK_START_MS     (4294967296ULL - 1000) // 1 s before the 32-bit millis() rollover
+
+#define UI_SCRIPT(events)     events, sizeof(events) / sizeof(events[0])
+
+// One mode press with bounce on both edges
+static const ButtonEvent SCRIPT_MODE_ONCE[] = {
+  { 123, BUTTON_MODE_PIN, true },
+  { 144, BUTTON_MODE_PIN, false },
+  { 165, BUTTON_MODE_PIN, true },
+  { 302, BUTTON_MODE_PIN, false },
+  { 323, BUTTON_MODE_PIN, true },
+  { 344, BUTTON_MODE_PIN, false }
+};
+
+// Mode, then select twice: sensors mode on the pressure page
+static const ButtonEvent SCRIPT_SENSOR_PAGES[] = {
+  { 101, BUTTON_MODE_PIN, true },
+  { 122, BUTTON_MODE_PIN, false },
+  { 143, BUTTON_MODE_PIN, true },
+  { 241, BUTTON_MODE_PIN, false },
+  { 431, BUTTON_SELECT_PIN, true },
+  { 452, BUTTON_SELECT_PIN, false },
+  { 473, BUTTON_SELECT_PIN, true },
+  { 581, BUTTON_SELECT_PIN, false },
+  { 777, BUTTON_SELECT_PIN, true },
+  { 901, BUTTON_SELECT_PIN, false },
+  { 922, BUTTON_SELECT_PIN, true },
+  { 943, BUTTON_SELECT_PIN, false }
+};
+
+// Six mode presses: every mode, back to the clock
+static const ButtonEvent SCRIPT_MODE_CYCLE[] = {
+  { 91, BUTTON_MODE_PIN, true },
+  { 231, BUTTON_MODE_PIN, false },
+  { 401, BUTTON_MODE_PIN, true },
+  { 422, BUTTON_MODE_PIN, false },
+  { 443, BUTTON_MODE_PIN, true },
+  { 561, BUTTON_MODE_PIN, false },
+  { 733, BUTTON_MODE_PIN, true },
+  { 891, BUTTON_MODE_PIN, false },
+  { 1049, BUTTON_MODE_PIN, true },
+  { 1071, BUTTON_MODE_PIN, false },
+  { 1088, BUTTON_MODE_PIN, true },
+  { 1201, BUTTON_MODE_PIN, false },
+  { 1377, BUTTON_MODE_PIN, true },
+  { 1531, BUTTON_MODE_PIN, false },
+  { 1702, BUTTON_MODE_PIN, true },
+  { 1723, BUTTON_MODE_PIN, false },
+  { 1744, BUTTON_MODE_PIN, true },
+  { 1861, BUTTON_MODE_PIN, false }
+};
+
+// One mode press, then no input until the inactivity timeout
+static const ButtonEvent SCRIPT_TIMEOUT[] = {
+  { 75, BUTTON_MODE_PIN, true },
+  { 210, BUTTON_MODE_PIN, false }
+};
+
+// Into the settings menu, long press to edit, one step, mode to leave edit
+static const ButtonEvent SCRIPT_SETTINGS_EDIT[] = {
+  { 100, BUTTON_MODE_PIN, true },
+  { 250, BUTTON_MODE_PIN, false },
+  { 400, BUTTON_MODE_PIN, true },
+  { 550, BUTTON_MODE_PIN, false },
+  { 700, BUTTON_MODE_PIN, true },
+  { 850, BUTTON_MODE_PIN, false },
+  { 1010, BUTTON_SELECT_PIN, true },
+  { 1031, BUTTON_SELECT_PIN, false },
+  { 1048, BUTTON_SELECT_PIN, true },
+  { 2300, BUTTON_SELECT_PIN, false },
+  { 2520, BUTTON_SELECT_PIN, true },
+  { 2660, BUTTON_SELECT_PIN, false },
+  { 2681, BUTTON_SELECT_PIN, true },
+  { 2698, BUTTON_SELECT_PIN, false },
+  { 2900, BUTTON_MODE_PIN, true },
+  { 3050, BUTTON_MODE_PIN, false }
+};
+
+// Into stopwatch mode, start, then stop 1.2 s later with a bouncing press
+static const ButtonEvent SCRIPT_STOPWATCH[] = {
+  { 100, BUTTON_MODE_PIN, true },
+  { 250, BUTTON_MODE_PIN, false },
+  { 400, BUTTON_MODE_PIN, true },
+  { 550, BUTTON_MODE_PIN, false },
+  { 700, BUTTON_MODE_PIN, true },
+  { 850, BUTTON_MODE_PIN, false },
+  { 1000, BUTTON_MODE_PIN, true },
+  { 1150, BUTTON_MODE_PIN, false },
+  { 1503, BUTTON_SELECT_PIN, true },
+  { 1620, BUTTON_SELECT_PIN, false },
+  { 2703, BUTTON_SELECT_PIN, true },
+  { 2722, BUTTON_SELECT_PIN, false },
+  { 2741, BUTTON_SELECT_PIN, true },
+  { 2820, BUTTON_SELECT_PIN, false }
+};
+
+/**
+ * @struct UiScenario
+ * @brief A button script and the UI state it must end in
+ */
+struct UiScenario {
+  const char* name;
+  const ButtonEvent* events;
+  size_t count;
+  unsigned long runFor;     ///< Simulated time to run (ms since start)
+  UIMode mode;              ///< Expected final mode
+  SensorPage page;          ///< Expected final sensor page
+  unsigned long changes;    ///< Expected number of UI state changes
+  uint32_t stopwatch;       ///< Expected stopwatch time (ms)
+};
+
+static const UiScenario UI_SCENARIOS[] = {
+  { "ui.modeOnce", UI_SCRIPT(SCRIPT_MODE_ONCE), 1000,
+    UI_MODE_SENSORS, SENSOR_PAGE_TEMP_IN, 1, 0 },
+  { "ui.sensorPages", UI_SCRIPT(SCRIPT_SENSOR_PAGES), 1500,
+    UI_MODE_SENSORS, SENSOR_PAGE_PRESSURE, 3, 0 },
+  { "ui.modeCycle", UI_SCRIPT(SCRIPT_MODE_CYCLE), 2500,
+    UI_MODE_CLOCK, SENSOR_PAGE_TEMP_IN, 6, 0 },
+  { "ui.timeout", UI_SCRIPT(SCRIPT_TIMEOUT), UI_TIMEOUT + 1000,
+    UI_MODE_CLOCK, SENSOR_PAGE_TEMP_IN, 2, 0 },
+  { "ui.settingsEdit", UI_SCRIPT(SCRIPT_SETTINGS_EDIT), 3500,
+    UI_MODE_SETTINGS, SENSOR_PAGE_TEMP_IN, 6, 0 },
+  { "ui.stopwatch", UI_SCRIPT(SCRIPT_STOPWATCH), 3500,
+    UI_MODE_STOPWATCH, SENSOR_PAGE_TEMP_IN, 6, 1200 }
+};
+
+/**
+ * @class UiCheck
+ * @brief Replays every scenario and compares the resulting UI state
+ * 
+ * Each scenario runs on a fresh UIManager polled every UI_CHECK_POLL_MS
+ * of simulated time, so results are identical on every run and the
+ * firmware's own UIManager is left untouched. After each poll the screen
+ * is drawn on a DisplayManager, as loop() does. Every button edge must
+ * reach the UIManager, and only the scripted presses may change its
+ * state. The latency from a button edge to the redraw showing its result
+ * (the simulated wait for the next poll plus the real time taken by the
+ * update and the redraw) must stay within one poll interval. The
+ * stopwatch runs on the same simulated time, so its reading is exact.
+ */
+class UiCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  UiCheck() : results("UI") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of scenarios that did not end in the expected state
+   */
+  int runAll() {
+    results.begin();
+    
+    for (size_t i = 0; i < sizeof(UI_SCENARIOS) / sizeof(UI_SCENARIOS[0]); i++) {
+      runScenario(UI_SCENARIOS[i]);
+    }
+    
+    return results.end();
+  }
+
+private:
+  void runScenario(const UiScenario& scenario) {
+    UIManager ui;
+    DisplayManager display;
+    Settings settings;
+    settings.loadDefaults();
+    ui.attachSettings(&settings);
+    ButtonScript script(scenario.events, scenario.count);
+    ButtonRecorder edges;
+    edges.begin(UI_CHECK_START_MS);
+    ui.setRecorder(&edges);
+    ui.setInputScript(&script, UI_CHECK_START_MS);
+    
+    uint32_t maxLatency = 0;
+    unsigned long lastVersion = 0;
+    bool redrawPending = false;
+    unsigned long redraws = 0;
+    uint64_t edgeAt = 0;
+    for (unsigned long t = 0; t <= scenario.runFor; t += UI_CHECK_POLL_MS) {
+      uint64_t pollStart = Timebase::micros64();
+      ui.update(UI_CHECK_START_MS + t);
+      if (ui.getStateVersion() != lastVersion) {
+        lastVersion = ui.getStateVersion();
+        edgeAt = t - ui.getLastInputLatency();
+        redrawPending = true;
+      }
+      
+      draw(display, ui, settings);
+      if (redrawPending && display.getLastRedrawMicros() >= pollStart &&
+          display.getShownScreen() == screenOf(ui)) {
+        uint32_t latency = (uint32_t)((t - edgeAt) * 1000 + (display.getLastRedrawMicros() - pollStart));
+        if (latency > maxLatency) maxLatency = latency;
+        redrawPending = false;
+        redraws++;
+      }
+    }
+    ui.setRecorder(nullptr);
+    
+    bool ok = script.isFinished() &&
+              edges.getCount() == scenario.count &&
+              ui.getCurrentMode() == scenario.mode &&
+              ui.getSensorPage() == scenario.page &&
+              ui.getStateVersion() == scenario.changes &&
+              redraws == scenario.changes &&
+              ui.getStopwatch().getElapsedMillis() == scenario.stopwatch &&
+              maxLatency < UI_CHECK_POLL_MS * 1000UL;
+    
+    results.start(scenario.name);
+    results.field("mode", (int)ui.getCurrentMode());
+    results.field("page", (int)ui.getSensorPage());
+    results.field("edges", (unsigned long)edges.getCount());
+    results.field("changes", ui.getStateVersion());
+    results.field("stopwatch_ms", (unsigned long)ui.getStopwatch().getElapsedMillis());
+    results.field("redraws", redraws);
+    results.field("max_redraw_latency_us", (unsigned long)maxLatency);
+    results.finish(ok);
+  }
+  
+  /**
+   * @brief Draw the screen of the current UI mode, as loop() does
+   */
+  void draw(DisplayManager& display, const UIManager& ui, const Settings& settings) {
+    static const TimeInfo time = { 12, 0, 0, 1, 1, 2025, 3, true };
+    static const SensorData data = {};
+    
+    switch (ui.getCurrentMode()) {
+      case UI_MODE_CLOCK:
+        display.showClock(time);
+        break;
+      case UI_MODE_SENSORS:
+        display.showSensorData(data, ui.getSensorPage());
+        break;
+      case UI_MODE_NETWORK:
+        display.showNetworkInfo(0);
+        break;
+      case UI_MODE_SETTINGS:
+      case UI_MODE_SETTINGS_EDIT:
+        display.showSettings(ui.getSettingsMenu(), settings,
+                             ui.getCurrentMode() == UI_MODE_SETTINGS_EDIT);
+        break;
+      case UI_MODE_STOPWATCH:
+        display.showStopwatch(ui.getStopwatch());
+        break;
+      case UI_MODE_COUNTDOWN:
+        display.showCountdown(ui.getCountdown());
+        break;
+      default:
+        break;
+    }
+  }
+  
+  /**
+   * @brief Screen the display must show for the current UI state
+   */
+  static uint32_t screenOf(const UIManager& ui) {
+    UIMode mode = ui.getCurrentMode();
+    switch (mode) {
+      case UI_MODE_SENSORS:
+        return DISPLAY_SCREEN(mode, ui.getSensorPage());
+      case UI_MODE_SETTINGS:
+      case UI_MODE_SETTINGS_EDIT:
+        return DISPLAY_SCREEN(mode, ui.getSettingsMenu());
+      case UI_MODE_STOPWATCH:
+        return DisplayManager::timerScreen(ui.getStopwatch());
+      case UI_MODE_COUNTDOWN:
+        return DisplayManager::timerScreen(ui.getCountdown());
+      default:
+        return DISPLAY_SCREEN(mode, 0);
+    }
+  }
+};
+
+#endif // UI_CHECK_H
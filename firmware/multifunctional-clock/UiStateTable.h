@@ -0,0 +1,236 @@
+/**
+ * @file UiStateTable.h
+ * @brief Transition table of the UI state machine
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * The UI is described as a list of (state, event) -> (next state, action)
+ * transitions. The list is turned into a state x event lookup table at
+ * compile time, so dispatching an event is a single indexed read from
+ * flash whatever the number of modes. The static_asserts at the end check
+ * that every state handles every event exactly once and that every state
+ * can be reached from the clock, so a new mode that is only half wired
+ * fails to compile.
+ * 
+ * Adding a mode: add it to UIMode in config.h, give it one row per event
+ * below, and add any new action to UiAction and UIManager::runAction().
+ */
+
+#ifndef UI_STATE_TABLE_H
+#define UI_STATE_TABLE_H
+
+#include "config.h"
+
+/**
+ * @brief Inputs of the UI state machine
+ */
+enum UiEvent {
+  UI_EVENT_MODE = 0,    ///< Mode button pressed
+  UI_EVENT_SELECT,      ///< Select button pressed
+  UI_EVENT_SELECT_LONG, ///< Select button held for BUTTON_LONG_PRESS
+  UI_EVENT_TIMEOUT,     ///< No activity for UI_TIMEOUT
+  UI_EVENT_COUNT
+};
+
+/**
+ * @brief Side effects run when a transition is taken
+ */
+enum UiAction {
+  UI_ACTION_NONE = 0,
+  UI_ACTION_RESET_SENSOR_PAGE,  ///< Show the first sensor page
+  UI_ACTION_NEXT_SENSOR_PAGE,   ///< Show the next sensor page
+  UI_ACTION_RESET_SETTINGS,     ///< Select the first settings item
+  UI_ACTION_NEXT_SETTING,       ///< Select the next settings item
+  UI_ACTION_INCREMENT_SETTING,  ///< Step the selected setting's value
+  UI_ACTION_STOPWATCH_TOGGLE,   ///< Start or stop the stopwatch
+  UI_ACTION_STOPWATCH_LAP,      ///< Record a lap, or reset when stopped
+  UI_ACTION_COUNTDOWN_TOGGLE,   ///< Start or pause the countdown
+  UI_ACTION_COUNTDOWN_RESET,    ///< Reset, or pick the next preset when reset
+  UI_ACTION_COUNT
+};
+
+/**
+ * @struct UiTransition
+ * @brief One row of the transition list
+ */
+struct UiTransition {
+  UIMode state;
+  UiEvent event;
+  UIMode next;
+  UiAction action;
+};
+
+static constexpr UiTransition UI_TRANSITIONS[] = {
+  // State             Event              Next               Action
+  { UI_MODE_CLOCK,     UI_EVENT_MODE,     UI_MODE_SENSORS,   UI_ACTION_RESET_SENSOR_PAGE },
+  { UI_MODE_CLOCK,     UI_EVENT_SELECT,   UI_MODE_CLOCK,     UI_ACTION_NONE },
+  { UI_MODE_CLOCK,     UI_EVENT_SELECT_LONG, UI_MODE_CLOCK,  UI_ACTION_NONE },
+  { UI_MODE_CLOCK,     UI_EVENT_TIMEOUT,  UI_MODE_CLOCK,     UI_ACTION_NONE },
+  
+  { UI_MODE_SENSORS,   UI_EVENT_MODE,     UI_MODE_NETWORK,   UI_ACTION_NONE },
+  { UI_MODE_SENSORS,   UI_EVENT_SELECT,   UI_MODE_SENSORS,   UI_ACTION_NEXT_SENSOR_PAGE },
+  { UI_MODE_SENSORS,   UI_EVENT_SELECT_LONG, UI_MODE_SENSORS, UI_ACTION_NONE },
+  { UI_MODE_SENSORS,   UI_EVENT_TIMEOUT,  UI_MODE_CLOCK,     UI_ACTION_NONE },
+  
+  // Select in network mode is left to NetworkManager
+  { UI_MODE_NETWORK,   UI_EVENT_MODE,     UI_MODE_SETTINGS,  UI_ACTION_RESET_SETTINGS },
+  { UI_MODE_NETWORK,   UI_EVENT_SELECT,   UI_MODE_NETWORK,   UI_ACTION_NONE },
+  { UI_MODE_NETWORK,   UI_EVENT_SELECT_LONG, UI_MODE_NETWORK, UI_ACTION_NONE },
+  { UI_MODE_NETWORK,   UI_EVENT_TIMEOUT,  UI_MODE_CLOCK,     UI_ACTION_NONE },
+  
+  { UI_MODE_SETTINGS,  UI_EVENT_MODE,     UI_MODE_STOPWATCH, UI_ACTION_NONE },
+  { UI_MODE_SETTINGS,  UI_EVENT_SELECT,   UI_MODE_SETTINGS,  UI_ACTION_NEXT_SETTING },
+  { UI_MODE_SETTINGS,  UI_EVENT_SELECT_LONG, UI_MODE_SETTINGS_EDIT, UI_ACTION_NONE },
+  { UI_MODE_SETTINGS,  UI_EVENT_TIMEOUT,  UI_MODE_CLOCK,     UI_ACTION_NONE },
+  
+  // Editing the selected setting: select steps it, mode or a long press is done
+  { UI_MODE_SETTINGS_EDIT, UI_EVENT_MODE,   UI_MODE_SETTINGS,      UI_ACTION_NONE },
+  { UI_MODE_SETTINGS_EDIT, UI_EVENT_SELECT, UI_MODE_SETTINGS_EDIT, UI_ACTION_INCREMENT_SETTING },
+  { UI_MODE_SETTINGS_EDIT, UI_EVENT_SELECT_LONG, UI_MODE_SETTINGS, UI_ACTION_NONE },
+  { UI_MODE_SETTINGS_EDIT, UI_EVENT_TIMEOUT, UI_MODE_CLOCK,        UI_ACTION_NONE },
+  
+  // Running timers stay on screen: no timeout
+  { UI_MODE_STOPWATCH, UI_EVENT_MODE,     UI_MODE_COUNTDOWN, UI_ACTION_NONE },
+  { UI_MODE_STOPWATCH, UI_EVENT_SELECT,   UI_MODE_STOPWATCH, UI_ACTION_STOPWATCH_TOGGLE },
+  { UI_MODE_STOPWATCH, UI_EVENT_SELECT_LONG, UI_MODE_STOPWATCH, UI_ACTION_STOPWATCH_LAP },
+  { UI_MODE_STOPWATCH, UI_EVENT_TIMEOUT,  UI_MODE_STOPWATCH, UI_ACTION_NONE },
+  
+  { UI_MODE_COUNTDOWN, UI_EVENT_MODE,     UI_MODE_CLOCK,     UI_ACTION_NONE },
+  { UI_MODE_COUNTDOWN, UI_EVENT_SELECT,   UI_MODE_COUNTDOWN, UI_ACTION_COUNTDOWN_TOGGLE },
+  { UI_MODE_COUNTDOWN, UI_EVENT_SELECT_LONG, UI_MODE_COUNTDOWN, UI_ACTION_COUNTDOWN_RESET },
+  { UI_MODE_COUNTDOWN, UI_EVENT_TIMEOUT,  UI_MODE_COUNTDOWN, UI_ACTION_NONE }
+};
+
+static constexpr size_t UI_TRANSITION_COUNT = sizeof(UI_TRANSITIONS) / sizeof(UI_TRANSITIONS[0]);
+
+/**
+ * @struct UiTableEntry
+ * @brief Packed result of one state x event lookup
+ */
+struct UiTableEntry {
+  uint8_t next;    ///< UIMode to switch to
+  uint8_t action;  ///< UiAction to run
+};
+
+/**
+ * @struct UiDispatchTable
+ * @brief State x event lookup table built from UI_TRANSITIONS
+ */
+struct UiDispatchTable {
+  UiTableEntry entries[UI_MODE_COUNT][UI_EVENT_COUNT];
+  
+  constexpr const UiTableEntry& lookup(UIMode state, UiEvent event) const {
+    return entries[state][event];
+  }
+  
+  /**
+   * @brief Check whether a long press does anything in a state
+   * 
+   * In such states a short select press acts on release, so that the
+   * start of a long press is not taken as a short one.
+   */
+  constexpr bool hasLongPress(UIMode state) const {
+    return entries[state][UI_EVENT_SELECT_LONG].next != state ||
+           entries[state][UI_EVENT_SELECT_LONG].action != UI_ACTION_NONE;
+  }
+};
+
+/**
+ * @brief Build the lookup table from the transition list
+ */
+constexpr UiDispatchTable buildUiDispatchTable() {
+  UiDispatchTable table = {};
+  for (size_t i = 0; i < UI_TRANSITION_COUNT; i++) {
+    const UiTransition& t = UI_TRANSITIONS[i];
+    table.entries[t.state][t.event].next = t.next;
+    table.entries[t.state][t.event].action = t.action;
+  }
+  return table;
+}
+
+static constexpr UiDispatchTable UI_DISPATCH = buildUiDispatchTable();
+
+// ===========================================
+// COMPILE-TIME CHECKS
+// ===========================================
+
+/**
+ * @brief Every state, event, target and action is within its enum
+ */
+constexpr bool uiTransitionsInRange() {
+  for (size_t i = 0; i < UI_TRANSITION_COUNT; i++) {
+    const UiTransition& t = UI_TRANSITIONS[i];
+    if (t.state >= UI_MODE_COUNT || t.event >= UI_EVENT_COUNT ||
+        t.next >= UI_MODE_COUNT || t.action >= UI_ACTION_COUNT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Every (state, event) pair has exactly one transition
+ */
+constexpr bool uiTransitionsComplete() {
+  for (int s = 0; s < UI_MODE_COUNT; s++) {
+    for (int e = 0; e < UI_EVENT_COUNT; e++) {
+      int found = 0;
+      for (size_t i = 0; i < UI_TRANSITION_COUNT; i++) {
+        if (UI_TRANSITIONS[i].state == s && UI_TRANSITIONS[i].event == e) {
+          found++;
+        }
+      }
+      if (found != 1) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Every state can be reached from the clock
+ */
+constexpr bool uiStatesReachable() {
+  bool reached[UI_MODE_COUNT] = {};
+  reached[UI_MODE_CLOCK] = true;
+  
+  // Relax until no new state is found; at most one pass per state
+  for (int pass = 0; pass < UI_MODE_COUNT; pass++) {
+    for (size_t i = 0; i < UI_TRANSITION_COUNT; i++) {
+      if (reached[UI_TRANSITIONS[i].state]) {
+        reached[UI_TRANSITIONS[i].next] = true;
+      }
+    }
+  }
+  
+  for (int s = 0; s < UI_MODE_COUNT; s++) {
+    if (!reached[s]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Inactivity brings the display back to the clock or leaves it as is
+ * 
+ * A timeout never moves to another menu and never runs an action.
+ */
+constexpr bool uiTimeoutsReturnToClock() {
+  for (int s = 0; s < UI_MODE_COUNT; s++) {
+    const UiTableEntry& entry = UI_DISPATCH.entries[s][UI_EVENT_TIMEOUT];
+    if ((entry.next != UI_MODE_CLOCK && entry.next != s) || entry.action != UI_ACTION_NONE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(uiTransitionsInRange(), "UI transition uses an out-of-range state, event or action");
+static_assert(uiTransitionsComplete(), "UI state is missing a transition or has a duplicate one");
+static_assert(uiStatesReachable(), "UI state cannot be reached from the clock");
+static_assert(uiTimeoutsReturnToClock(), "UI timeout must return to the clock or stay put");
+
+#endif // UI_STATE_TABLE_H
@@ -0,0 +1,259 @@
+/**
+ * @file WifiCheck.h
+ * @brief WiFi connection check against a scripted radio
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * Runs WifiConnection against ScriptedRadio, a WifiRadio whose access
+ * point associates after a set time, can vanish, drop the link or refuse
+ * a static lease. Times are scripted: first connection, reconnect on the
+ * cached lease, fallback to DHCP after the lease is refused, and the
+ * retry spacing while the access point is gone.
+ */
+
+#ifndef WIFI_CHECK_H
+#define WIFI_CHECK_H
+
+#include "config.h"
+#include "CheckReport.h"
+#include "WifiConnection.h"
+
+#define WIFI_CHECK_ASSOCIATION  3000    // Access point association time (ms)
+#define WIFI_CHECK_STEP         20      // Loop period (ms)
+#define WIFI_CHECK_MAX_BEGINS   32
+#define WIFI_CHECK_OUTAGE       600000UL  // Dead access point scenario (ms)
+
+/**
+ * @class ScriptedRadio
+ * @brief WiFi module stand-in with a scripted access point
+ */
+class ScriptedRadio : public WifiRadio {
+private:
+  bool associating;
+  uint64_t associatedAt;
+
+public:
+  uint64_t now;               ///< Scripted time (ms)
+  bool reachable;             ///< false: the access point never answers
+  bool leaseAccepted;         ///< false: associations on a static lease fail
+  bool staticMode;            ///< Set to a lease, not DHCP
+  bool staticAtBegin;         ///< staticMode at the last begin()
+  unsigned long begins;
+  unsigned long leases;       ///< useLease() calls
+  unsigned long dhcps;        ///< useDhcp() calls
+  unsigned long errors;       ///< begin() with other credentials
+  IPAddress staticIp;         ///< Address of the last useLease()
+  uint64_t beginTimes[WIFI_CHECK_MAX_BEGINS];
+  
+  ScriptedRadio() :
+    associating(false),
+    associatedAt(0),
+    now(0),
+    reachable(true),
+    leaseAccepted(true),
+    staticMode(false),
+    staticAtBegin(false),
+    begins(0),
+    leases(0),
+    dhcps(0),
+    errors(0) {}
+  
+  int begin(const char* ssid, const char* password) override {
+    if (begins < WIFI_CHECK_MAX_BEGINS) {
+      beginTimes[begins] = now;
+    }
+    begins++;
+    if (strcmp(ssid, WIFI_SSID) != 0 || strcmp(password, WIFI_PASSWORD) != 0) {
+      errors++;
+    }
+    staticAtBegin = staticMode;
+    associating = true;
+    associatedAt = now + WIFI_CHECK_ASSOCIATION;
+    return WL_IDLE_STATUS;
+  }
+  
+  int status() override {
+    if (!associating || !reachable || now < associatedAt) {
+      return WL_DISCONNECTED;
+    }
+    return staticMode && !leaseAccepted ? WL_CONNECT_FAILED : WL_CONNECTED;
+  }
+  
+  void disconnect() override {
+    associating = false;
+  }
+  
+  void useLease(const WifiLease& lease) override {
+    leases++;
+    staticIp = lease.ip;
+    staticMode = true;
+  }
+  
+  void useDhcp() override {
+    dhcps++;
+    staticMode = false;
+  }
+  
+  void readLease(WifiLease& lease) override {
+    lease.ip = IPAddress(192, 0, 2, 20);
+    lease.gateway = IPAddress(192, 0, 2, 1);
+    lease.subnet = IPAddress(255, 255, 255, 0);
+    lease.dns = IPAddress(192, 0, 2, 1);
+    const uint8_t bssid[6] = { 0x02, 0, 0, 0, 0, 0x01 };
+    memcpy(lease.bssid, bssid, sizeof(bssid));
+    lease.channel = 6;
+  }
+  
+  /**
+   * @brief The access point drops the station
+   */
+  void drop() {
+    associating = false;
+  }
+};
+
+/**
+ * @class WifiCheck
+ * @brief Runs the connection scenarios and prints the results
+ */
+class WifiCheck {
+private:
+  CheckReport results;
+
+public:
+  /**
+   * @brief Constructor
+   */
+  WifiCheck() : results("WIFI") {}
+  
+  /**
+   * @brief Run every scenario and print the results
+   * 
+   * @return Number of failed scenarios
+   */
+  int runAll() {
+    results.begin();
+    
+    checkConnect();
+    checkLeaseReuse();
+    checkDhcpFallback();
+    checkDeadAccessPoint();
+    
+    return results.end();
+  }
+
+private:
+  /**
+   * @brief Start the first attempt at the radio's time
+   */
+  static void start(WifiConnection& wifi, ScriptedRadio& radio) {
+    radio.now = Timebase::millis64();
+    wifi.begin();
+  }
+  
+  /**
+   * @brief Step the loop for a while, or until the link is up
+   */
+  static void run(WifiConnection& wifi, ScriptedRadio& radio, uint32_t duration, bool untilConnected) {
+    uint64_t end = radio.now + duration;
+    while (radio.now < end && !(untilConnected && wifi.isConnected())) {
+      radio.now += WIFI_CHECK_STEP;
+      wifi.update(radio.now);
+    }
+  }
+  
+  /**
+   * @brief Associating takes a few status polls, not a wait
+   */
+  void checkConnect() {
+    ScriptedRadio radio;
+    WifiConnection wifi(&radio, WIFI_SSID, WIFI_PASSWORD);
+    start(wifi, radio);
+    run(wifi, radio, 20000, true);
+    
+    const WifiMetrics& metrics = wifi.getMetrics();
+    bool ok = wifi.isConnected() && radio.begins == 1 && radio.leases == 0 && radio.dhcps == 0 &&
+              metrics.lastConnectMs >= WIFI_CHECK_ASSOCIATION &&
+              metrics.lastConnectMs <= WIFI_CHECK_ASSOCIATION + WIFI_STATUS_INTERVAL + 2 * WIFI_CHECK_STEP;
+    report("wifi.connect", radio, wifi, ok);
+  }
+  
+  /**
+   * @brief After a drop, the station comes back on the cached lease
+   */
+  void checkLeaseReuse() {
+    ScriptedRadio radio;
+    WifiConnection wifi(&radio, WIFI_SSID, WIFI_PASSWORD);
+    start(wifi, radio);
+    run(wifi, radio, 20000, true);
+    
+    radio.drop();
+    run(wifi, radio, WIFI_STATUS_INTERVAL + WIFI_CHECK_STEP, false);
+    run(wifi, radio, 20000, true);
+    
+    const WifiMetrics& metrics = wifi.getMetrics();
+    bool ok = wifi.isConnected() && radio.begins == 2 && radio.leases == 1 && radio.staticAtBegin &&
+              radio.staticIp == IPAddress(192, 0, 2, 20) &&
+              metrics.linkLosses == 1 && metrics.fastReconnects == 1 && metrics.sameApReconnects == 1;
+    report("wifi.leaseReuse", radio, wifi, ok);
+  }
+  
+  /**
+   * @brief A refused lease is dropped and the next attempt asks DHCP
+   */
+  void checkDhcpFallback() {
+    ScriptedRadio radio;
+    WifiConnection wifi(&radio, WIFI_SSID, WIFI_PASSWORD);
+    start(wifi, radio);
+    run(wifi, radio, 20000, true);
+    
+    radio.leaseAccepted = false;
+    radio.drop();
+    run(wifi, radio, WIFI_STATUS_INTERVAL + WIFI_CHECK_STEP, false);
+    run(wifi, radio, WIFI_TIMEOUT + WIFI_BACKOFF_MIN + 20000, true);
+    
+    const WifiMetrics& metrics = wifi.getMetrics();
+    bool ok = wifi.isConnected() && radio.begins == 3 && radio.leases == 1 && radio.dhcps == 1 &&
+              !radio.staticMode && !radio.staticAtBegin &&
+              metrics.failedAttempts == 1 && metrics.fastReconnects == 0 && metrics.connects == 2;
+    report("wifi.dhcpFallback", radio, wifi, ok);
+  }
+  
+  /**
+   * @brief With the access point gone, attempts are spread by the backoff
+   */
+  void checkDeadAccessPoint() {
+    ScriptedRadio radio;
+    radio.reachable = false;
+    WifiConnection wifi(&radio, WIFI_SSID, WIFI_PASSWORD);
+    start(wifi, radio);
+    run(wifi, radio, WIFI_CHECK_OUTAGE, false);
+    
+    // Each gap is the attempt timeout plus half to all of the backoff
+    bool ok = !wifi.isConnected() && radio.begins > 1 && radio.begins <= WIFI_CHECK_MAX_BEGINS;
+    for (unsigned long i = 1; ok && i < radio.begins; i++) {
+      uint32_t full = WIFI_BACKOFF_MAX;
+      if (i - 1 < 16 && ((uint32_t)WIFI_BACKOFF_MIN << (i - 1)) < WIFI_BACKOFF_MAX) {
+        full = (uint32_t)WIFI_BACKOFF_MIN << (i - 1);
+      }
+      uint64_t gap = radio.beginTimes[i] - radio.beginTimes[i - 1];
+      ok = gap >= WIFI_TIMEOUT + full / 2 &&
+           gap <= WIFI_TIMEOUT + full + WIFI_STATUS_INTERVAL + 2 * WIFI_CHECK_STEP;
+    }
+    report("wifi.deadAccessPoint", radio, wifi, ok);
+  }
+  
+  void report(const char* name, const ScriptedRadio& radio, const WifiConnection& wifi, bool ok) {
+    results.start(name);
+    results.field("begins", radio.begins);
+    results.field("leases", radio.leases);
+    results.field("dhcp", radio.dhcps);
+    results.field("errors", radio.errors);
+    results.field("connect_ms", wifi.getMetrics().lastConnectMs);
+    results.field("max_begin_ms", wifi.getMetrics().maxBeginMs);
+    results.finish(ok && radio.errors == 0);
+  }
+};
+
+#endif // WIFI_CHECK_H
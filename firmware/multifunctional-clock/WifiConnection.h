@@ -0,0 +1,404 @@
+/**
+ * @file WifiConnection.h
+ * @brief WiFi connection state machine
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ * 
+ * The link is brought up and watched from update(), called every loop
+ * iteration, which never waits for the access point: an attempt is
+ * started with WifiRadio::begin(), which only hands the credentials to
+ * the WiFi module, and then polled with status() until it succeeds or
+ * WIFI_TIMEOUT runs out. Failed attempts and lost links are retried after
+ * a jittered exponential backoff, so a dead access point costs one begin()
+ * per attempt and one status poll every WIFI_STATUS_INTERVAL, each a
+ * single exchange with the module. The time spent inside begin() is kept
+ * in the metrics (lastBeginMs, maxBeginMs).
+ * 
+ * After each successful connection the BSSID, channel and DHCP lease are
+ * cached. The next reconnect within WIFI_LEASE_REUSE reuses the lease as
+ * a static configuration, which skips the DHCP exchange; if that attempt
+ * fails the cache is dropped and the following one switches the module
+ * back to DHCP before associating. The WiFiS3
+ * API cannot pin an association to a BSSID or channel, so those are kept
+ * to report whether a reconnect landed on the same access point.
+ */
+
+#ifndef WIFI_CONNECTION_H
+#define WIFI_CONNECTION_H
+
+#include "config.h"
+#include "Timebase.h"
+#include "Backoff.h"
+#include <WiFi.h>
+
+/**
+ * @struct WifiLease
+ * @brief Addresses and access point of the last connection
+ */
+struct WifiLease {
+  IPAddress ip;
+  IPAddress gateway;
+  IPAddress subnet;
+  IPAddress dns;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint64_t obtainedAt;  ///< Timebase::millis64() when cached
+  bool valid;
+};
+
+/**
+ * @class WifiRadio
+ * @brief Interface for the WiFi module
+ */
+class WifiRadio {
+public:
+  virtual ~WifiRadio() {}
+  
+  /**
+   * @brief Start associating without waiting for the access point
+   * 
+   * @return Status right after the request, WL_CONNECTED if already up
+   */
+  virtual int begin(const char* ssid, const char* password) = 0;
+  
+  /**
+   * @brief Current link status (WL_CONNECTED, WL_CONNECT_FAILED...)
+   */
+  virtual int status() = 0;
+  
+  virtual void disconnect() = 0;
+  
+  /**
+   * @brief Use the addresses of a lease instead of asking DHCP
+   */
+  virtual void useLease(const WifiLease& lease) = 0;
+  
+  /**
+   * @brief Ask DHCP for the addresses again on the next association
+   */
+  virtual void useDhcp() = 0;
+  
+  /**
+   * @brief Read the addresses, BSSID and channel of the current link
+   */
+  virtual void readLease(WifiLease& lease) = 0;
+};
+
+/**
+ * @class WifiS3Radio
+ * @brief The UNO R4 WiFi module through WiFiS3
+ * 
+ * WiFiS3's WiFi.begin() waits for the association for up to its timeout
+ * (10 s by default); the timeout is set to WIFI_BEGIN_WAIT so that it
+ * only sends the request and returns.
+ */
+class WifiS3Radio : public WifiRadio {
+public:
+  int begin(const char* ssid, const char* password) override {
+    WiFi.setTimeout(WIFI_BEGIN_WAIT);
+    return WiFi.begin(ssid, password);
+  }
+  
+  int status() override {
+    return WiFi.status();
+  }
+  
+  void disconnect() override {
+    WiFi.disconnect();
+  }
+  
+  void useLease(const WifiLease& lease) override {
+    WiFi.config(lease.ip, lease.dns, lease.gateway, lease.subnet);
+  }
+  
+  void useDhcp() override {
+    IPAddress none(0, 0, 0, 0);
+    WiFi.config(none, none, none, none);
+  }
+  
+  void readLease(WifiLease& lease) override {
+    lease.ip = WiFi.localIP();
+    lease.gateway = WiFi.gatewayIP();
+    lease.subnet = WiFi.subnetMask();
+    lease.dns = WiFi.dnsIP(0);
+    WiFi.BSSID(lease.bssid);
+    lease.channel = WiFi.channel();
+  }
+};
+
+/**
+ * @brief Connection states
+ */
+enum WifiState {
+  WIFI_STATE_IDLE = 0,    ///< begin() not called yet
+  WIFI_STATE_CONNECTING,  ///< Attempt in progress
+  WIFI_STATE_CONNECTED,   ///< Link up
+  WIFI_STATE_BACKOFF      ///< Waiting before the next attempt
+};
+
+/**
+ * @struct WifiMetrics
+ * @brief Connection statistics since boot
+ */
+struct WifiMetrics {
+  unsigned long connects;         ///< Successful connections
+  unsigned long failedAttempts;   ///< Attempts that timed out or failed
+  unsigned long linkLosses;       ///< Drops detected while connected
+  unsigned long fastReconnects;   ///< Connections that reused the lease
+  unsigned long sameApReconnects; ///< Connections to the previous BSSID
+  uint32_t lastConnectMs;         ///< Duration of the last successful attempt
+  uint32_t lastOutageMs;          ///< Duration of the last outage
+  uint32_t lastBeginMs;           ///< Time the last begin() held the loop
+  uint32_t maxBeginMs;            ///< Longest begin() since boot
+  uint64_t totalOutageMs;         ///< Time without link after drops and failed attempts
+};
+
+/**
+ * @class WifiConnection
+ * @brief Keeps the station connected without blocking the main loop
+ */
+class WifiConnection {
+private:
+  WifiRadio* radio;
+  const char* ssid;
+  const char* password;
+  
+  WifiState state;
+  uint64_t attemptStart;     ///< Start of the current attempt
+  uint64_t nextAttempt;      ///< End of the current backoff
+  uint64_t lastStatusPoll;
+  uint64_t outageStart;      ///< Time the link went down
+  bool inOutage;             ///< Link dropped or an attempt failed
+  uint8_t failures;          ///< Consecutive failed attempts
+  bool usingLease;           ///< Current attempt reuses the cached lease
+  bool staticAddress;        ///< Module set to the lease, not DHCP
+  bool reconnected;          ///< Link came back, not yet taken
+  JitteredBackoff backoff;
+  
+  WifiLease lease;
+  WifiMetrics metrics;
+
+public:
+  /**
+   * @brief Constructor
+   * 
+   * @param wifiRadio WiFi module
+   * @param networkSsid Network name
+   * @param networkPassword Network passphrase
+   */
+  WifiConnection(WifiRadio* wifiRadio, const char* networkSsid, const char* networkPassword) :
+    radio(wifiRadio),
+    ssid(networkSsid),
+    password(networkPassword),
+    state(WIFI_STATE_IDLE),
+    attemptStart(0),
+    nextAttempt(0),
+    lastStatusPoll(0),
+    outageStart(0),
+    inOutage(false),
+    failures(0),
+    usingLease(false),
+    staticAddress(false),
+    reconnected(false),
+    backoff(WIFI_BACKOFF_MIN, WIFI_BACKOFF_MAX, 1) {
+    lease.valid = false;
+    lease.channel = 0;
+    lease.obtainedAt = 0;
+    memset(lease.bssid, 0, sizeof(lease.bssid));
+    memset(&metrics, 0, sizeof(metrics));
+  }
+  
+  /**
+   * @brief Start the first connection attempt
+   */
+  void begin() {
+    backoff.seed(micros());
+    startAttempt(Timebase::millis64());
+  }
+  
+  /**
+   * @brief Advance the state machine
+   * 
+   * Should be called every loop iteration. Polls the link status at most
+   * once per WIFI_STATUS_INTERVAL.
+   */
+  void update() {
+    update(Timebase::millis64());
+  }
+  
+  /**
+   * @brief Advance the state machine to a given time
+   * 
+   * @param now Timebase::millis64() or a scripted time (ms)
+   */
+  void update(uint64_t now) {
+    switch (state) {
+      case WIFI_STATE_CONNECTING:
+        if (now - lastStatusPoll < WIFI_STATUS_INTERVAL) {
+          break;
+        }
+        lastStatusPoll = now;
+        pollAttempt(now);
+        break;
+      
+      case WIFI_STATE_CONNECTED:
+        if (now - lastStatusPoll < WIFI_STATUS_INTERVAL) {
+          break;
+        }
+        lastStatusPoll = now;
+        if (radio->status() != WL_CONNECTED) {
+          DEBUG_PRINTLN("WiFi link lost");
+          metrics.linkLosses++;
+          outageStart = now;
+          inOutage = true;
+          // First retry at once, then back off
+          failures = 0;
+          startAttempt(now);
+        }
+        break;
+      
+      case WIFI_STATE_BACKOFF:
+        if (now >= nextAttempt) {
+          startAttempt(now);
+        }
+        break;
+      
+      default:
+        break;
+    }
+  }
+  
+  /**
+   * @brief Check whether the link is up
+   */
+  bool isConnected() const {
+    return state == WIFI_STATE_CONNECTED;
+  }
+  
+  /**
+   * @brief Check and clear the "link came back after an outage" flag
+   */
+  bool takeReconnected() {
+    bool wasReconnected = reconnected;
+    reconnected = false;
+    return wasReconnected;
+  }
+  
+  WifiState getState() const { return state; }
+  
+  /**
+   * @brief Check whether at least one attempt has failed since the last
+   * connection
+   */
+  bool hasFailed() const {
+    return failures > 0;
+  }
+  
+  const WifiLease& getLease() const { return lease; }
+  const WifiMetrics& getMetrics() const { return metrics; }
+
+private:
+  void startAttempt(uint64_t now) {
+    usingLease = lease.valid && now - lease.obtainedAt < WIFI_LEASE_REUSE;
+    if (usingLease) {
+      radio->useLease(lease);
+      staticAddress = true;
+    } else if (staticAddress) {
+      // Still set to a lease that did not work: back to DHCP
+      radio->useDhcp();
+      staticAddress = false;
+    }
+    
+    DEBUG_PRINT(usingLease ? "WiFi reconnecting with cached lease to " : "WiFi connecting to ");
+    DEBUG_PRINTLN(ssid);
+    uint64_t called = Timebase::millis64();
+    int status = radio->begin(ssid, password);
+    metrics.lastBeginMs = Timebase::millis64() - called;
+    if (metrics.lastBeginMs > metrics.maxBeginMs) {
+      metrics.maxBeginMs = metrics.lastBeginMs;
+    }
+    
+    state = WIFI_STATE_CONNECTING;
+    attemptStart = now;
+    lastStatusPoll = now;
+    if (status == WL_CONNECTED) {
+      onConnected(now);
+    }
+  }
+  
+  void pollAttempt(uint64_t now) {
+    int status = radio->status();
+    
+    if (status == WL_CONNECTED) {
+      onConnected(now);
+      return;
+    }
+    
+    bool failed = status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL;
+    if (!failed && now - attemptStart < WIFI_TIMEOUT) {
+      return;
+    }
+    
+    metrics.failedAttempts++;
+    if (usingLease) {
+      // The lease may have been given away: next time, ask DHCP
+      lease.valid = false;
+    }
+    radio->disconnect();
+    
+    uint32_t retryDelay = backoff.delay(failures);
+    if (failures < 255) failures++;
+    nextAttempt = now + retryDelay;
+    state = WIFI_STATE_BACKOFF;
+    if (!inOutage) {
+      outageStart = attemptStart;
+      inOutage = true;
+    }
+    
+    DEBUG_PRINT("WiFi attempt failed, retry in ");
+    DEBUG_PRINT(retryDelay);
+    DEBUG_PRINTLN(" ms");
+  }
+  
+  void onConnected(uint64_t now) {
+    state = WIFI_STATE_CONNECTED;
+    metrics.connects++;
+    metrics.lastConnectMs = now - attemptStart;
+    if (usingLease) {
+      metrics.fastReconnects++;
+    }
+    
+    if (inOutage) {
+      metrics.lastOutageMs = now - outageStart;
+      metrics.totalOutageMs += metrics.lastOutageMs;
+      inOutage = false;
+      reconnected = true;
+    }
+    failures = 0;
+    
+    WifiLease current;
+    memset(current.bssid, 0, sizeof(current.bssid));
+    radio->readLease(current);
+    bool sameAccessPoint = lease.valid && memcmp(current.bssid, lease.bssid, sizeof(lease.bssid)) == 0;
+    if (sameAccessPoint) {
+      metrics.sameApReconnects++;
+    }
+    cacheLease(now, current);
+    
+    DEBUG_PRINT("WiFi connected in ");
+    DEBUG_PRINT(metrics.lastConnectMs);
+    DEBUG_PRINT(" ms, channel ");
+    DEBUG_PRINT(lease.channel);
+    DEBUG_PRINTLN(sameAccessPoint ? " (same AP)" : "");
+  }
+  
+  void cacheLease(uint64_t now, const WifiLease& current) {
+    uint64_t obtainedAt = usingLease ? lease.obtainedAt : now;
+    lease = current;
+    lease.obtainedAt = obtainedAt;
+    lease.valid = lease.ip != IPAddress(0, 0, 0, 0);
+  }
+};
+
+#endif // WIFI_CONNECTION_H
@@ -39,11 +39,70 @@
 #define NETWORK_SYNC_INTERVAL   86400000UL // 24 heures
 #define BUTTON_DEBOUNCE_DELAY   50       // 50ms
 #define ANIMATION_SPEED         100      // ms entre frames
+#define HOUR_ANIMATION_DURATION 5000UL   // Durée animation changement d'heure
+#define LED_FRAME_INTERVAL      20       // Animations LED : 50 images/s
+#define LOOP_DELAY              10       // Pause en fin de loop() (ms)
+#define TICK_REPORT_INTERVAL    60       // Rapport de phase des secondes (en secondes)
+#ifndef TIMEBASE_START_US
+// Origine de l'horloge 64 bits (us). Pour tester le débordement de millis()
+// 10 s après le démarrage : -DTIMEBASE_START_US=4294957296000ULL
+#define TIMEBASE_START_US       0ULL
+#endif
+
+#ifndef TIMEBASE_LOCAL
+// Simulateur de flotte (hôte) : une horloge par thread
+// -DTIMEBASE_LOCAL=thread_local
+#define TIMEBASE_LOCAL
+#endif
+
+// Synchronisation NTP : serveurs interrogés en parallèle, meilleurs
+// échantillons retenus (filtre de délai minimal puis intersection)
+#define NTP_SERVERS          { "0.pool.ntp.org", "1.pool.ntp.org", \
+                               "2.pool.ntp.org", "3.pool.ntp.org" }
+#define NTP_SERVER_COUNT     4
+#define NTP_DELAY_FACTOR     2           // Délai gardé : 2 x minimum...
+#define NTP_DELAY_SLACK_US   10000       // ... + 10 ms
+#define NTP_PRECISION_US     1000        // Incertitude d'horodatage local (us)
 
-// Synchronisation NTP
-#define NTP_SERVER           "pool.ntp.org"
+// Serveur SNTP pour le réseau local (une fois l'heure synchronisée)
+#define SNTP_MAX_PER_POLL    2           // Requêtes servies par passage de loop()
+#define SNTP_MAX_SYNC_AGE    172800000UL // Plus de réponse 48 h après la dernière synchro
+#define SNTP_DRIFT_PPM       50          // Dérive du quartz (dispersion annoncée)
 #define TIMEZONE_OFFSET      1           // UTC+1 (France)
 #define DST_OFFSET           1           // Heure d'été
+#define NTP_LOCAL_PORT       2390        // Port UDP local
+#define NTP_TIMEOUT          5000        // Attente réponse (ms)
+
+// Cache DNS (serveur NTP, hôtes d'envoi)
+#define DNS_CACHE_SIZE       6           // Noms d'hôtes conservés
+#define DNS_HOST_MAX         48          // Longueur max d'un nom (avec '\0')
+#define DNS_PACKET_MAX       512         // Taille max d'une réponse UDP
+#define DNS_LOCAL_PORT       2391        // Port UDP local
+#define DNS_QUERY_TIMEOUT    2000        // Attente réponse (ms)
+#define DNS_RETRY_INTERVAL   30000UL     // Pause après un échec (ms)
+#define DNS_MIN_TTL          60UL        // TTL plancher (s)
+#define DNS_MAX_TTL          86400UL     // TTL plafond (s)
+#define DNS_STALE_LIMIT      86400000UL  // Adresse expirée servie au plus 24 h
+
+// Horloge temps réel (RTC du RA4M1)
+#define RTC_MIN_VALID_EPOCH  1735689600UL // 2025-01-01 : avant, RTC non réglée
+#define RTC_HOLDOVER_INTERVAL 60000UL    // Relecture RTC sans NTP (ms)
+
+// Alarmes et minuteries
+#define ALARM_COUNT          2           // Nombre d'alarmes configurables
+#define ALARM_TIMER_COUNT    4           // Minuteries simultanées
+#define ALARM_DEFAULT_HOUR   7           // 07h00 par défaut
+#define ALARM_DEFAULT_MINUTE 0
+#define ALARM_SNOOZE_DURATION 300        // Répétition après 5 minutes
+#define ALARM_RING_DURATION  60          // Arrêt auto après 60 s
+#define TIMER_WHEEL_CAPACITY (2 * ALARM_COUNT + 1 + ALARM_TIMER_COUNT) // Alarmes, aubes, répétition, minuteries
+
+// Simulateur d'aube (réveil lumineux)
+#define SUNRISE_DEFAULT_MINUTES 0        // Désactivé par défaut (10 à 30 min)
+#define COLOR_SUNRISE_END    0xFFB46B    // Blanc chaud en fin de rampe
+
+// Chronomètre et compte à rebours
+#define STOPWATCH_MAX_LAPS   3           // Tours affichés (lignes LCD restantes)
 
 // ===========================================
 // CONFIGURATION WIFI
@@ -52,11 +111,77 @@
 #define WIFI_SSID            "VotreSSID"
 #define WIFI_PASSWORD        "VotreMotDePasse"
 #define WIFI_TIMEOUT         10000       // 10 secondes
+#define WIFI_STATUS_INTERVAL 500         // Lecture de WiFi.status() (ms)
+#define WIFI_BEGIN_WAIT      0           // Attente dans WiFi.begin() (ms) : aucune, l'état est relu ensuite
+#define WIFI_BACKOFF_MIN     1000        // Premier délai avant nouvel essai (ms)
+#define WIFI_BACKOFF_MAX     60000UL     // Délai maximal entre essais (ms)
+#define WIFI_LEASE_REUSE     3600000UL   // Réutilisation du bail DHCP (1 heure)
 
 // API Web
 #define WEB_SERVER_PORT      80
 #define API_ENDPOINT         "/api/data"
 #define WEB_UPDATE_INTERVAL  300000UL    // 5 minutes
+#define JSON_BUFFER_SIZE     256         // Taille max payload JSON
+#define API_SETTINGS_ENDPOINT "/api/settings"
+
+// Limites requêtes HTTP (aucune allocation dynamique)
+#define HTTP_MAX_TOKEN       24          // Méthode, version, nom d'en-tête
+#define HTTP_MAX_PATH        32
+#define HTTP_MAX_QUERY       112
+#define HTTP_MAX_BODY        128
+#define HTTP_MAX_ETAGS       48          // En-tête If-None-Match conservé
+#define HTTP_MAX_HEADER_BYTES 1024       // Ligne de requête + en-têtes
+#define HTTP_READ_CHUNK      64          // Octets lus par appel
+#define HTTP_CLIENT_TIMEOUT  2000        // Abandon requête incomplète (ms)
+
+// Évènements poussés aux navigateurs (Server-Sent Events)
+#define API_EVENTS_ENDPOINT  "/api/events"
+#define SSE_MAX_CLIENTS      4           // Navigateurs abonnés simultanés
+#define SSE_BUFFER_SIZE      1024        // Tampon partagé par tous les abonnés
+#define SSE_WRITE_CHUNK      256         // Octets envoyés par abonné et par appel
+#define SSE_KEEPALIVE_INTERVAL 15000     // Commentaire de maintien si inactif (ms)
+#define SSE_RETRY_DELAY      5000        // Délai de reconnexion du navigateur (ms)
+
+// Historique des capteurs en RAM, interrogé par /api/history
+#define API_HISTORY_ENDPOINT "/api/history"
+#define HISTORY_INTERVAL     180         // Moyenne par créneau (s)
+#define HISTORY_SIZE         480         // Créneaux conservés (24 h, 7,5 Ko)
+#define HISTORY_DEFAULT_POINTS 100       // Points renvoyés sans ?points=
+#define HISTORY_MAX_POINTS   500
+#define HISTORY_MAX_STEP_BACK 3600       // Recul de l'heure au-delà duquel l'historique repart (s)
+#define HTTP_WRITE_BUFFER    256         // Regroupement des écritures en flux
+
+// Télémétrie MQTT 3.1.1 (QoS 1, lots d'échantillons capteurs)
+#define MQTT_BROKER          "192.168.1.2" // Nom ou adresse IP du broker
+#define MQTT_BROKER_PORT     1883
+#define MQTT_CLIENT_ID       "horloge-multifonction"
+#define MQTT_USER            ""          // Vide : sans authentification
+#define MQTT_PASSWORD        ""
+#define MQTT_TOPIC           "horloge/capteurs"
+#define MQTT_KEEPALIVE       60          // Keep alive annoncé au broker (s)
+#define MQTT_BATCH_SIZE      4           // Échantillons par message
+#define MQTT_BATCH_MAX_AGE   300000UL    // Lot incomplet envoyé après 5 min
+#define MQTT_QUEUE_SIZE      12          // Messages en file (24 min à 30 s)
+#define MQTT_MAX_INFLIGHT    4           // Messages publiés en attente de PUBACK
+#define MQTT_PACKET_MAX      1024        // Taille max d'un PUBLISH
+#define MQTT_WRITE_CHUNK     256         // Octets écrits par passage de loop()
+#define MQTT_READ_CHUNK      32          // Octets lus par appel
+#define MQTT_CONNECT_TIMEOUT 5000        // Attente CONNACK (ms)
+#define MQTT_ACK_TIMEOUT     10000       // Attente PUBACK/PINGRESP (ms)
+#define MQTT_BACKOFF_MIN     2000        // Premier délai avant reconnexion (ms)
+#define MQTT_BACKOFF_MAX     120000UL    // Délai maximal entre essais (ms)
+#define MQTT_REPORT_INTERVAL 600000UL    // Ligne MQTT-STATS (10 min)
+
+// Format de la télémétrie envoyée : JSON (lisible) ou CBOR (compact,
+// valeurs en virgule fixe, décodé par web-interface/telemetry.js)
+#define TELEMETRY_JSON       0
+#define TELEMETRY_CBOR       1
+#define TELEMETRY_FORMAT     TELEMETRY_CBOR
+#define TELEMETRY_LZSS       false       // Compression LZSS des lots (utile en JSON)
+
+// Écriture des réglages
+#define SETTINGS_MAX_KEY     16
+#define SETTINGS_MAX_VALUE   8
 
 // ===========================================
 // CONFIGURATION COULEURS LED
@@ -76,6 +201,13 @@
 #define COLOR_AIR_UNHEALTHY  0xFF0000    // Rouge
 #define COLOR_AIR_DANGEROUS  0x800080    // Violet
 
+// Couleur alarme (couche clignotante)
+#define COLOR_ALARM          0xFF8000    // Orange
+
+// Couleurs chronomètre (anneau de progression)
+#define COLOR_STOPWATCH      0x00FFFF    // Cyan
+#define COLOR_COUNTDOWN      0xFF00FF    // Magenta
+
 // Mode nuit
 #define NIGHT_MODE_START     22          // 22h00
 #define NIGHT_MODE_END       7           // 07h00
@@ -102,6 +234,13 @@
 #define TEMP_MAX             80.0
 #define HUMIDITY_MIN         0.0
 #define HUMIDITY_MAX         100.0
+#define PRESSURE_MIN         300.0       // Limites BMP180 (hPa)
+#define PRESSURE_MAX         1100.0
+#define AIR_QUALITY_MIN      0           // Plage MQ135 (PPM)
+#define AIR_QUALITY_MAX      1000
+
+// Simulation capteurs
+#define SENSOR_SIM_SEED      12345UL     // Graine reproductible
 
 // ===========================================
 // CONFIGURATION INTERFACE
@@ -113,6 +252,9 @@ enum UIMode {
   UI_MODE_SENSORS,
   UI_MODE_NETWORK, 
   UI_MODE_SETTINGS,
+  UI_MODE_SETTINGS_EDIT,
+  UI_MODE_STOPWATCH,
+  UI_MODE_COUNTDOWN,
   UI_MODE_COUNT
 };
 
@@ -128,6 +270,8 @@ enum SensorPage {
 // Timeouts interface
 #define UI_TIMEOUT           30000       // Retour auto au mode horloge
 #define MENU_BLINK_INTERVAL  500         // Clignotement sélection
+#define BUTTON_RECORD_CAPACITY 32        // Fronts mémorisés par l'enregistreur
+#define BUTTON_LONG_PRESS    1000        // Appui long (édition réglage)
 
 // ===========================================
 // DEBUG CONFIGURATION
@@ -138,13 +282,23 @@ enum SensorPage {
 #define DEBUG_NETWORK        true        ///< Enable network debug messages
 #define DEBUG_LEDS           false       ///< Enable LED debug messages
 
+// ===========================================
+// BENCHMARK CONFIGURATION
+// ===========================================
+
+#ifndef BENCHMARK_MODE
+#define BENCHMARK_MODE       false       ///< Run micro-benchmarks at boot
+#endif
+#define BENCHMARK_ITERATIONS 1000        ///< Calls per benchmark
+
 /**
  * @brief Debug print macros
  * 
  * These macros can be enabled/disabled at compile time to control
  * debug output without affecting performance in production.
+ * Debug output is muted in benchmark builds so it does not skew timings.
  */
-#if DEBUG_MODE
+#if DEBUG_MODE && !BENCHMARK_MODE
   #define DEBUG_PRINT(x)     Serial.print(x)     ///< Debug print macro
   #define DEBUG_PRINTLN(x)   Serial.println(x)   ///< Debug println macro
 #else
@@ -152,4 +306,12 @@ enum SensorPage {
   #define DEBUG_PRINTLN(x)    ///< Disabled debug println
 #endif
 
+/**
+ * @brief Periodic statistics lines (TICK, MQTT-STATS)
+ * 
+ * Kept in benchmark builds, where they are measurements, and in debug
+ * builds; a production build prints none every minute.
+ */
+#define STATS_REPORTS        (DEBUG_MODE || BENCHMARK_MODE)
+
 #endif // CONFIG_H
\ No newline at end of file
@@ -0,0 +1,429 @@
+/**
+ * @file SimNetwork.h
+ * @brief Simulated LAN seen by one virtual clock
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * What a clock on a home network talks to: an access point that takes a
+ * few seconds to associate, the router's DNS resolver, the NTP servers
+ * on true world time and the MQTT broker. Every reply comes back one
+ * round trip later in world time, which runs at the board's clock rate
+ * corrected by its drift, so NTP sees real offsets and delays.
+ *
+ * One SimNetwork per clock and no shared state: clocks can run on any
+ * thread. Only the counters are read by the fleet at the end.
+ */
+
+#ifndef SIM_NETWORK_H
+#define SIM_NETWORK_H
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+#include "config.h"
+#include "NtpPacket.h"
+#include "DnsMessage.h"
+#include "MqttPacket.h"
+
+#define SIM_WORLD_EPOCH         1767225600ULL  // 2026-01-01 00:00:00 UTC
+#define SIM_DNS_TTL             300            // TTL of the resolver's answers (s)
+#define SIM_MQTT_HANDLE         1
+
+/**
+ * @struct SimCounters
+ * @brief Traffic seen by the servers of one clock
+ */
+struct SimCounters {
+  unsigned long associations;
+  unsigned long dnsQueries;
+  unsigned long ntpRequests;
+  unsigned long mqttConnects;
+  unsigned long publishes;
+  unsigned long publishBytes;   ///< PUBLISH payload bytes received
+  unsigned long errors;         ///< Malformed packets
+};
+
+/**
+ * @class SimNetwork
+ * @brief Access point, resolver, NTP servers and broker of one clock
+ */
+class SimNetwork : public HostNetwork {
+private:
+  struct Datagram {
+    uint64_t due;               ///< World time of arrival (us)
+    uint16_t localPort;
+    IPAddress from;
+    uint16_t fromPort;
+    std::vector<uint8_t> data;
+  };
+
+  struct Segment {
+    uint64_t due;
+    std::vector<uint8_t> data;
+  };
+
+  HostBoard& board;
+  uint64_t bootAt;              ///< World time of power-up (us)
+  double rate;                  ///< Board microseconds per world microsecond
+  uint32_t oneWay;              ///< Network latency (us)
+  uint32_t associationDelay;    ///< Access point association time (us)
+
+  bool associating;
+  uint64_t associatedAt;
+
+  std::deque<Datagram> datagrams;
+
+  bool brokerOpen;
+  std::vector<uint8_t> brokerRx;
+  std::deque<Segment> brokerTx;
+  size_t brokerTxPos;
+
+public:
+  SimCounters counters;
+
+  /**
+   * @brief Constructor
+   *
+   * @param host Board this network belongs to
+   * @param powerUp World time at which the board is powered up (us)
+   * @param driftPpm Board oscillator error, positive when it runs fast
+   * @param latencyUs One-way latency to every server (us)
+   * @param associationUs Time to join the access point (us)
+   */
+  SimNetwork(HostBoard& host, uint64_t powerUp, double driftPpm, uint32_t latencyUs,
+             uint32_t associationUs) :
+    board(host),
+    bootAt(powerUp),
+    rate(1.0 + driftPpm * 1e-6),
+    oneWay(latencyUs),
+    associationDelay(associationUs),
+    associating(false),
+    associatedAt(0),
+    brokerOpen(false),
+    brokerTxPos(0),
+    counters() {}
+
+  /**
+   * @brief World time now (us since the simulation started)
+   */
+  uint64_t worldNow() const {
+    return bootAt + (uint64_t)(board.micros / rate);
+  }
+
+  /**
+   * @brief World time at a board time (us)
+   */
+  uint64_t worldAt(uint64_t boardMicros) const {
+    return bootAt + (uint64_t)(boardMicros / rate);
+  }
+
+  /**
+   * @brief Board time at which the world reaches a time (us)
+   */
+  uint64_t boardAt(uint64_t world) const {
+    return world <= bootAt ? 0 : (uint64_t)((world - bootAt) * rate);
+  }
+
+  /**
+   * @brief UTC of a world time (us since 1970)
+   */
+  static int64_t utcMicros(uint64_t world) {
+    return (int64_t)(SIM_WORLD_EPOCH * 1000000ULL + world);
+  }
+
+  // Access point
+
+  void wifiBegin(const char* ssid) override {
+    if (!associating) {
+      associating = true;
+      associatedAt = worldNow() + associationDelay;
+      counters.associations++;
+    }
+  }
+
+  void wifiDisconnect() override {
+    associating = false;
+    closeBroker();
+  }
+
+  bool wifiConnected() override {
+    return associating && worldNow() >= associatedAt;
+  }
+
+  // Resolver
+
+  /**
+   * @brief Address of a name on the simulated network
+   */
+  static bool lookup(const char* host, IPAddress& address) {
+    static const char* const names[] = NTP_SERVERS;
+    for (uint8_t i = 0; i < NTP_SERVER_COUNT; i++) {
+      if (!strcmp(host, names[i])) {
+        address = ntpServer(i);
+        return true;
+      }
+    }
+    return !strcmp(host, MQTT_BROKER) && address.fromString(MQTT_BROKER);
+  }
+
+  bool resolve(const char* host, IPAddress& address) override {
+    counters.dnsQueries++;
+    return wifiConnected() && lookup(host, address);
+  }
+
+  // UDP
+
+  bool udpSend(uint16_t localPort, const IPAddress& address, uint16_t port,
+               const uint8_t* data, size_t length) override {
+    if (!wifiConnected()) {
+      return false;
+    }
+    uint64_t arrival = worldNow() + oneWay;
+    if (address == IPAddress(board.dns) && port == DNS_PORT) {
+      answerDns(localPort, address, data, length, arrival);
+    } else if (port == NTP_PORT && ntpIndex(address) >= 0) {
+      answerNtp(localPort, address, data, length, arrival);
+    }
+    return true;
+  }
+
+  int udpReceive(uint16_t localPort, uint8_t* buffer, size_t size,
+                 IPAddress& address, uint16_t& port) override {
+    uint64_t now = worldNow();
+    for (size_t i = 0; i < datagrams.size(); i++) {
+      Datagram& d = datagrams[i];
+      if (d.localPort != localPort || d.due > now) {
+        continue;
+      }
+      size_t length = d.data.size() < size ? d.data.size() : size;
+      memcpy(buffer, d.data.data(), length);
+      address = d.from;
+      port = d.fromPort;
+      datagrams.erase(datagrams.begin() + i);
+      return length;
+    }
+    return 0;
+  }
+
+  // TCP: the broker is the only server
+
+  int tcpConnect(const IPAddress& address, uint16_t port) override {
+    IPAddress broker;
+    if (!wifiConnected() || !broker.fromString(MQTT_BROKER) || address != broker ||
+        port != MQTT_BROKER_PORT) {
+      return 0;
+    }
+    closeBroker();
+    brokerOpen = true;
+    counters.mqttConnects++;
+    return SIM_MQTT_HANDLE;
+  }
+
+  bool tcpConnected(int handle) override {
+    return handle == SIM_MQTT_HANDLE && brokerOpen && wifiConnected();
+  }
+
+  int tcpAvailable(int handle) override {
+    if (!tcpConnected(handle) || brokerTx.empty() || brokerTx.front().due > worldNow()) {
+      return 0;
+    }
+    return brokerTx.front().data.size() - brokerTxPos;
+  }
+
+  int tcpRead(int handle, uint8_t* buffer, size_t size) override {
+    int available = tcpAvailable(handle);
+    size_t length = (size_t)available < size ? available : size;
+    if (length == 0) {
+      return 0;
+    }
+    memcpy(buffer, brokerTx.front().data.data() + brokerTxPos, length);
+    brokerTxPos += length;
+    if (brokerTxPos == brokerTx.front().data.size()) {
+      brokerTx.pop_front();
+      brokerTxPos = 0;
+    }
+    return length;
+  }
+
+  size_t tcpWrite(int handle, const uint8_t* data, size_t length) override {
+    if (!tcpConnected(handle)) {
+      return 0;
+    }
+    brokerRx.insert(brokerRx.end(), data, data + length);
+    while (brokerOpen && takeMqttPacket()) {
+    }
+    return length;
+  }
+
+  void tcpClose(int handle) override {
+    if (handle == SIM_MQTT_HANDLE) {
+      closeBroker();
+    }
+  }
+
+  static IPAddress ntpServer(uint8_t i) {
+    return IPAddress(203, 0, 113, 1 + i);
+  }
+
+private:
+  static int ntpIndex(const IPAddress& address) {
+    for (uint8_t i = 0; i < NTP_SERVER_COUNT; i++) {
+      if (address == ntpServer(i)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  void reply(uint64_t due, uint16_t localPort, const IPAddress& from, uint16_t fromPort,
+             const uint8_t* data, size_t length) {
+    Datagram d;
+    d.due = due;
+    d.localPort = localPort;
+    d.from = from;
+    d.fromPort = fromPort;
+    d.data.assign(data, data + length);
+    datagrams.push_back(d);
+  }
+
+  /**
+   * @brief Answer an A query for a known name, NXDOMAIN otherwise
+   */
+  void answerDns(uint16_t localPort, const IPAddress& server, const uint8_t* query,
+                 size_t length, uint64_t arrival) {
+    counters.dnsQueries++;
+    char name[64];
+    size_t pos = DNS_HEADER_SIZE;
+    size_t out = 0;
+    while (pos < length && query[pos] != 0) {
+      uint8_t label = query[pos++];
+      if (pos + label > length || out + label + 1 >= sizeof(name)) {
+        counters.errors++;
+        return;
+      }
+      if (out > 0) name[out++] = '.';
+      memcpy(name + out, query + pos, label);
+      out += label;
+      pos += label;
+    }
+    name[out] = '\0';
+    size_t questionEnd = pos + 5;  // Root label, QTYPE, QCLASS
+    if (length < DNS_HEADER_SIZE || questionEnd > length) {
+      counters.errors++;
+      return;
+    }
+
+    uint8_t answer[HOST_UDP_PACKET_MAX];
+    memcpy(answer, query, questionEnd);
+    answer[2] = 0x81;  // QR, RD
+    answer[3] = 0x80;  // RA, RCODE 0
+    memset(answer + 6, 0, 6);
+    size_t end = questionEnd;
+    IPAddress address;
+    if (lookup(name, address)) {
+      answer[7] = 1;  // ANCOUNT
+      const uint8_t record[] = {
+        0xC0, DNS_HEADER_SIZE, 0, DNS_TYPE_A, 0, DNS_CLASS_IN,
+        0, 0, SIM_DNS_TTL >> 8, SIM_DNS_TTL & 0xFF,
+        0, 4, address[0], address[1], address[2], address[3]
+      };
+      memcpy(answer + end, record, sizeof(record));
+      end += sizeof(record);
+    } else {
+      answer[3] |= 3;  // NXDOMAIN
+    }
+    reply(arrival + oneWay, localPort, server, DNS_PORT, answer, end);
+  }
+
+  /**
+   * @brief Answer a client request from a stratum 1 server on world time
+   */
+  void answerNtp(uint16_t localPort, const IPAddress& server, const uint8_t* request,
+                 size_t length, uint64_t arrival) {
+    counters.ntpRequests++;
+    if (!NtpPacket::isClientRequest(request, length)) {
+      counters.errors++;
+      return;
+    }
+    uint8_t answer[NTP_PACKET_SIZE];
+    int64_t received = utcMicros(arrival);
+    NtpPacket::buildReply(answer, request, 1, 0, NtpPacket::toShort(100), 0x47505300,
+                          NtpPacket::fromUnixMicros(received - 16000000),
+                          NtpPacket::fromUnixMicros(received));
+    NtpPacket::setTransmit(answer, NtpPacket::fromUnixMicros(received + 30));
+    reply(arrival + 30 + oneWay, localPort, server, NTP_PORT, answer, NTP_PACKET_SIZE);
+  }
+
+  /**
+   * @brief Consume one complete MQTT packet from the client, if any
+   */
+  bool takeMqttPacket() {
+    size_t remaining = 0;
+    size_t header = 1;
+    uint8_t shift = 0;
+    for (;;) {
+      if (header >= brokerRx.size()) {
+        return false;
+      }
+      uint8_t digit = brokerRx[header++];
+      remaining |= (size_t)(digit & 0x7F) << shift;
+      shift += 7;
+      if (!(digit & 0x80)) break;
+      if (shift > 21) {
+        counters.errors++;
+        closeBroker();
+        return false;
+      }
+    }
+    if (brokerRx.size() < header + remaining) {
+      return false;
+    }
+
+    const uint8_t* body = brokerRx.data() + header;
+    uint8_t type = brokerRx[0] >> 4;
+    uint8_t qos = (brokerRx[0] >> 1) & 3;
+    uint8_t ack[4];
+    if (type == MQTT_CONNECT) {
+      ack[0] = MQTT_CONNACK << 4; ack[1] = 2; ack[2] = 0; ack[3] = 0;
+      send(ack, 4);
+    } else if (type == MQTT_PUBLISH && remaining >= 2) {
+      size_t topic = ((size_t)body[0] << 8) | body[1];
+      size_t payload = 2 + topic + (qos ? 2 : 0);
+      if (payload > remaining) {
+        counters.errors++;
+      } else {
+        counters.publishes++;
+        counters.publishBytes += remaining - payload;
+        if (qos == 1) {
+          ack[0] = MQTT_PUBACK << 4; ack[1] = 2; ack[2] = body[2 + topic]; ack[3] = body[3 + topic];
+          send(ack, 4);
+        }
+      }
+    } else if (type == MQTT_PINGREQ) {
+      ack[0] = MQTT_PINGRESP << 4; ack[1] = 0;
+      send(ack, 2);
+    } else if (type == MQTT_DISCONNECT) {
+      closeBroker();
+      return false;
+    }
+    brokerRx.erase(brokerRx.begin(), brokerRx.begin() + header + remaining);
+    return true;
+  }
+
+  void send(const uint8_t* data, size_t length) {
+    Segment segment;
+    segment.due = worldNow() + 2 * oneWay;
+    segment.data.assign(data, data + length);
+    brokerTx.push_back(segment);
+  }
+
+  void closeBroker() {
+    brokerOpen = false;
+    brokerRx.clear();
+    brokerTx.clear();
+    brokerTxPos = 0;
+  }
+};
+
+#endif // SIM_NETWORK_H
@@ -0,0 +1,158 @@
+/**
+ * @file WorkStealingPool.h
+ * @brief Fixed thread pool with per-worker deques and work stealing
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * run() hands a batch of independent tasks to the workers and returns
+ * when all are done. Tasks are dealt round-robin into one deque per
+ * worker; a worker takes from the back of its own deque and, once it is
+ * empty, steals from the front of the others. Clocks that cost more
+ * (booting, syncing, publishing) thus do not leave threads idle while
+ * one worker finishes its share. The threads live as long as the pool.
+ */
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Runs batches of tasks on a fixed set of threads
+ */
+class WorkStealingPool {
+private:
+  struct Worker {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+    std::atomic<unsigned long> steals{0};
+  };
+
+  std::vector<std::thread> threads;
+  std::vector<Worker> workers;
+  std::function<void(size_t)> task;
+
+  std::mutex lock;
+  std::condition_variable started;
+  std::condition_variable finished;
+  unsigned long batch;
+  size_t busy;
+  bool stopping;
+
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param count Number of worker threads, at least 1
+   */
+  explicit WorkStealingPool(size_t count) :
+    workers(count ? count : 1),
+    batch(0),
+    busy(0),
+    stopping(false) {
+    for (size_t i = 0; i < workers.size(); i++) {
+      threads.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  ~WorkStealingPool() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+    }
+    started.notify_all();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  size_t size() const {
+    return workers.size();
+  }
+
+  /**
+   * @brief Run fn(0) .. fn(count - 1) and wait for all of them
+   */
+  void run(size_t count, const std::function<void(size_t)>& fn) {
+    std::unique_lock<std::mutex> guard(lock);
+    task = fn;
+    for (size_t i = 0; i < count; i++) {
+      Worker& worker = workers[i % workers.size()];
+      std::lock_guard<std::mutex> queue(worker.lock);
+      worker.tasks.push_back(i);
+    }
+    busy = workers.size();
+    batch++;
+    started.notify_all();
+    finished.wait(guard, [this] { return busy == 0; });
+  }
+
+  /**
+   * @brief Tasks taken from another worker's deque since construction
+   */
+  unsigned long steals() {
+    unsigned long total = 0;
+    for (Worker& worker : workers) {
+      total += worker.steals;
+    }
+    return total;
+  }
+
+private:
+  bool take(size_t self, size_t& index) {
+    Worker& own = workers[self];
+    {
+      std::lock_guard<std::mutex> queue(own.lock);
+      if (!own.tasks.empty()) {
+        index = own.tasks.back();
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t n = 1; n < workers.size(); n++) {
+      Worker& victim = workers[(self + n) % workers.size()];
+      std::lock_guard<std::mutex> queue(victim.lock);
+      if (!victim.tasks.empty()) {
+        index = victim.tasks.front();
+        victim.tasks.pop_front();
+        own.steals++;  // Only written by its owner, never under two locks
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(size_t self) {
+    unsigned long seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        started.wait(guard, [this, seen] { return stopping || batch != seen; });
+        if (stopping) {
+          return;
+        }
+        seen = batch;
+      }
+
+      size_t index;
+      while (take(self, index)) {
+        task(index);
+      }
+
+      std::lock_guard<std::mutex> guard(lock);
+      if (--busy == 0) {
+        finished.notify_one();
+      }
+    }
+  }
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,309 @@
+/**
+ * @file fleet.cpp
+ * @brief Runs a fleet of virtual clocks on a work-stealing thread pool
+ * @author Your Name
+ * @version 1.0
+ * @date 2025
+ *
+ * Each virtual clock is the unchanged firmware (Firmware.h) on its own
+ * HostBoard: its own virtual micros(), Timebase, RTC, sensor simulation
+ * and SimNetwork with its own latency, access point delay and
+ * oscillator drift. Power-ups are staggered over the first minute.
+ * The fleet advances in slices of world time; in each slice every clock
+ * runs its loop() until it reaches the end of the slice, and the pool
+ * spreads the clocks over the threads.
+ *
+ * One FLEET {json} line per run: simulated clock-seconds per wall
+ * second, MQTT uploads, NTP and DNS traffic, and the largest offset from
+ * world time among the clocks synchronized over NTP, and the longest
+ * loop stall in WiFi.begin(). The firmware's own upload counters are
+ * checked against what the simulated broker received: a clock cannot
+ * have more messages acknowledged than the broker took, nor have written
+ * fewer bytes than the payloads that arrived. Clocks that disagree are
+ * counted in "count_mismatches" and make the run exit with 1. With --scaling, the same fleet is run with
+ * 1, 2, 4... threads up to --threads, each line with its speedup over
+ * one thread.
+ *
+ * Build from the firmware directory:
+ *
+ *   g++ -O2 -std=gnu++17 -pthread -include Arduino.h -Ihost -Imultifunctional-clock \
+ *       simulator/fleet.cpp host/HostBoard.cpp -o fleet
+ *   ./fleet [--clocks N] [--threads N] [--minutes N] [--scaling] [--log N]
+ */
+
+// One Timebase selection per thread, whichever clock it runs
+#define TIMEBASE_LOCAL thread_local
+
+#include <Arduino.h>
+#include <chrono>
+#include <memory>
+#include "Firmware.h"
+#include "RtcBackend.h"
+#include "SensorSource.h"
+#include "SimNetwork.h"
+#include "WorkStealingPool.h"
+
+#define FLEET_SLICE_US          60000000ULL    // World time run between barriers
+#define FLEET_STAGGER_US        60000000ULL    // Power-ups spread over the first minute
+#define FLEET_DRIFT_PPM         50.0           // Oscillator error, up to +/-
+#define FLEET_LATENCY_MIN_US    2000           // One-way latency to the servers
+#define FLEET_LATENCY_MAX_US    60000
+#define FLEET_ASSOCIATION_MIN_US 1000000       // Time to join the access point
+#define FLEET_ASSOCIATION_MAX_US 6000000
+
+/**
+ * @brief Serial sink writing to stdout, for --log
+ */
+class StdoutPrint : public Print {
+public:
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+};
+
+/**
+ * @class VirtualClock
+ * @brief One clock: board, network, RTC, sensors and firmware
+ */
+class VirtualClock {
+private:
+  HostBoard board;
+  Timebase timebase;
+  std::unique_ptr<MemoryRtc> rtc;
+  SimulatedSensorSource sensors;
+  std::unique_ptr<Firmware> firmware;
+  bool rtcKept;                 ///< RTC kept time while powered off
+  bool halted;                  ///< begin() failed, as while(1) in setup()
+
+public:
+  SimNetwork network;
+  unsigned long loops;
+
+  VirtualClock(uint32_t id, uint64_t powerUp, double driftPpm, uint32_t latencyUs,
+               uint32_t associationUs, bool keptTime, Print* log) :
+    timebase(0),
+    sensors(id + 1),
+    rtcKept(keptTime),
+    halted(false),
+    network(board, powerUp, driftPpm, latencyUs, associationUs),
+    loops(0) {
+    board.network = &network;
+    board.serial = log;
+    board.rngState = id + 1;
+  }
+
+  /**
+   * @brief Run loop() until the board reaches a world time
+   *
+   * Runs setup() first on the first call after power-up.
+   */
+  void runUntil(uint64_t world) {
+    uint64_t until = network.boardAt(world);
+    if (until == 0 || halted) {
+      return;
+    }
+    hostBoard = &board;
+    Timebase::select(&timebase);
+
+    if (!firmware) {
+      boot();
+    }
+    while (!halted && board.micros < until) {
+      firmware->loop();
+      loops++;
+    }
+
+    Timebase::select(nullptr);
+    hostBoard = nullptr;
+  }
+
+  /**
+   * @brief Offset from world time of a clock synchronized over NTP
+   *
+   * @param offset Clock time minus world time (us)
+   * @return false if the clock has no recent NTP time
+   */
+  bool ntpOffset(int64_t& offset) {
+    if (!firmware) {
+      return false;
+    }
+    hostBoard = &board;
+    Timebase::select(&timebase);
+    NtpReference reference;
+    bool synced = firmware->clockMgr.getNtpReference(reference);
+    if (synced) {
+      offset = reference.offset + (int64_t)Timebase::micros64() - SimNetwork::utcMicros(network.worldNow());
+    }
+    Timebase::select(nullptr);
+    hostBoard = nullptr;
+    return synced;
+  }
+
+  /**
+   * @brief Longest time the firmware spent inside WiFi.begin() (ms)
+   */
+  uint32_t maxWifiBeginMs() const {
+    return firmware ? firmware->networkMgr.getWifiMetrics().maxBeginMs : 0;
+  }
+
+  /**
+   * @brief MQTT messages the firmware saw acknowledged
+   */
+  unsigned long uploadCount() const {
+    return firmware ? firmware->networkMgr.getUploadCount() : 0;
+  }
+
+  /**
+   * @brief Bytes the firmware wrote to the broker, headers included
+   */
+  unsigned long bytesSent() const {
+    return firmware ? firmware->networkMgr.getBytesSent() : 0;
+  }
+
+private:
+  void boot() {
+    // An RTC that kept time holds UTC at power-up; otherwise it is stopped
+    uint32_t utc = (uint32_t)(SimNetwork::utcMicros(network.worldNow()) / 1000000);
+    rtc.reset(new MemoryRtc(rtcKept ? utc : 0));
+    firmware.reset(new Firmware());
+    firmware->clockMgr.setRtc(rtc.get());
+    firmware->sensorMgr.setSource(&sensors);
+
+    Serial.println("=== Horloge Multifonctions v1.0 ===");
+    halted = !firmware->begin();
+    firmware->start();
+  }
+};
+
+/**
+ * @struct FleetOptions
+ */
+struct FleetOptions {
+  uint32_t clocks = 64;
+  uint32_t threads = 0;         ///< 0: one per core
+  uint32_t minutes = 30;
+  bool scaling = false;
+  long log = -1;                ///< Clock whose Serial goes to stdout
+};
+
+/**
+ * @brief Uniform value in [low, high] from a fixed-seed generator
+ */
+static uint32_t draw(uint32_t& state, uint32_t low, uint32_t high) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return low + state % (high - low + 1);
+}
+
+/**
+ * @brief Build and run one fleet, print its FLEET line
+ *
+ * @param mismatches Incremented for each clock whose counters disagree
+ * @return Wall time of the run (s)
+ */
+static double runFleet(const FleetOptions& options, uint32_t threads, double baseline, uint32_t& mismatches) {
+  static StdoutPrint out;
+  std::vector<std::unique_ptr<VirtualClock>> clocks;
+  uint32_t state = 2463534242UL;
+  for (uint32_t i = 0; i < options.clocks; i++) {
+    uint64_t powerUp = (uint64_t)draw(state, 0, 1000000) * FLEET_STAGGER_US / 1000000;
+    double drift = ((int32_t)draw(state, 0, 2000) - 1000) * FLEET_DRIFT_PPM / 1000.0;
+    uint32_t latency = draw(state, FLEET_LATENCY_MIN_US, FLEET_LATENCY_MAX_US);
+    uint32_t association = draw(state, FLEET_ASSOCIATION_MIN_US, FLEET_ASSOCIATION_MAX_US);
+    clocks.emplace_back(new VirtualClock(i, powerUp, drift, latency, association, i % 2 == 1,
+                                         (long)i == options.log ? &out : nullptr));
+  }
+
+  WorkStealingPool pool(threads);
+  uint64_t end = (uint64_t)options.minutes * 60000000ULL;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t world = FLEET_SLICE_US; ; world += FLEET_SLICE_US) {
+    uint64_t until = world < end ? world : end;
+    pool.run(clocks.size(), [&clocks, until](size_t i) { clocks[i]->runUntil(until); });
+    if (until == end) break;
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  SimCounters total = {};
+  unsigned long loops = 0;
+  uint32_t synced = 0;
+  int64_t maxError = 0;
+  uint32_t maxBegin = 0;
+  unsigned long acked = 0;
+  unsigned long sent = 0;
+  uint32_t disagree = 0;
+  double simulated = 0;
+  for (auto& clock : clocks) {
+    const SimCounters& c = clock->network.counters;
+    total.associations += c.associations;
+    total.dnsQueries += c.dnsQueries;
+    total.ntpRequests += c.ntpRequests;
+    total.mqttConnects += c.mqttConnects;
+    total.publishes += c.publishes;
+    total.publishBytes += c.publishBytes;
+    total.errors += c.errors;
+    loops += clock->loops;
+    simulated += (end - clock->network.worldAt(0)) / 1e6;
+    uint32_t begin = clock->maxWifiBeginMs();
+    if (begin > maxBegin) maxBegin = begin;
+    // The broker counts what arrived, the firmware what it wrote and got back
+    unsigned long uploads = clock->uploadCount();
+    unsigned long bytes = clock->bytesSent();
+    acked += uploads;
+    sent += bytes;
+    if (uploads > c.publishes || bytes < c.publishBytes) disagree++;
+    int64_t offset;
+    if (clock->ntpOffset(offset)) {
+      synced++;
+      if (llabs(offset) > maxError) maxError = llabs(offset);
+    }
+  }
+
+  printf("FLEET {\"threads\":%u,\"clocks\":%u,\"minutes\":%u,\"simulated_s\":%.0f,"
+         "\"wall_s\":%.3f,\"sim_s_per_wall_s\":%.0f,\"loops_per_s\":%.0f,\"speedup\":%.2f,"
+         "\"steals\":%lu,\"associations\":%lu,\"dns_queries\":%lu,\"ntp_requests\":%lu,"
+         "\"mqtt_connects\":%lu,\"uploads\":%lu,\"upload_bytes\":%lu,\"errors\":%lu,"
+         "\"acked\":%lu,\"sent_bytes\":%lu,\"count_mismatches\":%u,"
+         "\"synced\":%u,\"max_offset_ms\":%.3f,\"max_wifi_begin_ms\":%u}\n",
+         threads, options.clocks, options.minutes, simulated, wall, simulated / wall,
+         loops / wall, baseline > 0 ? baseline / wall : 1.0, pool.steals(),
+         total.associations, total.dnsQueries, total.ntpRequests, total.mqttConnects,
+         total.publishes, total.publishBytes, total.errors, acked, sent, disagree,
+         synced, maxError / 1000.0, maxBegin);
+  fflush(stdout);
+  mismatches += disagree;
+  return wall;
+}
+
+int main(int argc, char** argv) {
+  FleetOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--clocks") && i + 1 < argc) {
+      options.clocks = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+      options.threads = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--minutes") && i + 1 < argc) {
+      options.minutes = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--log") && i + 1 < argc) {
+      options.log = atol(argv[++i]);
+    } else if (!strcmp(argv[i], "--scaling")) {
+      options.scaling = true;
+    } else {
+      fprintf(stderr, "usage: %s [--clocks N] [--threads N] [--minutes N] [--scaling] [--log N]\n", argv[0]);
+      return 2;
+    }
+  }
+  uint32_t threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+
+  uint32_t mismatches = 0;
+  if (!options.scaling) {
+    runFleet(options, threads, 0, mismatches);
+    return mismatches ? 1 : 0;
+  }
+  double baseline = runFleet(options, 1, 0, mismatches);
+  for (uint32_t n = 2; n <= threads; n *= 2) {
+    runFleet(options, n, baseline, mismatches);
+  }
+  return mismatches ? 1 : 0;
+}
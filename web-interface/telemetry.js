@@ -0,0 +1,268 @@
+/**
+ * Telemetry decoder for the clock's compact CBOR payloads
+ * (firmware/multifunctional-clock/TelemetryCbor.h).
+ *
+ * Also inflates LZSS streams (firmware/multifunctional-clock/Lzss.h),
+ * as sent by the API with ?compress=lzss and by compressed MQTT batches,
+ * and maps the binary history (/api/history?format=bin) into typed arrays.
+ *
+ * Works in the browser (window.Telemetry) and in Node:
+ *   node telemetry.js payload.cbor      decodes a file and prints JSON
+ *   curl -s 'http://<clock>/api/data?format=cbor' | node telemetry.js
+ *   curl -s 'http://<clock>/api/data?compress=lzss' | node telemetry.js --lzss
+ *   curl -s 'http://<clock>/api/history?format=bin' | node telemetry.js
+ */
+(function (root) {
+  'use strict';
+
+  // Sample fields in encoding order, with their fixed-point scale
+  var FIELDS = [
+    ['tempIndoor', 10],
+    ['tempOutdoor', 10],
+    ['humidityIndoor', 10],
+    ['humidityOutdoor', 10],
+    ['pressure', 100],
+    ['airQuality', 1]
+  ];
+
+  var BATCH_VERSION = 1;
+
+  // Binary history, as in HistoryLog.h; same fields, every one x10 except
+  // air quality
+  var HISTORY_MAGIC = 0x48;  // 'H'
+  var HISTORY_VERSION = 1;
+  var HISTORY_HEADER = 12;
+  var HISTORY_SCALES = [10, 10, 10, 10, 10, 1];
+
+  // LZSS parameters, as in Lzss.h
+  var LZSS_WINDOW_BITS = 8;
+  var LZSS_LENGTH_BITS = 4;
+  var LZSS_MIN_MATCH = 2;
+
+  /**
+   * Inflate an LZSS stream: 1 + 8 bits for a literal, 0 + distance - 1 +
+   * length - LZSS_MIN_MATCH for a match, MSB first, 0-padded.
+   */
+  function inflateLzss(bytes) {
+    var out = [];
+    var totalBits = bytes.length * 8;
+    var bit = 0;
+
+    function read(count) {
+      var value = 0;
+      for (var i = 0; i < count; i++, bit++) {
+        value = (value << 1) | ((bytes[bit >> 3] >> (7 - (bit & 7))) & 1);
+      }
+      return value;
+    }
+
+    while (true) {
+      if (totalBits - bit < 9) break;  // Only padding left
+      if (read(1)) {
+        out.push(read(8));
+        continue;
+      }
+      if (totalBits - bit < LZSS_WINDOW_BITS + LZSS_LENGTH_BITS) break;
+      var distance = read(LZSS_WINDOW_BITS) + 1;
+      var length = read(LZSS_LENGTH_BITS) + LZSS_MIN_MATCH;
+      if (distance > out.length) throw new Error('LZSS match before start of stream');
+      for (var k = 0; k < length; k++) out.push(out[out.length - distance]);
+    }
+    return new Uint8Array(out);
+  }
+
+  /**
+   * Decode one CBOR item (RFC 8949: integers, strings, arrays, maps,
+   * simple values and floats; no tags or indefinite lengths).
+   */
+  function decodeCbor(bytes) {
+    var view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    var pos = 0;
+
+    function argument(info) {
+      if (info < 24) return info;
+      var value;
+      switch (info) {
+        case 24: value = view.getUint8(pos); pos += 1; return value;
+        case 25: value = view.getUint16(pos); pos += 2; return value;
+        case 26: value = view.getUint32(pos); pos += 4; return value;
+        case 27:
+          value = view.getUint32(pos) * 4294967296 + view.getUint32(pos + 4);
+          pos += 8;
+          return value;
+        default: throw new Error('Unsupported CBOR length ' + info + ' at ' + (pos - 1));
+      }
+    }
+
+    function item() {
+      if (pos >= bytes.length) throw new Error('Truncated CBOR');
+      var initial = bytes[pos++];
+      var major = initial >> 5;
+      var info = initial & 0x1f;
+      var i, n, out, start;
+
+      switch (major) {
+        case 0: return argument(info);
+        case 1: return -1 - argument(info);
+        case 2:
+        case 3:
+          n = argument(info);
+          start = pos;
+          pos += n;
+          if (pos > bytes.length) throw new Error('Truncated CBOR');
+          return major === 2 ? bytes.slice(start, pos) :
+            new TextDecoder().decode(bytes.subarray(start, pos));
+        case 4:
+          n = argument(info);
+          out = [];
+          for (i = 0; i < n; i++) out.push(item());
+          return out;
+        case 5:
+          n = argument(info);
+          out = {};
+          for (i = 0; i < n; i++) {
+            var key = item();
+            out[key] = item();
+          }
+          return out;
+        case 7:
+          if (info === 20) return false;
+          if (info === 21) return true;
+          if (info === 22) return null;
+          if (info === 25) { n = halfToFloat(view.getUint16(pos)); pos += 2; return n; }
+          if (info === 26) { n = view.getFloat32(pos); pos += 4; return n; }
+          if (info === 27) { n = view.getFloat64(pos); pos += 8; return n; }
+          throw new Error('Unsupported CBOR simple value ' + info);
+        default:
+          throw new Error('Unsupported CBOR major type ' + major);
+      }
+    }
+
+    var value = item();
+    if (pos !== bytes.length) throw new Error('Trailing bytes after CBOR item');
+    return value;
+  }
+
+  function halfToFloat(half) {
+    var exponent = (half >> 10) & 0x1f;
+    var mantissa = half & 0x3ff;
+    var value = exponent === 0 ? mantissa * Math.pow(2, -24) :
+      exponent === 31 ? (mantissa ? NaN : Infinity) :
+      (mantissa + 1024) * Math.pow(2, exponent - 25);
+    return half & 0x8000 ? -value : value;
+  }
+
+  /**
+   * Sample fields array -> object with the /api/data JSON names
+   */
+  function fieldsToData(fields, offset) {
+    var data = {};
+    for (var i = 0; i < FIELDS.length; i++) {
+      data[FIELDS[i][0]] = fields[offset + i] / FIELDS[i][1];
+    }
+    data.valid = fields[offset + FIELDS.length] === true;
+    return data;
+  }
+
+  /**
+   * GET /api/data?format=cbor -> { tempIndoor: 21.5, ..., valid: true }
+   */
+  function decodeSample(bytes) {
+    var fields = decodeCbor(bytes);
+    if (!Array.isArray(fields) || fields.length !== FIELDS.length + 1) {
+      throw new Error('Not a telemetry sample');
+    }
+    return fieldsToData(fields, 0);
+  }
+
+  /**
+   * MQTT batch -> [{ time: <UTC epoch>, data: {...} }, ...]
+   */
+  function decodeBatch(bytes) {
+    var batch = decodeCbor(bytes);
+    if (!batch || batch[0] !== BATCH_VERSION || !Array.isArray(batch[2])) {
+      throw new Error('Not a telemetry batch (version ' + (batch && batch[0]) + ')');
+    }
+    var time = batch[1];
+    return batch[2].map(function (entry, i) {
+      if (i > 0) time += entry[0];
+      return { time: time, data: fieldsToData(entry, 1) };
+    });
+  }
+
+  /**
+   * GET /api/history?format=bin -> { field, last, matched, time: Uint32Array,
+   * series: { tempIndoor: Int16Array, ... }, scale: { tempIndoor: 10, ... } }
+   *
+   * The columns are views on the response, not copies: divide by the scale
+   * when drawing (series.tempIndoor[i] / scale.tempIndoor is in degrees).
+   */
+  function decodeHistory(bytes) {
+    var view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    if (bytes.length < HISTORY_HEADER || bytes[0] !== HISTORY_MAGIC || bytes[1] !== HISTORY_VERSION) {
+      throw new Error('Not a binary history (version ' + bytes[1] + ')');
+    }
+    var columns = bytes[3];
+    var points = view.getUint16(10, true);
+    if (bytes.length !== HISTORY_HEADER + points * (4 + 2 * columns)) {
+      throw new Error('Truncated binary history');
+    }
+    // Typed arrays need aligned offsets: copy only if the buffer is not
+    if (bytes.byteOffset % 4 !== 0) bytes = bytes.slice();
+
+    var history = {
+      field: bytes[2] < FIELDS.length ? FIELDS[bytes[2]][0] : bytes[2],
+      last: view.getUint32(4, true),
+      matched: view.getUint16(8, true),
+      time: new Uint32Array(bytes.buffer, bytes.byteOffset + HISTORY_HEADER, points),
+      series: {},
+      scale: {}
+    };
+    var offset = bytes.byteOffset + HISTORY_HEADER + points * 4;
+    for (var i = 0; i < columns && i < FIELDS.length; i++, offset += points * 2) {
+      history.series[FIELDS[i][0]] = new Int16Array(bytes.buffer, offset, points);
+      history.scale[FIELDS[i][0]] = HISTORY_SCALES[i];
+    }
+    return history;
+  }
+
+  /**
+   * JSON text, a binary history, or a CBOR sample or batch, told apart by
+   * their first byte
+   */
+  function decode(bytes) {
+    if (bytes[0] === 0x7b || bytes[0] === 0x5b) {  // '{' or '['
+      return JSON.parse(new TextDecoder().decode(bytes));
+    }
+    if (bytes[0] === HISTORY_MAGIC) {
+      return decodeHistory(bytes);
+    }
+    return (bytes[0] >> 5) === 5 ? { samples: decodeBatch(bytes) } : decodeSample(bytes);
+  }
+
+  var Telemetry = {
+    inflateLzss: inflateLzss,
+    decodeCbor: decodeCbor,
+    decodeSample: decodeSample,
+    decodeBatch: decodeBatch,
+    decodeHistory: decodeHistory,
+    decode: decode
+  };
+
+  if (typeof module !== 'undefined' && module.exports) {
+    module.exports = Telemetry;
+    if (require.main === module) {
+      var fs = require('fs');
+      var args = process.argv.slice(2);
+      var lzss = args[0] === '--lzss';
+      if (lzss) args.shift();
+      var input = new Uint8Array(fs.readFileSync(args[0] || 0));
+      if (lzss) input = inflateLzss(input);
+      console.log(JSON.stringify(decode(input), function (key, value) {
+        return ArrayBuffer.isView(value) ? Array.from(value) : value;
+      }, 2));
+    }
+  } else {
+    root.Telemetry = Telemetry;
+  }
+})(this);